@@ -364,6 +364,8 @@ static void StartElementHandler ( void * userData, XMP_StringPtr name, XMP_Strin
 		++thiz->elemNesting;
 	#endif
 
+	if ( thiz->elementSink != 0 ) thiz->elementSink->StartElement ( elemNode );
+
 }	// StartElementHandler
 
 // =================================================================================================
@@ -377,6 +379,7 @@ static void EndElementHandler ( void * userData, XMP_StringPtr name )
 	#if XMP_DebugBuild
 		--thiz->elemNesting;
 	#endif
+	XML_Node * elemNode = thiz->parseStack.back();
 	(void) thiz->parseStack.pop_back();
 	
 	#if XMP_DebugBuild & DumpXMLParseEvents
@@ -386,6 +389,8 @@ static void EndElementHandler ( void * userData, XMP_StringPtr name )
 		}
 	#endif
 
+	if ( thiz->elementSink != 0 ) thiz->elementSink->EndElement ( elemNode );	// ! Might delete elemNode.
+
 }	// EndElementHandler
 
 // =================================================================================================
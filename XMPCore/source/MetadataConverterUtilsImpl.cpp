@@ -174,7 +174,7 @@ namespace AdobeXMPCore_Int {
         
         XMP_Node * newQual = 0;
         
-        newQual = new XMP_Node( xmpParent, childName, value, kXMP_PropIsQualifier );
+        newQual = new ( xmpParent ) XMP_Node( xmpParent, childName, value, kXMP_PropIsQualifier );
         
         if ( !( isLang | isType ) ) {
             xmpParent->qualifiers.push_back( newQual );
@@ -255,7 +255,7 @@ namespace AdobeXMPCore_Int {
         }
         
         // Add the new child to the XMP parent node.
-        XMP_Node * newChild = new XMP_Node( xmpParent, childName, value, childOptions );
+        XMP_Node * newChild = new ( xmpParent ) XMP_Node( xmpParent, childName, value, childOptions );
         xmpParent->children.push_back( newChild );
         
         return newChild;
@@ -268,7 +268,7 @@ namespace AdobeXMPCore_Int {
             spIMetadata metadata = structureNode->ConvertToMetadata();
             if ( metadata ) {
                 metadataNode = true;
-                parent->name = metadata->GetAboutURI()->c_str();
+                parent->name = XMP_NodeName::Private ( metadata->GetAboutURI()->c_str() );
             }
         }
         
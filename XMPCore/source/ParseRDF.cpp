@@ -24,7 +24,8 @@ using namespace std;
 // =================================================================================================
 
 // *** This might be faster and use less memory as a state machine. A big advantage of building an
-// *** XML tree though is easy lookahead during the recursive descent processing.
+// *** XML tree though is easy lookahead during the recursive descent processing. RDF_StreamParser
+// *** drives these productions during the XML parse for the large parts of typical packets.
 
 // *** It would be nice to give a line number or byte offset in the exception messages.
 
@@ -179,6 +180,12 @@ public:
 
 	void ResourcePropertyElement ( XMP_Node * xmpParent, const XML_Node & xmlNode, bool isTopLevel );
 
+	XMP_Node * StartResourceProperty ( XMP_Node * xmpParent, const XML_Node & xmlNode, bool isTopLevel );
+
+	bool SetResourcePropertyForm ( XMP_Node * newCompound, const XML_Node & valueNode );
+
+	void FinishResourceProperty ( XMP_Node * newCompound );
+
 	void LiteralPropertyElement ( XMP_Node * xmpParent, const XML_Node & xmlNode, bool isTopLevel );
 
 	void ParseTypeLiteralPropertyElement ( XMP_Node * xmpParent, const XML_Node & xmlNode, bool isTopLevel );
@@ -193,6 +200,9 @@ public:
 
 	RDF_Parser ( XMPMeta::ErrorCallbackInfo * ec ) : errorCallback(ec) {};
 
+	void NotifyClient ( XMP_ErrorSeverity severity, XMP_Error & error )
+		{ this->errorCallback->NotifyClient ( severity, error ); };
+
 private:
 
 	RDF_Parser() { 
@@ -472,7 +482,7 @@ XMP_Node * RDF_Parser::AddChildNode ( XMP_Node * xmpParent, const XML_Node & xml
 	}
 	
 	// Add the new child to the XMP parent node.
-	XMP_Node * newChild = new XMP_Node ( xmpParent, childName, value, childOptions );
+	XMP_Node * newChild = new ( xmpParent ) XMP_Node ( xmpParent, childName, value, childOptions );
 	if ( (! isValueNode) || xmpParent->children.empty() ) {
 		 xmpParent->children.push_back ( newChild );
 	} else {
@@ -495,7 +505,7 @@ XMP_Node * RDF_Parser::AddQualifierNode ( XMP_Node * xmpParent, const XMP_VarStr
 
 	XMP_Node * newQual = 0;
 
-	newQual = new XMP_Node ( xmpParent, name, value, kXMP_PropIsQualifier );
+	newQual = new ( xmpParent ) XMP_Node ( xmpParent, name, value, kXMP_PropIsQualifier );
 
 	if ( ! (isLang | isType) ) {
 		xmpParent->qualifiers.push_back ( newQual );
@@ -588,7 +598,7 @@ void RDF_Parser::FixupQualifiedNode ( XMP_Node * xmpParent )
 		} else {
 			xmpParent->qualifiers.insert ( xmpParent->qualifiers.begin(), langQual );
 		}
-		valueNode->qualifiers[0] = 0;	// We just moved it to the parent.
+		valueNode->qualifiers.SetNode ( 0, 0 );	// We just moved it to the parent.
 
 		qualNum = 1;	// Start the remaining copy after the xml:lang qualifier.
 
@@ -608,7 +618,7 @@ void RDF_Parser::FixupQualifiedNode ( XMP_Node * xmpParent )
 
 		currQual->parent = xmpParent;
 		xmpParent->qualifiers.push_back ( currQual );
-		valueNode->qualifiers[qualNum] = 0;	// We just moved it to the parent.
+		valueNode->qualifiers.SetNode ( qualNum, 0 );	// We just moved it to the parent.
 
 	}
 	
@@ -646,7 +656,7 @@ void RDF_Parser::FixupQualifiedNode ( XMP_Node * xmpParent )
 			
 		}
 		
-		xmpParent->children[childNum] = 0;	// We just moved it to the qualifers, or ignored it.
+		xmpParent->children.SetNode ( childNum, 0 );	// We just moved it to the qualifers, or ignored it.
 
 	}
 	
@@ -661,7 +671,7 @@ void RDF_Parser::FixupQualifiedNode ( XMP_Node * xmpParent )
 	
 	xmpParent->value.swap ( valueNode->value );
 
-	xmpParent->children[0] = 0;	// ! Remove the value node itself before the swap.
+	xmpParent->children.SetNode ( 0, 0 );	// ! Remove the value node itself before the swap.
 	xmpParent->children.swap ( valueNode->children );
 	
 	for ( childNum = 0, childLim = xmpParent->children.size(); childNum != childLim; ++childNum ) {
@@ -796,7 +806,7 @@ void RDF_Parser::NodeElementAttrs ( XMP_Node * xmpParent, const XML_Node & xmlNo
 					// it doesn't have a name yet. Make sure this name matches the XMP tree name.
 					XMP_Assert ( xmpParent->parent == 0 );	// Must be the tree root node.
 					if ( xmpParent->name.empty() ) {
-						xmpParent->name = (*currAttr)->value;
+						xmpParent->name = XMP_NodeName::Private ( (*currAttr)->value );
 					} else if ( ! (*currAttr)->value.empty() ) {
 						if ( xmpParent->name != (*currAttr)->value ) {
 							XMP_Error error ( kXMPErr_BadXMP, "Mismatched top level rdf:about values" );
@@ -991,10 +1001,54 @@ void RDF_Parser::PropertyElement ( XMP_Node * xmpParent, const XML_Node & xmlNod
 
 void RDF_Parser::ResourcePropertyElement ( XMP_Node * xmpParent, const XML_Node & xmlNode, bool isTopLevel )
 {
-	if ( isTopLevel && (xmlNode.name == "iX:changes") ) return;	// Strip old "punchcard" chaff.
+	XMP_Node * newCompound = this->StartResourceProperty ( xmpParent, xmlNode, isTopLevel );
+	if ( newCompound == 0 ) return;	// Ignore lower level errors.
+	
+	XML_cNodePos currChild = xmlNode.content.begin();
+	XML_cNodePos endChild  = xmlNode.content.end();
+
+	for ( ; currChild != endChild; ++currChild ) {
+		if ( ! (*currChild)->IsWhitespaceNode() ) break;
+	}
+	if ( currChild == endChild ) {
+		XMP_Error error ( kXMPErr_BadRDF, "Missing child of resource property element" );
+		this->errorCallback->NotifyClient ( kXMPErrSev_Recoverable, error );
+		return;
+	}
+	if ( (*currChild)->kind != kElemNode ) {
+		XMP_Error error ( kXMPErr_BadRDF, "Children of resource property element must be XML elements" );
+		this->errorCallback->NotifyClient ( kXMPErrSev_Recoverable, error );
+		return;
+	}
+
+	if ( ! this->SetResourcePropertyForm ( newCompound, **currChild ) ) return;
+
+	this->NodeElement ( newCompound, **currChild, kNotTopLevel );
+	this->FinishResourceProperty ( newCompound );
+
+	for ( ++currChild; currChild != endChild; ++currChild ) {
+		if ( ! (*currChild)->IsWhitespaceNode() ) {
+			XMP_Error error ( kXMPErr_BadRDF, "Invalid child of resource property element" );
+			this->errorCallback->NotifyClient ( kXMPErrSev_Recoverable, error );
+			break;	// Don't bother looking for more trailing errors.
+		}
+	}
+
+}	// RDF_Parser::ResourcePropertyElement
+
+// -------------------------------------------------------------------------------------------------
+// RDF_Parser::StartResourceProperty
+// ---------------------------------
+//
+// The parts of ResourcePropertyElement that only need the property element itself. Returns the new
+// XMP node, or 0 if the property is to be ignored.
+
+XMP_Node * RDF_Parser::StartResourceProperty ( XMP_Node * xmpParent, const XML_Node & xmlNode, bool isTopLevel )
+{
+	if ( isTopLevel && (xmlNode.name == "iX:changes") ) return 0;	// Strip old "punchcard" chaff.
 	
 	XMP_Node * newCompound = this->AddChildNode ( xmpParent, xmlNode, "", isTopLevel );
-	if ( newCompound == 0 ) return;	// Ignore lower level errors.
+	if ( newCompound == 0 ) return 0;	// Ignore lower level errors.
 	
 	XML_cNodePos currAttr = xmlNode.attrs.begin();
 	XML_cNodePos endAttr  = xmlNode.attrs.end();
@@ -1011,63 +1065,64 @@ void RDF_Parser::ResourcePropertyElement ( XMP_Node * xmpParent, const XML_Node
 			continue;
 		}
 	}
-	
-	XML_cNodePos currChild = xmlNode.content.begin();
-	XML_cNodePos endChild  = xmlNode.content.end();
 
-	for ( ; currChild != endChild; ++currChild ) {
-		if ( ! (*currChild)->IsWhitespaceNode() ) break;
-	}
-	if ( currChild == endChild ) {
-		XMP_Error error ( kXMPErr_BadRDF, "Missing child of resource property element" );
-		this->errorCallback->NotifyClient ( kXMPErrSev_Recoverable, error );
-		return;
-	}
-	if ( (*currChild)->kind != kElemNode ) {
-		XMP_Error error ( kXMPErr_BadRDF, "Children of resource property element must be XML elements" );
-		this->errorCallback->NotifyClient ( kXMPErrSev_Recoverable, error );
-		return;
-	}
+	return newCompound;
+
+}	// RDF_Parser::StartResourceProperty
+
+// -------------------------------------------------------------------------------------------------
+// RDF_Parser::SetResourcePropertyForm
+// -----------------------------------
+//
+// Set the array or struct form of a resource property from the name of its node element. Returns
+// false if the node element is not usable.
+
+bool RDF_Parser::SetResourcePropertyForm ( XMP_Node * newCompound, const XML_Node & valueNode )
+{
 
-	if ( (*currChild)->name == "rdf:Bag" ) {
+	if ( valueNode.name == "rdf:Bag" ) {
 		newCompound->options |= kXMP_PropValueIsArray;
-	} else if ( (*currChild)->name == "rdf:Seq" ) {
+	} else if ( valueNode.name == "rdf:Seq" ) {
 		newCompound->options |= kXMP_PropValueIsArray | kXMP_PropArrayIsOrdered;
-	} else if ( (*currChild)->name == "rdf:Alt" ) {
+	} else if ( valueNode.name == "rdf:Alt" ) {
 		newCompound->options |= kXMP_PropValueIsArray | kXMP_PropArrayIsOrdered | kXMP_PropArrayIsAlternate;
 	} else {
 		// This is the Typed Node case. Add an rdf:type qualifier with a URI value.
-		if ( (*currChild)->name != "rdf:Description" ) {
-			XMP_VarString typeName ( (*currChild)->ns );
-			size_t colonPos = (*currChild)->name.find_first_of(':');
+		if ( valueNode.name != "rdf:Description" ) {
+			XMP_VarString typeName ( valueNode.ns );
+			size_t colonPos = valueNode.name.find_first_of(':');
 			if ( colonPos == XMP_VarString::npos ) {
 				XMP_Error error ( kXMPErr_BadXMP, "All XML elements must be in a namespace" );
 				this->errorCallback->NotifyClient ( kXMPErrSev_Recoverable, error );
-				return;
+				return false;
 			}
-			typeName.append ( (*currChild)->name, colonPos+1, XMP_VarString::npos );	// Append just the local name.
+			typeName.append ( valueNode.name, colonPos+1, XMP_VarString::npos );	// Append just the local name.
 			XMP_Node * typeQual = this->AddQualifierNode ( newCompound, XMP_VarString("rdf:type"), typeName );
 			if ( typeQual != 0 ) typeQual->options |= kXMP_PropValueIsURI;
 		}
 		newCompound->options |= kXMP_PropValueIsStruct;
 	}
 
-	this->NodeElement ( newCompound, **currChild, kNotTopLevel );
+	return true;
+
+}	// RDF_Parser::SetResourcePropertyForm
+
+// -------------------------------------------------------------------------------------------------
+// RDF_Parser::FinishResourceProperty
+// ----------------------------------
+//
+// Cleanup once all of the node element content has been added.
+
+void RDF_Parser::FinishResourceProperty ( XMP_Node * newCompound )
+{
+
 	if ( newCompound->options & kRDF_HasValueElem ) {
 		this->FixupQualifiedNode ( newCompound );
 	} else if ( newCompound->options & kXMP_PropArrayIsAlternate ) {
 		DetectAltText ( newCompound );
 	}
 
-	for ( ++currChild; currChild != endChild; ++currChild ) {
-		if ( ! (*currChild)->IsWhitespaceNode() ) {
-			XMP_Error error ( kXMPErr_BadRDF, "Invalid child of resource property element" );
-			this->errorCallback->NotifyClient ( kXMPErrSev_Recoverable, error );
-			break;	// Don't bother looking for more trailing errors.
-		}
-	}
-
-}	// RDF_Parser::ResourcePropertyElement
+}	// RDF_Parser::FinishResourceProperty
 
 // =================================================================================================
 // RDF_Parser::LiteralPropertyElement
@@ -1385,6 +1440,242 @@ void RDF_Parser::EmptyPropertyElement ( XMP_Node * xmpParent, const XML_Node & x
 
 }	// RDF_Parser::EmptyPropertyElement
 
+// =================================================================================================
+// RDF_StreamParser
+// ================
+//
+// Used for kXMP_ParseStreaming, this drives the RDF productions from the XML parser callbacks so that
+// the XML tree never holds more than one top level property. The state machine is kept simple by
+// only streaming what dominates large packets: each top level property of a top level rdf:Description
+// is recognized when it ends, and the items of a top level array are recognized as each one ends.
+// The XML nodes are deleted once they are recognized. Anything else is left in the XML tree for the
+// normal recursive descent by ProcessRDF, which then only sees the leftovers.
+//
+// Only an rdf:RDF that the XML tree processing would choose as the root is streamed. That is the
+// first rdf:RDF child of an outermost x:xmpmeta element, or an outermost rdf:RDF element if that is
+// allowed. Other XML documents are not affected by the option.
+
+class RDF_StreamParser : public XML_ElementSink {
+public:
+
+	RDF_StreamParser ( XMP_Node * _xmpTree, XMPMeta::ErrorCallbackInfo * ec, XMP_OptionBits _options )
+		: rdf(ec), xmpTree(_xmpTree), options(_options), rdfRoot(0), rdfDone(false),
+		  currDesc(0), currProp(0), currArray(0), currCompound(0) {};
+
+	virtual ~RDF_StreamParser() {};
+
+	void StartElement ( XML_Node * elemNode );
+	void EndElement   ( XML_Node * elemNode );
+
+private:
+
+	RDF_Parser rdf;
+	XMP_Node * xmpTree;
+	XMP_OptionBits options;
+
+	XML_Node * rdfRoot;			// The rdf:RDF element being streamed.
+	bool       rdfDone;			// The streamed rdf:RDF has ended, ignore the rest.
+	XML_Node * currDesc;		// The top level rdf:Description being streamed.
+	XML_Node * currProp;		// The top level array property whose items are being streamed.
+	XML_Node * currArray;		// The rdf:Bag, rdf:Seq, or rdf:Alt element of currProp.
+	XMP_Node * currCompound;	// The XMP node for currProp, null if the property is ignored.
+
+	bool IsRootCandidate ( const XML_Node * elemNode ) const;
+	bool IsStreamedArray ( const XML_Node * elemNode ) const;
+
+	static void DeleteLastContent ( XML_Node * xmlParent, XML_Node * elemNode );
+
+	RDF_StreamParser ( const RDF_StreamParser & );	// ! Hidden on purpose.
+	void operator= ( const RDF_StreamParser & );
+
+};
+
+// -------------------------------------------------------------------------------------------------
+// RDF_StreamParser::IsRootCandidate
+// ---------------------------------
+//
+// Mirror FindRootNode and PickBestRoot, a later rdf:RDF can never be chosen over one of these.
+
+bool RDF_StreamParser::IsRootCandidate ( const XML_Node * elemNode ) const
+{
+	if ( elemNode->name != "rdf:RDF" ) return false;
+
+	const XML_Node * xmlParent = elemNode->parent;
+	if ( xmlParent->kind == kRootNode ) return ((this->options & kXMP_RequireXMPMeta) == 0);
+
+	return ( ((xmlParent->name == "x:xmpmeta") || (xmlParent->name == "x:xapmeta")) &&
+			 (xmlParent->parent != 0) && (xmlParent->parent->kind == kRootNode) );
+
+}	// RDF_StreamParser::IsRootCandidate
+
+// -------------------------------------------------------------------------------------------------
+// RDF_StreamParser::IsStreamedArray
+// ---------------------------------
+//
+// True for the array element of a top level property that PropertyElement would send to
+// ResourcePropertyElement, with only whitespace before the array element.
+
+bool RDF_StreamParser::IsStreamedArray ( const XML_Node * elemNode ) const
+{
+	if ( (elemNode->name != "rdf:Bag") && (elemNode->name != "rdf:Seq") && (elemNode->name != "rdf:Alt") ) return false;
+
+	const XML_Node * propNode = elemNode->parent;
+	if ( ! IsPropertyElementName ( GetRDFTermKind ( propNode->name ) ) ) return false;
+	if ( propNode->attrs.size() > 3 ) return false;
+
+	for ( size_t attrNum = 0, attrLim = propNode->attrs.size(); attrNum < attrLim; ++attrNum ) {
+		const XMP_VarString & attrName = propNode->attrs[attrNum]->name;
+		if ( (attrName != "xml:lang") && (attrName != "rdf:ID") ) return false;
+	}
+
+	XMP_Assert ( propNode->content.back() == elemNode );
+	for ( size_t childNum = 0, childLim = propNode->content.size() - 1; childNum < childLim; ++childNum ) {
+		if ( ! propNode->content[childNum]->IsWhitespaceNode() ) return false;
+	}
+
+	return true;
+
+}	// RDF_StreamParser::IsStreamedArray
+
+// -------------------------------------------------------------------------------------------------
+// RDF_StreamParser::DeleteLastContent
+// -----------------------------------
+//
+// Delete an element that has just ended, and the whitespace before it.
+
+void RDF_StreamParser::DeleteLastContent ( XML_Node * xmlParent, XML_Node * elemNode )
+{
+	XMP_Assert ( (! xmlParent->content.empty()) && (xmlParent->content.back() == elemNode) );
+
+	xmlParent->content.pop_back();
+	delete elemNode;
+
+	while ( (! xmlParent->content.empty()) && xmlParent->content.back()->IsWhitespaceNode() ) {
+		delete xmlParent->content.back();
+		xmlParent->content.pop_back();
+	}
+
+}	// RDF_StreamParser::DeleteLastContent
+
+// -------------------------------------------------------------------------------------------------
+// RDF_StreamParser::StartElement
+// ------------------------------
+
+void RDF_StreamParser::StartElement ( XML_Node * elemNode )
+{
+	XML_Node * xmlParent = elemNode->parent;
+
+	if ( this->rdfRoot == 0 ) {
+		if ( (! this->rdfDone) && this->IsRootCandidate ( elemNode ) ) this->rdfRoot = elemNode;
+		return;
+	}
+
+	if ( xmlParent == this->rdfRoot ) {
+
+		// A top level typedNode or other invalid node element is left for ProcessRDF to report.
+		if ( GetRDFTermKind ( elemNode->name ) == kRDFTerm_Description ) {
+			this->currDesc = elemNode;
+			this->rdf.NodeElementAttrs ( this->xmpTree, *elemNode, kIsTopLevel );
+		}
+
+	} else if ( (this->currDesc != 0) && (this->currProp == 0) &&
+				(xmlParent->parent == this->currDesc) && this->IsStreamedArray ( elemNode ) ) {
+
+		this->currProp  = xmlParent;
+		this->currArray = elemNode;
+
+		this->currCompound = this->rdf.StartResourceProperty ( this->xmpTree, *xmlParent, kIsTopLevel );
+		if ( this->currCompound != 0 ) {
+			(void) this->rdf.SetResourcePropertyForm ( this->currCompound, *elemNode );	// ! Can't fail for arrays.
+			this->rdf.NodeElementAttrs ( this->currCompound, *elemNode, kNotTopLevel );
+		}
+
+	}
+
+}	// RDF_StreamParser::StartElement
+
+// -------------------------------------------------------------------------------------------------
+// RDF_StreamParser::EndElement
+// ----------------------------
+
+void RDF_StreamParser::EndElement ( XML_Node * elemNode )
+{
+	if ( this->rdfRoot == 0 ) return;
+
+	XML_Node * xmlParent = elemNode->parent;
+
+	if ( elemNode == this->rdfRoot ) {
+
+		this->rdfRoot = 0;	// ! Keep the element, ProcessRDF handles whatever is left in it.
+		this->rdfDone = true;
+
+	} else if ( elemNode == this->currDesc ) {
+
+		this->rdf.PropertyElementList ( this->xmpTree, *elemNode, kIsTopLevel );	// Report leftover content.
+		this->currDesc = 0;
+		DeleteLastContent ( xmlParent, elemNode );
+
+	} else if ( (xmlParent == this->currDesc) && (xmlParent != 0) ) {
+
+		if ( elemNode != this->currProp ) {
+
+			this->rdf.PropertyElement ( this->xmpTree, *elemNode, kIsTopLevel );
+
+		} else {
+
+			if ( this->currCompound != 0 ) {
+
+				this->rdf.FinishResourceProperty ( this->currCompound );
+
+				XML_cNodePos currChild = elemNode->content.begin();
+				XML_cNodePos endChild  = elemNode->content.end();
+				while ( *currChild != this->currArray ) ++currChild;
+
+				for ( ++currChild; currChild != endChild; ++currChild ) {
+					if ( ! (*currChild)->IsWhitespaceNode() ) {
+						XMP_Error error ( kXMPErr_BadRDF, "Invalid child of resource property element" );
+						this->rdf.NotifyClient ( kXMPErrSev_Recoverable, error );
+						break;	// Don't bother looking for more trailing errors.
+					}
+				}
+
+			}
+
+			this->currProp  = 0;
+			this->currArray = 0;
+			this->currCompound = 0;
+
+		}
+
+		DeleteLastContent ( xmlParent, elemNode );
+
+	} else if ( elemNode == this->currArray ) {
+
+		if ( this->currCompound != 0 ) this->rdf.PropertyElementList ( this->currCompound, *elemNode, kNotTopLevel );
+		elemNode->RemoveContent();
+
+	} else if ( (xmlParent == this->currArray) && (xmlParent != 0) ) {
+
+		if ( this->currCompound != 0 ) this->rdf.PropertyElement ( this->currCompound, *elemNode, kNotTopLevel );
+		DeleteLastContent ( xmlParent, elemNode );
+
+	}
+
+}	// RDF_StreamParser::EndElement
+
+// =================================================================================================
+// XMPMeta::NewRDFStream
+// =====================
+//
+// Create the element sink for a streaming parse, owned by the XML parser adapter.
+
+XML_ElementSink * XMPMeta::NewRDFStream ( XMP_OptionBits options )
+{
+
+	return new RDF_StreamParser ( &this->tree, &this->errorCallback, options );
+
+}	// XMPMeta::NewRDFStream
+
 // =================================================================================================
 // XMPMeta::ProcessRDF
 // ===================
@@ -148,6 +148,28 @@ WXMPIterator_Skip_1 ( XMPIteratorRef xmpObjRef,
     XMP_EXIT
 }
 
+// -------------------------------------------------------------------------------------------------
+
+void
+WXMPIterator_GetPropPath_1 ( XMPIteratorRef xmpObjRef,
+                             void *         propPath,
+                             SetClientStringProc SetClientString,
+                             WXMP_Result *  wResult )
+{
+    XMP_ENTER_ObjRead ( XMPIterator, "WXMPIterator_GetPropPath_1" )
+
+		if ( propPath == 0 ) XMP_Throw ( "Null output path", kXMPErr_BadParam );
+
+		XMP_Assert( thiz.info.xmpObj != NULL );
+		XMP_AutoLock metaLock ( &thiz.info.xmpObj->lock, kXMP_ReadLock, (thiz.info.xmpObj != 0) );
+
+		XMP_VarString fullPath;
+		thiz.GetPropPath ( &fullPath );
+		(*SetClientString) ( propPath, fullPath.c_str(), static_cast<XMP_StringLen>(fullPath.size()) );
+
+    XMP_EXIT
+}
+
 // =================================================================================================
 
 #if __cplusplus
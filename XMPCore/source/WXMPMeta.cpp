@@ -649,6 +649,191 @@ WXMPMeta_DoesQualifierExist_1 ( XMPMetaRef	  xmpObjRef,
 
 // -------------------------------------------------------------------------------------------------
 
+/* class static */ void
+WXMPMeta_CompilePath_1 ( XMP_StringPtr schemaNS,
+						 XMP_StringPtr propName,
+						 WXMP_Result * wResult )
+{
+	XMP_ENTER_Static ( "WXMPMeta_CompilePath_1" )
+
+		if ( (schemaNS == 0) || (*schemaNS == 0) ) XMP_Throw ( "Empty schema namespace URI", kXMPErr_BadSchema );
+		if ( (propName == 0) || (*propName == 0) ) XMP_Throw ( "Empty property name", kXMPErr_BadXPath );
+
+		XMP_CompiledPath * compiledPath = new XMP_CompiledPath ( schemaNS, propName );
+		wResult->ptrResult = XMPPathRef ( compiledPath );
+
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/* class static */ void
+WXMPMeta_ReleasePath_1 ( XMPPathRef	   pathRef,
+						 WXMP_Result * wResult )
+{
+	XMP_ENTER_NoLock ( "WXMPMeta_ReleasePath_1" )
+
+		delete ( (XMP_CompiledPath*)pathRef );
+
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void
+WXMPMeta_GetCompiledProperty_1 ( XMPMetaRef		  xmpObjRef,
+								 XMPPathRef		  pathRef,
+								 void *           propValue,
+								 XMP_OptionBits * options,
+								 SetClientStringProc SetClientString,
+								 WXMP_Result *	  wResult ) /* const */
+{
+	XMP_ENTER_ObjRead ( XMPMeta, "WXMPMeta_GetCompiledProperty_1" )
+	
+		if ( pathRef == 0 ) XMP_Throw ( "Null compiled path", kXMPErr_BadParam );
+		
+		XMP_StringPtr valuePtr = 0;
+		XMP_StringLen valueSize = 0;
+
+		XMP_OptionBits voidOptionBits = 0;
+		if ( options == 0 ) options = &voidOptionBits;
+
+		bool found = thiz.GetProperty ( *((XMP_CompiledPath*)pathRef), &valuePtr, &valueSize, options );
+		wResult->int32Result = found;
+		
+		if ( found && (propValue != 0) ) (*SetClientString) ( propValue, valuePtr, valueSize );
+
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void
+WXMPMeta_SetCompiledProperty_1 ( XMPMetaRef		xmpObjRef,
+								 XMPPathRef		pathRef,
+								 XMP_StringPtr	propValue,
+								 XMP_OptionBits options,
+								 WXMP_Result *	wResult )
+{
+	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_SetCompiledProperty_1" )
+
+		if ( pathRef == 0 ) XMP_Throw ( "Null compiled path", kXMPErr_BadParam );
+
+		thiz->SetProperty ( *((XMP_CompiledPath*)pathRef), propValue, options );
+		
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void
+WXMPMeta_DeleteCompiledProperty_1 ( XMPMetaRef	  xmpObjRef,
+									XMPPathRef	  pathRef,
+									WXMP_Result * wResult )
+{
+	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_DeleteCompiledProperty_1" )
+
+		if ( pathRef == 0 ) XMP_Throw ( "Null compiled path", kXMPErr_BadParam );
+
+		thiz->DeleteProperty ( *((XMP_CompiledPath*)pathRef) );
+		
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void
+WXMPMeta_DoesCompiledPropertyExist_1 ( XMPMetaRef	 xmpObjRef,
+									   XMPPathRef	 pathRef,
+									   WXMP_Result * wResult ) /* const */
+{
+	XMP_ENTER_ObjRead ( XMPMeta, "WXMPMeta_DoesCompiledPropertyExist_1" )
+	
+		if ( pathRef == 0 ) XMP_Throw ( "Null compiled path", kXMPErr_BadParam );
+
+		bool found = thiz.DoesPropertyExist ( *((XMP_CompiledPath*)pathRef) );
+		wResult->int32Result = found;
+		
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void
+WXMPMeta_GetProperties_1 ( XMPMetaRef		  xmpObjRef,
+						   const XMPPathRef * pathRefs,
+						   XMP_Index		  count,
+						   void *			  values,
+						   XMP_Index *		  offsets,
+						   XMP_OptionBits *	  options,
+						   SetClientStringProc SetClientString,
+						   WXMP_Result *	  wResult ) /* const */
+{
+	XMP_ENTER_ObjRead ( XMPMeta, "WXMPMeta_GetProperties_1" )
+
+		if ( count < 0 ) XMP_Throw ( "Negative property count", kXMPErr_BadParam );
+		if ( (pathRefs == 0) && (count > 0) ) XMP_Throw ( "Null compiled path list", kXMPErr_BadParam );
+
+		XMP_VarString valueList;	// ! The values are appended here and handed over in one client call.
+		XMP_Index found = 0;
+
+		for ( XMP_Index pathNum = 0; pathNum < count; ++pathNum ) {
+
+			if ( pathRefs[pathNum] == 0 ) XMP_Throw ( "Null compiled path", kXMPErr_BadParam );
+
+			XMP_StringPtr valuePtr = 0;
+			XMP_StringLen valueSize = 0;
+			XMP_OptionBits valueOptions = 0;
+			XMP_Index valueOffset = -1;
+
+			if ( thiz.GetProperty ( *((XMP_CompiledPath*)pathRefs[pathNum]), &valuePtr, &valueSize, &valueOptions ) ) {
+				++found;
+				valueOffset = 0;
+				if ( values != 0 ) {
+					valueOffset = static_cast<XMP_Index>( valueList.size() );
+					valueList.append ( valuePtr, valueSize );
+					valueList += '\0';
+				}
+			}
+
+			if ( offsets != 0 ) offsets[pathNum] = valueOffset;
+			if ( options != 0 ) options[pathNum] = valueOptions;
+
+		}
+
+		if ( values != 0 ) (*SetClientString) ( values, valueList.c_str(), static_cast<XMP_StringLen>( valueList.size() ) );
+		wResult->int32Result = found;
+
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void
+WXMPMeta_SetProperties_1 ( XMPMetaRef			  xmpObjRef,
+						   const XMPPathRef *	  pathRefs,
+						   XMP_Index			  count,
+						   const XMP_StringPtr *  values,
+						   const XMP_OptionBits * options,
+						   WXMP_Result *		  wResult )
+{
+	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_SetProperties_1" )
+
+		if ( count < 0 ) XMP_Throw ( "Negative property count", kXMPErr_BadParam );
+		if ( (pathRefs == 0) && (count > 0) ) XMP_Throw ( "Null compiled path list", kXMPErr_BadParam );
+
+		for ( XMP_Index pathNum = 0; pathNum < count; ++pathNum ) {
+			if ( pathRefs[pathNum] == 0 ) XMP_Throw ( "Null compiled path", kXMPErr_BadParam );
+			thiz->SetProperty ( *((XMP_CompiledPath*)pathRefs[pathNum]),
+								((values == 0) ? 0 : values[pathNum]),
+								((options == 0) ? 0 : options[pathNum]) );
+		}
+
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
 void
 WXMPMeta_GetLocalizedText_1 ( XMPMetaRef	   xmpObjRef,
 							  XMP_StringPtr	   schemaNS,
@@ -1147,6 +1332,20 @@ WXMPMeta_GetObjectOptions_1 ( XMPMetaRef    xmpObjRef,
 
 // -------------------------------------------------------------------------------------------------
 
+void
+WXMPMeta_SetObjectOptions_1 ( XMPMetaRef     xmpObjRef,
+							  XMP_OptionBits options,
+							  WXMP_Result *  wResult )
+{
+	XMP_ENTER_ObjWrite ( XMPMeta, "WXMPMeta_SetObjectOptions_1" )
+
+		thiz->SetObjectOptions ( options );
+
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
 void
 WXMPMeta_ParseFromBuffer_1 ( XMPMetaRef		xmpObjRef,
 							 XMP_StringPtr	buffer,
@@ -1189,6 +1388,31 @@ WXMPMeta_SerializeToBuffer_1 ( XMPMetaRef	  xmpObjRef,
 
 // -------------------------------------------------------------------------------------------------
 
+void
+WXMPMeta_SerializeToSink_1 ( XMPMetaRef		   xmpObjRef,
+							 XMP_TextOutputProc outProc,
+							 void *			   refCon,
+							 XMP_OptionBits	   options,
+							 XMP_StringLen	   padding,
+							 XMP_StringPtr	   newline,
+							 XMP_StringPtr	   indent,
+							 XMP_Index		   baseIndent,
+							 WXMP_Result *	   wResult ) /* const */
+{
+	XMP_ENTER_ObjRead ( XMPMeta, "WXMPMeta_SerializeToSink_1" )
+
+		if ( outProc == 0 ) XMP_Throw ( "Null client output routine", kXMPErr_BadParam );
+
+		if ( newline == 0 ) newline = "";
+		if ( indent == 0 ) indent = "";
+
+		thiz.SerializeToSink ( outProc, refCon, options, padding, newline, indent, baseIndent );
+
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
 void
 WXMPMeta_SetDefaultErrorCallback_1 ( XMPMeta_ErrorCallbackWrapper wrapperProc,
 									 XMPMeta_ErrorCallbackProc    clientProc,
@@ -267,7 +267,7 @@ FindIndexedItem ( XMP_Node * arrayNode, const XMP_VarString & indexStep, bool cr
 	if ( index < 0 ) XMP_Throw ( "Array index must be larger than zero", kXMPErr_BadXPath );
 
 	if ( (index == (XMP_Index)arrayNode->children.size()) && createNodes ) {	// Append a new last+1 node.
-		XMP_Node * newItem = new XMP_Node ( arrayNode, kXMP_ArrayItemName, kXMP_NewImplicitNode );
+		XMP_Node * newItem = new ( arrayNode ) XMP_Node ( arrayNode, kXMP_ArrayItemName, kXMP_NewImplicitNode );
 		arrayNode->children.push_back ( newItem );
 	}
 
@@ -449,10 +449,10 @@ FollowXPathStep	( XMP_Node *	   parentNode,
 			XMP_Assert ( parentNode->options & kXMP_PropArrayIsAltText );
 			XMP_Assert ( (stepNum == 2) && (nextStep.step == "[?xml:lang=\"x-default\"]") );
 
-			nextNode = new XMP_Node ( parentNode, kXMP_ArrayItemName,
+			nextNode = new ( parentNode ) XMP_Node ( parentNode, kXMP_ArrayItemName,
 									  (kXMP_PropHasQualifiers | kXMP_PropHasLang | kXMP_NewImplicitNode) );
 
-			XMP_Node * langQual = new XMP_Node ( nextNode, "xml:lang", "x-default", kXMP_PropIsQualifier );
+			XMP_Node * langQual = new ( nextNode ) XMP_Node ( nextNode, "xml:lang", "x-default", kXMP_PropIsQualifier );
 			nextNode->qualifiers.push_back ( langQual );
 
 			if ( parentNode->children.empty() ) {
@@ -814,6 +814,401 @@ ExpandXPath	( XMP_StringPtr			schemaNS,
 
 }	// ExpandXPath
 
+// =================================================================================================
+// XMP_NodeIndex
+// =============
+//
+// An open addressed hash table with linear probing over the names in an XMP_NodeOffspring vector.
+// Each slot holds an offspring position plus 1 and the name's hash, a zero position marks an empty
+// slot. The table is kept at most half full. Equal names are found in offspring order, the same as
+// a linear search, because the earlier node always sits earlier in the probe sequence.
+
+class XMP_NodeIndex {
+public:
+
+	size_t count;	// The offspring size that the index matches.
+
+	XMP_NodeIndex ( const XMP_NodeOffspring & offspring ) : count(0)
+	{
+		size_t slotCount = 4 * kXMP_NodeIndexThreshold;
+		while ( slotCount < 4*offspring.size() ) slotCount *= 2;
+		this->slots.assign ( slotCount, IndexSlot() );
+		for ( size_t pos = 0, posLim = offspring.size(); pos < posLim; ++pos ) this->AddNode ( offspring, pos );
+		this->count = offspring.size();
+	}
+
+	bool AppendNode ( const XMP_NodeOffspring & offspring )	// Returns false if the index must be rebuilt.
+	{
+		size_t pos = offspring.size() - 1;
+		if ( (this->count != pos) || (2*offspring.size() > this->slots.size()) ) return false;
+		this->AddNode ( offspring, pos );
+		this->count = offspring.size();
+		return true;
+	}
+
+	size_t Find ( const XMP_NodeOffspring & offspring, const XMP_NodeName & name ) const
+	{
+		const size_t slotMask = this->slots.size() - 1;
+		const XMP_Uns32 nameHash = HashName ( name );
+		for ( size_t slot = nameHash & slotMask; this->slots[slot].pos != 0; slot = (slot + 1) & slotMask ) {
+			const IndexSlot & currSlot = this->slots[slot];
+			if ( currSlot.hash != nameHash ) continue;
+			const XMP_Node * currNode = offspring[currSlot.pos-1];
+			if ( (currNode != 0) && (currNode->name == name) ) return currSlot.pos - 1;
+		}
+		return offspring.size();
+	}
+
+private:
+
+	struct IndexSlot {
+		XMP_Uns32 pos, hash;
+		IndexSlot() : pos(0), hash(0) {};
+	};
+
+	std::vector<IndexSlot> slots;	// ! The size is always a power of 2.
+
+	static XMP_Uns32 HashName ( const XMP_NodeName & name ) { return name.Hash(); }
+
+	void AddNode ( const XMP_NodeOffspring & offspring, size_t pos )
+	{
+		const XMP_Node * node = offspring[pos];
+		if ( node == 0 ) return;	// ! The RDF parser temporarily leaves null entries.
+		const size_t slotMask = this->slots.size() - 1;
+		const XMP_Uns32 nameHash = HashName ( node->name );
+		size_t slot = nameHash & slotMask;
+		while ( this->slots[slot].pos != 0 ) slot = (slot + 1) & slotMask;
+		this->slots[slot].pos  = (XMP_Uns32) (pos + 1);
+		this->slots[slot].hash = nameHash;
+	}
+
+};
+
+// -------------------------------------------------------------------------------------------------
+// XMP_NodeOffspring::FindNamed
+// ----------------------------
+//
+// The name is looked up in the atom table first, after that a node matches by pointer compare. Narrow
+// vectors are searched linearly. Wide ones build the index on first use. Readers holding only
+// the object's read lock can get here concurrently, so the index is published with a compare and
+// swap and a losing reader discards its own copy. Only writers change or delete an existing index.
+
+size_t
+XMP_NodeOffspring::FindNamed ( XMP_StringPtr _name ) const
+{
+	const XMP_NodeName name = XMP_NodeName::Lookup ( _name );
+	if ( name.empty() && (*_name != 0) ) return this->size();	// Not a known name, so no node has it.
+	return this->FindNamed ( name );
+}
+
+size_t
+XMP_NodeOffspring::FindNamed ( const XMP_NodeName & name ) const
+{
+	const size_t offLim = this->size();
+
+	if ( offLim >= kXMP_NodeIndexThreshold ) {
+
+		XMP_NodeIndex * currIndex = this->index.load ( std::memory_order_acquire );
+
+		if ( currIndex == 0 ) {
+			XMP_NodeIndex * newIndex = new XMP_NodeIndex ( *this );
+			if ( this->index.compare_exchange_strong ( currIndex, newIndex, std::memory_order_acq_rel ) ) {
+				currIndex = newIndex;
+			} else {
+				delete newIndex;	// Another reader published first, currIndex now holds theirs.
+			}
+		}
+
+		if ( currIndex->count == offLim ) return currIndex->Find ( *this, name );
+		XMP_Assert ( currIndex->count == offLim );	// Some mutator did not keep the index in sync.
+
+	}
+
+	for ( size_t offNum = 0; offNum != offLim; ++offNum ) {
+		const XMP_Node * currNode = (*this)[offNum];
+		if ( (currNode != 0) && (currNode->name == name) ) return offNum;
+	}
+
+	return offLim;
+
+}	// XMP_NodeOffspring::FindNamed
+
+// -------------------------------------------------------------------------------------------------
+// XMP_NodeOffspring::IndexLastNode
+// --------------------------------
+
+void
+XMP_NodeOffspring::IndexLastNode()
+{
+	XMP_NodeIndex * currIndex = this->index.load ( std::memory_order_relaxed );
+	if ( (currIndex != 0) && (! currIndex->AppendNode ( *this )) ) this->InvalidateIndex();
+}	// XMP_NodeOffspring::IndexLastNode
+
+// -------------------------------------------------------------------------------------------------
+// XMP_NodeOffspring::SetNode
+// --------------------------
+
+void
+XMP_NodeOffspring::SetNode ( size_t pos, XMP_Node * node )
+{
+	const XMP_Node * oldNode = this->nodes[pos];
+	if ( (oldNode == 0) || (node == 0) || (! (oldNode->name == node->name)) ) this->InvalidateIndex();
+	this->nodes[pos] = node;
+}	// XMP_NodeOffspring::SetNode
+
+// -------------------------------------------------------------------------------------------------
+// XMP_NodeOffspring::InvalidateIndex
+// ----------------------------------
+
+void
+XMP_NodeOffspring::InvalidateIndex()
+{
+	delete this->index.exchange ( 0, std::memory_order_acq_rel );
+}	// XMP_NodeOffspring::InvalidateIndex
+
+// =================================================================================================
+// XMP_NodeName
+// ============
+
+XMP_AtomTable & NodeNameAtoms()
+{
+	static XMP_AtomTable nodeNameAtoms;	// ! Function local for a thread safe first use, never cleared.
+	return nodeNameAtoms;
+}	// NodeNameAtoms
+
+// -------------------------------------------------------------------------------------------------
+// XMP_NodeName::Assign
+// --------------------
+//
+// Use the atom if there is room in the table, otherwise keep a private copy. Whether a string fits
+// can not change later, the table never shrinks.
+
+void XMP_NodeName::Assign ( XMP_StringPtr _name, XMP_StringLen _len )
+{
+	const XMP_VarString * newAtom = NodeNameAtoms().Intern ( _name, _len );
+	const bool newPrivate = (newAtom == 0) && (_len != 0);
+	if ( newPrivate ) newAtom = new XMP_VarString ( _name, _len );	// ! Before clear, _name might be ours.
+	this->clear();
+	this->atom = newAtom;
+	this->isPrivate = newPrivate;
+}	// XMP_NodeName::Assign
+
+// -------------------------------------------------------------------------------------------------
+// XMP_NodeName::Lookup
+// --------------------
+//
+// Check the table before IsFull. A name that is not an atom while the table still has room was
+// never given to a node, once the table is full it might be a private name.
+
+XMP_NodeName XMP_NodeName::Lookup ( XMP_StringPtr _name )
+{
+	const XMP_StringLen len = (XMP_StringLen) strlen ( _name );
+	const XMP_VarString * found = NodeNameAtoms().Find ( _name, len );
+	if ( (found != 0) || (len == 0) || (! NodeNameAtoms().IsFull()) ) return XMP_NodeName ( found );
+	return Private ( XMP_VarString ( _name, len ) );
+}	// XMP_NodeName::Lookup
+
+// -------------------------------------------------------------------------------------------------
+// XMP_NodeName::Private
+// ---------------------
+//
+// The root's rdf:about URI usually differs per file, interning it would fill the table with names
+// that are never used again. The root is never looked up among siblings, so the value hash of a
+// private name need not match the address hash of an atom with the same string.
+
+XMP_NodeName XMP_NodeName::Private ( const XMP_VarString & _name )
+{
+	XMP_NodeName name;
+	if ( ! _name.empty() ) {
+		name.atom = new XMP_VarString ( _name );
+		name.isPrivate = true;
+	}
+	return name;
+}	// XMP_NodeName::Private
+
+// -------------------------------------------------------------------------------------------------
+
+XMP_Uns32 XMP_NodeName::Hash() const
+{
+	if ( this->isPrivate ) return XMP_AtomTable::Hash ( this->atom->data(), (XMP_StringLen) this->atom->size() );
+	XMP_Uns64 atomBits = (XMP_Uns64) (size_t) this->atom;	// An atom, hash the address.
+	return (XMP_Uns32) ((atomBits * 0x9E3779B97F4A7C15ULL) >> 32);
+}	// XMP_NodeName::Hash
+
+// -------------------------------------------------------------------------------------------------
+
+const XMP_VarString & XMP_NodeName::EmptyName()
+{
+	static const XMP_VarString emptyName;
+	return emptyName;
+}	// XMP_NodeName::EmptyName
+
+// =================================================================================================
+// XMP_NodeArena
+// =============
+
+static const size_t kNodeArenaChunkSize = 64*1024;
+static const size_t kNodeHeaderSize = sizeof(XMP_NodeArena*);	// ! Keeps XMP_Node pointer aligned.
+
+XMP_NodeArena::~XMP_NodeArena()
+{
+	for ( size_t i = 0, limit = this->chunks.size(); i < limit; ++i ) free ( this->chunks[i] );
+}	// XMP_NodeArena::~XMP_NodeArena
+
+// -------------------------------------------------------------------------------------------------
+
+void *
+XMP_NodeArena::Allocate ( size_t size )
+{
+	size = (size + kNodeHeaderSize - 1) & ~(kNodeHeaderSize - 1);
+	XMP_Assert ( size <= kNodeArenaChunkSize );
+
+	if ( size > this->chunkLeft ) {
+		char * newChunk = (char*) malloc ( kNodeArenaChunkSize );
+		if ( newChunk == 0 ) XMP_Throw ( "Out of memory for node arena", kXMPErr_NoMemory );
+		this->chunks.push_back ( newChunk );
+		this->chunkNext = newChunk;
+		this->chunkLeft = kNodeArenaChunkSize;
+	}
+
+	void * mem = this->chunkNext;
+	this->chunkNext += size;
+	this->chunkLeft -= size;
+	++this->refCount;
+	return mem;
+
+}	// XMP_NodeArena::Allocate
+
+// -------------------------------------------------------------------------------------------------
+
+void
+XMP_NodeArena::Release()
+{
+	if ( --this->refCount == 0 ) delete this;
+}	// XMP_NodeArena::Release
+
+// -------------------------------------------------------------------------------------------------
+
+void
+XMP_NodeArena::ReleaseNodes ( size_t count )
+{
+	XMP_Int32 oldCount = this->refCount.fetch_sub ( (XMP_Int32)count );
+	XMP_Assert ( oldCount > (XMP_Int32)count );	// ! The owner's reference is still there.
+	(void) oldCount;
+}	// XMP_NodeArena::ReleaseNodes
+
+// -------------------------------------------------------------------------------------------------
+
+bool
+XMP_NodeArena::Reset()
+{
+	if ( this->refCount != 1 ) return false;	// Some node moved to another tree is still alive.
+	if ( this->chunks.empty() ) return true;
+
+	for ( size_t i = 1, limit = this->chunks.size(); i < limit; ++i ) free ( this->chunks[i] );
+	this->chunks.resize ( 1 );
+	this->chunkNext = this->chunks[0];
+	this->chunkLeft = kNodeArenaChunkSize;
+	return true;
+
+}	// XMP_NodeArena::Reset
+
+// =================================================================================================
+// XMP_Node::operator new
+// ======================
+//
+// Find the root of the parent's tree, allocate from its arena if it has one. The parent chain is
+// short, and following it at allocation time means a subtree moved to another tree allocates its
+// new offspring from the new tree's arena.
+
+void *
+XMP_Node::operator new ( size_t size, const XMP_Node * parent )
+{
+	XMP_NodeArena * arena = 0;
+	if ( parent != 0 ) {
+		while ( parent->parent != 0 ) parent = parent->parent;
+		arena = parent->arena;
+	}
+
+	char * mem;
+	if ( arena == 0 ) {
+		mem = (char*) ::operator new ( kNodeHeaderSize + size );
+	} else {
+		mem = (char*) arena->Allocate ( kNodeHeaderSize + size );
+	}
+
+	*((XMP_NodeArena**)mem) = arena;
+	return mem + kNodeHeaderSize;
+
+}	// XMP_Node::operator new
+
+// -------------------------------------------------------------------------------------------------
+
+static inline XMP_NodeArena * NodeArena ( const XMP_Node * node )
+{
+	return *((XMP_NodeArena* const *)((const char*)node - kNodeHeaderSize));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void
+XMP_Node::operator delete ( void * ptr )
+{
+	if ( ptr == 0 ) return;
+	char * mem = (char*)ptr - kNodeHeaderSize;
+	XMP_NodeArena * arena = *((XMP_NodeArena**)mem);
+	if ( arena == 0 ) {
+		::operator delete ( mem );
+	} else {
+		arena->Release();	// The memory itself goes back with the rest of the arena.
+	}
+}	// XMP_Node::operator delete
+
+// =================================================================================================
+// XMP_Node::ClearArenaTree
+// ========================
+//
+// Whole-tree teardown for the root of an arena tree. The nodes allocated from the root's arena are
+// destroyed in place without going through operator delete, their arena references are dropped in
+// one step, and the arena is rewound for reuse. Shared schema nodes and nodes that came from some
+// other arena or the heap are released the normal way.
+
+static size_t
+DestroyArenaOffspring ( XMP_NodeOffspring & offspring, const XMP_NodeArena * arena )
+{
+	size_t destroyed = 0;
+
+	for ( size_t offNum = 0, offLim = offspring.size(); offNum < offLim; ++offNum ) {
+		XMP_Node * currNode = offspring[offNum];
+		if ( currNode == 0 ) continue;
+		if ( (NodeArena ( currNode ) != arena) || (currNode->shareRefs.load ( std::memory_order_acquire ) != 0) ) {
+			XMP_Node::ReleaseNode ( currNode );
+		} else {
+			destroyed += DestroyArenaOffspring ( currNode->children, arena );
+			destroyed += DestroyArenaOffspring ( currNode->qualifiers, arena );
+			currNode->~XMP_Node();	// ! The offspring are gone, this only frees the strings.
+			++destroyed;
+		}
+	}
+
+	offspring.clear();
+	return destroyed;
+
+}	// DestroyArenaOffspring
+
+void
+XMP_Node::ClearArenaTree()
+{
+	XMP_Assert ( (this->parent == 0) && (this->arena != 0) );
+
+	size_t destroyed = DestroyArenaOffspring ( this->children, this->arena );
+	destroyed += DestroyArenaOffspring ( this->qualifiers, this->arena );
+	if ( destroyed > 0 ) this->arena->ReleaseNodes ( destroyed );
+
+	(void) this->arena->Reset();	// Only rewinds if no node moved to another tree is still alive.
+
+}	// XMP_Node::ClearArenaTree
+
 // =================================================================================================
 // FindSchemaNode
 // ==============
@@ -834,19 +1229,16 @@ FindSchemaNode	( XMP_Node *		xmpTree,
 	
 	XMP_Assert ( xmpTree->parent == 0 );
 	
-	for ( size_t schemaNum = 0, schemaLim = xmpTree->children.size(); schemaNum != schemaLim; ++schemaNum ) {
-		XMP_Node * currSchema = xmpTree->children[schemaNum];
-		XMP_Assert ( currSchema->parent == xmpTree );
-		if ( currSchema->name == nsURI ) {
-			schemaNode = currSchema;
-			if ( ptrPos != 0 ) *ptrPos = xmpTree->children.begin() + schemaNum;
-			break;
-		}
+	size_t schemaNum = xmpTree->children.FindNamed ( nsURI );
+	if ( schemaNum != xmpTree->children.size() ) {
+		schemaNode = xmpTree->children[schemaNum];
+		XMP_Assert ( (schemaNode->parent == xmpTree) || (schemaNode->shareRefs != 0) || (! createNodes) );	// See XMPMeta::Clone.
+		if ( ptrPos != 0 ) *ptrPos = xmpTree->children.begin() + schemaNum;
 	}
 	
 	if ( (schemaNode == 0) && createNodes ) {
 
-		schemaNode = new XMP_Node ( xmpTree, nsURI, (kXMP_SchemaNode | kXMP_NewImplicitNode) );
+		schemaNode = new ( xmpTree ) XMP_Node ( xmpTree, nsURI, (kXMP_SchemaNode | kXMP_NewImplicitNode) );
 
 		try {
 			XMP_StringPtr prefixPtr;
@@ -917,18 +1309,15 @@ FindChildNode	( XMP_Node *		parent,
 		parent->options |= kXMP_PropValueIsStruct;
 	}
 	
-	for ( size_t childNum = 0, childLim = parent->children.size(); childNum != childLim; ++childNum ) {
-		XMP_Node * currChild = parent->children[childNum];
-		XMP_Assert ( currChild->parent == parent );
-		if ( currChild->name == childName ) {
-			childNode = currChild;
-			if ( ptrPos != 0 ) *ptrPos = parent->children.begin() + childNum;
-			break;
-		}
+	size_t childNum = parent->children.FindNamed ( childName );
+	if ( childNum != parent->children.size() ) {
+		childNode = parent->children[childNum];
+		XMP_Assert ( childNode->parent == parent );
+		if ( ptrPos != 0 ) *ptrPos = parent->children.begin() + childNum;
 	}
 	
 	if ( (childNode == 0) && createNodes ) {
-		childNode = new XMP_Node ( parent, childName, kXMP_NewImplicitNode );
+		childNode = new ( parent ) XMP_Node ( parent, childName, kXMP_NewImplicitNode );
 		parent->children.push_back ( childNode );
 		if ( ptrPos != 0 ) *ptrPos = parent->children.end() - 1;
 	}
@@ -959,19 +1348,16 @@ FindQualifierNode	( XMP_Node *		parent,
 	
 	XMP_Assert ( *qualName != '?' );
 	
-	for ( size_t qualNum = 0, qualLim = parent->qualifiers.size(); qualNum != qualLim; ++qualNum ) {
-		XMP_Node * currQual = parent->qualifiers[qualNum];
-		XMP_Assert ( currQual->parent == parent );
-		if ( currQual->name == qualName ) {
-			qualNode = currQual;
-			if ( ptrPos != 0 ) *ptrPos = parent->qualifiers.begin() + qualNum;
-			break;
-		}
+	size_t qualNum = parent->qualifiers.FindNamed ( qualName );
+	if ( qualNum != parent->qualifiers.size() ) {
+		qualNode = parent->qualifiers[qualNum];
+		XMP_Assert ( qualNode->parent == parent );
+		if ( ptrPos != 0 ) *ptrPos = parent->qualifiers.begin() + qualNum;
 	}
 	
 	if ( (qualNode == 0) && createNodes ) {
 
-		qualNode = new XMP_Node ( parent, qualName, (kXMP_PropIsQualifier | kXMP_NewImplicitNode) );
+		qualNode = new ( parent ) XMP_Node ( parent, qualName, (kXMP_PropIsQualifier | kXMP_NewImplicitNode) );
 		parent->options |= kXMP_PropHasQualifiers;
 
 		const bool isLang 	 = XMP_LitMatch ( qualName, "xml:lang" );
@@ -1193,6 +1579,200 @@ EXIT:
 	
 }	// FindNode
 
+// =================================================================================================
+// XMP_CompiledPath
+// ================
+//
+// The compiled steps follow FindNode and FollowXPathStep for existing nodes. A path with an array
+// index that FindIndexedItem would reject gets no compiled steps, so that the lookups throw the
+// same errors at the same time as for the string form of the path.
+
+static bool
+CompileXPathStep ( const XPathStepInfo & stepInfo, XMP_CompiledStep * compiledStep )
+{
+	compiledStep->kind = GetStepKind ( stepInfo.options );
+
+	switch ( compiledStep->kind ) {
+
+		case 0 :	// The schema step.
+		case kXMP_StructFieldStep :
+			compiledStep->name = stepInfo.step;
+			break;
+
+		case kXMP_QualifierStep :
+			XMP_Assert ( stepInfo.step[0] == '?' );
+			compiledStep->name = stepInfo.step.c_str() + 1;
+			break;
+
+		case kXMP_ArrayIndexStep :
+			{
+				XMP_Index index = 0;
+				for ( size_t chNum = 1, chLim = stepInfo.step.size() - 1; chNum != chLim; ++chNum ) {
+					index = (index * 10) + (stepInfo.step[chNum] - '0');
+					if ( index < 0 ) return false;	// ! Overflow.
+				}
+				if ( index == 0 ) return false;
+				compiledStep->index = index - 1;	// Change to a C-style, zero based index.
+			}
+			break;
+
+		case kXMP_ArrayLastStep :
+			break;
+
+		case kXMP_FieldSelectorStep :
+		case kXMP_QualSelectorStep :
+			{
+				XMP_VarString selName;
+				SplitNameAndValue ( stepInfo.step, &selName, &compiledStep->value );
+				compiledStep->name = selName;
+				if ( (compiledStep->kind == kXMP_QualSelectorStep) && (selName == "xml:lang") ) {
+					NormalizeLangValue ( &compiledStep->value );
+					compiledStep->isLang = true;
+				}
+			}
+			break;
+
+		default :
+			XMP_Throw ( "Unknown XPath step kind", kXMPErr_InternalFailure );
+
+	}
+
+	return true;
+
+}	// CompileXPathStep
+
+XMP_CompiledPath::XMP_CompiledPath ( XMP_StringPtr _schemaNS, XMP_StringPtr _propName )
+	: schemaNS(_schemaNS), propName(_propName)
+{
+	ExpandXPath ( _schemaNS, _propName, &this->expPath );
+	XMP_Assert ( this->expPath.size() > kRootPropStep );
+
+	// A top level alias is replaced by its actual path, like the start of FindNode.
+
+	const XMP_ExpandedXPath * rootPath = &this->expPath;
+	size_t rootLim = kRootPropStep + 1;
+
+	if ( this->expPath[kRootPropStep].options & kXMP_StepIsAlias ) {
+		XMP_AliasMapPos aliasPos = sRegisteredAliasMap->find ( this->expPath[kRootPropStep].step );
+		XMP_Assert ( aliasPos != sRegisteredAliasMap->end() );
+		rootPath = &aliasPos->second;
+		rootLim = rootPath->size();
+	}
+
+	this->steps.resize ( rootLim + this->expPath.size() - (kRootPropStep + 1) );
+
+	bool compiled = true;
+	size_t compiledNum = 0;
+	for ( size_t stepNum = 0; stepNum < rootLim; ++stepNum, ++compiledNum ) {
+		compiled &= CompileXPathStep ( (*rootPath)[stepNum], &this->steps[compiledNum] );
+	}
+	for ( size_t stepNum = kRootPropStep + 1, stepLim = this->expPath.size(); stepNum < stepLim; ++stepNum, ++compiledNum ) {
+		compiled &= CompileXPathStep ( this->expPath[stepNum], &this->steps[compiledNum] );
+	}
+
+	if ( ! compiled ) this->steps.clear();
+
+}	// XMP_CompiledPath::XMP_CompiledPath
+
+// -------------------------------------------------------------------------------------------------
+// LookupCompiledSelector
+// ----------------------
+
+static XMP_Index
+LookupCompiledSelector ( const XMP_Node * arrayNode, const XMP_CompiledStep & selStep )
+{
+	const bool isField = (selStep.kind == kXMP_FieldSelectorStep);
+
+	for ( size_t index = 0, itemLim = arrayNode->children.size(); index != itemLim; ++index ) {
+
+		const XMP_Node * currItem = arrayNode->children[index];
+
+		if ( isField ) {
+			if ( ! (currItem->options & kXMP_PropValueIsStruct) ) {
+				XMP_Throw ( "Field selector must be used on array of struct", kXMPErr_BadXPath );
+			}
+		} else if ( selStep.isLang ) {
+			const XMP_NodeOffspring & quals = currItem->qualifiers;
+			if ( (! quals.empty()) && (quals[0]->name == selStep.name) && (quals[0]->value == selStep.value) ) {
+				return static_cast<XMP_Index>( index );
+			}
+			continue;
+		}
+
+		const XMP_NodeOffspring & offspring = (isField ? currItem->children : currItem->qualifiers);
+		for ( size_t offNum = 0, offLim = offspring.size(); offNum != offLim; ++offNum ) {
+			const XMP_Node * currNode = offspring[offNum];
+			if ( currNode->name != selStep.name ) continue;
+			if ( currNode->value == selStep.value ) return static_cast<XMP_Index>( index );
+		}
+
+	}
+
+	return -1;
+
+}	// LookupCompiledSelector
+
+// -------------------------------------------------------------------------------------------------
+// FindCompiledNode
+// ----------------
+//
+// Find an existing node, the same one FindConstNode finds for the expanded path.
+
+const XMP_Node *
+FindCompiledNode ( const XMP_Node * xmpTree, const XMP_CompiledPath & compiledPath )
+{
+	if ( compiledPath.steps.empty() ) return FindConstNode ( xmpTree, compiledPath.expPath );
+
+	size_t nodeNum = xmpTree->children.FindNamed ( compiledPath.steps[kSchemaStep].name );
+	if ( nodeNum == xmpTree->children.size() ) return 0;
+	const XMP_Node * currNode = xmpTree->children[nodeNum];
+
+	for ( size_t stepNum = kRootPropStep, stepLim = compiledPath.steps.size(); stepNum < stepLim; ++stepNum ) {
+
+		const XMP_CompiledStep & currStep = compiledPath.steps[stepNum];
+		const XMP_Node * parentNode = currNode;
+
+		if ( currStep.kind == kXMP_StructFieldStep ) {
+
+			if ( ! (parentNode->options & (kXMP_SchemaNode | kXMP_PropValueIsStruct)) ) {
+				XMP_Throw ( "Named children only allowed for schemas and structs", kXMPErr_BadXPath );
+			}
+			nodeNum = parentNode->children.FindNamed ( currStep.name );
+			if ( nodeNum == parentNode->children.size() ) return 0;
+			currNode = parentNode->children[nodeNum];
+
+		} else if ( currStep.kind == kXMP_QualifierStep ) {
+
+			nodeNum = parentNode->qualifiers.FindNamed ( currStep.name );
+			if ( nodeNum == parentNode->qualifiers.size() ) return 0;
+			currNode = parentNode->qualifiers[nodeNum];
+
+		} else {
+
+			if ( ! (parentNode->options & kXMP_PropValueIsArray) ) {
+				XMP_Throw ( "Indexing applied to non-array", kXMPErr_BadXPath );
+			}
+
+			XMP_Index index;
+			if ( currStep.kind == kXMP_ArrayIndexStep ) {
+				index = currStep.index;
+			} else if ( currStep.kind == kXMP_ArrayLastStep ) {
+				index = static_cast<XMP_Index>( parentNode->children.size() - 1 );
+			} else {
+				index = LookupCompiledSelector ( parentNode, currStep );
+			}
+
+			if ( (index < 0) || (index >= (XMP_Index)parentNode->children.size()) ) return 0;
+			currNode = parentNode->children[index];
+
+		}
+
+	}
+
+	return currNode;
+
+}	// FindCompiledNode
+
 // =================================================================================================
 // CloneOffspring
 // ==============
@@ -1210,7 +1790,7 @@ CloneOffspring ( const XMP_Node * origParent, XMP_Node * cloneParent, bool skipE
 		for ( size_t qualNum = 0, qualLim = qualCount; qualNum != qualLim; ++qualNum ) {
 			const XMP_Node * origQual  = origParent->qualifiers[qualNum];
 			if ( skipEmpty && origQual->value.empty() && origQual->children.empty() ) continue;
-			XMP_Node * cloneQual = new XMP_Node ( cloneParent, origQual->name, origQual->value, origQual->options );
+			XMP_Node * cloneQual = new ( cloneParent ) XMP_Node ( cloneParent, origQual->name, origQual->value, origQual->options );
 			CloneOffspring ( origQual, cloneQual, skipEmpty );
 			if ( skipEmpty && cloneQual->value.empty() && cloneQual->children.empty() ) {
 				// Check again, might have had an array or struct with all empty children.
@@ -1229,7 +1809,7 @@ CloneOffspring ( const XMP_Node * origParent, XMP_Node * cloneParent, bool skipE
 		for ( size_t childNum = 0, childLim = childCount; childNum != childLim; ++childNum ) {
 			const XMP_Node * origChild  = origParent->children[childNum];
 			if ( skipEmpty && origChild->value.empty() && origChild->children.empty() ) continue;
-			XMP_Node * cloneChild = new XMP_Node ( cloneParent, origChild->name, origChild->value, origChild->options );
+			XMP_Node * cloneChild = new ( cloneParent ) XMP_Node ( cloneParent, origChild->name, origChild->value, origChild->options );
 			CloneOffspring ( origChild, cloneChild, skipEmpty );
 			if ( skipEmpty && cloneChild->value.empty() && cloneChild->children.empty() ) {
 				// Check again, might have had an array or struct with all empty children.
@@ -1262,7 +1842,7 @@ CloneSubtree ( const XMP_Node * origRoot, XMP_Node * cloneParent, bool skipEmpty
 		}
 	#endif
 	
-	XMP_Node * cloneRoot = new XMP_Node ( cloneParent, origRoot->name, origRoot->value, origRoot->options );
+	XMP_Node * cloneRoot = new ( cloneParent ) XMP_Node ( cloneParent, origRoot->name, origRoot->value, origRoot->options );
 	CloneOffspring ( origRoot, cloneRoot, skipEmpty ) ;
 
 	if ( skipEmpty && cloneRoot->value.empty() && cloneRoot->children.empty() ) {
@@ -1452,9 +2032,7 @@ NormalizeLangArray ( XMP_Node * array )
 	if ( hasDefault ) {
 
 		if ( itemNum != 0 ) {
-			XMP_Node * temp = array->children[0];
-			array->children[0] = array->children[itemNum];
-			array->children[itemNum] = temp;
+			array->children.SwapNodes ( 0, itemNum );
 		}
 
 		if ( itemLim == 2 ) array->children[1]->value = array->children[0]->value;
@@ -1496,13 +2074,13 @@ DetectAltText ( XMP_Node * xmpParent )
 
 static inline bool Compare ( const XMP_Node * left, const XMP_Node * right )
 {
-	return (left->name < right->name);
+	return (left->name.str() < right->name.str());
 }
 
 void
 SortNamedNodes ( XMP_NodeOffspring & nodeVector )
 {
-	sort ( nodeVector.begin(), nodeVector.end(), Compare );
+	nodeVector.SortNodes ( Compare );
 }	// SortNamedNodes
 
 // =================================================================================================
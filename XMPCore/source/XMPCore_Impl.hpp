@@ -21,6 +21,8 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <cstdlib>
@@ -39,7 +41,90 @@ class XPathStepInfo;
 
 typedef XMP_Node *	XMP_NodePtr;
 
-typedef std::vector<XMP_Node*>		XMP_NodeOffspring;
+class XMP_NodeIndex;
+class XMP_NodeName;
+
+// -------------------------------------------------------------------------------------------------
+// XMP_NodeOffspring
+// -----------------
+//
+// The children or qualifiers of an XMP_Node. This wraps a std::vector of node pointers, the order of
+// the vector is the serialization order. Once a vector reaches kXMP_NodeIndexThreshold entries a
+// name index is built on the first lookup, which makes FindSchemaNode, FindChildNode, and
+// FindQualifierNode independent of the width. The vector is private and every mutator keeps the
+// index in sync, the iterators are read only. Code that renames a node in place must call
+// InvalidateIndex. Array items are never looked up by name and are not indexed.
+
+enum { kXMP_NodeIndexThreshold = 16 };
+
+class XMP_NodeOffspring {
+public:
+
+	typedef std::vector<XMP_Node*> NodeVector;
+
+	typedef NodeVector::value_type		value_type;
+	typedef NodeVector::size_type		size_type;
+	typedef NodeVector::const_iterator	iterator;	// ! Read only, store through SetNode.
+	typedef NodeVector::const_iterator	const_iterator;
+	typedef NodeVector::const_reverse_iterator	reverse_iterator;
+	typedef NodeVector::const_reverse_iterator	const_reverse_iterator;
+
+	XMP_NodeOffspring() : index(0) {};
+	XMP_NodeOffspring ( const XMP_NodeOffspring & other ) : nodes(other.nodes), index(0) {};
+	~XMP_NodeOffspring() { this->InvalidateIndex(); };
+
+	XMP_NodeOffspring & operator= ( const XMP_NodeOffspring & other )
+		{ this->InvalidateIndex(); this->nodes = other.nodes; return *this; };
+
+	size_t size() const { return this->nodes.size(); };
+	bool empty() const { return this->nodes.empty(); };
+	void reserve ( size_t count ) { this->nodes.reserve ( count ); };
+
+	XMP_Node * operator[] ( size_t pos ) const { return this->nodes[pos]; };
+	XMP_Node * front() const { return this->nodes.front(); };
+	XMP_Node * back() const { return this->nodes.back(); };
+
+	const_iterator begin() const { return this->nodes.begin(); };
+	const_iterator end() const { return this->nodes.end(); };
+	const_reverse_iterator rbegin() const { return this->nodes.rbegin(); };
+	const_reverse_iterator rend() const { return this->nodes.rend(); };
+
+	void push_back ( XMP_Node * node ) { this->nodes.push_back ( node ); this->IndexLastNode(); };
+	void pop_back() { this->InvalidateIndex(); this->nodes.pop_back(); };
+	void clear() { this->InvalidateIndex(); this->nodes.clear(); };
+
+	iterator insert ( const_iterator pos, XMP_Node * node )
+		{ this->InvalidateIndex(); return this->nodes.insert ( pos, node ); };
+	iterator erase ( const_iterator pos )
+		{ this->InvalidateIndex(); return this->nodes.erase ( pos ); };
+	iterator erase ( const_iterator first, const_iterator last )
+		{ this->InvalidateIndex(); return this->nodes.erase ( first, last ); };
+
+	void SetNode ( size_t pos, XMP_Node * node );	// Keeps the index if the name is the same.
+	void SwapNodes ( size_t left, size_t right ) { std::swap ( this->nodes[left], this->nodes[right] ); };	// ! Array items only.
+
+	void swap ( XMP_NodeOffspring & other )
+		{ this->InvalidateIndex(); other.InvalidateIndex(); this->nodes.swap ( other.nodes ); };
+
+	template <class Compare>
+	void SortNodes ( Compare comp ) { this->InvalidateIndex(); std::sort ( this->nodes.begin(), this->nodes.end(), comp ); };
+	template <class Compare>
+	void StableSortNodes ( Compare comp ) { this->InvalidateIndex(); std::stable_sort ( this->nodes.begin(), this->nodes.end(), comp ); };
+
+	size_t FindNamed ( XMP_StringPtr name ) const;	// Returns size() if there is no such node.
+	size_t FindNamed ( const XMP_NodeName & name ) const;
+
+	void InvalidateIndex();
+
+private:
+
+	NodeVector nodes;
+	mutable std::atomic<XMP_NodeIndex*> index;	// ! Built lazily, possibly by concurrent readers.
+
+	void IndexLastNode();
+
+};
+
 typedef XMP_NodeOffspring::iterator	XMP_NodePtrPos;
 
 typedef XMP_VarString::iterator			XMP_VarStringPos;
@@ -75,6 +160,7 @@ typedef void(*XMP_DeleteProc)   (void * ptr);
 
 extern XMP_Bool sUseNewCoreAPIs;
 extern XMP_NamespaceTable * sRegisteredNamespaces;
+XMP_AtomTable & NodeNameAtoms();	// ! Created on first use, never null.
 
 extern XMP_AliasMap * sRegisteredAliasMap;
 
@@ -300,26 +386,167 @@ enum {	// Bits for XPathStepInfo options.	// *** Add mask check to init code.
 // =================================================================================================
 // XMP_Node details
 
+// -------------------------------------------------------------------------------------------------
+// XMP_NodeArena
+// -------------
+//
+// Chunked bump allocation for the XMP_Node objects of one tree, used when an XMPMeta object has the
+// kXMP_UseNodeArena option. Deleting an arena node only drops a reference, the memory comes back
+// when the whole arena is reset or released. Clearing the root of an arena tree destroys the nodes
+// in place, drops their references in one step, and rewinds the arena, see XMP_Node::ClearNode.
+// The owning XMPMeta holds one reference and each live node one more, so a node moved into another
+// tree keeps its arena alive. The name and value strings and the offspring vectors keep using the
+// normal heap, except for short strings that fit inside the node.
+//
+// Allocation is not synchronized, it relies on the owning object's write lock. Nodes are allocated
+// from the arena of the tree they are created in, see XMP_Node::operator new.
+
+class XMP_NodeArena {
+public:
+
+	XMP_NodeArena() : refCount(1), chunkNext(0), chunkLeft(0) {};
+
+	void * Allocate ( size_t size );	// Adds a reference for the allocation.
+	void   Release();					// Drops a reference, the last one deletes the arena.
+	void   ReleaseNodes ( size_t count );	// Drops the references of nodes destroyed in place.
+
+	bool Reset();	// Reuse the memory if only the owner's reference is left, returns false if not.
+
+private:
+
+	std::atomic<XMP_Int32> refCount;
+	std::vector<char*> chunks;
+	char * chunkNext;
+	size_t chunkLeft;
+
+	~XMP_NodeArena();	// ! Use Release.
+
+};
+
+// -------------------------------------------------------------------------------------------------
+// XMP_NodeName
+// ------------
+//
+// The name of an XMP_Node, usually an atom from NodeNameAtoms(). A repeated name like "dc:title" or
+// "[]" is stored once for the whole process, and comparing two atoms is a pointer compare. This has
+// enough of the std::string interface for the code that reads names, anything more goes through
+// str(). The atom table is created on first use rather than in XMPMeta::Initialize, because the C
+// API allows creating empty XMPMeta objects before that.
+//
+// Atoms live for the rest of the process, so the table has a fixed capacity. A name that does not
+// fit is a private copy owned by the node. The table never shrinks, so a given string is always an
+// atom or always private, and a private name only has to be compared by value against another
+// private name. The tree root's name, the rdf:about URI, is always private since each file has its
+// own, see Private.
+
+class XMP_NodeName {
+public:
+
+	XMP_NodeName() : atom(0), isPrivate(false) {};
+	XMP_NodeName ( XMP_StringPtr _name ) : atom(0), isPrivate(false) { this->Assign ( _name, (XMP_StringLen) strlen ( _name ) ); };
+	XMP_NodeName ( const XMP_VarString & _name ) : atom(0), isPrivate(false) { this->Assign ( _name.data(), (XMP_StringLen) _name.size() ); };
+
+	XMP_NodeName ( const XMP_NodeName & other ) : atom(other.atom), isPrivate(other.isPrivate)
+		{ if ( this->isPrivate ) this->atom = new XMP_VarString ( *other.atom ); };
+
+	~XMP_NodeName() { this->clear(); };
+
+	XMP_NodeName & operator= ( const XMP_NodeName & other )
+		{
+			if ( this != &other ) {
+				this->clear();
+				this->atom = other.isPrivate ? new XMP_VarString ( *other.atom ) : other.atom;
+				this->isPrivate = other.isPrivate;
+			}
+			return *this;
+		};
+	XMP_NodeName & operator= ( XMP_StringPtr _name )
+		{ this->Assign ( _name, (XMP_StringLen) strlen ( _name ) ); return *this; };
+	XMP_NodeName & operator= ( const XMP_VarString & _name )
+		{ this->Assign ( _name.data(), (XMP_StringLen) _name.size() ); return *this; };
+
+	// Returns a null name, which matches no node, if the string has never been used as a name.
+	static XMP_NodeName Lookup ( XMP_StringPtr _name );
+
+	// Returns a name that is never interned, for the tree root.
+	static XMP_NodeName Private ( const XMP_VarString & _name );
+
+	const XMP_VarString & str() const { return (this->atom != 0) ? *this->atom : EmptyName(); };
+	operator const XMP_VarString & () const { return this->str(); };
+
+	XMP_StringPtr c_str() const { return this->str().c_str(); };
+	size_t size() const { return (this->atom != 0) ? this->atom->size() : 0; };
+	bool empty() const { return (this->atom == 0); };
+	void clear() { if ( this->isPrivate ) delete this->atom; this->atom = 0; this->isPrivate = false; };
+
+	char operator[] ( size_t pos ) const { return this->str()[pos]; };
+	size_t find ( char ch, size_t pos = 0 ) const { return this->str().find ( ch, pos ); };
+	size_t find ( XMP_StringPtr s, size_t pos = 0 ) const { return this->str().find ( s, pos ); };
+	size_t find_first_of ( char ch, size_t pos = 0 ) const { return this->str().find_first_of ( ch, pos ); };
+	size_t find_first_of ( XMP_StringPtr s, size_t pos = 0 ) const { return this->str().find_first_of ( s, pos ); };
+
+	bool operator== ( const XMP_NodeName & other ) const
+		{ return (this->atom == other.atom) || ((this->isPrivate || other.isPrivate) && (this->str() == other.str())); };
+	bool operator!= ( const XMP_NodeName & other ) const { return ! (*this == other); };
+	bool operator== ( XMP_StringPtr other ) const { return (this->str() == other); };
+	bool operator!= ( XMP_StringPtr other ) const { return (this->str() != other); };
+	bool operator== ( const XMP_VarString & other ) const { return (this->str() == other); };
+	bool operator!= ( const XMP_VarString & other ) const { return (this->str() != other); };
+
+	// A hash that agrees with operator==. An atom hashes its address, a private name its value.
+	XMP_Uns32 Hash() const;
+
+	// Identifies the stored string, equal atoms give the same address. A private name has its own
+	// address, like a name that is used once.
+	const void * Atom() const { return this->atom; };
+
+private:
+
+	const XMP_VarString * atom;	// ! Null for the empty name.
+	bool isPrivate;				// ! The string is owned by this name rather than the atom table.
+
+	explicit XMP_NodeName ( const XMP_VarString * _atom ) : atom(_atom), isPrivate(false) {};
+
+	void Assign ( XMP_StringPtr _name, XMP_StringLen _len );
+
+	static const XMP_VarString & EmptyName();
+
+};
+
+inline bool operator== ( XMP_StringPtr left, const XMP_NodeName & right ) { return (right == left); }
+inline bool operator!= ( XMP_StringPtr left, const XMP_NodeName & right ) { return (right != left); }
+inline bool operator== ( const XMP_VarString & left, const XMP_NodeName & right ) { return (right == left); }
+inline bool operator!= ( const XMP_VarString & left, const XMP_NodeName & right ) { return (right != left); }
+
 #if 0	// Pattern for iterating over the children or qualifiers:
 	for ( size_t xxNum = 0, xxLim = _node_->_offspring_.size(); xxNum < xxLim; ++xxNum ) {
 		const XMP_Node * _curr_ = _node_->_offspring_[xxNum];
 	}
 #endif
 
+// A schema node can be shared by the trees of several XMPMeta objects, see XMPMeta::Clone. A shared
+// schema is read-only, each tree makes its own copy before changing it. The shareRefs count is the
+// number of other trees the node is in. The parent of a shared schema is the tree it was made in,
+// which might be gone, it is only fixed when a tree takes sole ownership. Nodes below the schema
+// level are never shared and always have shareRefs of 0.
+
 class XMP_Node {
 public:
 
 	XMP_OptionBits		options;
-	XMP_VarString		name, value;
+	std::atomic<XMP_Int32> shareRefs;	// ! Fills the padding after options.
+	XMP_NodeName		name;
+	XMP_VarString		value;
 	XMP_Node *			parent;
 	XMP_NodeOffspring	children;
 	XMP_NodeOffspring	qualifiers;
+	XMP_NodeArena *		arena;	// Only used in a tree root, where offspring are allocated from.
 	#if XMP_DebugBuild
 		// *** XMP_StringPtr	_namePtr, _valuePtr;	// *** Not working, need operator=?
 	#endif
 
 	XMP_Node ( XMP_Node * _parent, XMP_StringPtr _name, XMP_OptionBits _options )
-		: options(_options), name(_name), parent(_parent)
+		: options(_options), shareRefs(0), name(_name), parent(_parent), arena(0)
 	{
 		#if XMP_DebugBuild
 			XMP_Assert ( (name.find ( ':' ) != XMP_VarString::npos) || (name == kXMP_ArrayItemName) ||
@@ -329,8 +556,8 @@ public:
 		#endif
 	};
 
-	XMP_Node ( XMP_Node * _parent, const XMP_VarString & _name, XMP_OptionBits _options )
-		: options(_options), name(_name), parent(_parent)
+	XMP_Node ( XMP_Node * _parent, const XMP_NodeName & _name, XMP_OptionBits _options )
+		: options(_options), shareRefs(0), name(_name), parent(_parent), arena(0)
 	{
 		#if XMP_DebugBuild
 			XMP_Assert ( (name.find ( ':' ) != XMP_VarString::npos) || (name == kXMP_ArrayItemName) ||
@@ -341,7 +568,7 @@ public:
 	};
 
 	XMP_Node ( XMP_Node * _parent, XMP_StringPtr _name, XMP_StringPtr _value, XMP_OptionBits _options )
-		: options(_options), name(_name), value(_value), parent(_parent)
+		: options(_options), shareRefs(0), name(_name), value(_value), parent(_parent), arena(0)
 	{
 		#if XMP_DebugBuild
 			XMP_Assert ( (name.find ( ':' ) != XMP_VarString::npos) || (name == kXMP_ArrayItemName) ||
@@ -351,8 +578,8 @@ public:
 		#endif
 	};
 
-	XMP_Node ( XMP_Node * _parent, const XMP_VarString & _name, const XMP_VarString & _value, XMP_OptionBits _options )
-		: options(_options), name(_name), value(_value), parent(_parent)
+	XMP_Node ( XMP_Node * _parent, const XMP_NodeName & _name, const XMP_VarString & _value, XMP_OptionBits _options )
+		: options(_options), shareRefs(0), name(_name), value(_value), parent(_parent), arena(0)
 	{
 		#if XMP_DebugBuild
 			XMP_Assert ( (name.find ( ':' ) != XMP_VarString::npos) || (name == kXMP_ArrayItemName) ||
@@ -369,11 +596,19 @@ public:
 	void RemoveChildren()
 	{
 		for ( size_t i = 0, vLim = children.size(); i < vLim; ++i ) {
-			if ( children[i] != 0 ) delete children[i];
+			if ( children[i] != 0 ) ReleaseNode ( children[i] );
 		}
 		children.clear();
 	}
 
+	// Adds a tree to a shared schema node, or drops one. The last tree to drop it deletes it.
+	void AddShare() { shareRefs.fetch_add ( 1, std::memory_order_relaxed ); };
+	static void ReleaseNode ( XMP_Node * node )
+	{
+		if ( (node->shareRefs.load ( std::memory_order_acquire ) == 0) ||
+			 (node->shareRefs.fetch_sub ( 1, std::memory_order_acq_rel ) == 0) ) delete node;
+	}
+
 	void RemoveQualifiers()
 	{
 		for ( size_t i = 0, vLim = qualifiers.size(); i < vLim; ++i ) {
@@ -385,18 +620,33 @@ public:
 	void ClearNode()
 	{
 		options = 0;
-		name.erase();
+		name.clear();
 		value.erase();
-		this->RemoveChildren();
-		this->RemoveQualifiers();
+		if ( this->arena != 0 ) {
+			this->ClearArenaTree();
+		} else {
+			this->RemoveChildren();
+			this->RemoveQualifiers();
+		}
 	}
 
 	void SetValue( XMP_StringPtr value );
 
 	virtual ~XMP_Node() { RemoveChildren(); RemoveQualifiers(); };
 
+	// Nodes are allocated as "new ( parent ) XMP_Node ( parent, ... )". This uses the arena of the
+	// tree the parent is in, or the heap if that tree has none. Each allocation is preceded by a
+	// pointer to its arena, or null for the heap, so that delete can tell them apart.
+
+	static void * operator new ( size_t size, const XMP_Node * parent );
+	static void * operator new ( size_t size ) { return XMP_Node::operator new ( size, 0 ); };
+	static void   operator delete ( void * ptr );
+	static void   operator delete ( void * ptr, const XMP_Node * /* parent */ ) { XMP_Node::operator delete ( ptr ); };
+
 private:
-	XMP_Node() : options(0), parent(0)	// ! Make sure parent pointer is always set.
+	void ClearArenaTree();	// Whole-tree teardown for a root with an arena.
+
+	XMP_Node() : options(0), shareRefs(0), parent(0), arena(0)	// ! Make sure parent pointer is always set.
 	{
 		#if XMP_DebugBuild
 			// *** _namePtr  = name.c_str();
@@ -412,15 +662,50 @@ public:
 	XMP_AutoNode() : nodePtr(0) {};
 	~XMP_AutoNode() { if ( nodePtr != 0 ) delete ( nodePtr ); nodePtr = 0; };
 	XMP_AutoNode ( XMP_Node * _parent, XMP_StringPtr _name, XMP_OptionBits _options )
-		: nodePtr ( new XMP_Node ( _parent, _name, _options ) ) {};
-	XMP_AutoNode ( XMP_Node * _parent, const XMP_VarString & _name, XMP_OptionBits _options )
-		: nodePtr ( new XMP_Node ( _parent, _name, _options ) ) {};
+		: nodePtr ( new ( _parent ) XMP_Node ( _parent, _name, _options ) ) {};
+	XMP_AutoNode ( XMP_Node * _parent, const XMP_NodeName & _name, XMP_OptionBits _options )
+		: nodePtr ( new ( _parent ) XMP_Node ( _parent, _name, _options ) ) {};
 	XMP_AutoNode ( XMP_Node * _parent, XMP_StringPtr _name, XMP_StringPtr _value, XMP_OptionBits _options )
-		: nodePtr ( new XMP_Node ( _parent, _name, _value, _options ) ) {};
-	XMP_AutoNode ( XMP_Node * _parent, const XMP_VarString & _name, const XMP_VarString & _value, XMP_OptionBits _options )
-		: nodePtr ( new XMP_Node ( _parent, _name, _value, _options ) ) {};
+		: nodePtr ( new ( _parent ) XMP_Node ( _parent, _name, _value, _options ) ) {};
+	XMP_AutoNode ( XMP_Node * _parent, const XMP_NodeName & _name, const XMP_VarString & _value, XMP_OptionBits _options )
+		: nodePtr ( new ( _parent ) XMP_Node ( _parent, _name, _value, _options ) ) {};
 };
 
+// -------------------------------------------------------------------------------------------------
+// XMP_CompiledPath
+// ----------------
+//
+// A path expression expanded once, for clients that use the same paths on many objects, see
+// TXMPMeta::CompilePath. The expanded path is kept for the setters, which use FindNode as usual.
+// Lookups use FindCompiledNode instead, which follows the compiled steps. There a top level alias
+// is already replaced by its actual path, names are atoms, and array indices and selector values
+// are already parsed, so a lookup does no parsing and no allocation. A compiled path is never
+// changed after construction, any number of threads can use it at once.
+
+class XMP_CompiledStep {
+public:
+	XMP_OptionBits kind;	// The step kind, kXMP_StructFieldStep and following, 0 for the schema.
+	XMP_NodeName   name;	// The schema URI, field or qualifier name, or the selector's name.
+	XMP_VarString  value;	// The selector value, normalized for an xml:lang selector.
+	XMP_Index      index;	// The zero based array index.
+	bool           isLang;	// An xml:lang selector, only the first qualifier is checked.
+	XMP_CompiledStep() : kind(0), index(0), isLang(false) {};
+};
+
+class XMP_CompiledPath {
+public:
+
+	XMP_VarString schemaNS, propName;	// As passed in, for XMPMeta2.
+	XMP_ExpandedXPath expPath;
+	std::vector<XMP_CompiledStep> steps;	// ! Empty if FindCompiledNode must use expPath.
+
+	XMP_CompiledPath ( XMP_StringPtr _schemaNS, XMP_StringPtr _propName );	// Throws for a bad path.
+
+};
+
+extern const XMP_Node *
+FindCompiledNode ( const XMP_Node * xmpTree, const XMP_CompiledPath & compiledPath );
+
 // =================================================================================================
 
 #endif	// __XMPCore_Impl_hpp__
@@ -10,6 +10,7 @@
 
 #include <string>
 #include <stdio.h>	// For snprintf.
+#include <string.h>	// For strlen.
 
 #include "XMPCore/source/XMPCore_Impl.hpp"
 
@@ -320,6 +321,190 @@ GetNextXMPNode ( IterInfo & info )
 
 }	// GetNextXMPNode
 
+// -------------------------------------------------------------------------------------------------
+// AdvanceCursor
+// -------------
+//
+// Move a kXMP_IterCursor iteration to the next node in a pre-order depth-first traversal, the same
+// order as AdvanceIterPos. The offspring of the current node are entered here rather than when it
+// is returned, so that Skip only has to clear the descend flag or finish the top level.
+
+static const XMP_Node *
+AdvanceCursor ( IterInfo & info )
+{
+	IterCursor & cursor = info.cursor;
+
+	if ( cursor.rootNode != 0 ) {
+		cursor.currNode = cursor.rootNode;
+		cursor.rootNode = 0;
+		cursor.descend = true;
+		return cursor.currNode;
+	}
+
+	if ( (cursor.currNode != 0) && cursor.descend && (! (info.options & kXMP_IterJustChildren)) ) {
+		cursor.levels.push_back ( IterCursorLevel ( cursor.currNode, (! (info.options & kXMP_IterOmitQualifiers)) ) );
+	}
+
+	while ( ! cursor.levels.empty() ) {
+
+		IterCursorLevel & level = cursor.levels.back();
+		const XMP_NodeOffspring & offspring = (level.inQualifiers ? level.parent->qualifiers : level.parent->children);
+
+		if ( level.nextNum < offspring.size() ) {
+			const XMP_Node * xmpNode = offspring[level.nextNum++];
+			if ( XMP_NodeIsSchema ( xmpNode->options ) ) {
+				if ( xmpNode->children.empty() && (! (info.options & kXMP_IterJustChildren)) ) continue;
+				cursor.currSchema = xmpNode;
+			}
+			cursor.currNode = xmpNode;
+			cursor.descend = true;
+			return xmpNode;
+		}
+
+		if ( level.inQualifiers ) {
+			level.inQualifiers = false;	// The qualifiers are done, move on to the children.
+			level.nextNum = 0;
+		} else {
+			cursor.levels.pop_back();
+		}
+
+	}
+
+	cursor.currNode = 0;
+	return 0;
+
+}	// AdvanceCursor
+
+// -------------------------------------------------------------------------------------------------
+// GetArrayItemIndex
+// -----------------
+//
+// Return the one-based index of an array item. The level the item was visited from has the index,
+// the array is only searched for an item above the levels, like the root of a property iteration.
+
+static size_t
+GetArrayItemIndex ( const IterCursor & cursor, const XMP_Node * xmpItem )
+{
+	const XMP_Node * xmpArray = xmpItem->parent;
+
+	for ( size_t levelNum = cursor.levels.size(); levelNum > 0; --levelNum ) {
+		const IterCursorLevel & level = cursor.levels[levelNum-1];
+		if ( (level.parent != xmpArray) || level.inQualifiers ) continue;
+		const size_t itemNum = level.nextNum - 1;
+		if ( (itemNum < xmpArray->children.size()) && (xmpArray->children[itemNum] == xmpItem) ) return itemNum + 1;
+		break;
+	}
+
+	for ( size_t itemNum = 0, itemLim = xmpArray->children.size(); itemNum != itemLim; ++itemNum ) {
+		if ( xmpArray->children[itemNum] == xmpItem ) return itemNum + 1;
+	}
+
+	XMP_Throw ( "Array item not in its parent", kXMPErr_InternalFailure );
+
+}	// GetArrayItemIndex
+
+// -------------------------------------------------------------------------------------------------
+// ComposeCursorPath
+// -----------------
+//
+// Compose the full path of a node from the parent links, the same path AddNodeOffspring builds.
+
+static void
+ComposeCursorPath ( const IterCursor & cursor, const XMP_Node * xmpNode, XMP_VarString * fullPath )
+{
+	const XMP_Node * xmpParent = xmpNode->parent;
+
+	if ( ! XMP_NodeIsSchema ( xmpParent->options ) ) {
+
+		ComposeCursorPath ( cursor, xmpParent, fullPath );
+
+		if ( xmpNode->options & kXMP_PropIsQualifier ) {
+			*fullPath += "/?";
+		} else if ( xmpParent->options & kXMP_PropValueIsArray ) {
+			char buffer [32];	// AUDIT: Using sizeof(buffer) below for snprintf length is safe.
+			snprintf ( buffer, sizeof(buffer), "[%lu]", (unsigned long)GetArrayItemIndex ( cursor, xmpNode ) );
+			*fullPath += buffer;
+			return;
+		} else {
+			*fullPath += '/';
+		}
+
+	}
+
+	*fullPath += xmpNode->name;
+
+}	// ComposeCursorPath
+
+// -------------------------------------------------------------------------------------------------
+// NextCursorNode
+// --------------
+//
+// The kXMP_IterCursor form of XMPIterator::Next. The strings returned point into the XMP nodes, or
+// for an array item into the cursor's leafName buffer. The path is just the leaf name.
+
+static bool
+NextCursorNode ( IterInfo &		  info,
+				 XMP_StringPtr *  schemaNS,
+				 XMP_StringLen *  nsSize,
+				 XMP_StringPtr *  propPath,
+				 XMP_StringLen *  pathSize,
+				 XMP_StringPtr *  propValue,
+				 XMP_StringLen *  valueSize,
+				 XMP_OptionBits * propOptions )
+{
+	IterCursor & cursor = info.cursor;
+
+	const XMP_Node * xmpNode = AdvanceCursor ( info );
+	if ( xmpNode == 0 ) return false;
+
+	if ( info.options & kXMP_IterJustLeafNodes ) {
+		while ( XMP_NodeIsSchema ( xmpNode->options ) || (! xmpNode->children.empty()) ) {
+			if ( ! (info.options & kXMP_IterJustChildren) ) {
+				cursor.levels.push_back ( IterCursorLevel ( xmpNode, false ) );	// Skip to this node's children.
+			}
+			cursor.descend = false;
+			xmpNode = AdvanceCursor ( info );
+			if ( xmpNode == 0 ) return false;
+		}
+	}
+
+	*schemaNS = cursor.currSchema->name.c_str();
+	*nsSize   = static_cast<XMP_StringLen>(cursor.currSchema->name.size());
+
+	*propPath  = "";
+	*pathSize  = 0;
+	*propValue = "";
+	*valueSize = 0;
+
+	if ( XMP_NodeIsSchema ( xmpNode->options ) ) {
+		*propOptions = kXMP_SchemaNode;
+		return true;
+	}
+
+	*propOptions = xmpNode->options;
+
+	if ( (! (xmpNode->options & kXMP_PropIsQualifier)) && (xmpNode->parent->options & kXMP_PropValueIsArray) ) {
+		snprintf ( cursor.leafName, sizeof(cursor.leafName), "[%lu]", (unsigned long)GetArrayItemIndex ( cursor, xmpNode ) );
+		*propPath = cursor.leafName;
+		*pathSize = static_cast<XMP_StringLen>(strlen ( cursor.leafName ));
+	} else {
+		*propPath = xmpNode->name.c_str();
+		*pathSize = static_cast<XMP_StringLen>(xmpNode->name.size());
+	}
+
+	if ( info.options & kXMP_IterJustLeafName ) {
+		xmpNode->GetLocalURI ( schemaNS, nsSize );	// Use the leaf namespace, not the top namespace.
+	}
+
+	if ( ! (xmpNode->options & kXMP_PropCompositeMask) ) {
+		*propValue = xmpNode->value.c_str();
+		*valueSize = static_cast<XMP_StringLen>(xmpNode->value.size());
+	}
+
+	return true;
+
+}	// NextCursorNode
+
 // =================================================================================================
 // Init/Term
 // =================================================================================================
@@ -376,6 +561,40 @@ XMPIterator::XMPIterator ( const XMPMeta & xmpObj,
 	
 	// *** Lock the XMPMeta object if we ever stop using a full DLL lock.
 
+	if ( options & kXMP_IterCursor ) {
+
+		// A cursor iteration only has to find where to start, it keeps no copy of the tree. With
+		// kXMP_IterJustChildren the root is the first level, otherwise it is visited first.
+
+		IterCursor & cursor = info.cursor;
+		const XMP_Node * rootNode = 0;
+
+		if ( *propName != 0 ) {
+			XMP_ExpandedXPath propPath;
+			ExpandXPath ( schemaNS, propName, &propPath );
+			rootNode = FindConstNode ( &xmpObj.tree, propPath );	// If not found get empty iteration.
+		} else if ( *schemaNS != 0 ) {
+			rootNode = FindConstSchema ( &xmpObj.tree, schemaNS );
+			if ( (rootNode != 0) && rootNode->children.empty() ) rootNode = 0;
+		} else {
+			cursor.levels.push_back ( IterCursorLevel ( &xmpObj.tree, false ) );
+		}
+
+		if ( rootNode != 0 ) {
+			cursor.currSchema = rootNode;
+			while ( ! XMP_NodeIsSchema ( cursor.currSchema->options ) ) cursor.currSchema = cursor.currSchema->parent;
+			if ( options & kXMP_IterJustChildren ) {
+				cursor.levels.push_back ( IterCursorLevel ( rootNode, (! (options & kXMP_IterOmitQualifiers)) ) );
+			} else {
+				cursor.rootNode = rootNode;
+			}
+		}
+
+		info.currPos = info.endPos = info.tree.children.end();
+		return;
+
+	}
+
 	if ( *propName != 0 ) {
 
 		// An iterator rooted at a specific node.
@@ -514,6 +733,10 @@ XMPIterator::Next ( XMP_StringPtr *	 schemaNS,
 {
 	// *** Lock the XMPMeta object if we ever stop using a full DLL lock.
 	
+	if ( info.options & kXMP_IterCursor ) {
+		return NextCursorNode ( info, schemaNS, nsSize, propPath, pathSize, propValue, valueSize, propOptions );
+	}
+
 	// ! NOTE: Supporting aliases throws in some nastiness with schemas. There might not be any XMP
 	// ! node for the schema, but we still have to visit it because of possible aliases.
 	
@@ -594,6 +817,17 @@ XMPIterator::Skip ( XMP_OptionBits iterOptions )
 	if ( iterOptions == 0 ) XMP_Throw ( "Must specify what to skip", kXMPErr_BadOptions );
 	if ( (iterOptions & ~kXMP_ValidIterSkipOptions) != 0 ) XMP_Throw ( "Undefined options", kXMPErr_BadOptions );
 
+	if ( info.options & kXMP_IterCursor ) {
+		IterCursor & cursor = info.cursor;
+		if ( cursor.currNode == 0 ) return;	// Nothing visited yet, or the iteration is over.
+		cursor.descend = false;
+		if ( (iterOptions & kXMP_IterSkipSiblings) && (! (iterOptions & kXMP_IterSkipSubtree)) && (! cursor.levels.empty()) ) {
+			IterCursorLevel & level = cursor.levels.back();	// The level of the current node.
+			level.nextNum = (level.inQualifiers ? level.parent->qualifiers.size() : level.parent->children.size());
+		}
+		return;
+	}
+
 	#if TraceIterators
 		printf ( "Skipping from %s, stage = %s, iterator @ %.8X",
 			     info.currPos->fullPath.c_str(), sStageNames[info.currPos->visitStage], this );
@@ -619,4 +853,33 @@ XMPIterator::Skip ( XMP_OptionBits iterOptions )
 
 }	// Skip
 
+// -------------------------------------------------------------------------------------------------
+// GetPropPath
+// -----------
+//
+// Return the full path of the node last visited by Next. This is how a kXMP_IterCursor iteration
+// gets full paths, they are only composed when asked for.
+
+void
+XMPIterator::GetPropPath ( XMP_VarString * propPath ) const
+{
+	propPath->erase();
+
+	if ( info.options & kXMP_IterCursor ) {
+
+		const XMP_Node * xmpNode = info.cursor.currNode;
+		if ( xmpNode == 0 ) XMP_Throw ( "No current iteration node", kXMPErr_BadIterPosition );
+		if ( ! XMP_NodeIsSchema ( xmpNode->options ) ) ComposeCursorPath ( info.cursor, xmpNode, propPath );
+
+	} else {
+
+		if ( (info.currPos == info.endPos) || (info.currPos->visitStage == kIter_BeforeVisit) ) {
+			XMP_Throw ( "No current iteration node", kXMPErr_BadIterPosition );
+		}
+		if ( ! (info.currPos->options & kXMP_SchemaNode) ) *propPath = info.currPos->fullPath;
+
+	}
+
+}	// GetPropPath
+
 // =================================================================================================
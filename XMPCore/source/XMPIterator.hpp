@@ -58,6 +58,35 @@ struct IterNode {
 
 };
 
+// -------------------------------------------------------------------------------------------------
+// A kXMP_IterCursor iteration walks the XMP_Node tree in place instead of building IterNodes. The
+// levels stack has an entry for each node whose offspring are being visited, with the index of the
+// next offspring. Nothing else is kept, so the storage is bounded by the depth of the tree.
+
+struct IterCursorLevel {
+
+	const XMP_Node * parent;
+	size_t			 nextNum;
+	bool			 inQualifiers;
+
+	IterCursorLevel ( const XMP_Node * _parent, bool _inQualifiers )
+		: parent(_parent), nextNum(0), inQualifiers(_inQualifiers) {};
+
+};
+
+struct IterCursor {
+
+	const XMP_Node * currNode;		// The node last returned by Next, 0 before the first.
+	const XMP_Node * currSchema;	// The schema of currNode.
+	const XMP_Node * rootNode;		// A schema or property visited before the levels, 0 if none.
+	bool			 descend;		// Visit the offspring of currNode next, cleared by Skip.
+	std::vector<IterCursorLevel> levels;
+	char			 leafName [32];	// For the "[n]" leaf names of array items.
+
+	IterCursor() : currNode(0), currSchema(0), rootNode(0), descend(false) { leafName[0] = 0; };
+
+};
+
 struct IterInfo {
 
 	XMP_OptionBits	options;
@@ -66,6 +95,7 @@ struct IterInfo {
 	IterPos			currPos, endPos;
 	IterPosStack	ancestors;
 	IterNode 		tree;
+	IterCursor		cursor;
 	#if 0	// *** XMP_DebugBuild
 		XMP_StringPtr	_schemaPtr;	// *** Not working, need operator=?
 	#endif
@@ -116,6 +146,9 @@ public:
 	virtual void
 	Skip ( XMP_OptionBits options );
 
+	virtual void
+	GetPropPath ( XMP_VarString * propPath ) const;
+
 	// ! Expose so that wrappers and file static functions can see the data.
 
 	XMP_Int32 clientRefs;	// ! Must be signed to allow decrement from 0.
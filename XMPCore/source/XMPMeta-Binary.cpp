@@ -0,0 +1,617 @@
+// =================================================================================================
+// Copyright Adobe
+// All Rights Reserved.
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+#include "public/include/XMP_Environment.h"	// ! This must be the first include!
+
+#include "XMPCore/source/XMPCore_Impl.hpp"
+
+#include "XMPCore/source/XMPMeta.hpp"
+
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// =================================================================================================
+// The compact binary form
+// =======================
+//
+// A direct encoding of the XMP_Node tree, written by SerializeToBuffer with kXMP_SerializeBinary
+// and read by ParseFromBuffer with kXMP_ParseBinary. It is meant for caches and interprocess use,
+// where the RDF is only an exchange format. Loading it is mostly copying, there is no XML or RDF
+// to parse and no normalization to do, the tree already has its final form.
+//
+// All numbers are unsigned LEB128 varints, 7 bits per byte with the high bit set on all but the
+// last byte. Strings are a varint byte count and the UTF-8 bytes, with no terminating nul.
+//
+//   magic		4 bytes, "\x89XMB"
+//   version	varint, kBinaryVersion
+//   names		varint count, then the strings. Each distinct node name is written once, nodes
+//				refer to it by its index in this table.
+//   namespaces	varint count, then a URI string and a prefix string for each. The prefix includes
+//				the colon. These are all of the namespaces used in schema, property, and qualifier
+//				names.
+//   root		the tree root as a node, but with its name, the rdf:about URI, as a string instead
+//				of a name index.
+//
+// A node is a varint name index, varint options, the value string, then a varint count of the
+// qualifiers followed by the qualifier nodes, then a varint count of the children followed by the
+// child nodes. The options are the XMP_Node option bits as they are in memory.
+//
+// When read, the tree is checked for the shape and options the rest of XMPCore relies on, see
+// ReadOffspring. The namespaces are registered once the whole input is read. If a URI is already
+// registered with another prefix, the names using the old prefix are changed to the registered one,
+// as the RDF parser does. Any malformed input throws kXMPErr_BadXMP, leaves the XMP object empty,
+// and registers no namespaces.
+
+static const char      kBinaryMagic[4] = { '\x89', 'X', 'M', 'B' };
+static const XMP_Uns32 kBinaryVersion  = 1;
+
+static const size_t kMaxBinaryDepth = 1000;	// Deeper trees are taken as malformed input.
+static const size_t kMinNodeSize    = 5;	// Name, options, value length, and the two counts.
+
+// =================================================================================================
+// Writing
+// =======
+
+// -------------------------------------------------------------------------------------------------
+// AppendVarint
+// ------------
+
+static inline void
+AppendVarint ( XMP_VarString * out, XMP_Uns32 number )
+{
+	while ( number >= 0x80 ) {
+		out->push_back ( (char)((number & 0x7F) | 0x80) );
+		number >>= 7;
+	}
+	out->push_back ( (char)number );
+
+}	// AppendVarint
+
+// -------------------------------------------------------------------------------------------------
+// AppendString
+// ------------
+
+static inline void
+AppendString ( XMP_VarString * out, const XMP_VarString & str )
+{
+	AppendVarint ( out, (XMP_Uns32)str.size() );
+	out->append ( str );
+
+}	// AppendString
+
+// -------------------------------------------------------------------------------------------------
+// BinaryTables
+// ------------
+//
+// The name and namespace tables, collected in a first pass over the tree. The namespace of a name
+// is only looked up the first time the name is seen. The root's name is the rdf:about URI, it is
+// written as a string and is not in the tables.
+
+struct BinaryTables {
+
+	typedef std::unordered_map < const void *, XMP_Uns32 > NameIndexMap;
+
+	NameIndexMap nameIndex;
+	std::vector < const XMP_VarString * > names;
+	XMP_StringMap prefixToURI;	// ! Sorted by prefix, so the output is stable.
+	size_t valueBytes;
+	size_t nodeCount;
+
+	BinaryTables() : valueBytes(0), nodeCount(0) {};
+
+	void AddNode ( const XMP_Node & node );
+	void AddOffspring ( const XMP_Node & node );
+
+};
+
+void
+BinaryTables::AddNode ( const XMP_Node & node )
+{
+
+	++this->nodeCount;
+	this->valueBytes += node.value.size();
+
+	std::pair < NameIndexMap::iterator, bool > added =
+		this->nameIndex.insert ( NameIndexMap::value_type ( node.name.Atom(), (XMP_Uns32)this->names.size() ) );
+
+	if ( added.second ) {
+
+		const XMP_VarString & name = node.name.str();
+		this->names.push_back ( &name );
+
+		if ( node.options & kXMP_SchemaNode ) {
+			if ( node.value.empty() ) XMP_Throw ( "Schema node has no prefix", kXMPErr_InternalFailure );
+			this->prefixToURI[node.value] = name;	// ! The schema value is the prefix.
+		} else {
+			size_t colonPos = name.find ( ':' );
+			if ( colonPos != XMP_VarString::npos ) {
+				XMP_VarString prefix ( name, 0, colonPos+1 );
+				if ( this->prefixToURI.find ( prefix ) == this->prefixToURI.end() ) {
+					XMP_StringPtr uriStr;
+					XMP_StringLen uriLen;
+					bool nsFound = sRegisteredNamespaces->GetURI ( prefix.c_str(), &uriStr, &uriLen );
+					XMP_Enforce ( nsFound );
+					this->prefixToURI[prefix].assign ( uriStr, uriLen );
+				}
+			}
+		}
+
+	}
+
+	this->AddOffspring ( node );
+
+}	// BinaryTables::AddNode
+
+void
+BinaryTables::AddOffspring ( const XMP_Node & node )
+{
+	for ( size_t qualNum = 0, qualLim = node.qualifiers.size(); qualNum < qualLim; ++qualNum ) {
+		this->AddNode ( *node.qualifiers[qualNum] );
+	}
+	for ( size_t childNum = 0, childLim = node.children.size(); childNum < childLim; ++childNum ) {
+		this->AddNode ( *node.children[childNum] );
+	}
+}
+
+// -------------------------------------------------------------------------------------------------
+// AppendNode and AppendOffspring
+// ------------------------------
+
+static void AppendOffspring ( XMP_VarString * out, const BinaryTables & tables, const XMP_Node & node );
+
+static void
+AppendNode ( XMP_VarString * out, const BinaryTables & tables, const XMP_Node & node )
+{
+	AppendVarint ( out, tables.nameIndex.find ( node.name.Atom() )->second );
+	AppendVarint ( out, node.options );
+	AppendString ( out, node.value );
+	AppendOffspring ( out, tables, node );
+}
+
+static void
+AppendOffspring ( XMP_VarString * out, const BinaryTables & tables, const XMP_Node & node )
+{
+
+	AppendVarint ( out, (XMP_Uns32)node.qualifiers.size() );
+	for ( size_t qualNum = 0, qualLim = node.qualifiers.size(); qualNum < qualLim; ++qualNum ) {
+		AppendNode ( out, tables, *node.qualifiers[qualNum] );
+	}
+
+	AppendVarint ( out, (XMP_Uns32)node.children.size() );
+	for ( size_t childNum = 0, childLim = node.children.size(); childNum < childLim; ++childNum ) {
+		AppendNode ( out, tables, *node.children[childNum] );
+	}
+
+}	// AppendOffspring
+
+// -------------------------------------------------------------------------------------------------
+// SerializeToBinary
+// -----------------
+
+void
+XMPMeta::SerializeToBinary ( XMP_VarString * binString ) const
+{
+	XMP_Assert ( binString != 0 );
+
+	BinaryTables tables;
+	tables.AddOffspring ( this->tree );
+
+	size_t reserveSize = sizeof(kBinaryMagic) + 20 + this->tree.name.size() + this->tree.value.size() + tables.valueBytes + tables.nodeCount * (kMinNodeSize + 2);
+	for ( size_t i = 0, limit = tables.names.size(); i < limit; ++i ) reserveSize += tables.names[i]->size() + 2;
+	XMP_StringMap::const_iterator nsPos = tables.prefixToURI.begin();
+	XMP_StringMap::const_iterator nsEnd = tables.prefixToURI.end();
+	for ( ; nsPos != nsEnd; ++nsPos ) reserveSize += nsPos->first.size() + nsPos->second.size() + 4;
+
+	binString->erase();
+	binString->reserve ( reserveSize );
+
+	binString->append ( kBinaryMagic, sizeof(kBinaryMagic) );
+	AppendVarint ( binString, kBinaryVersion );
+
+	AppendVarint ( binString, (XMP_Uns32)tables.names.size() );
+	for ( size_t i = 0, limit = tables.names.size(); i < limit; ++i ) AppendString ( binString, *tables.names[i] );
+
+	AppendVarint ( binString, (XMP_Uns32)tables.prefixToURI.size() );
+	for ( nsPos = tables.prefixToURI.begin(); nsPos != nsEnd; ++nsPos ) {
+		AppendString ( binString, nsPos->second );
+		AppendString ( binString, nsPos->first );
+	}
+
+	AppendString ( binString, this->tree.name.str() );
+	AppendVarint ( binString, this->tree.options );
+	AppendString ( binString, this->tree.value );
+	AppendOffspring ( binString, tables, this->tree );
+
+}	// SerializeToBinary
+
+// =================================================================================================
+// Reading
+// =======
+
+// -------------------------------------------------------------------------------------------------
+// BinaryReader
+// ------------
+
+class BinaryReader {
+public:
+
+	BinaryReader ( XMP_StringPtr buffer, XMP_StringLen bufferSize )
+		: ptr ( (const XMP_Uns8*)buffer ), limit ( (const XMP_Uns8*)buffer + bufferSize ) {};
+
+	size_t Remaining() const { return (size_t)(this->limit - this->ptr); };
+
+	XMP_Uns32 Varint()
+	{
+		XMP_Uns32 number = 0;
+		for ( size_t shift = 0; shift < 35; shift += 7 ) {
+			if ( this->ptr == this->limit ) ThrowMalformed();
+			XMP_Uns8 byte = *this->ptr++;
+			if ( (shift == 28) && (byte > 0x0F) ) ThrowMalformed();	// More than 32 bits.
+			number |= (XMP_Uns32)(byte & 0x7F) << shift;
+			if ( (byte & 0x80) == 0 ) return number;
+		}
+		ThrowMalformed();
+		return 0;	// Not reached.
+	}
+
+	XMP_StringPtr String ( XMP_StringLen * length )
+	{
+		*length = this->Varint();
+		if ( *length > this->Remaining() ) ThrowMalformed();
+		XMP_StringPtr str = (XMP_StringPtr)this->ptr;
+		this->ptr += *length;
+		return str;
+	}
+
+	// Reads a count of nodes, checking that there is room for that many.
+	XMP_Uns32 NodeCount()
+	{
+		XMP_Uns32 count = this->Varint();
+		if ( count > (this->Remaining() / kMinNodeSize) ) ThrowMalformed();
+		return count;
+	}
+
+	bool Match ( const char * bytes, size_t length )
+	{
+		if ( length > this->Remaining() ) return false;
+		if ( memcmp ( this->ptr, bytes, length ) != 0 ) return false;
+		this->ptr += length;
+		return true;
+	}
+
+	static void ThrowMalformed() { XMP_Throw ( "Malformed binary XMP", kXMPErr_BadXMP ); };
+
+private:
+
+	const XMP_Uns8 * ptr;
+	const XMP_Uns8 * limit;
+
+};
+
+// -------------------------------------------------------------------------------------------------
+// BinaryNames
+// -----------
+//
+// The name and namespace tables of the input. The node names are made from the name table on first
+// use, with the prefix changed where the URI is already registered with another one. Schema names
+// are URIs and are not changed. Namespaces that are not registered yet are only registered once the
+// whole input is read, so malformed input leaves the namespace table alone. The xml:lang and
+// rdf:type qualifiers are recognized by their namespace URI, whatever the input's prefix is.
+
+class BinaryNames {
+public:
+
+	struct Entry {
+		XMP_StringPtr str;
+		XMP_StringLen length;
+		bool haveNodeName, haveSchemaName;
+		bool isLang, isType;	// Set along with nodeName.
+		XMP_NodeName nodeName, schemaName;
+	};
+
+	std::vector < Entry > names;
+	XMP_StringMap prefixToURI;		// From the input's namespace table.
+	XMP_StringMap uriToPrefix;
+	XMP_StringMap prefixChanges;	// Input prefix to registered prefix, only where they differ.
+
+	void AddNamespace ( const XMP_VarString & uri, const XMP_VarString & prefix );
+	void RegisterNewNamespaces ( XMP_StringMap * lateChanges );
+
+	const Entry & Node ( XMP_Uns32 index );
+	const XMP_NodeName & SchemaName ( XMP_Uns32 index );
+
+private:
+
+	std::vector < const XMP_VarString * > newURIs;	// Not registered when the input was read.
+
+};
+
+void
+BinaryNames::AddNamespace ( const XMP_VarString & uri, const XMP_VarString & prefix )
+{
+	if ( ! this->prefixToURI.insert ( XMP_StringMap::value_type ( prefix, uri ) ).second ) BinaryReader::ThrowMalformed();
+	std::pair < XMP_StringMap::iterator, bool > added = this->uriToPrefix.insert ( XMP_StringMap::value_type ( uri, prefix ) );
+	if ( ! added.second ) BinaryReader::ThrowMalformed();
+
+	XMP_StringPtr regPrefix;
+	XMP_StringLen regLen;
+	if ( ! sRegisteredNamespaces->GetPrefix ( uri.c_str(), &regPrefix, &regLen ) ) {
+		this->newURIs.push_back ( &added.first->first );
+	} else if ( (regLen != prefix.size()) || (memcmp ( regPrefix, prefix.c_str(), regLen ) != 0) ) {
+		this->prefixChanges[prefix].assign ( regPrefix, regLen );
+	}
+
+}	// BinaryNames::AddNamespace
+
+// Registers the namespaces that were new, returning the input prefixes that could not be kept,
+// because another URI took them, and what they were registered as instead.
+
+void
+BinaryNames::RegisterNewNamespaces ( XMP_StringMap * lateChanges )
+{
+	for ( size_t i = 0, limit = this->newURIs.size(); i < limit; ++i ) {
+		const XMP_VarString & uri = *this->newURIs[i];
+		const XMP_VarString & prefix = this->uriToPrefix[uri];
+		XMP_StringPtr regPrefix;
+		XMP_StringLen regLen;
+		(void) XMPMeta::RegisterNamespace ( uri.c_str(), prefix.c_str(), &regPrefix, &regLen );
+		if ( (regLen != prefix.size()) || (memcmp ( regPrefix, prefix.c_str(), regLen ) != 0) ) {
+			(*lateChanges)[prefix].assign ( regPrefix, regLen );
+		}
+	}
+
+}	// BinaryNames::RegisterNewNamespaces
+
+const BinaryNames::Entry &
+BinaryNames::Node ( XMP_Uns32 index )
+{
+	if ( index >= this->names.size() ) BinaryReader::ThrowMalformed();
+	Entry & entry = this->names[index];
+	if ( entry.haveNodeName ) return entry;
+
+	XMP_VarString name ( entry.str, entry.length );
+	size_t colonPos = name.find ( ':' );
+
+	if ( colonPos == XMP_VarString::npos ) {
+		if ( name != kXMP_ArrayItemName ) BinaryReader::ThrowMalformed();
+	} else {
+		XMP_VarString prefix ( name, 0, colonPos+1 );
+		XMP_StringMap::const_iterator uriPos = this->prefixToURI.find ( prefix );
+		if ( uriPos == this->prefixToURI.end() ) BinaryReader::ThrowMalformed();
+		entry.isLang = (uriPos->second == kXMP_NS_XML) && (name.compare ( colonPos+1, XMP_VarString::npos, "lang" ) == 0);
+		entry.isType = (uriPos->second == kXMP_NS_RDF) && (name.compare ( colonPos+1, XMP_VarString::npos, "type" ) == 0);
+		XMP_StringMap::const_iterator changePos = this->prefixChanges.find ( prefix );
+		if ( changePos != this->prefixChanges.end() ) name.replace ( 0, colonPos+1, changePos->second );
+	}
+
+	entry.nodeName = name;
+	entry.haveNodeName = true;
+	return entry;
+
+}	// BinaryNames::Node
+
+const XMP_NodeName &
+BinaryNames::SchemaName ( XMP_Uns32 index )
+{
+	if ( index >= this->names.size() ) BinaryReader::ThrowMalformed();
+	Entry & entry = this->names[index];
+	if ( ! entry.haveSchemaName ) {
+		XMP_VarString uri ( entry.str, entry.length );
+		if ( this->uriToPrefix.find ( uri ) == this->uriToPrefix.end() ) BinaryReader::ThrowMalformed();
+		entry.schemaName = uri;
+		entry.haveSchemaName = true;
+	}
+	return entry.schemaName;
+
+}	// BinaryNames::SchemaName
+
+// -------------------------------------------------------------------------------------------------
+// ReadOffspring
+// -------------
+//
+// Reads the qualifiers and children of a node whose own name, options, and value are already set.
+// Each new node is added to its parent before its offspring are read, so a failure leaves nothing
+// that the tree does not own. The tree is checked as it is read, the rest of XMPCore relies on:
+//
+//	- The root's children are the schema nodes, and nothing else is a schema node.
+//	- The qualifiers, and only they, have kXMP_PropIsQualifier.
+//	- An array's children are named "[]", other nodes are not.
+//	- Other siblings have distinct names, the lookups only find the first of a name.
+//	- The HasQualifiers, HasLang, and HasType options say what the qualifiers are.
+//	- An xml:lang qualifier is the first one.
+//	- A node is not both a struct and an array.
+//
+// The schema node values, their prefixes, are set once the namespaces are registered.
+
+static void
+ReadOffspring ( BinaryReader & in, BinaryNames & names, XMP_Node * parent, size_t depth )
+{
+	if ( depth > kMaxBinaryDepth ) BinaryReader::ThrowMalformed();
+
+	const bool parentIsArray = ((parent->options & kXMP_PropValueIsArray) != 0);
+	bool hasLang = false, hasType = false;
+
+	for ( int pass = 0; pass < 2; ++pass ) {
+
+		const bool isQualifier = (pass == 0);
+		const bool isSchema = (! isQualifier) && (depth == 0);
+		const bool isArrayItem = (! isQualifier) && parentIsArray;
+
+		XMP_NodeOffspring & offspring = isQualifier ? parent->qualifiers : parent->children;
+		XMP_Uns32 count = in.NodeCount();
+		if ( count == 0 ) continue;
+		offspring.reserve ( count );
+
+		for ( XMP_Uns32 nodeNum = 0; nodeNum < count; ++nodeNum ) {
+
+			XMP_Uns32 nameIndex = in.Varint();
+			XMP_OptionBits options = in.Varint();
+			XMP_StringLen valueLen;
+			XMP_StringPtr valueStr = in.String ( &valueLen );
+
+			if ( ((options & kXMP_SchemaNode) != 0) != isSchema ) BinaryReader::ThrowMalformed();
+			if ( ((options & kXMP_PropIsQualifier) != 0) != isQualifier ) BinaryReader::ThrowMalformed();
+			if ( (options & kXMP_PropValueIsStruct) && (options & kXMP_PropValueIsArray) ) BinaryReader::ThrowMalformed();
+
+			XMP_Node * node;
+
+			if ( isSchema ) {
+
+				const XMP_NodeName & schemaName = names.SchemaName ( nameIndex );
+				if ( offspring.FindNamed ( schemaName ) != offspring.size() ) BinaryReader::ThrowMalformed();
+				node = new ( parent ) XMP_Node ( parent, schemaName, options );
+				offspring.push_back ( node );
+
+			} else {
+
+				const BinaryNames::Entry & entry = names.Node ( nameIndex );
+				if ( (entry.nodeName == kXMP_ArrayItemName) != isArrayItem ) BinaryReader::ThrowMalformed();
+				if ( isQualifier ) {
+					if ( entry.isLang && (nodeNum != 0) ) BinaryReader::ThrowMalformed();	// Lookups only look at the first.
+					hasLang |= entry.isLang;
+					hasType |= entry.isType;
+				}
+				if ( (! isArrayItem) && (offspring.FindNamed ( entry.nodeName ) != offspring.size()) ) {
+					BinaryReader::ThrowMalformed();	// A duplicate sibling.
+				}
+
+				node = new ( parent ) XMP_Node ( parent, entry.nodeName, options );
+				offspring.push_back ( node );
+				node->value.assign ( valueStr, valueLen );
+
+			}
+
+			ReadOffspring ( in, names, node, depth+1 );
+
+		}
+
+	}
+
+	const XMP_OptionBits options = parent->options;
+	if ( ((options & kXMP_PropHasQualifiers) != 0) != (! parent->qualifiers.empty()) ) BinaryReader::ThrowMalformed();
+	if ( ((options & kXMP_PropHasLang) != 0) != hasLang ) BinaryReader::ThrowMalformed();
+	if ( ((options & kXMP_PropHasType) != 0) != hasType ) BinaryReader::ThrowMalformed();
+
+}	// ReadOffspring
+
+// -------------------------------------------------------------------------------------------------
+// ChangePrefixes
+// --------------
+//
+// Changes the prefix of the names using one that a namespace could not be registered with. This is
+// rare, it takes an input prefix that the process already uses for a different URI.
+
+static void
+ChangePrefixes ( XMP_Node * parent, const XMP_StringMap & changes )
+{
+	for ( int pass = 0; pass < 2; ++pass ) {
+
+		XMP_NodeOffspring & offspring = (pass == 0) ? parent->qualifiers : parent->children;
+		bool renamed = false;
+
+		for ( size_t nodeNum = 0, nodeLim = offspring.size(); nodeNum < nodeLim; ++nodeNum ) {
+			XMP_Node * node = offspring[nodeNum];
+			if ( ! (node->options & kXMP_SchemaNode) ) {
+				const XMP_VarString & name = node->name.str();
+				size_t colonPos = name.find ( ':' );
+				if ( colonPos != XMP_VarString::npos ) {
+					XMP_StringMap::const_iterator changePos = changes.find ( XMP_VarString ( name, 0, colonPos+1 ) );
+					if ( changePos != changes.end() ) {
+						node->name = changePos->second + name.substr ( colonPos+1 );
+						renamed = true;
+					}
+				}
+			}
+			ChangePrefixes ( node, changes );
+		}
+
+		if ( renamed ) offspring.InvalidateIndex();	// The duplicate checks might have indexed the old names.
+
+	}
+
+}	// ChangePrefixes
+
+// -------------------------------------------------------------------------------------------------
+// ParseFromBinary
+// ---------------
+
+void
+XMPMeta::ParseFromBinary ( XMP_StringPtr buffer, XMP_StringLen bufferSize )
+{
+	this->tree.ClearNode();	// Make sure the target XMP object is totally empty.
+
+	try {	// Cleanup the tree if anything fails.
+
+		BinaryReader in ( buffer, bufferSize );
+		if ( ! in.Match ( kBinaryMagic, sizeof(kBinaryMagic) ) ) BinaryReader::ThrowMalformed();
+		if ( in.Varint() != kBinaryVersion ) XMP_Throw ( "Unsupported binary XMP version", kXMPErr_BadXMP );
+
+		BinaryNames names;
+
+		XMP_Uns32 nameCount = in.Varint();
+		if ( nameCount > in.Remaining() ) BinaryReader::ThrowMalformed();
+		names.names.resize ( nameCount );
+		for ( XMP_Uns32 i = 0; i < nameCount; ++i ) {
+			BinaryNames::Entry & entry = names.names[i];
+			entry.str = in.String ( &entry.length );
+			entry.haveNodeName = entry.haveSchemaName = false;
+			entry.isLang = entry.isType = false;
+		}
+
+		XMP_Uns32 nsCount = in.Varint();
+		for ( XMP_Uns32 i = 0; i < nsCount; ++i ) {
+
+			XMP_StringLen uriLen, prefixLen;
+			XMP_StringPtr uriStr = in.String ( &uriLen );
+			XMP_StringPtr prefixStr = in.String ( &prefixLen );
+			if ( (uriLen == 0) || (prefixLen < 2) || (prefixStr[prefixLen-1] != ':') ) BinaryReader::ThrowMalformed();
+
+			XMP_VarString uri ( uriStr, uriLen ), prefix ( prefixStr, prefixLen );
+			if ( (uri.find ( '\0' ) != XMP_VarString::npos) || (prefix.find ( '\0' ) != XMP_VarString::npos) ) BinaryReader::ThrowMalformed();
+			names.AddNamespace ( uri, prefix );
+
+		}
+
+		XMP_StringLen nameLen, valueLen;
+		XMP_StringPtr nameStr = in.String ( &nameLen );
+		this->tree.options = in.Varint();
+		XMP_StringPtr valueStr = in.String ( &valueLen );
+		this->tree.name = XMP_NodeName::Private ( XMP_VarString ( nameStr, nameLen ) );
+		this->tree.value.assign ( valueStr, valueLen );
+
+		ReadOffspring ( in, names, &this->tree, 0 );
+		if ( in.Remaining() != 0 ) BinaryReader::ThrowMalformed();
+
+		// The input is good, register its namespaces and finish the names and schema prefixes.
+
+		XMP_StringMap lateChanges;
+		names.RegisterNewNamespaces ( &lateChanges );
+		if ( ! lateChanges.empty() ) ChangePrefixes ( &this->tree, lateChanges );
+
+		for ( size_t schemaNum = 0, schemaLim = this->tree.children.size(); schemaNum < schemaLim; ++schemaNum ) {
+			XMP_Node * schema = this->tree.children[schemaNum];
+			XMP_StringPtr prefixStr;
+			XMP_StringLen prefixLen;
+			bool nsFound = sRegisteredNamespaces->GetPrefix ( schema->name.c_str(), &prefixStr, &prefixLen );
+			XMP_Enforce ( nsFound );
+			schema->value.assign ( prefixStr, prefixLen );
+		}
+
+	} catch ( ... ) {
+
+		this->tree.ClearNode();
+		throw;
+
+	}
+
+}	// ParseFromBinary
+
+// =================================================================================================
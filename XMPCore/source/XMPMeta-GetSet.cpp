@@ -210,6 +210,49 @@ SetNode	( XMP_Node * node, XMP_StringPtr value, XMP_OptionBits options )
 }	// SetNode
 
 
+// -------------------------------------------------------------------------------------------------
+// DoDeleteProperty
+// ----------------
+//
+// The internals for DeleteProperty, shared by the string and compiled path forms.
+
+static void
+DoDeleteProperty ( XMPMeta * xmpObj, const XMP_ExpandedXPath & expPath )
+{
+	XMP_NodePtrPos ptrPos;
+	xmpObj->MakePathWritable ( expPath );
+	XMP_Node * propNode = FindNode ( &xmpObj->tree, expPath, kXMP_ExistingOnly, kXMP_NoOptions, &ptrPos );
+	if ( propNode == 0 ) return;
+	XMP_Node * parentNode = propNode->parent;
+	
+	// Erase the pointer from the parent's vector, then delete the node and all below it.
+	
+	if ( ! (propNode->options & kXMP_PropIsQualifier) ) {
+
+		parentNode->children.erase ( ptrPos );
+		DeleteEmptySchema ( parentNode );
+
+	} else {
+
+		if ( propNode->name == "xml:lang" ) {
+			XMP_Assert ( parentNode->options & kXMP_PropHasLang );	// *** &= ~flag would be safer
+			parentNode->options ^= kXMP_PropHasLang;
+		} else if ( propNode->name == "rdf:type" ) {
+			XMP_Assert ( parentNode->options & kXMP_PropHasType );
+			parentNode->options ^= kXMP_PropHasType;
+		}
+
+		parentNode->qualifiers.erase ( ptrPos );
+		XMP_Assert ( parentNode->options & kXMP_PropHasQualifiers );
+		if ( parentNode->qualifiers.empty() ) parentNode->options ^= kXMP_PropHasQualifiers;
+
+	}
+	
+	delete propNode;	// ! The destructor takes care of the whole subtree.
+	
+}	// DoDeleteProperty
+
+
 // -------------------------------------------------------------------------------------------------
 // DoSetArrayItem
 // --------------
@@ -247,7 +290,7 @@ DoSetArrayItem ( XMP_Node *		arrayNode,
 	if ( itemIndex == arraySize+1 ) {
 
 		if ( itemLoc != 0 ) XMP_Throw ( "Can't insert before or after implicit new item", kXMPErr_BadIndex );
-		itemNode = new XMP_Node ( arrayNode, kXMP_ArrayItemName, 0 );
+		itemNode = new ( arrayNode ) XMP_Node ( arrayNode, kXMP_ArrayItemName, 0 );
 		arrayNode->children.push_back ( itemNode );
 
 	} else {
@@ -259,7 +302,7 @@ DoSetArrayItem ( XMP_Node *		arrayNode,
 		} else {
 			XMP_NodePtrPos itemPos = arrayNode->children.begin() + itemIndex;
 			if ( itemLoc == kXMP_InsertAfterItem ) ++itemPos;
-			itemNode = new XMP_Node ( arrayNode, kXMP_ArrayItemName, 0 );
+			itemNode = new ( arrayNode ) XMP_Node ( arrayNode, kXMP_ArrayItemName, 0 );
 			itemPos = arrayNode->children.insert ( itemPos, itemNode );
 		}
 
@@ -378,8 +421,8 @@ ChooseLocalizedText ( const XMP_Node *	 arrayNode,
 static void
 AppendLangItem ( XMP_Node * arrayNode, XMP_StringPtr itemLang, XMP_StringPtr itemValue )
 {
-	XMP_Node * newItem  = new XMP_Node ( arrayNode, kXMP_ArrayItemName, (kXMP_PropHasQualifiers | kXMP_PropHasLang) );
-	XMP_Node * langQual = new XMP_Node ( newItem, "xml:lang", kXMP_PropIsQualifier );
+	XMP_Node * newItem  = new ( arrayNode ) XMP_Node ( arrayNode, kXMP_ArrayItemName, (kXMP_PropHasQualifiers | kXMP_PropHasLang) );
+	XMP_Node * langQual = new ( newItem ) XMP_Node ( newItem, "xml:lang", kXMP_PropIsQualifier );
 	
 	try {	// ! Use SetNodeValue, not constructors above, to get the character checks.
 		SetNodeValue ( newItem, itemValue );
@@ -529,6 +572,7 @@ XMPMeta::SetProperty ( XMP_StringPtr  schemaNS,
 	XMP_ExpandedXPath expPath;
 	ExpandXPath ( schemaNS, propName, &expPath );
 
+	this->MakePathWritable ( expPath );
 	XMP_Node * propNode = FindNode ( &tree, expPath, kXMP_CreateNodes, options );
 	if ( propNode == 0 ) XMP_Throw ( "Specified property does not exist", kXMPErr_BadXPath );
 	
@@ -552,6 +596,7 @@ XMPMeta::SetArrayItem ( XMP_StringPtr  schemaNS,
 
 	XMP_ExpandedXPath arrayPath;
 	ExpandXPath ( schemaNS, arrayName, &arrayPath );
+	this->MakePathWritable ( arrayPath );
 	XMP_Node * arrayNode = FindNode ( &tree, arrayPath, kXMP_ExistingOnly );	// Just lookup, don't try to create.
 	if ( arrayNode == 0 ) XMP_Throw ( "Specified array does not exist", kXMPErr_BadXPath );
 	
@@ -583,6 +628,7 @@ XMPMeta::AppendArrayItem ( XMP_StringPtr  schemaNS,
 	
 	XMP_ExpandedXPath arrayPath;
 	ExpandXPath ( schemaNS, arrayName, &arrayPath );
+	this->MakePathWritable ( arrayPath );
 	XMP_Node * arrayNode = FindNode ( &tree, arrayPath, kXMP_ExistingOnly );	// Just lookup, don't try to create.
 	
 	if ( arrayNode != 0 ) {
@@ -645,6 +691,7 @@ XMPMeta::SetQualifier ( XMP_StringPtr  schemaNS,
 
 	XMP_ExpandedXPath expPath;
 	ExpandXPath ( schemaNS, propName, &expPath );
+	this->MakePathWritable ( expPath );
 	XMP_Node * propNode = FindNode ( &tree, expPath, kXMP_ExistingOnly );
 	if ( propNode == 0 ) XMP_Throw ( "Specified property does not exist", kXMPErr_BadXPath );
 
@@ -668,35 +715,7 @@ XMPMeta::DeleteProperty	( XMP_StringPtr	schemaNS,
 	XMP_ExpandedXPath	expPath;
 	ExpandXPath ( schemaNS, propName, &expPath );
 	
-	XMP_NodePtrPos ptrPos;
-	XMP_Node * propNode = FindNode ( &tree, expPath, kXMP_ExistingOnly, kXMP_NoOptions, &ptrPos );
-	if ( propNode == 0 ) return;
-	XMP_Node * parentNode = propNode->parent;
-	
-	// Erase the pointer from the parent's vector, then delete the node and all below it.
-	
-	if ( ! (propNode->options & kXMP_PropIsQualifier) ) {
-
-		parentNode->children.erase ( ptrPos );
-		DeleteEmptySchema ( parentNode );
-
-	} else {
-
-		if ( propNode->name == "xml:lang" ) {
-			XMP_Assert ( parentNode->options & kXMP_PropHasLang );	// *** &= ~flag would be safer
-			parentNode->options ^= kXMP_PropHasLang;
-		} else if ( propNode->name == "rdf:type" ) {
-			XMP_Assert ( parentNode->options & kXMP_PropHasType );
-			parentNode->options ^= kXMP_PropHasType;
-		}
-
-		parentNode->qualifiers.erase ( ptrPos );
-		XMP_Assert ( parentNode->options & kXMP_PropHasQualifiers );
-		if ( parentNode->qualifiers.empty() ) parentNode->options ^= kXMP_PropHasQualifiers;
-
-	}
-	
-	delete propNode;	// ! The destructor takes care of the whole subtree.
+	DoDeleteProperty ( this, expPath );
 	
 }	// DeleteProperty
 
@@ -776,6 +795,61 @@ XMPMeta::DoesPropertyExist ( XMP_StringPtr schemaNS,
 }	// DoesPropertyExist
 
 
+// -------------------------------------------------------------------------------------------------
+// GetProperty, SetProperty, DeleteProperty, DoesPropertyExist for compiled paths
+// ------------------------------------------------------------------------------
+//
+// The same as the string forms, without expanding the path. A setter only goes through FindNode
+// when it has to create the property.
+
+bool
+XMPMeta::GetProperty ( const XMP_CompiledPath & compiledPath,
+					   XMP_StringPtr *	propValue,
+					   XMP_StringLen *	valueSize,
+					   XMP_OptionBits *	options ) const
+{
+	XMP_Assert ( (propValue != 0) && (valueSize != 0) && (options != 0) );	// Enforced by wrapper.
+
+	const XMP_Node * propNode = FindCompiledNode ( &tree, compiledPath );
+	if ( propNode == 0 ) return false;
+	
+	*propValue = propNode->value.c_str();
+	*valueSize = static_cast<XMP_StringLen>( propNode->value.size() );
+	*options   = propNode->options;
+	
+	return true;
+	
+}	// GetProperty
+
+void
+XMPMeta::SetProperty ( const XMP_CompiledPath & compiledPath,
+					   XMP_StringPtr  propValue,
+					   XMP_OptionBits options )
+{
+	options = VerifySetOptions ( options, propValue );
+
+	this->MakePathWritable ( compiledPath.expPath );
+	XMP_Node * propNode = const_cast<XMP_Node*> ( FindCompiledNode ( &tree, compiledPath ) );
+	if ( propNode == 0 ) propNode = FindNode ( &tree, compiledPath.expPath, kXMP_CreateNodes, options );
+	if ( propNode == 0 ) XMP_Throw ( "Specified property does not exist", kXMPErr_BadXPath );
+	
+	SetNode ( propNode, propValue, options );
+	
+}	// SetProperty
+
+void
+XMPMeta::DeleteProperty	( const XMP_CompiledPath & compiledPath )
+{
+	DoDeleteProperty ( this, compiledPath.expPath );
+}	// DeleteProperty
+
+bool
+XMPMeta::DoesPropertyExist ( const XMP_CompiledPath & compiledPath ) const
+{
+	return (FindCompiledNode ( &tree, compiledPath ) != 0);
+}	// DoesPropertyExist
+
+
 // -------------------------------------------------------------------------------------------------
 // DoesArrayItemExist
 // ------------------
@@ -910,6 +984,7 @@ XMPMeta::SetLocalizedText ( XMP_StringPtr  schemaNS,
 	ExpandXPath ( schemaNS, arrayName, &arrayPath );
 	
 	// Find the array node and set the options if it was just created.
+	this->MakePathWritable ( arrayPath );
 	XMP_Node * arrayNode = FindNode ( &tree, arrayPath, kXMP_CreateNodes,
 									  (kXMP_PropValueIsArray | kXMP_PropArrayIsOrdered | kXMP_PropArrayIsAlternate) );
 	if ( arrayNode == 0 ) XMP_Throw ( "Failed to find or create array node", kXMPErr_BadXPath );
@@ -942,9 +1017,7 @@ XMPMeta::SetLocalizedText ( XMP_StringPtr  schemaNS,
 	
 	if ( haveXDefault && (itemNum != 0) ) {
 		XMP_Assert ( arrayNode->children[itemNum]->qualifiers[0]->value == "x-default" );
-		XMP_Node * temp = arrayNode->children[0];
-		arrayNode->children[0] = arrayNode->children[itemNum];
-		arrayNode->children[itemNum] = temp;
+		arrayNode->children.SwapNodes ( 0, itemNum );
 	}
 	
 	// Find the appropriate item. ChooseLocalizedText will make sure the array is a language alternative.
@@ -1052,6 +1125,7 @@ XMPMeta::DeleteLocalizedText ( XMP_StringPtr schemaNS,
 	
 	// Find the LangAlt array and the selected array item.
 
+	this->MakePathWritable ( arrayPath );
 	XMP_Node * arrayNode = FindNode ( &tree, arrayPath, kXMP_ExistingOnly );
 	if ( arrayNode == 0 ) return;
 	size_t arraySize = arrayNode->children.size();
@@ -1077,9 +1151,7 @@ XMPMeta::DeleteLocalizedText ( XMP_StringPtr schemaNS,
 	}
 	
 	if ( itemIsXDefault && (itemIndex != 0) ) {	// Enforce the x-default is first policy.
-		XMP_Node * temp = arrayNode->children[0];
-		arrayNode->children[0] = arrayNode->children[itemIndex];
-		arrayNode->children[itemIndex] = temp;
+		arrayNode->children.SwapNodes ( 0, itemIndex );
 		itemIndex = 0;
 	}
 	
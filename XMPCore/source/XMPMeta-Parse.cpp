@@ -213,8 +213,8 @@ NormalizeDCArrays ( XMP_Node * xmpTree )
 		if ( arrayForm == 0 ) continue;	// Nothing to do if it isn't supposed to be an array.
 		
 		arrayForm = VerifySetOptions ( arrayForm, 0 );	// Set the implicit array bits.
-		XMP_Node * newArray = new XMP_Node ( dcSchema, currProp->name.c_str(), arrayForm );
-		dcSchema->children[propNum] = newArray;
+		XMP_Node * newArray = new ( dcSchema ) XMP_Node ( dcSchema, currProp->name.c_str(), arrayForm );
+		dcSchema->children.SetNode ( propNum, newArray );
 		
 		if ( currProp->value.empty() ) {	// Don't add an empty item, leave the array empty.
 		
@@ -227,7 +227,7 @@ NormalizeDCArrays ( XMP_Node * xmpTree )
 			currProp->name = kXMP_ArrayItemName;
 			
 			if ( XMP_ArrayIsAltText ( arrayForm ) && (! (currProp->options & kXMP_PropHasLang)) ) {
-				XMP_Node * newLang = new XMP_Node ( currProp, "xml:lang", "x-default", kXMP_PropIsQualifier );
+				XMP_Node * newLang = new ( currProp ) XMP_Node ( currProp, "xml:lang", "x-default", kXMP_PropIsQualifier );
 				currProp->options |= (kXMP_PropHasQualifiers | kXMP_PropHasLang);
 				if ( currProp->qualifiers.empty() ) {	// *** Need a util?
 					currProp->qualifiers.push_back ( newLang );
@@ -309,7 +309,7 @@ TransplantArrayItemAlias ( XMP_Node * oldParent, size_t oldNum, XMP_Node * newPa
 		    errorCallback.NotifyClient ( kXMPErrSev_OperationFatal, error );	// *** Allow x-default.
 		}
 		childNode->options |= (kXMP_PropHasQualifiers | kXMP_PropHasLang);
-		XMP_Node * langQual = new XMP_Node ( childNode, "xml:lang", "x-default", kXMP_PropIsQualifier );	// *** AddLangQual util?
+		XMP_Node * langQual = new ( childNode ) XMP_Node ( childNode, "xml:lang", "x-default", kXMP_PropIsQualifier );	// *** AddLangQual util?
 		if ( childNode->qualifiers.empty() ) {
 			childNode->qualifiers.push_back ( langQual );
 		} else {
@@ -394,7 +394,7 @@ MoveExplicitAliases ( XMP_Node * tree, XMP_OptionBits parseOptions, XMPMeta::Err
 					TransplantNamedAlias ( currSchema, propNum, baseSchema, basePath[kRootPropStep].step );
 				} else {
 					// An alias to an array item, create the array and transplant the property.
-					baseNode = new XMP_Node ( baseSchema, basePath[kRootPropStep].step.c_str(), arrayOptions );
+					baseNode = new ( baseSchema ) XMP_Node ( baseSchema, basePath[kRootPropStep].step.c_str(), arrayOptions );
 					baseSchema->children.push_back ( baseNode );
 					TransplantArrayItemAlias ( currSchema, propNum, baseNode, errorCallback );
 				}
@@ -612,7 +612,7 @@ RepairAltText ( XMP_Node & tree, XMP_StringPtr schemaNS, XMP_StringPtr arrayName
 			} else {
 
 				// Add an xml:lang qualifier with the value "x-repair".
-				XMP_Node * repairLang = new XMP_Node ( currChild, "xml:lang", "x-repair", kXMP_PropIsQualifier );
+				XMP_Node * repairLang = new ( currChild ) XMP_Node ( currChild, "xml:lang", "x-repair", kXMP_PropIsQualifier );
 				if ( currChild->qualifiers.empty() ) {
 					currChild->qualifiers.push_back ( repairLang );
 				} else {
@@ -653,11 +653,11 @@ TouchUpDataModel ( XMPMeta * xmp, XMPMeta::ErrorCallbackInfo & /*errorCallback*/
 		// *** For now just do this for exif:UserComment, the one case we know about, late in cycle fix.
 		XMP_Node * userComment = FindChildNode ( currSchema, "exif:UserComment", kXMP_ExistingOnly );
 		if ( (userComment != 0) && XMP_PropIsSimple ( userComment->options ) ) {
-			XMP_Node * newChild = new XMP_Node ( userComment, kXMP_ArrayItemName,
+			XMP_Node * newChild = new ( userComment ) XMP_Node ( userComment, kXMP_ArrayItemName,
 												 userComment->value.c_str(), userComment->options );
 			newChild->qualifiers.swap ( userComment->qualifiers );
 			if ( ! XMP_PropHasLang ( newChild->options ) ) {
-				XMP_Node * langQual = new XMP_Node ( newChild, "xml:lang", "x-default", kXMP_PropIsQualifier );
+				XMP_Node * langQual = new ( newChild ) XMP_Node ( newChild, "xml:lang", "x-default", kXMP_PropIsQualifier );
 				newChild->qualifiers.insert ( newChild->qualifiers.begin(), langQual );
 				newChild->options |= (kXMP_PropHasQualifiers | kXMP_PropHasLang);
 			}
@@ -740,7 +740,7 @@ TouchUpDataModel ( XMPMeta * xmp, XMPMeta::ErrorCallbackInfo & /*errorCallback*/
 			idNode->RemoveChildren();
 			idNode->RemoveQualifiers();
 
-			tree.name.erase();
+			tree.name.clear();
 
 		}
 
@@ -954,7 +954,8 @@ ProcessUTF8Portion ( XMLParserAdapter * xmlParser,
 		
 	for ( spanEnd = spanStart; spanEnd < bufEnd; ++spanEnd ) {
 
-		if ( (0x20 <= *spanEnd) && (*spanEnd <= 0x7E) && (*spanEnd != '&') ) continue;	// A regular ASCII character.
+		spanEnd = XMP_SkipPlainASCII ( spanEnd, bufEnd );	// Skip the regular ASCII characters.
+		if ( spanEnd == bufEnd ) break;
 
 		if ( *spanEnd >= 0x80 ) {
 		
@@ -1196,6 +1197,17 @@ void XMPMeta::ProcessXMLTree ( XMP_OptionBits options )
 		DumpXMLTree ( this->xmlParser->parseLog, this->xmlParser->tree, 0 );
 	#endif
 
+	if ( this->xmlParser->elementSink != 0 ) {
+		// Recoverable XML errors can leave elements open. End them for a streaming parse, they
+		// are part of the XML tree used by the normal processing.
+		XML_NodeVector & parseStack = this->xmlParser->parseStack;
+		while ( parseStack.size() > 1 ) {	// ! Keep the XML root node.
+			XML_Node * openNode = parseStack.back();
+			parseStack.pop_back();
+			this->xmlParser->elementSink->EndElement ( openNode );
+		}
+	}
+
 	const XML_Node * xmlRoot = FindRootNode ( *this->xmlParser, options );
 
 	if ( xmlRoot != 0 ) {
@@ -1246,6 +1258,15 @@ XMPMeta::ParseFromBuffer ( XMP_StringPtr  buffer,
 {
 	if ( (buffer == 0) && (xmpSize != 0) ) XMP_Throw ( "Null parse buffer", kXMPErr_BadParam );
 	if (xmpSize == kXMP_UseNullTermination) xmpSize = static_cast<XMP_Index>(strnlen_safe(buffer, Max_XMP_Uns32));
+
+	if ( options & kXMP_ParseBinary ) {
+		if ( options & (kXMP_ParseMoreBuffers | kXMP_ParseStreaming) ) {
+			XMP_Throw ( "Can't use kXMP_ParseMoreBuffers or kXMP_ParseStreaming with kXMP_ParseBinary", kXMPErr_BadOptions );
+		}
+		if ( this->xmlParser != 0 ) XMP_Throw ( "Binary parse in the middle of an RDF parse", kXMPErr_BadOptions );
+		this->ParseFromBinary ( buffer, xmpSize );
+		return;
+	}
 	
 	const bool lastClientCall = ((options & kXMP_ParseMoreBuffers) == 0);	// *** Could use FlagIsSet & FlagIsClear macros.
 	
@@ -1254,6 +1275,7 @@ XMPMeta::ParseFromBuffer ( XMP_StringPtr  buffer,
 		if ( (xmpSize == 0) && lastClientCall ) return;	// Tolerate empty parse. Expat complains if there are no XML elements.
 		this->xmlParser = XMP_NewExpatAdapter ( ExpatAdapter::kUseGlobalNamespaces );
 		this->xmlParser->SetErrorCallback ( &this->errorCallback );
+		if ( options & kXMP_ParseStreaming ) this->xmlParser->elementSink = this->NewRDFStream ( options );
 	}
 	
 	try {	// Cleanup the tree and xmlParser if anything fails.
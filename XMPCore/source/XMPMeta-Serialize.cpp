@@ -42,8 +42,9 @@ using namespace std;
 // Local Types and Constants
 // =========================
 
-static const char * kPacketHeader  = "<?xpacket begin=\"\xEF\xBB\xBF\" id=\"W5M0MpCehiHzreSzNTczkc9d\"?>";
-static const char * kPacketTrailer = "<?xpacket end=\"w\"?>";	// ! The w/r is at [size-4].
+static const char * kPacketHeader          = "<?xpacket begin=\"\xEF\xBB\xBF\" id=\"W5M0MpCehiHzreSzNTczkc9d\"?>";
+static const char * kPacketTrailer         = "<?xpacket end=\"w\"?>";
+static const char * kPacketTrailerReadOnly = "<?xpacket end=\"r\"?>";
 
 //static const char * kTXMP_SchemaGroup = "XMP_SchemaGroup";
 
@@ -56,10 +57,8 @@ static const char * kRDF_RDFEnd       = "</rdf:RDF>";
 static const char * kRDF_SchemaStart  = "<rdf:Description rdf:about=";
 static const char * kRDF_SchemaEnd    = "</rdf:Description>";
 
-static const char * kRDF_StructStart  = "<rdf:Description>";
 static const char * kRDF_StructEnd    = "</rdf:Description>";
 
-static const char * kRDF_BagStart     = "<rdf:Bag>";
 //static const char * kRDF_BagEnd       = "</rdf:Bag>";
 
 //static const char * kRDF_SeqStart     = "<rdf:Seq>";
@@ -68,10 +67,8 @@ static const char * kRDF_BagStart     = "<rdf:Bag>";
 //static const char * kRDF_AltStart     = "<rdf:Alt>";
 //static const char * kRDF_AltEnd       = "</rdf:Alt>";
 
-static const char * kRDF_ItemStart    = "<rdf:li>";
 //static const char * kRDF_ItemEnd      = "</rdf:li>";
 
-static const char * kRDF_ValueStart   = "<rdf:value>";
 //static const char * kRDF_ValueEnd     = "</rdf:value>";
 
 
@@ -86,49 +83,109 @@ static const char * kRDF_ValueStart   = "<rdf:value>";
 
 
 // -------------------------------------------------------------------------------------------------
-// EstimateRDFSize
+// RDF_SizeCounter
 // ---------------
+//
+// An output for the serialization functions that only counts the bytes, used to find the exact
+// packet size before a packet is written. If given an MD5 context it also digests the bytes, for
+// the rdfhash attribute.
 
-//  *** Pull the strlen(kXyz) calls into constants.
+class RDF_SizeCounter {
+public:
 
-static size_t
-EstimateRDFSize ( const XMP_Node * currNode, XMP_Index indent, size_t indentLen )
-{
-	size_t outputLen = 2 * (indent*indentLen + currNode->name.size() + 4);	// The property element tags.
-	
-	if ( ! currNode->qualifiers.empty() ) {
-		// This node has qualifiers, assume it is written using rdf:value and estimate the qualifiers.
+	RDF_SizeCounter ( MD5_CTX * _digest = 0 ) : count(0), digest(_digest) {};
+
+	size_t size() const { return this->count; };
+
+	void append ( const char * str, size_t len )
+	{
+		this->count += len;
+		if ( this->digest != 0 ) MD5Update ( this->digest, (XMP_Uns8*)str, (unsigned int)len );
+	};
+
+	void append ( size_t len, char /* ch */ )	// ! Only used for padding, which is never digested.
+	{
+		XMP_Assert ( this->digest == 0 );	// ! The digest needs the actual bytes.
+		this->count += len;
+	};
+
+	RDF_SizeCounter & operator+= ( const char * str ) { this->append ( str, strlen ( str ) ); return *this; };
+	RDF_SizeCounter & operator+= ( const XMP_VarString & str ) { this->append ( str.data(), str.size() ); return *this; };
+	RDF_SizeCounter & operator+= ( char ch ) { this->append ( &ch, 1 ); return *this; };
+
+private:
+
+	size_t    count;
+	MD5_CTX * digest;
+
+};	// RDF_SizeCounter
+
+
+// -------------------------------------------------------------------------------------------------
+// RDF_CallbackSink
+// ----------------
+//
+// An output for the serialization functions that passes the text to a client callback in chunks of
+// up to kSinkBufferSize bytes. A nonzero status from the callback aborts the serialization.
+
+class RDF_CallbackSink {
+public:
 
-		indent += 2;	// Everything else is indented inside the rdf:Description element.
-		outputLen += 2 * ((indent-1)*indentLen + strlen(kRDF_StructStart) + 2);	// The rdf:Description tags.
-		outputLen += 2 * (indent*indentLen + strlen(kRDF_ValueStart) + 2);		// The rdf:value tags.
+	enum { kSinkBufferSize = 16*1024 };
 
-		for ( size_t qualNum = 0, qualLim = currNode->qualifiers.size(); qualNum < qualLim; ++qualNum ) {
-			const XMP_Node * currQual = currNode->qualifiers[qualNum];
-			outputLen += EstimateRDFSize ( currQual, indent, indentLen );
+	RDF_CallbackSink ( XMP_TextOutputProc _outProc, void * _refCon )
+		: outProc(_outProc), refCon(_refCon), used(0) {};
+
+	void append ( const char * str, size_t len )
+	{
+		if ( (this->used + len) > kSinkBufferSize ) {
+			this->Flush();
+			if ( len >= kSinkBufferSize ) {
+				this->Write ( str, len );	// Pass big values straight through.
+				return;
+			}
+		}
+		memcpy ( &this->buffer[this->used], str, len );
+		this->used += len;
+	};
+
+	void append ( size_t len, char ch )
+	{
+		while ( len > 0 ) {
+			if ( this->used == kSinkBufferSize ) this->Flush();
+			size_t fill = kSinkBufferSize - this->used;
+			if ( fill > len ) fill = len;
+			memset ( &this->buffer[this->used], ch, fill );
+			this->used += fill;
+			len -= fill;
 		}
+	};
 
-	}
-	
-	if ( currNode->options & kXMP_PropValueIsStruct ) {
-		indent += 1;
-		outputLen += 2 * (indent*indentLen + strlen(kRDF_StructStart) + 2);	// The rdf:Description tags.
-	} else if ( currNode->options & kXMP_PropValueIsArray ) {
-		indent += 2;
-		outputLen += 2 * ((indent-1)*indentLen + strlen(kRDF_BagStart) + 2);		// The rdf:Bag/Seq/Alt tags.
-		outputLen += 2 * currNode->children.size() * (strlen(kRDF_ItemStart) + 2);	// The rdf:li tags, indent counted in children.
-	} else if ( ! (currNode->options & kXMP_SchemaNode) ) {
-		outputLen += currNode->value.size();	// This is a leaf value node.
-	}
+	RDF_CallbackSink & operator+= ( const char * str ) { this->append ( str, strlen ( str ) ); return *this; };
+	RDF_CallbackSink & operator+= ( const XMP_VarString & str ) { this->append ( str.data(), str.size() ); return *this; };
+	RDF_CallbackSink & operator+= ( char ch ) { this->append ( &ch, 1 ); return *this; };
 
-	for ( size_t childNum = 0, childLim = currNode->children.size(); childNum < childLim; ++childNum ) {
-		const XMP_Node * currChild = currNode->children[childNum];
-		outputLen += EstimateRDFSize ( currChild, indent+1, indentLen );
-	}
+	void Flush()
+	{
+		if ( this->used == 0 ) return;
+		this->Write ( this->buffer, this->used );
+		this->used = 0;
+	};
 
-	return outputLen;
-	
-}	// EstimateRDFSize
+private:
+
+	XMP_TextOutputProc outProc;
+	void * refCon;
+	size_t used;
+	char   buffer [kSinkBufferSize];
+
+	void Write ( const char * str, size_t len )
+	{
+		XMP_Status status = (*this->outProc) ( this->refCon, str, (XMP_StringLen)len );
+		if ( status != 0 ) XMP_Throw ( "Serialization output callback failed", kXMPErr_ExternalFailure );
+	};
+
+};	// RDF_CallbackSink
 
 
 // -------------------------------------------------------------------------------------------------
@@ -239,9 +296,10 @@ enum {
 	kIsEndTag   = false
 };
 
+template <class tOutput>
 static void
 EmitRDFArrayTag	( XMP_OptionBits  arrayForm,
-				  XMP_VarString & outputStr,
+				  tOutput &       outputStr,
 				  XMP_StringPtr	  newline,
 				  XMP_StringPtr	  indentStr,
 				  XMP_Index		  indent,
@@ -279,8 +337,9 @@ EmitRDFArrayTag	( XMP_OptionBits  arrayForm,
 // Append a property or qualifier value to the output with appropriate XML escaping. The escaped
 // characters for elements and attributes are '&', '<', '>', and ASCII controls (tab, LF, CR). In
 // addition, '"' is escaped for attributes. For efficiency, this is done in a double loop. The outer
-// loop makes sure the whole value is processed. The inner loop does a contiguous unescaped run
-// followed by one escaped character (if we're not at the end).
+// loop makes sure the whole value is processed. XMP_FindXMLEscape finds the end of a contiguous
+// unescaped run, which is appended in one piece, followed by one escaped character (if we're not
+// at the end).
 //
 // We depend on parsing and SetProperty logic to make sure there are no invalid ASCII controls in
 // the XMP values. The XML spec only allows tab, LF, and CR. Others are not even allowed as
@@ -291,27 +350,25 @@ enum {
 	kForElement   = false
 };
 
+template <class tOutput>
 static void
-AppendNodeValue ( XMP_VarString & outputStr, const XMP_VarString & value, bool forAttribute )
+AppendNodeValue ( tOutput & outputStr, const XMP_VarString & value, bool forAttribute )
 {
 
-	unsigned char * runStart = (unsigned char *) value.c_str();
-	unsigned char * runLimit  = runStart + value.size();
-	unsigned char * runEnd;
-	unsigned char   ch = 0;
+	const XMP_Uns8 * runStart = (const XMP_Uns8 *) value.c_str();
+	const XMP_Uns8 * runLimit = runStart + value.size();
+	const XMP_Uns8 * runEnd;
 	
 	while ( runStart < runLimit ) {
 	
-		for ( runEnd = runStart; runEnd < runLimit; ++runEnd ) {
-			ch = *runEnd;
-			if ( forAttribute && (ch == '"') ) break;
-			if ( (ch < 0x20) || (ch == '&') || (ch == '<') || (ch == '>') ) break;
-		}
+		runEnd = XMP_FindXMLEscape ( runStart, runLimit, forAttribute );
 		
-		outputStr.append ( (char *) runStart, (runEnd - runStart) );
+		outputStr.append ( (const char *) runStart, (runEnd - runStart) );
 		
 		if ( runEnd < runLimit ) {
 
+			const XMP_Uns8 ch = *runEnd;
+
 			if ( ch < 0x20 ) {
 			
 				XMP_Assert ( (ch == kTab) || (ch == kLF) || (ch == kCR) );
@@ -384,6 +441,33 @@ IsRDFAttrQualifier ( XMP_VarString qualName )
 }	// IsRDFAttrQualifier
 
 
+// -------------------------------------------------------------------------------------------------
+// DeclareAllNamespaces
+// --------------------
+//
+// Collect the xmlns attributes for all namespaces used in the tree. This is done once per
+// serialization, both passes of SerializeToBuffer use the result.
+
+static void
+DeclareAllNamespaces ( const XMP_Node & xmpTree,
+					   XMP_VarString *  nsDecls,
+					   XMP_StringPtr	newline,
+					   XMP_StringPtr	indentStr,
+					   XMP_Index		baseIndent )
+{
+	XMP_VarString usedNS;
+	usedNS.reserve ( 400 );	// The predefined prefixes add up to about 320 bytes.
+	usedNS = ":xml:rdf:";
+
+	nsDecls->erase();
+	for ( size_t schema = 0, schemaLim = xmpTree.children.size(); schema != schemaLim; ++schema ) {
+		const XMP_Node * currSchema = xmpTree.children[schema];
+		DeclareUsedNamespaces ( currSchema, usedNS, *nsDecls, newline, indentStr, baseIndent+4 );
+	}
+
+}	// DeclareAllNamespaces
+
+
 // -------------------------------------------------------------------------------------------------
 // StartOuterRDFDescription
 // ------------------------
@@ -391,12 +475,13 @@ IsRDFAttrQualifier ( XMP_VarString qualName )
 // Start the outer rdf:Description element, including all needed xmlns attributes. Leave the element
 // open so that the compact form can add proprtty attributes.
 
+template <class tOutput>
 static void
-StartOuterRDFDescription ( const XMP_Node & xmpTree,
-						   XMP_VarString &  outputStr,
-						   XMP_StringPtr	newline,
-						   XMP_StringPtr	indentStr,
-						   XMP_Index		baseIndent )
+StartOuterRDFDescription ( const XMP_Node &      xmpTree,
+						   tOutput &             outputStr,
+						   const XMP_VarString & nsDecls,
+						   XMP_StringPtr         indentStr,
+						   XMP_Index             baseIndent )
 {
 	
 	// Begin the outer rdf:Description start tag.
@@ -409,14 +494,7 @@ StartOuterRDFDescription ( const XMP_Node & xmpTree,
 	
 	// Write all necessary xmlns attributes.
 
-	XMP_VarString usedNS;
-	usedNS.reserve ( 400 );	// The predefined prefixes add up to about 320 bytes.
-	usedNS = ":xml:rdf:";
-
-	for ( size_t schema = 0, schemaLim = xmpTree.children.size(); schema != schemaLim; ++schema ) {
-		const XMP_Node * currSchema = xmpTree.children[schema];
-		DeclareUsedNamespaces ( currSchema, usedNS, outputStr, newline, indentStr, baseIndent+4 );
-	}
+	outputStr += nsDecls;
 
 }	// StartOuterRDFDescription
 
@@ -458,9 +536,10 @@ StartOuterRDFDescription ( const XMP_Node & xmpTree,
 enum { kUseCanonicalRDF = true, kUseAdobeVerboseRDF = false };
 enum { kEmitAsRDFValue = true, kEmitAsNormalValue = false };
 
+template <class tOutput>
 static void
 SerializeCanonicalRDFProperty ( const XMP_Node * propNode,
-								XMP_VarString &  outputStr,
+								tOutput &        outputStr,
 								XMP_StringPtr	 newline,
 								XMP_StringPtr	 indentStr,
 								XMP_Index		 indent,
@@ -687,16 +766,18 @@ SerializeCanonicalRDFProperty ( const XMP_Node * propNode,
 //
 //	</rdf:Description>
 
+template <class tOutput>
 static void
-SerializeCanonicalRDFSchemas ( const XMP_Node & xmpTree,
-							   XMP_VarString &	outputStr,
-							   XMP_StringPtr	newline,
-							   XMP_StringPtr	indentStr,
-							   XMP_Index		baseIndent,
-							   bool				useCanonicalRDF )
+SerializeCanonicalRDFSchemas ( const XMP_Node &      xmpTree,
+							   tOutput &             outputStr,
+							   const XMP_VarString & nsDecls,
+							   XMP_StringPtr         newline,
+							   XMP_StringPtr         indentStr,
+							   XMP_Index             baseIndent,
+							   bool                  useCanonicalRDF )
 {
 
-	StartOuterRDFDescription ( xmpTree, outputStr, newline, indentStr, baseIndent );
+	StartOuterRDFDescription ( xmpTree, outputStr, nsDecls, indentStr, baseIndent );
 	
 	if ( xmpTree.children.size() > 0 ) {
 		outputStr += ">";
@@ -731,9 +812,10 @@ SerializeCanonicalRDFSchemas ( const XMP_Node & xmpTree,
 // Write each of the parent's simple unqualified properties as an attribute. Returns true if all
 // of the properties are written as attributes.
 
+template <class tOutput>
 static bool
 SerializeCompactRDFAttrProps ( const XMP_Node *	parentNode,
-							   XMP_VarString &	outputStr,
+							   tOutput &		outputStr,
 							   XMP_StringPtr	newline,
 							   XMP_StringPtr	indentStr,
 							   XMP_Index		indent )
@@ -802,9 +884,10 @@ SerializeCompactRDFAttrProps ( const XMP_Node *	parentNode,
 // *** Consider numbered array items, but has compatibility problems.
 // *** Consider qualified form with rdf:Description and attributes.
 
+template <class tOutput>
 static void
 SerializeCompactRDFElemProps ( const XMP_Node *	parentNode,
-							   XMP_VarString &	outputStr,
+							   tOutput &		outputStr,
 							   XMP_StringPtr	newline,
 							   XMP_StringPtr	indentStr,
 							   XMP_Index		indent )
@@ -1023,17 +1106,19 @@ SerializeCompactRDFElemProps ( const XMP_Node *	parentNode,
 //		... The remaining properties of the schema, see SerializeCompactRDFElemProps
 //	</rdf:Description>
 
+template <class tOutput>
 static void
-SerializeCompactRDFSchemas ( const XMP_Node & xmpTree,
-							 XMP_VarString &  outputStr,
-							 XMP_StringPtr	  newline,
-							 XMP_StringPtr	  indentStr,
-							 XMP_Index		  baseIndent )
+SerializeCompactRDFSchemas ( const XMP_Node &      xmpTree,
+							 tOutput &             outputStr,
+							 const XMP_VarString & nsDecls,
+							 XMP_StringPtr         newline,
+							 XMP_StringPtr         indentStr,
+							 XMP_Index             baseIndent )
 {
 	XMP_Index level;
 	size_t schema, schemaLim;
 	
-	StartOuterRDFDescription ( xmpTree, outputStr, newline, indentStr, baseIndent );
+	StartOuterRDFDescription ( xmpTree, outputStr, nsDecls, indentStr, baseIndent );
 	
 	// Write the top level "attrProps" and close the rdf:Description start tag.
 	bool allAreAttrs = true;
@@ -1083,160 +1168,238 @@ SerializeCompactRDFSchemas ( const XMP_Node & xmpTree,
 // *** Need to verify round tripping of rdf:ID and similar qualifiers, see RDF 7.2.21.
 // *** Check cases of rdf:resource plus explicit attr qualifiers (like xml:lang).
 
+template <class tOutput>
 static void
-SerializeAsRDF ( const XMPMeta & xmpObj,
-				 XMP_VarString & headStr,	// Everything up to the padding.
-				 XMP_VarString & tailStr,	// Everything after the padding.
-				 XMP_OptionBits	 options,
-				 XMP_StringPtr	 newline,
-				 XMP_StringPtr	 indentStr,
-				 XMP_Index		 baseIndent )
+SerializeRDFElement ( const XMPMeta &       xmpObj,
+					  tOutput &             outputStr,
+					  const XMP_VarString & nsDecls,
+					  XMP_OptionBits        options,
+					  XMP_StringPtr         newline,
+					  XMP_StringPtr         indentStr,
+					  XMP_Index             baseIndent )
 {
-	const size_t treeNameLen = xmpObj.tree.name.size();
-	const size_t indentLen   = strlen ( indentStr );
-
-	// First estimate the worst case space and reserve room in the output string. This optimization
-	// avoids reallocating and copying the output as it grows. The initial count does not look at
-	// the values of properties, so it does not account for character entities, e.g. &#xA; for newline.
-	// Since there can be a lot of these in things like the base 64 encoding of a large thumbnail,
-	// inflate the count by 1/4 (easy to do) to accommodate.
-	
-	// *** Need to include estimate for alias comments.
-	
-	size_t outputLen = 2 * (strlen(kPacketHeader) + strlen(kRDF_XMPMetaStart) + strlen(kRDF_RDFStart) + 3*baseIndent*indentLen);
-
-	for ( size_t schemaNum = 0, schemaLim = xmpObj.tree.children.size(); schemaNum < schemaLim; ++schemaNum ) {
-		const XMP_Node * currSchema = xmpObj.tree.children[schemaNum];
-		outputLen += 2*(baseIndent+2)*indentLen + strlen(kRDF_SchemaStart) + treeNameLen + strlen(kRDF_SchemaEnd) + 2;
-		outputLen += EstimateRDFSize ( currSchema, baseIndent+2, indentLen );
-	}
-	
-	outputLen += (outputLen >> 2);	// Inflate by 1/4, an empirical fudge factor.
-	
-	// Now generate the RDF into the head string as UTF-8.
-	
-	XMP_Index level;
-	
-	std::string rdfstring;
-	headStr.erase();
-	rdfstring.reserve ( outputLen );
-
 	// Write the rdf:RDF start tag.
-	rdfstring += kRDF_RDFStart;
-	rdfstring += newline;
-	
+	outputStr += kRDF_RDFStart;
+	outputStr += newline;
+
 	// Write all of the properties.
 	if ( options & kXMP_UseCompactFormat ) {
-		SerializeCompactRDFSchemas ( xmpObj.tree, rdfstring, newline, indentStr, baseIndent );
+		SerializeCompactRDFSchemas ( xmpObj.tree, outputStr, nsDecls, newline, indentStr, baseIndent );
 	} else {
 		bool useCanonicalRDF = XMP_OptionIsSet ( options, kXMP_UseCanonicalFormat );
-		SerializeCanonicalRDFSchemas ( xmpObj.tree, rdfstring, newline, indentStr, baseIndent, useCanonicalRDF );
+		SerializeCanonicalRDFSchemas ( xmpObj.tree, outputStr, nsDecls, newline, indentStr, baseIndent, useCanonicalRDF );
 	}
 
 	// Write the rdf:RDF end tag.
-	for ( level = baseIndent+1; level > 0; --level ) rdfstring += indentStr;
-	rdfstring += kRDF_RDFEnd;
+	for ( XMP_Index level = baseIndent+1; level > 0; --level ) outputStr += indentStr;
+	outputStr += kRDF_RDFEnd;
+
+}	// SerializeRDFElement
+
+
+// -------------------------------------------------------------------------------------------------
+// SerializeAsRDF
+// --------------
+//
+// Writes everything up to the padding. The nsDecls come from DeclareAllNamespaces. The rdfHash is
+// the hex MD5 digest of the rdf:RDF element, it is only used if kXMP_IncludeRDFHash is set.
+
+template <class tOutput>
+static void
+SerializeAsRDF ( const XMPMeta &       xmpObj,
+				 tOutput &             outputStr,
+				 const XMP_VarString & nsDecls,
+				 XMP_OptionBits        options,
+				 XMP_StringPtr         newline,
+				 XMP_StringPtr         indentStr,
+				 XMP_Index             baseIndent,
+				 const XMP_VarString & rdfHash )
+{
+	XMP_Index level;
+
 	// Write the packet header PI.
 	if ( ! (options & kXMP_OmitPacketWrapper) ) {
-		for ( level = baseIndent; level > 0; --level ) headStr += indentStr;
-		headStr += kPacketHeader;
-		headStr += newline;
+		for ( level = baseIndent; level > 0; --level ) outputStr += indentStr;
+		outputStr += kPacketHeader;
+		outputStr += newline;
 	}
 
 	// Write the xmpmeta element's start tag.
 	if ( ! (options & kXMP_OmitXMPMetaElement) ) {
-		for ( level = baseIndent; level > 0; --level ) headStr += indentStr;
-		headStr += kRDF_XMPMetaStart;
-		headStr += kXMPCore_VersionMessage  "\"";
-		std::string digestStr;
-		unsigned char digestBin [16];
-		if (options & kXMP_IncludeRDFHash)
-		{
-			std::string hashrdf;	
-			MD5_CTX    context;
-			MD5Init ( &context );
-			MD5Update ( &context, (XMP_Uns8*)rdfstring.c_str(), (unsigned int)rdfstring.size() );
-			MD5Final ( digestBin, &context );
-			char buffer [40];
-			for ( int in = 0, out = 0; in < 16; in += 1, out += 2 ) {
-				XMP_Uns8 byte = digestBin[in];
-				buffer[out]   = kHexDigits [ byte >> 4 ];
-				buffer[out+1] = kHexDigits [ byte & 0xF ];
-			}
-			buffer[32] = 0;
-			digestStr.append ( buffer );
-			headStr += " rdfhash=\"";
-			headStr += digestStr + "\"";
-			headStr += " merged=\"0\"";
+		for ( level = baseIndent; level > 0; --level ) outputStr += indentStr;
+		outputStr += kRDF_XMPMetaStart;
+		outputStr += kXMPCore_VersionMessage  "\"";
+		if ( options & kXMP_IncludeRDFHash ) {
+			outputStr += " rdfhash=\"";
+			outputStr += rdfHash;
+			outputStr += "\"";
+			outputStr += " merged=\"0\"";
 		}
-		headStr += ">";
-		headStr += newline;
+		outputStr += ">";
+		outputStr += newline;
 	}
 
-	for ( level = baseIndent+1; level > 0; --level ) headStr += indentStr;
-	headStr+= rdfstring ;
-	headStr += newline;
+	for ( level = baseIndent+1; level > 0; --level ) outputStr += indentStr;
+	SerializeRDFElement ( xmpObj, outputStr, nsDecls, options, newline, indentStr, baseIndent );
+	outputStr += newline;
 
 	// Write the xmpmeta end tag.
 	if ( ! (options & kXMP_OmitXMPMetaElement) ) {
-		for ( level = baseIndent; level > 0; --level ) headStr += indentStr;
-		headStr += kRDF_XMPMetaEnd;
-		headStr += newline;
+		for ( level = baseIndent; level > 0; --level ) outputStr += indentStr;
+		outputStr += kRDF_XMPMetaEnd;
+		outputStr += newline;
 	}
-	
-	// Write the packet trailer PI into the tail string as UTF-8.
-	tailStr.erase();
+
+}	// SerializeAsRDF
+
+
+// -------------------------------------------------------------------------------------------------
+// SerializePacketTrailer
+// ----------------------
+//
+// Writes everything after the padding.
+
+template <class tOutput>
+static void
+SerializePacketTrailer ( tOutput &      outputStr,
+						 XMP_OptionBits options,
+						 XMP_StringPtr  indentStr,
+						 XMP_Index      baseIndent )
+{
+
 	if ( ! (options & kXMP_OmitPacketWrapper) ) {
-		tailStr.reserve ( strlen(kPacketTrailer) + (strlen(indentStr) * baseIndent) );
-		for ( level = baseIndent; level > 0; --level ) tailStr += indentStr;
-		tailStr += kPacketTrailer;
-		if ( options & kXMP_ReadOnlyPacket ) tailStr[tailStr.size()-4] = 'r';
+		for ( XMP_Index level = baseIndent; level > 0; --level ) outputStr += indentStr;
+		outputStr += (options & kXMP_ReadOnlyPacket) ? kPacketTrailerReadOnly : kPacketTrailer;
 	}
-	
-}	// SerializeAsRDF
+
+}	// SerializePacketTrailer
 
 
 // -------------------------------------------------------------------------------------------------
-// SerializeToBuffer
-// -----------------
+// AppendPadding
+// -------------
+//
+// Appends exactly padding bytes of UTF-8 whitespace, lines of 100 spaces followed by the newline.
 
-void
-XMPMeta::SerializeToBuffer ( XMP_VarString * rdfString,
-							 XMP_OptionBits	 options,
-							 XMP_StringLen	 padding,
-							 XMP_StringPtr	 newline,
-							 XMP_StringPtr	 indentStr,
-							 XMP_Index		 baseIndent ) const
+template <class tOutput>
+static void
+AppendPadding ( tOutput & outputStr, size_t padding, XMP_StringPtr newline )
+{
+	size_t newlineLen = strlen ( newline );
+
+	if ( padding < newlineLen ) {
+		outputStr.append ( padding, ' ' );
+	} else {
+		padding -= newlineLen;	// Write this newline last.
+		while ( padding >= (100 + newlineLen) ) {
+			outputStr.append ( 100, ' ' );
+			outputStr += newline;
+			padding -= (100 + newlineLen);
+		}
+		outputStr.append ( padding, ' ' );
+		outputStr += newline;
+	}
+
+}	// AppendPadding
+
+
+// -------------------------------------------------------------------------------------------------
+// ComputeRDFHash
+// --------------
+//
+// The rdfhash attribute is written before the content it covers, so it needs a digest pass that
+// runs the serialization of the rdf:RDF element without writing anything.
+
+static void
+ComputeRDFHash ( const XMPMeta &       xmpObj,
+				 const XMP_VarString & nsDecls,
+				 XMP_OptionBits        options,
+				 XMP_StringPtr         newline,
+				 XMP_StringPtr         indentStr,
+				 XMP_Index             baseIndent,
+				 XMP_VarString *       rdfHash )
+{
+	MD5_CTX context;
+	unsigned char digestBin [16];
+	MD5Init ( &context );
+	RDF_SizeCounter digester ( &context );
+	SerializeRDFElement ( xmpObj, digester, nsDecls, options, newline, indentStr, baseIndent );
+	MD5Final ( digestBin, &context );
+
+	char buffer [40];
+	for ( int in = 0, out = 0; in < 16; in += 1, out += 2 ) {
+		XMP_Uns8 byte = digestBin[in];
+		buffer[out]   = kHexDigits [ byte >> 4 ];
+		buffer[out+1] = kHexDigits [ byte & 0xF ];
+	}
+	buffer[32] = 0;
+	rdfHash->assign ( buffer );
+
+}	// ComputeRDFHash
+
+
+// -------------------------------------------------------------------------------------------------
+// MeasureAsRDF
+// ------------
+//
+// The sizing pass, runs the serialization without writing anything. Returns the length of the
+// UTF-8 output of SerializeAsRDF plus SerializePacketTrailer, i.e. the packet without padding.
+
+static size_t
+MeasureAsRDF ( const XMPMeta &       xmpObj,
+			   const XMP_VarString & nsDecls,
+			   XMP_OptionBits        options,
+			   XMP_StringPtr         newline,
+			   XMP_StringPtr         indentStr,
+			   XMP_Index             baseIndent,
+			   const XMP_VarString & rdfHash )
+{
+	RDF_SizeCounter counter;
+	SerializeAsRDF ( xmpObj, counter, nsDecls, options, newline, indentStr, baseIndent, rdfHash );
+	SerializePacketTrailer ( counter, options, indentStr, baseIndent );
+	return counter.size();
+
+}	// MeasureAsRDF
+
+
+// -------------------------------------------------------------------------------------------------
+// CheckSerializeOptions
+// ---------------------
+//
+// Checks the options for consistency, fixes up the default parameters, and figures the amount of
+// padding. With kXMP_ExactPacketLength the padding is still the overall packet length.
+
+static void
+CheckSerializeOptions ( const XMPMeta &  xmpObj,
+						XMP_OptionBits   options,
+						XMP_StringLen *  padding,
+						XMP_StringPtr *  newline,
+						XMP_StringPtr *  indentStr,
+						size_t *         unicodeUnitSize )
 {
-	XMP_Enforce( rdfString != 0 );
-	XMP_Assert ( (newline != 0) && (indentStr != 0) );
-	rdfString->erase();
-	
-	// Fix up some default parameters.
-	
 	enum { kDefaultPad = 2048 };
-	size_t unicodeUnitSize = 1;
+	*unicodeUnitSize = 1;
 	XMP_OptionBits charEncoding = options & kXMP_EncodingMask;
 
 	if ( charEncoding != kXMP_EncodeUTF8 ) {
 		if ( options & _XMP_UTF16_Bit ) {
 			if ( options & _XMP_UTF32_Bit ) XMP_Throw ( "Can't use both _XMP_UTF16_Bit and _XMP_UTF32_Bit", kXMPErr_BadOptions );
-			unicodeUnitSize = 2;
+			*unicodeUnitSize = 2;
 		} else if ( options & _XMP_UTF32_Bit ) {
-			unicodeUnitSize = 4;
+			*unicodeUnitSize = 4;
 		} else {
 			XMP_Throw ( "Can't use _XMP_LittleEndian_Bit by itself", kXMPErr_BadOptions );
 		}
 	}
 	
 	if ( options & kXMP_OmitAllFormatting ) {
-		newline = " ";	// ! Yes, a space for "newline". This ensures token separation.
-		indentStr = "";
+		*newline = " ";	// ! Yes, a space for "newline". This ensures token separation.
+		*indentStr = "";
 	} else {
-		if ( *newline == 0 ) newline = "\xA";	// Linefeed
-		if ( *indentStr == 0 ) {
-			indentStr = " ";
-			if ( ! (options & kXMP_UseCompactFormat) ) indentStr  = "   ";
+		if ( **newline == 0 ) *newline = "\xA";	// Linefeed
+		if ( **indentStr == 0 ) {
+			*indentStr = " ";
+			if ( ! (options & kXMP_UseCompactFormat) ) *indentStr  = "   ";
 		}
 	}
 	
@@ -1244,86 +1407,120 @@ XMPMeta::SerializeToBuffer ( XMP_VarString * rdfString,
 		if ( options & (kXMP_OmitPacketWrapper | kXMP_IncludeThumbnailPad) ) {
 			XMP_Throw ( "Inconsistent options for exact size serialize", kXMPErr_BadOptions );
 		}
-		if ( (padding & (unicodeUnitSize-1)) != 0 ) {
+		if ( (*padding & (*unicodeUnitSize-1)) != 0 ) {
 			XMP_Throw ( "Exact size must be a multiple of the Unicode element", kXMPErr_BadOptions );
 		}
 	} else if ( options & kXMP_ReadOnlyPacket ) {
 		if ( options & (kXMP_OmitPacketWrapper | kXMP_IncludeThumbnailPad) ) {
 			XMP_Throw ( "Inconsistent options for read-only packet", kXMPErr_BadOptions );
 		}
-		padding = 0;
+		*padding = 0;
 	} else if ( options & kXMP_OmitPacketWrapper ) {
 		if ( options & kXMP_IncludeThumbnailPad ) {
 			XMP_Throw ( "Inconsistent options for non-packet serialize", kXMPErr_BadOptions );
 		}
-		padding = 0;
+		*padding = 0;
 	} else if ( options & kXMP_OmitXMPMetaElement ) {
 		if ( options & kXMP_IncludeRDFHash ) {
 			XMP_Throw ( "Inconsistent options for x:xmpmeta serialize", kXMPErr_BadOptions );
 		}
-		padding = 0;
+		*padding = 0;
 	} else {
-		if ( padding == 0 ) {
-			padding = static_cast<XMP_StringLen>(kDefaultPad * unicodeUnitSize);
-		} else if ( (padding >> 28) != 0 ) {
+		if ( *padding == 0 ) {
+			*padding = static_cast<XMP_StringLen>(kDefaultPad * *unicodeUnitSize);
+		} else if ( (*padding >> 28) != 0 ) {
 			XMP_Throw ( "Outrageously large padding size", kXMPErr_BadOptions );	// Bigger than 256 MB.
 		}
 		if ( options & kXMP_IncludeThumbnailPad ) {
-			if ( ! this->DoesPropertyExist ( kXMP_NS_XMP, "Thumbnails" ) ) padding += (10000 * unicodeUnitSize);	// *** Need a better estimate.
+			if ( ! xmpObj.DoesPropertyExist ( kXMP_NS_XMP, "Thumbnails" ) ) *padding += static_cast<XMP_StringLen>(10000 * *unicodeUnitSize);	// *** Need a better estimate.
 		}
 	}
 
-	// Serialize as UTF-8, then convert to UTF-16 or UTF-32 if necessary, and assemble with the padding and tail.
+}	// CheckSerializeOptions
+
+
+// -------------------------------------------------------------------------------------------------
+// SerializeToBuffer
+// -----------------
+//
+// A UTF-8 packet is written straight into the output string, followed by the padding and trailer.
+// A sizing pass is only made for an exact packet length, so that a packet that doesn't fit throws
+// before anything is written and the string is allocated once. Otherwise it costs more than the
+// string growth it would save. Other encodings serialize the UTF-8 form and then convert it. The
+// binary form ignores the formatting options and parameters, it has no character encoding or
+// packet length.
+
+void
+XMPMeta::SerializeToBuffer ( XMP_VarString * rdfString,
+							 XMP_OptionBits	 options,
+							 XMP_StringLen	 padding,
+							 XMP_StringPtr	 newline,
+							 XMP_StringPtr	 indentStr,
+							 XMP_Index		 baseIndent ) const
+{
+	XMP_Enforce( rdfString != 0 );
+	XMP_Assert ( (newline != 0) && (indentStr != 0) );
+	rdfString->erase();
+
+	if ( options & kXMP_SerializeBinary ) {
+		if ( options & (kXMP_EncodingMask | kXMP_ExactPacketLength) ) {
+			XMP_Throw ( "Can't use an encoding or packet length with kXMP_SerializeBinary", kXMPErr_BadOptions );
+		}
+		this->SerializeToBinary ( rdfString );
+		return;
+	}
+	
+	// Fix up some default parameters.
 	
-	std::string tailStr;
+	size_t unicodeUnitSize;
+	XMP_OptionBits charEncoding = options & kXMP_EncodingMask;
 
-	SerializeAsRDF ( *this, *rdfString, tailStr, options, newline, indentStr, baseIndent );
+	CheckSerializeOptions ( *this, options, &padding, &newline, &indentStr, &unicodeUnitSize );
+
+	// Serialize the UTF-8 packet. Convert to UTF-16 or UTF-32 if necessary, and assemble with the
+	// padding and tail.
+	
+	XMP_VarString nsDecls, rdfHash;
+	DeclareAllNamespaces ( this->tree, &nsDecls, newline, indentStr, baseIndent );
+	if ( options & kXMP_IncludeRDFHash ) {
+		ComputeRDFHash ( *this, nsDecls, options, newline, indentStr, baseIndent, &rdfHash );
+	}
 
 	if ( charEncoding == kXMP_EncodeUTF8 ) {
 
 		if ( options & kXMP_ExactPacketLength ) {
-			size_t minSize = rdfString->size() + tailStr.size();
+			size_t minSize = MeasureAsRDF ( *this, nsDecls, options, newline, indentStr, baseIndent, rdfHash );
 			if ( minSize > padding ) XMP_Throw ( "Can't fit into specified packet size", kXMPErr_BadSerialize );
-			padding -= minSize;	// Now the actual amount of padding to add.
-		}
-		
-		size_t newlineLen = strlen ( newline );
-	
-		if ( padding < newlineLen ) {
-			rdfString->append ( padding, ' ' );
-		} else {
-			padding -= newlineLen;	// Write this newline last.
-			while ( padding >= (100 + newlineLen) ) {
-				rdfString->append ( 100, ' ' );
-				*rdfString += newline;
-				padding -= (100 + newlineLen);
-			}
-			rdfString->append ( padding, ' ' );
-			*rdfString += newline;
+			rdfString->reserve ( padding );	// The whole packet.
+			padding -= static_cast<XMP_StringLen>(minSize);	// Now the actual amount of padding to add.
 		}
 
-		*rdfString += tailStr;
+		SerializeAsRDF ( *this, *rdfString, nsDecls, options, newline, indentStr, baseIndent, rdfHash );
+		AppendPadding ( *rdfString, padding, newline );
+		SerializePacketTrailer ( *rdfString, options, indentStr, baseIndent );
 	
 	} else {
 	
-		// Need to convert the encoding. Swap the UTF-8 into a local string and convert back. Assemble everything.
+		// Need to convert the encoding. Serialize into local strings and convert back. Assemble everything.
 		
-		XMP_VarString utf8Str, newlineStr;
+		XMP_VarString utf8Str, tailStr, newlineStr;
 		bool bigEndian = ((charEncoding & _XMP_LittleEndian_Bit) == 0);
+
+		SerializeAsRDF ( *this, utf8Str, nsDecls, options, newline, indentStr, baseIndent, rdfHash );
+		SerializePacketTrailer ( tailStr, options, indentStr, baseIndent );
 		
 		if ( charEncoding & _XMP_UTF16_Bit ) {
 
 			std::string padStr ( "  " );  padStr[0] = 0;	// Assume big endian.
 			
-			utf8Str.swap ( *rdfString );
 			ToUTF16 ( (UTF8Unit*)utf8Str.c_str(), utf8Str.size(), rdfString, bigEndian );
 			utf8Str.swap ( tailStr );
 			ToUTF16 ( (UTF8Unit*)utf8Str.c_str(), utf8Str.size(), &tailStr, bigEndian );
 
 			if ( options & kXMP_ExactPacketLength ) {
-				size_t minSize = rdfString->size() + tailStr.size();
-				if ( minSize > padding ) XMP_Throw ( "Can't fit into specified packet size", kXMPErr_BadSerialize );
-				padding -= minSize;	// Now the actual amount of padding to add (in bytes).
+				size_t packetSize = rdfString->size() + tailStr.size();
+				if ( packetSize > padding ) XMP_Throw ( "Can't fit into specified packet size", kXMPErr_BadSerialize );
+				padding -= packetSize;	// Now the actual amount of padding to add (in bytes).
 			}
 
 			utf8Str.assign ( newline );
@@ -1353,15 +1550,14 @@ XMPMeta::SerializeToBuffer ( XMP_VarString * rdfString,
 				padStr[0] = ' '; padStr[1] = padStr[2] = padStr[3] = 0;
 			}
 			
-			utf8Str.swap ( *rdfString );
 			ToUTF32 ( (UTF8Unit*)utf8Str.c_str(), utf8Str.size(), rdfString, bigEndian );
 			utf8Str.swap ( tailStr );
 			ToUTF32 ( (UTF8Unit*)utf8Str.c_str(), utf8Str.size(), &tailStr, bigEndian );
 
 			if ( options & kXMP_ExactPacketLength ) {
-				size_t minSize = rdfString->size() + tailStr.size();
-				if ( minSize > padding ) XMP_Throw ( "Can't fit into specified packet size", kXMPErr_BadSerialize );
-				padding -= minSize;	// Now the actual amount of padding to add (in bytes).
+				size_t packetSize = rdfString->size() + tailStr.size();
+				if ( packetSize > padding ) XMP_Throw ( "Can't fit into specified packet size", kXMPErr_BadSerialize );
+				padding -= packetSize;	// Now the actual amount of padding to add (in bytes).
 			}
 
 			utf8Str.assign ( newline );
@@ -1389,4 +1585,57 @@ XMPMeta::SerializeToBuffer ( XMP_VarString * rdfString,
 
 }	// SerializeToBuffer
 
+
+// -------------------------------------------------------------------------------------------------
+// SerializeToSink
+// ---------------
+//
+// A UTF-8 packet goes straight to the callback, through a small buffer. The sizing pass is only
+// made for an exact packet length, so that a packet that doesn't fit throws before any output.
+// Other encodings and the binary form are made in memory by SerializeToBuffer and passed on in
+// one piece.
+
+void
+XMPMeta::SerializeToSink ( XMP_TextOutputProc outProc,
+						   void *             refCon,
+						   XMP_OptionBits     options,
+						   XMP_StringLen      padding,
+						   XMP_StringPtr      newline,
+						   XMP_StringPtr      indentStr,
+						   XMP_Index          baseIndent ) const
+{
+	XMP_Assert ( outProc != 0 );	// ! Enforced by wrapper.
+	XMP_Assert ( (newline != 0) && (indentStr != 0) );
+
+	if ( ((options & kXMP_EncodingMask) != kXMP_EncodeUTF8) || (options & kXMP_SerializeBinary) ) {
+		XMP_VarString packet;
+		this->SerializeToBuffer ( &packet, options, padding, newline, indentStr, baseIndent );
+		RDF_CallbackSink sink ( outProc, refCon );
+		sink.append ( packet.data(), packet.size() );
+		sink.Flush();
+		return;
+	}
+
+	size_t unicodeUnitSize;
+	CheckSerializeOptions ( *this, options, &padding, &newline, &indentStr, &unicodeUnitSize );
+
+	XMP_VarString nsDecls, rdfHash;
+	DeclareAllNamespaces ( this->tree, &nsDecls, newline, indentStr, baseIndent );
+	if ( options & kXMP_IncludeRDFHash ) {
+		ComputeRDFHash ( *this, nsDecls, options, newline, indentStr, baseIndent, &rdfHash );
+	}
+	if ( options & kXMP_ExactPacketLength ) {
+		size_t minSize = MeasureAsRDF ( *this, nsDecls, options, newline, indentStr, baseIndent, rdfHash );
+		if ( minSize > padding ) XMP_Throw ( "Can't fit into specified packet size", kXMPErr_BadSerialize );
+		padding -= static_cast<XMP_StringLen>(minSize);	// Now the actual amount of padding to add.
+	}
+
+	RDF_CallbackSink sink ( outProc, refCon );
+	SerializeAsRDF ( *this, sink, nsDecls, options, newline, indentStr, baseIndent, rdfHash );
+	AppendPadding ( sink, padding, newline );
+	SerializePacketTrailer ( sink, options, indentStr, baseIndent );
+	sink.Flush();
+
+}	// SerializeToSink
+
 // =================================================================================================
@@ -405,7 +405,7 @@ CompareNodeNames ( XMP_Node * left, XMP_Node * right )
 	if ( left->name  == "rdf:type" ) return true;
 	if ( right->name == "rdf:type" ) return false;
 
-	return ( left->name < right->name );
+	return ( left->name.str() < right->name.str() );
 
 }	// CompareNodeNames
 
@@ -471,19 +471,19 @@ SortWithinOffspring ( XMP_NodeOffspring & nodeVec )
 		XMP_Node * currPos = nodeVec[i];
 
 		if ( ! currPos->qualifiers.empty() ) {
-			sort ( currPos->qualifiers.begin(), currPos->qualifiers.end(), CompareNodeNames );
+			currPos->qualifiers.SortNodes ( CompareNodeNames );
 			SortWithinOffspring ( currPos->qualifiers );
 		}
 
 		if ( ! currPos->children.empty() ) {
 
 			if ( XMP_PropIsStruct ( currPos->options ) || XMP_NodeIsSchema ( currPos->options ) ) {
-				sort ( currPos->children.begin(), currPos->children.end(), CompareNodeNames );
+				currPos->children.SortNodes ( CompareNodeNames );
 			} else if ( XMP_PropIsArray ( currPos->options ) ) {
 				if ( XMP_ArrayIsUnordered ( currPos->options ) ) {
-					stable_sort ( currPos->children.begin(), currPos->children.end(), CompareNodeValues );
+					currPos->children.StableSortNodes ( CompareNodeValues );
 				} else if ( XMP_ArrayIsAltText ( currPos->options ) ) {
-					sort ( currPos->children.begin(), currPos->children.end(), CompareNodeLangs );
+					currPos->children.SortNodes ( CompareNodeLangs );
 				}
 			}
 
@@ -686,7 +686,7 @@ RegisterStandardAliases()
 // ============
 
 
-XMPMeta::XMPMeta() : clientRefs(0), tree(XMP_Node(0,"",0)), xmlParser(0)
+XMPMeta::XMPMeta() : clientRefs(0), tree(0,"",0), xmlParser(0)
 {
 	#if XMP_TraceCTorDTor
 		printf ( "Default construct XMPMeta @ %.8X\n", this );
@@ -713,6 +713,12 @@ XMPMeta::~XMPMeta() RELEASE_NO_THROW
 	if ( xmlParser != 0 ) delete ( xmlParser );
 	xmlParser = 0;
 
+	if ( this->tree.arena != 0 ) {
+		this->tree.ClearNode();	// ! The nodes must go before the arena reference.
+		this->tree.arena->Release();
+		this->tree.arena = 0;
+	}
+
 }	// ~XMPMeta
 
 
@@ -1214,7 +1220,7 @@ void
 XMPMeta::SetObjectName ( XMP_StringPtr name )
 {
 	VerifyUTF8 ( name );	// Throws if the string is not legit UTF-8.
-	tree.name = name;
+	tree.name = XMP_NodeName::Private ( name );
 
 }	// SetObjectName
 
@@ -1228,11 +1234,39 @@ XMPMeta::GetObjectOptions() const
 {
 	XMP_OptionBits	options	= 0;
 
+	if ( this->tree.arena != 0 ) options |= kXMP_UseNodeArena;
+
 	return options;
 
 }	// GetObjectOptions
 
 
+// -------------------------------------------------------------------------------------------------
+// SetObjectOptions
+// ----------------
+//
+// The options select how the object is stored, they can only be changed while it is empty.
+
+void
+XMPMeta::SetObjectOptions ( XMP_OptionBits options )
+{
+	if ( options & ~kXMP_AllObjectOptionsMask ) XMP_Throw ( "Unrecognized object options", kXMPErr_BadOptions );
+	if ( options == this->GetObjectOptions() ) return;
+
+	if ( (! this->tree.children.empty()) || (! this->tree.qualifiers.empty()) ) {
+		XMP_Throw ( "Object options can only be changed while the object is empty", kXMPErr_BadOptions );
+	}
+
+	if ( options & kXMP_UseNodeArena ) {
+		this->tree.arena = new XMP_NodeArena;
+	} else {
+		this->tree.arena->Release();
+		this->tree.arena = 0;
+	}
+
+}	// SetObjectOptions
+
+
 // -------------------------------------------------------------------------------------------------
 // Sort
 // ----
@@ -1245,15 +1279,16 @@ XMPMeta::GetObjectOptions() const
 void
 XMPMeta::Sort()
 {
+	this->MakeTreeWritable();
 
 	if ( ! this->tree.qualifiers.empty() ) {
-		sort ( this->tree.qualifiers.begin(), this->tree.qualifiers.end(), CompareNodeNames );
+		this->tree.qualifiers.SortNodes ( CompareNodeNames );
 		SortWithinOffspring ( this->tree.qualifiers );
 	}
 
 	if ( ! this->tree.children.empty() ) {
 		// The schema prefixes are the node's value, the name is the URI, so we sort schemas by value.
-		sort ( this->tree.children.begin(), this->tree.children.end(), CompareNodeValues );
+		this->tree.children.SortNodes ( CompareNodeValues );
 		SortWithinOffspring ( this->tree.children );
 	}
 
@@ -1274,7 +1309,7 @@ XMPMeta::Erase()
 		delete ( this->xmlParser );
 		this->xmlParser = 0;
 	}
-	this->tree.ClearNode();
+	this->tree.ClearNode();	// ! Also rewinds the node arena.
 
 }	// Erase
 
@@ -1282,6 +1317,11 @@ XMPMeta::Erase()
 // -------------------------------------------------------------------------------------------------
 // Clone
 // -----
+//
+// The clone shares the schema nodes of the original, only the root node and its qualifiers are
+// copied. A shared schema is copied by whichever object changes it first, see MakeSchemaWritable.
+// Many clones of one template that each change a few properties keep sharing the rest. Only the
+// share counts of the schemas change, so a clone can be made while other threads read the original.
 
 void
 XMPMeta::Clone ( XMPMeta * clone, XMP_OptionBits options ) const
@@ -1302,10 +1342,82 @@ XMPMeta::Clone ( XMPMeta * clone, XMP_OptionBits options ) const
 		clone->tree._valuePtr = clone->tree.value.c_str();
 	#endif
 
-	CloneOffspring ( &this->tree, &clone->tree );
+	for ( size_t qualNum = 0, qualLim = this->tree.qualifiers.size(); qualNum < qualLim; ++qualNum ) {
+		const XMP_Node * origQual = this->tree.qualifiers[qualNum];
+		XMP_AutoNode cloneQual ( &clone->tree, origQual->name.c_str(), origQual->options );
+		cloneQual.nodePtr->value = origQual->value;
+		CloneOffspring ( origQual, cloneQual.nodePtr );
+		clone->tree.qualifiers.push_back ( cloneQual.nodePtr );
+		cloneQual.nodePtr = 0;
+	}
+
+	clone->tree.children.reserve ( this->tree.children.size() );
+	for ( size_t schemaNum = 0, schemaLim = this->tree.children.size(); schemaNum < schemaLim; ++schemaNum ) {
+		XMP_Node * schemaNode = this->tree.children[schemaNum];
+		schemaNode->AddShare();
+		clone->tree.children.push_back ( schemaNode );
+	}
 
 }	// Clone
 
+// -------------------------------------------------------------------------------------------------
+// MakeSchemaWritable, MakePathWritable, MakeTreeWritable
+// ------------------------------------------------------
+//
+// A schema is writable if this tree is its only owner and its parent. One that the other trees
+// have all dropped only needs the parent fixed. One that is still shared is replaced by a copy,
+// which leaves the original to the other trees.
+
+static void
+UnshareSchema ( XMP_Node * xmpTree, size_t schemaNum )
+{
+	XMP_Node * schemaNode = xmpTree->children[schemaNum];
+	if ( (schemaNode->parent == xmpTree) && (schemaNode->shareRefs.load ( std::memory_order_acquire ) == 0) ) return;
+
+	if ( schemaNode->shareRefs.load ( std::memory_order_acquire ) == 0 ) {
+		schemaNode->parent = xmpTree;
+		return;
+	}
+
+	XMP_AutoNode schemaCopy ( xmpTree, schemaNode->name.c_str(), schemaNode->options );
+	schemaCopy.nodePtr->value = schemaNode->value;
+	CloneOffspring ( schemaNode, schemaCopy.nodePtr );
+
+	xmpTree->children.SetNode ( schemaNum, schemaCopy.nodePtr );
+	schemaCopy.nodePtr = 0;
+	XMP_Node::ReleaseNode ( schemaNode );
+
+}	// UnshareSchema
+
+void
+XMPMeta::MakeSchemaWritable ( XMP_StringPtr schemaURI )
+{
+	size_t schemaNum = this->tree.children.FindNamed ( schemaURI );
+	if ( schemaNum != this->tree.children.size() ) UnshareSchema ( &this->tree, schemaNum );
+}	// MakeSchemaWritable
+
+void
+XMPMeta::MakePathWritable ( const XMP_ExpandedXPath & expPath )
+{
+	if ( expPath.size() <= kRootPropStep ) return;	// ! FindNode throws for a bad path.
+
+	if ( ! (expPath[kRootPropStep].options & kXMP_StepIsAlias) ) {
+		this->MakeSchemaWritable ( expPath[kSchemaStep].step.c_str() );
+	} else {
+		XMP_AliasMapPos aliasPos = sRegisteredAliasMap->find ( expPath[kRootPropStep].step );
+		XMP_Assert ( aliasPos != sRegisteredAliasMap->end() );
+		this->MakeSchemaWritable ( aliasPos->second[kSchemaStep].step.c_str() );
+	}
+}	// MakePathWritable
+
+void
+XMPMeta::MakeTreeWritable()
+{
+	for ( size_t schemaNum = 0, schemaLim = this->tree.children.size(); schemaNum < schemaLim; ++schemaNum ) {
+		UnshareSchema ( &this->tree, schemaNum );
+	}
+}	// MakeTreeWritable
+
 // =================================================================================================
 // XMP_Node::GetLocalURI
 // =====================
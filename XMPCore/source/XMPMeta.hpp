@@ -194,6 +194,25 @@ public:
 	
 	// ---------------------------------------------------------------------------------------------
 	
+	virtual bool
+	GetProperty ( const XMP_CompiledPath & compiledPath,
+				  XMP_StringPtr *  propValue,
+				  XMP_StringLen *  valueSize,
+				  XMP_OptionBits * options ) const;
+	
+	virtual void
+	SetProperty ( const XMP_CompiledPath & compiledPath,
+				  XMP_StringPtr	 propValue,
+				  XMP_OptionBits options );
+	
+	virtual void
+	DeleteProperty ( const XMP_CompiledPath & compiledPath );
+	
+	virtual bool
+	DoesPropertyExist ( const XMP_CompiledPath & compiledPath ) const;
+	
+	// ---------------------------------------------------------------------------------------------
+	
 	virtual bool
 	GetLocalizedText ( XMP_StringPtr	schemaNS,
 					   XMP_StringPtr	altTextName,
@@ -295,6 +314,9 @@ public:
 	XMP_OptionBits
 	GetObjectOptions() const;
 
+	void
+	SetObjectOptions ( XMP_OptionBits options );
+
 	virtual void
 	Sort();
 
@@ -326,6 +348,15 @@ public:
 						XMP_StringPtr	newline,
 						XMP_StringPtr	indent,
 						XMP_Index		baseIndent ) const;
+
+	virtual void
+	SerializeToSink ( XMP_TextOutputProc outProc,
+					  void *			 refCon,
+					  XMP_OptionBits	 options,
+					  XMP_StringLen		 padding,
+					  XMP_StringPtr		 newline,
+					  XMP_StringPtr		 indent,
+					  XMP_Index			 baseIndent ) const;
 	
 	// ---------------------------------------------------------------------------------------------
 
@@ -399,6 +430,13 @@ public:
 	friend class XMPIterator;
 	friend class XMPUtils;
 
+	// The schemas of a clone are shared with the original until either changes them, see Clone.
+	// Code that changes the tree must first make the schemas it changes writable.
+
+	void MakeSchemaWritable ( XMP_StringPtr schemaURI );
+	void MakePathWritable ( const XMP_ExpandedXPath & expPath );
+	void MakeTreeWritable();
+
 private:
   
 	// ! These are hidden on purpose:
@@ -409,6 +447,11 @@ private:
 	void ProcessXMLTree ( XMP_OptionBits options );
 	bool ProcessXMLBuffer ( XMP_StringPtr buffer, XMP_StringLen xmpSize, bool lastClientCall );
 	void ProcessRDF ( const XML_Node & xmlTree, XMP_OptionBits options );
+	XML_ElementSink * NewRDFStream ( XMP_OptionBits options );
+
+	// The compact binary form, in XMPMeta-Binary.cpp.
+	void SerializeToBinary ( XMP_VarString * binString ) const;
+	void ParseFromBinary ( XMP_StringPtr buffer, XMP_StringLen bufferSize );
 
 };	// class XMPMeta
 
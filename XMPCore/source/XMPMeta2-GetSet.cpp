@@ -373,6 +373,7 @@ XMPMeta2::CountArrayItems ( XMP_StringPtr schemaNS,
 
 void XMPMeta2::ParseFromBuffer ( XMP_StringPtr buffer, XMP_StringLen bufferSize, XMP_OptionBits options )
 {
+	if ( options & kXMP_ParseBinary ) XMP_Throw ( "The binary form is not supported by the new core", kXMPErr_Unimplemented );
 	bool lastClientCall = (options & kXMP_ParseMoreBuffers) ? false : true;
 	if (!mBuffer) {
 		mBuffer = IUTF8String_I::CreateUTF8String("", 0);
@@ -400,6 +401,7 @@ void XMPMeta2::SerializeToBuffer ( XMP_VarString * rdfString,
 						XMP_StringPtr	indent,
 						XMP_Index		baseIndent ) const
 {
+	if ( options & kXMP_SerializeBinary ) XMP_Throw ( "The binary form is not supported by the new core", kXMPErr_Unimplemented );
 	auto registry = IDOMImplementationRegistry::GetDOMImplementationRegistry();
 	auto rdfSerializer = registry->GetSerializer( "rdf" );
 	auto str = rdfSerializer->GetIDOMSerializer_I()->SerializeInternal( mDOM, options, padding, newline, indent, baseIndent);
@@ -408,6 +410,20 @@ void XMPMeta2::SerializeToBuffer ( XMP_VarString * rdfString,
 		rdfString->append( str->c_str() );
 }
 
+void XMPMeta2::SerializeToSink ( XMP_TextOutputProc outProc,
+						void *			   refCon,
+						XMP_OptionBits	   options,
+						XMP_StringLen	   padding,
+						XMP_StringPtr	   newline,
+						XMP_StringPtr	   indent,
+						XMP_Index		   baseIndent ) const
+{
+	XMP_VarString packet;
+	this->SerializeToBuffer ( &packet, options, padding, newline, indent, baseIndent );
+	XMP_Status status = (*outProc) ( refCon, packet.c_str(), static_cast<XMP_StringLen>( packet.size() ) );
+	if ( status != 0 ) XMP_Throw ( "Serialization output callback failed", kXMPErr_ExternalFailure );
+}
+
 
 void
 XMPMeta2::Sort()
@@ -445,6 +461,41 @@ XMPMeta2::DoesPropertyExist ( XMP_StringPtr schemaNS,
 	
 }	// DoesPropertyExist
 
+// -------------------------------------------------------------------------------------------------
+// GetProperty, SetProperty, DeleteProperty, DoesPropertyExist for compiled paths
+// ------------------------------------------------------------------------------
+//
+// The compiled steps are for the XMP_Node tree, use the string forms of the path here.
+
+bool
+XMPMeta2::GetProperty ( const XMP_CompiledPath & compiledPath,
+						XMP_StringPtr *	 propValue,
+						XMP_StringLen *	 valueSize,
+						XMP_OptionBits * options ) const
+{
+	return this->GetProperty ( compiledPath.schemaNS.c_str(), compiledPath.propName.c_str(), propValue, valueSize, options );
+}
+
+void
+XMPMeta2::SetProperty ( const XMP_CompiledPath & compiledPath,
+						XMP_StringPtr  propValue,
+						XMP_OptionBits options )
+{
+	this->SetProperty ( compiledPath.schemaNS.c_str(), compiledPath.propName.c_str(), propValue, options );
+}
+
+void
+XMPMeta2::DeleteProperty ( const XMP_CompiledPath & compiledPath )
+{
+	this->DeleteProperty ( compiledPath.schemaNS.c_str(), compiledPath.propName.c_str() );
+}
+
+bool
+XMPMeta2::DoesPropertyExist ( const XMP_CompiledPath & compiledPath ) const
+{
+	return this->DoesPropertyExist ( compiledPath.schemaNS.c_str(), compiledPath.propName.c_str() );
+}
+
 // SetProperty
 // -----------
 
@@ -134,6 +134,14 @@ public:
 						XMP_StringPtr	indent,
 						XMP_Index		baseIndent ) const;
 	virtual void
+	SerializeToSink ( XMP_TextOutputProc outProc,
+					  void *			 refCon,
+					  XMP_OptionBits	 options,
+					  XMP_StringLen		 padding,
+					  XMP_StringPtr		 newline,
+					  XMP_StringPtr		 indent,
+					  XMP_Index			 baseIndent ) const;
+	virtual void
 	Clone ( XMPMeta * clone, XMP_OptionBits options ) const;
 	virtual bool
 	DoesPropertyExist ( XMP_StringPtr schemaNS,
@@ -148,6 +156,19 @@ public:
 	virtual void
 	DeleteProperty ( XMP_StringPtr schemaNS,
 					 XMP_StringPtr propName );
+	virtual bool
+	GetProperty ( const XMP_CompiledPath & compiledPath,
+				  XMP_StringPtr *  propValue,
+				  XMP_StringLen *  valueSize,
+				  XMP_OptionBits * options ) const;
+	virtual void
+	SetProperty ( const XMP_CompiledPath & compiledPath,
+				  XMP_StringPtr	 propValue,
+				  XMP_OptionBits options );
+	virtual void
+	DeleteProperty ( const XMP_CompiledPath & compiledPath );
+	virtual bool
+	DoesPropertyExist ( const XMP_CompiledPath & compiledPath ) const;
 	virtual void
 	DumpObject ( XMP_TextOutputProc outProc,
 				 void *				refCon ) const;
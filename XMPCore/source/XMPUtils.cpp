@@ -1754,7 +1754,7 @@ static bool MoveOneProperty(XMPMeta2 & stdXMP, XMPMeta2 * extXMP,
 	#define Trace_PackageForJPEG 0
 #endif
 
-typedef std::pair < XMP_VarString*, XMP_VarString* > StringPtrPair;
+typedef std::pair < const XMP_VarString*, const XMP_VarString* > StringPtrPair;
 typedef std::pair < const char *, const char * > StringPtrPair2;
 typedef std::multimap < size_t, StringPtrPair > PropSizeMap;
 typedef std::multimap < size_t, StringPtrPair2 > PropSizeMap2;
@@ -1776,7 +1776,7 @@ static void CreateEstimatedSizeMap ( XMPMeta & stdXMP, PropSizeMap * propSizes )
 				 (stdProp->name == "xmpNote:HasExtendedXMP") ) continue;	// ! Don't move xmpNote:HasExtendedXMP.
 
 			size_t propSize = EstimateSizeForJPEG ( stdProp );
-			StringPtrPair namePair ( &stdSchema->name, &stdProp->name );
+			StringPtrPair namePair ( &stdSchema->name.str(), &stdProp->name.str() );
 			PropSizeMap::value_type mapValue ( propSize, namePair );
 
 			(void) propSizes->insert ( propSizes->upper_bound ( propSize ), mapValue );
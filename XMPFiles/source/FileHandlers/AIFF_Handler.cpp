@@ -44,13 +44,10 @@ XMPFileHandler * AIFF_MetaHandlerCTor ( XMPFiles * parent )
 bool AIFF_CheckFormat ( XMP_FileFormat  /*format*/,
 			           XMP_StringPtr    /*filePath*/,
 			           XMP_IO*      file,
-			           XMPFiles*        /*parent*/ )
+			           XMPFiles*        parent )
 {
-	// Reset file pointer position
-	file ->Rewind();
-
 	XMP_Uns8 chunkID[12];
-	XMP_Int32 got = file->Read ( chunkID, 12 );
+	XMP_Int32 got = parent->ReadFileHeader ( file, chunkID, 12 );
 
 	// Reset file pointer position
 	file ->Rewind();
@@ -53,6 +53,12 @@ static const XMP_OptionBits kAIFF_HandlerFlags = (kXMPFiles_CanInjectXMP |
 												  kXMPFiles_CanNotifyProgress
 												 );
 
+static const XMPFileSignature kAIFF_Signatures [] = {
+	{ "FORM????AIFF", "xxxx????xxxx", 12, true },
+	{ "FORM????AIFC", "xxxx????xxxx", 12, true },
+	{ 0, 0, 0, false }
+};
+
 /**
  * Main class for the the AIFF file handler.
  */
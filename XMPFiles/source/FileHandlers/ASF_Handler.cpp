@@ -46,14 +46,13 @@ bool ASF_CheckFormat ( XMP_FileFormat format,
                        XMPFiles *     parent )
 {
 
-	IgnoreParam(format); IgnoreParam(filePath); IgnoreParam(fileRef); IgnoreParam(parent);
+	IgnoreParam(format); IgnoreParam(filePath); IgnoreParam(fileRef);
 	XMP_Assert ( format == kXMP_WMAVFile );
 
 	if ( fileRef->Length() < guidLen ) return false;
 	GUID guid;
 
-	fileRef->Rewind();
-	fileRef->Read ( &guid, guidLen );
+	if ( parent->ReadFileHeader ( fileRef, &guid, guidLen ) != guidLen ) return false;
 	if ( ! IsEqualGUID ( ASF_Header_Object, guid ) ) return false;
 
 	return true;
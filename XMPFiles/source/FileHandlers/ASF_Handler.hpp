@@ -39,6 +39,11 @@ static const XMP_OptionBits kASF_HandlerFlags = ( kXMPFiles_CanInjectXMP |
 												  kXMPFiles_NeedsReadOnlyPacket |
 												  kXMPFiles_CanNotifyProgress );
 
+static const XMPFileSignature kASF_Signatures [] = {
+	{ "\x30\x26\xB2\x75\x8E\x66\xCF\x11\xA6\xD9\x00\xAA\x00\x62\xCE\x6C", 0, 16, true },
+	{ 0, 0, 0, false }
+};
+
 class ASF_MetaHandler : public XMPFileHandler
 {
 public:
@@ -114,12 +114,11 @@ static inline void PutUns24BE ( XMP_Uns32 value, void * addr )
 bool FLV_CheckFormat ( XMP_FileFormat /*format*/,
 					   XMP_StringPtr  /*filePath*/,
 					   XMP_IO*    fileRef,
-					   XMPFiles *     /*parent*/ )
+					   XMPFiles *     parent )
 {
 	XMP_Uns8 buffer [9];
 
-	fileRef->Rewind();
-	XMP_Uns32 ioCount = fileRef->Read ( buffer, 9 );
+	XMP_Uns32 ioCount = parent->ReadFileHeader ( fileRef, buffer, 9 );
 	if ( ioCount != 9 ) return false;
 
 	XMP_Uns32 fileSignature = GetUns32BE ( &buffer[0] );
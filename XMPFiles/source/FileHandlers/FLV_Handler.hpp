@@ -44,6 +44,11 @@ static const XMP_OptionBits kFLV_HandlerFlags = ( kXMPFiles_CanInjectXMP |
 												  kXMPFiles_CanNotifyProgress
 												);
 
+static const XMPFileSignature kFLV_Signatures [] = {
+	{ "FLV\x01", 0, 4, false },
+	{ 0, 0, 0, false }
+};
+
 class FLV_MetaHandler : public XMPFileHandler
 {
 public:
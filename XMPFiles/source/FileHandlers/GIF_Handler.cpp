@@ -54,14 +54,13 @@ bool GIF_CheckFormat ( XMP_FileFormat format,
                        XMP_IO*        fileRef,
                        XMPFiles *     parent )
 {
-	IgnoreParam(format); IgnoreParam(filePath); IgnoreParam(parent);
+	IgnoreParam(format); IgnoreParam(filePath);
 	XMP_Assert ( format == kXMP_GIFFile );
 
 	if ( fileRef->Length() < GIF_89_Header_LEN ) return false;
 	XMP_Uns8 buffer[ GIF_89_Header_LEN ];
 
-	fileRef->Rewind();
-	fileRef->Read( buffer, GIF_89_Header_LEN );
+	parent->ReadFileHeader ( fileRef, buffer, GIF_89_Header_LEN );
 	if ( !CheckBytes( buffer, GIF_89_Header_DATA, GIF_89_Header_LEN ) ) return false;
 
 	return true;
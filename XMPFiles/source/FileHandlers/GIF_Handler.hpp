@@ -50,6 +50,11 @@ static const XMP_OptionBits kGIF_HandlerFlags = ( kXMPFiles_CanInjectXMP |
 												  kXMPFiles_NeedsReadOnlyPacket
 													);
 
+static const XMPFileSignature kGIF_Signatures [] = {
+	{ "GIF89a", 0, 6, true },
+	{ 0, 0, 0, false }
+};
+
 class GIF_MetaHandler : public XMPFileHandler
 {
 public:
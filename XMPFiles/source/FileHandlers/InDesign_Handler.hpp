@@ -37,6 +37,11 @@ extern bool InDesign_CheckFormat ( XMP_FileFormat format,
 
 static const XMP_OptionBits kInDesign_HandlerFlags = kBasic_HandlerFlags & (~kXMPFiles_CanInjectXMP);	// ! InDesign can't inject.
 
+static const XMPFileSignature kInDesign_Signatures [] = {
+	{ "\x06\x06\xED\xF5\xD8\x1D\x46\xE5\xBD\x31\xEF\xE7\xFE\x74\xB7\x1D", 0, 16, false },
+	{ 0, 0, 0, false }
+};
+
 class InDesign_MetaHandler : public Basic_MetaHandler
 {
 public:
@@ -48,6 +48,10 @@ static const size_t kPSIRMaxDataLength   = 0xFFFF - 2 - kPSIRSignatureLength;
 
 static const char * kMainXMPSignatureString = "http://ns.adobe.com/xap/1.0/\0";
 static const size_t kMainXMPSignatureLength = 29;
+static const size_t kMainXMPMaxLength       = 65000;	// The limit used by PackageForJPEG.
+static const size_t kDefaultPadding         = 2048;
+static const char * kPacketTrailer          = "<?xpacket end=\"w\"?>";
+static const size_t kPacketTrailerLength    = 19;
 
 static const char * kExtXMPSignatureString = "http://ns.adobe.com/xmp/extension/\0";
 static const size_t kExtXMPSignatureLength = 35;
@@ -150,7 +154,7 @@ JPEG_MetaHandler::~JPEG_MetaHandler()
 // CacheExtendedXMP
 // ================
 
-static void CacheExtendedXMP ( ExtendedXMPInfo * extXMP, XMP_Uns8 * buffer, size_t bufferLen )
+static void CacheExtendedXMP ( ExtendedXMPInfo * extXMP, const XMP_Uns8 * buffer, size_t bufferLen )
 {
 
 	// Have a portion of the extended XMP, cache the contents. This is complicated by the need to
@@ -170,7 +174,7 @@ static void CacheExtendedXMP ( ExtendedXMPInfo * extXMP, XMP_Uns8 * buffer, size
 	if ( bufferLen < kExtXMPPrefixLength ) return;	// Ignore bad input.
 	XMP_Assert ( CheckBytes ( &buffer[0], kExtXMPSignatureString, kExtXMPSignatureLength ) );
 
-	XMP_Uns8 * bufferPtr = buffer + kExtXMPSignatureLength;	// Start at the GUID.
+	const XMP_Uns8 * bufferPtr = buffer + kExtXMPSignatureLength;	// Start at the GUID.
 	
 	JPEG_MetaHandler::GUID_32 guid;
 	XMP_Assert ( sizeof(guid.data) == 32 );
@@ -336,9 +340,7 @@ void JPEG_MetaHandler::CacheFileData()
 				 CheckBytes ( &buffer[0], kPSIRSignatureString, kPSIRSignatureLength ) ) {
 
 				size_t psirLen = contentLen - kPSIRSignatureLength;
-				fileRef->Seek ( (contentOrigin + kPSIRSignatureLength), kXMP_SeekFromStart );
-				fileRef->ReadAll ( buffer, (XMP_Int32)psirLen );
-				this->psirContents.append( (char *) buffer, psirLen );
+				XIO::ReadRange ( fileRef, (contentOrigin + kPSIRSignatureLength), (XMP_Uns32)psirLen, &this->psirContents, true );
 				continue;	// Move on to the next marker.
 
 			}
@@ -357,9 +359,7 @@ void JPEG_MetaHandler::CacheFileData()
 				  CheckBytes ( &buffer[0], kExifSignatureAltStr, kExifSignatureLength )) ) {
 
 				size_t exifLen = contentLen - kExifSignatureLength;
-				fileRef->Seek ( (contentOrigin + kExifSignatureLength), kXMP_SeekFromStart );
-				fileRef->ReadAll ( buffer, (XMP_Int32)exifLen );
-				this->exifContents.append ( (char*)buffer, exifLen );
+				XIO::ReadRange ( fileRef, (contentOrigin + kExifSignatureLength), (XMP_Uns32)exifLen, &this->exifContents, true );
 				continue;	// Move on to the next marker.
 
 			}
@@ -369,9 +369,7 @@ void JPEG_MetaHandler::CacheFileData()
 
 				this->containsXMP = true;	// Found the standard XMP packet.
 				size_t xmpLen = contentLen - kMainXMPSignatureLength;
-				fileRef->Seek ( (contentOrigin + kMainXMPSignatureLength), kXMP_SeekFromStart );
-				fileRef->ReadAll ( buffer, (XMP_Int32)xmpLen );
-				this->xmpPacket.assign ( (char*)buffer, xmpLen );
+				XIO::ReadRange ( fileRef, (contentOrigin + kMainXMPSignatureLength), (XMP_Uns32)xmpLen, &this->xmpPacket );
 				this->packetInfo.offset = contentOrigin + kMainXMPSignatureLength;
 				this->packetInfo.length = (XMP_Int32)xmpLen;
 				this->packetInfo.padSize   = 0;	// Assume the rest for now, set later in ProcessXMP.
@@ -384,9 +382,15 @@ void JPEG_MetaHandler::CacheFileData()
 			if ( (signatureLen >= kExtXMPSignatureLength) &&
 				 CheckBytes ( &buffer[0], kExtXMPSignatureString, kExtXMPSignatureLength ) ) {
 
-				fileRef->Seek ( contentOrigin, kXMP_SeekFromStart );
-				fileRef->ReadAll ( buffer, contentLen );
-				CacheExtendedXMP ( &extXMP, buffer, contentLen );
+				const XMP_Uns8 * segment = XIO::BorrowRange ( fileRef, contentOrigin, contentLen );
+				if ( segment != 0 ) {
+					fileRef->Seek ( (contentOrigin + contentLen), kXMP_SeekFromStart );
+				} else {
+					fileRef->Seek ( contentOrigin, kXMP_SeekFromStart );
+					fileRef->ReadAll ( buffer, contentLen );
+					segment = buffer;
+				}
+				CacheExtendedXMP ( &extXMP, segment, contentLen );
 				continue;	// Move on to the next marker.
 
 			}
@@ -658,6 +662,59 @@ void JPEG_MetaHandler::ProcessXMP()
 
 }	// JPEG_MetaHandler::ProcessXMP
 
+// =================================================================================================
+// SetMainPadding
+// ==============
+//
+// PackageForJPEG pads the main packet with up to 2K of spaces before the trailer. Change that to
+// the padding chosen with XMPFiles::Initialize, as far as the main packet limit allows.
+
+static void SetMainPadding ( std::string * mainXMP, size_t padding )
+{
+	if ( mainXMP->size() < kPacketTrailerLength ) return;
+	size_t trailerStart = mainXMP->size() - kPacketTrailerLength;
+	if ( mainXMP->compare ( trailerStart, kPacketTrailerLength, kPacketTrailer ) != 0 ) return;
+
+	size_t padStart = trailerStart;
+	while ( (padStart > 0) && ((*mainXMP)[padStart-1] == ' ') ) --padStart;
+
+	const size_t usedLength = padStart + kPacketTrailerLength;
+	if ( usedLength >= kMainXMPMaxLength ) return;
+	if ( padding > (kMainXMPMaxLength - usedLength) ) padding = kMainXMPMaxLength - usedLength;
+
+	mainXMP->replace ( padStart, (trailerStart - padStart), padding, ' ' );
+
+}	// SetMainPadding
+
+// =================================================================================================
+// ResizePadding
+// =============
+//
+// Changes the padding before the trailer of a packet serialized with the default "\n" newline, to
+// what SerializeToBuffer writes for that amount: lines of 100 spaces, each ending with a newline.
+
+static void ResizePadding ( std::string * packet, size_t oldPadding, size_t newPadding )
+{
+	const size_t padEnd = packet->size() - kPacketTrailerLength;
+	XMP_Assert ( packet->compare ( padEnd, kPacketTrailerLength, kPacketTrailer ) == 0 );
+
+	std::string padding;
+	padding.reserve ( newPadding );
+	if ( newPadding > 0 ) {
+		size_t spaces = newPadding - 1;	// Write the last newline last.
+		while ( spaces >= 101 ) {
+			padding.append ( 100, ' ' );
+			padding += '\n';
+			spaces -= 101;
+		}
+		padding.append ( spaces, ' ' );
+		padding += '\n';
+	}
+
+	packet->replace ( (padEnd - oldPadding), oldPadding, padding );
+
+}	// ResizePadding
+
 // =================================================================================================
 // JPEG_MetaHandler::UpdateFile
 // ============================
@@ -680,28 +737,47 @@ void JPEG_MetaHandler::UpdateFile ( bool doSafeUpdate )
 
 	ExportPhotoData ( kXMP_JPEGFile, &this->xmpObj, this->exifMgr, this->iptcMgr, this->psirMgr );
 
-	try {
-		XMP_OptionBits options = kXMP_UseCompactFormat;
-		if ( fileHadXMP ) options |= kXMP_ExactPacketLength;
-		this->xmpObj.SerializeToBuffer ( &this->xmpPacket, options, oldPacketLength );
-	} catch ( ... ) {
-		this->xmpObj.SerializeToBuffer ( &this->xmpPacket, kXMP_UseCompactFormat );
-	}
-
 	// Decide whether to do an in-place update. This can only happen if all of the following are true:
 	//	- There is a standard packet in the file.
 	//	- There is no extended XMP in the file.
 	//	- The are no changes to the legacy Exif or PSIR portions. (The IPTC is in the PSIR.)
-	//	- The new XMP can fit in the old space, without extensions.
+	//	- The new XMP can fit in the old space, without extensions, or in filler segments after it.
 
-	bool doInPlace = (fileHadXMP && (this->xmpPacket.size() <= (size_t)oldPacketLength));
+	bool doInPlace = fileHadXMP;
 
 	if ( ! this->extendedXMP.empty() ) doInPlace = false;
 
 	if ( (this->exifMgr != 0) && (this->exifMgr->IsLegacyChanged()) ) doInPlace = false;
 	if ( (this->psirMgr != 0) && (this->psirMgr->IsLegacyChanged()) ) doInPlace = false;
 
+	// Only an in-place update tries the old packet length. Otherwise, or if the packet outgrew it,
+	// serialize with kDefaultPadding. GrowIntoFiller sizes that packet's padding to the filler, so
+	// the XMP is serialized at most twice.
+
+	bool fitsInPlace = false;
 	if ( doInPlace ) {
+		try {
+			this->xmpObj.SerializeToBuffer ( &this->xmpPacket, (kXMP_UseCompactFormat | kXMP_ExactPacketLength), oldPacketLength );
+			fitsInPlace = true;
+		} catch ( ... ) {
+			// Too big for the old space.
+		}
+	}
+	if ( ! fitsInPlace ) this->xmpObj.SerializeToBuffer ( &this->xmpPacket, kXMP_UseCompactFormat, kDefaultPadding );
+
+	bool grownInPlace = false;
+	if ( doInPlace && (! fitsInPlace) ) {
+		doInPlace = false;
+		grownInPlace = this->GrowIntoFiller ( oldPacketOffset, oldPacketLength );
+	}
+
+	if ( grownInPlace ) {
+
+		#if GatherPerformanceData
+			sAPIPerf->back().extraInfo += ", JPEG grown in-place update";
+		#endif
+
+	} else if ( doInPlace ) {
 
 		#if GatherPerformanceData
 			sAPIPerf->back().extraInfo += ", JPEG in-place update";
@@ -749,6 +825,107 @@ void JPEG_MetaHandler::UpdateFile ( bool doSafeUpdate )
 
 }	// JPEG_MetaHandler::UpdateFile
 
+// =================================================================================================
+// JPEG_MetaHandler::GrowIntoFiller
+// ================================
+//
+// Grows the XMP APP1 marker segment into the filler segments right after it, so that a larger
+// packet is still written in place. A filler segment is a COM or APPn segment whose content is
+// all zero or all space bytes, as left by tools that reserve room for metadata. The new packet
+// gets the usual padding as far as the filler allows. What is left of the filler is rewritten as
+// segments like the first filler segment. Returns false without touching the file if the filler
+// is too small. This does not reconcile or serialize, UpdateFile has already serialized the final
+// XMP with kDefaultPadding, only the padding of that packet is changed.
+
+bool JPEG_MetaHandler::GrowIntoFiller ( XMP_Int64 packetOffset, XMP_Int32 packetLength )
+{
+	XMP_IO* liveFile = this->parent->ioRef;
+	const XMP_Int64 fileLength = liveFile->Length();
+	const XMP_Int64 app1Offset = packetOffset - kMainXMPSignatureLength - 4;
+	if ( app1Offset < 2 ) return false;
+
+	XMP_Assert ( this->xmpPacket.size() > (kDefaultPadding + kPacketTrailerLength) );
+	const size_t minLength = this->xmpPacket.size() - kDefaultPadding;
+	if ( minLength > kMainXMPMaxLength ) return false;
+
+	size_t wantedLength = minLength + ((jpegPacketPadding != 0) ? jpegPacketPadding : kDefaultPadding);
+	if ( wantedLength > kMainXMPMaxLength ) wantedLength = kMainXMPMaxLength;
+
+	// Add up the filler segments after the APP1, until there is room for the wanted length.
+
+	XMP_Uns8 buffer [64*1024];	// Enough for a segment with maximum contents.
+	XMP_Int64 fillerEnd = packetOffset + packetLength;
+	XMP_Uns16 fillerMarker = 0;
+	XMP_Uns8  fillerByte = 0;
+
+	while ( (fillerEnd - packetOffset) < (XMP_Int64)wantedLength ) {
+
+		if ( (fillerEnd + 4) > fileLength ) break;
+		liveFile->Seek ( fillerEnd, kXMP_SeekFromStart );
+		XMP_Uns16 marker = XIO::ReadUns16_BE ( liveFile );
+		XMP_Uns16 contentLen = XIO::ReadUns16_BE ( liveFile );
+
+		if ( (marker != 0xFFFE) && ((marker < 0xFFE0) || (marker > 0xFFEF)) ) break;	// Only COM and APPn.
+		if ( contentLen < 2 ) break;
+		contentLen -= 2;
+		if ( (fillerEnd + 4 + contentLen) > fileLength ) break;
+
+		liveFile->ReadAll ( buffer, contentLen );
+		XMP_Uns8 firstByte = (contentLen == 0) ? 0 : buffer[0];
+		if ( (firstByte != 0x00) && (firstByte != 0x20) ) break;
+		size_t i = 1;
+		while ( (i < contentLen) && (buffer[i] == firstByte) ) ++i;
+		if ( i < contentLen ) break;
+
+		if ( fillerMarker == 0 ) {
+			fillerMarker = marker;
+			fillerByte = firstByte;
+		}
+		fillerEnd += 4 + contentLen;
+
+	}
+
+	// Pick the new packet length. The rest of the filler must be empty or hold a segment header.
+
+	const XMP_Int64 available = fillerEnd - packetOffset;
+	XMP_Int64 newLength = available;
+	if ( newLength > (XMP_Int64)wantedLength ) newLength = wantedLength;
+	XMP_Int64 remainder = available - newLength;
+	if ( (0 < remainder) && (remainder < 4) ) {
+		newLength -= 4 - remainder;
+		remainder = 4;
+	}
+	if ( newLength < (XMP_Int64)minLength ) return false;
+
+	ResizePadding ( &this->xmpPacket, kDefaultPadding, (size_t)(newLength - minLength) );
+	XMP_Assert ( this->xmpPacket.size() == (size_t)newLength );
+
+	// Write the new APP1 length, the packet, and the rest of the filler.
+
+	liveFile->Seek ( (app1Offset + 2), kXMP_SeekFromStart );
+	XIO::WriteUns16_BE ( liveFile, (XMP_Uns16)(2 + kMainXMPSignatureLength + newLength) );
+	liveFile->Seek ( packetOffset, kXMP_SeekFromStart );
+	liveFile->Write ( this->xmpPacket.c_str(), (XMP_Uns32)newLength );
+
+	memset ( buffer, fillerByte, sizeof(buffer) );
+	while ( remainder > 0 ) {
+		XMP_Int64 segmentLength = remainder;
+		if ( segmentLength > (4 + 0xFFFD) ) {
+			segmentLength = 4 + 0xFFFD;
+			const XMP_Int64 leftOver = remainder - segmentLength;
+			if ( (0 < leftOver) && (leftOver < 4) ) segmentLength -= 4;	// Leave room for the last header.
+		}
+		XIO::WriteUns16_BE ( liveFile, fillerMarker );
+		XIO::WriteUns16_BE ( liveFile, (XMP_Uns16)(segmentLength - 2) );
+		liveFile->Write ( buffer, (XMP_Uns32)(segmentLength - 4) );
+		remainder -= segmentLength;
+	}
+
+	this->packetInfo.length = (XMP_Int32)newLength;
+	return true;
+
+}	// JPEG_MetaHandler::GrowIntoFiller
+
 // =================================================================================================
 // JPEG_MetaHandler::WriteTempFile
 // ===============================
@@ -848,6 +1025,7 @@ void JPEG_MetaHandler::WriteTempFile ( XMP_IO* tempRef )
 	std::string mainXMP, extXMP, extDigest;
 	SXMPUtils::PackageForJPEG ( this->xmpObj, &mainXMP, &extXMP, &extDigest );
 	XMP_Assert ( (extXMP.size() == 0) || (extDigest.size() == 32) );
+	if ( jpegPacketPadding != 0 ) SetMainPadding ( &mainXMP, jpegPacketPadding );
 
 	first4 = MakeUns32BE ( 0xFFE10000 + 2 + kMainXMPSignatureLength + (XMP_Uns32)mainXMP.size() );
 	tempRef->Write ( &first4, 4 );
@@ -979,9 +1157,10 @@ void JPEG_MetaHandler::WriteTempFile ( XMP_IO* tempRef )
 
 	}
 
-	// Copy the remainder of the source file.
+	// Copy the remainder of the source file, mostly the entropy-coded image data. XIO::Copy lets the
+	// host file system do it for local files, perhaps by sharing the data blocks.
 
-	XIO::Copy ( origRef, tempRef, (origLength - origRef->Offset()) );
+	XIO::Copy ( origRef, tempRef, (origLength - origRef->Offset()), abortProc, abortArg );
 	this->needsUpdate = false;
 
 }	// JPEG_MetaHandler::WriteTempFile
@@ -45,6 +45,11 @@ static const XMP_OptionBits kJPEG_HandlerFlags = (kXMPFiles_CanInjectXMP |
                                                   kXMPFiles_ReturnsRawPacket |
                                                   kXMPFiles_AllowsSafeUpdate);
 
+static const XMPFileSignature kJPEG_Signatures [] = {
+	{ "\xFF\xD8", 0, 2, false },
+	{ 0, 0, 0, false }
+};
+
 class JPEG_MetaHandler : public XMPFileHandler
 {
 public:
@@ -87,6 +92,8 @@ private:
 
 	bool skipReconcile;	// ! Used between UpdateFile and WriteFile.
 
+	bool GrowIntoFiller ( XMP_Int64 packetOffset, XMP_Int32 packetLength );
+
 	typedef std::map < GUID_32, std::string > ExtendedXMPMap;
 
 	ExtendedXMPMap extendedXMP;	// ! Only contains those with complete data.
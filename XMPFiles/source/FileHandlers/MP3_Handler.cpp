@@ -86,29 +86,28 @@ bool MP3_CheckFormat ( XMP_FileFormat format,
 					  XMP_IO*    file,
 					  XMPFiles *     parent )
 {
-	IgnoreParam(format); IgnoreParam(filePath); IgnoreParam(parent);	//suppress warnings
+	IgnoreParam(format); IgnoreParam(filePath);	//suppress warnings
 	XMP_Assert ( format == kXMP_MP3File );		//standard assert
 
 	if ( file->Length() < 10 ) return false;
-	file ->Rewind();
 
-	XMP_Uns8 header[3];
-	file->ReadAll ( header, 3 );
+	XMP_Uns8 header[10];
+	if ( parent->ReadFileHeader ( file, header, 10 ) != 10 ) return false;
 	if ( ! CheckBytes( &header[0], "ID3", 3 ) ) return (parent->format == kXMP_MP3File);
 
-	XMP_Uns8 major = XIO::ReadUns8( file );
-	XMP_Uns8 minor = XIO::ReadUns8( file );
+	XMP_Uns8 major = header[3];
+	XMP_Uns8 minor = header[4];
 
 	if ( (major < 2) || (major > 4) || (minor == 0xFF) ) return false;
 
-	XMP_Uns8 flags = XIO::ReadUns8 ( file );
+	XMP_Uns8 flags = header[5];
 
 	//TODO
 	if ( flags & 0x10 ) XMP_Throw ( "no support for MP3 with footer", kXMPErr_Unimplemented );
 	if ( flags & 0x80 ) return false; //no support for unsynchronized MP3 (as before, also see [1219125])
 	if ( flags & 0x0F ) XMP_Throw ( "illegal header lower bits", kXMPErr_Unimplemented );
 
-	XMP_Uns32 size = XIO::ReadUns32_BE ( file );
+	XMP_Uns32 size = GetUns32BE ( &header[6] );
 	if ( (size & 0x80808080) != 0 ) return false; //if any bit survives -> not a valid synchsafe 32 bit integer
 
 	return true;
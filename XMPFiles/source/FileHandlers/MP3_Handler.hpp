@@ -29,6 +29,12 @@ static const XMP_OptionBits kMP3_HandlerFlags = (kXMPFiles_CanInjectXMP |
 												 kXMPFiles_AllowsOnlyXMP |
 												 kXMPFiles_ReturnsRawPacket |
 												 kXMPFiles_CanReconcile);
+
+static const XMPFileSignature kMP3_Signatures [] = {
+	{ "ID3", 0, 3, false },
+	{ 0, 0, 0, false }
+};
+
 class MP3_MetaHandler : public XMPFileHandler
 {
 public:
@@ -1941,14 +1941,85 @@ static void CheckFinalBox ( XMP_IO* fileRef, XMP_AbortProc abortProc, void * abo
 }	// CheckFinalBox
 
 
+// =================================================================================================
+// FindSkippedTables
+// =================
+//
+// Walk the path from 'moov' down to the 'stbl' boxes and note the content of the large sample tables
+// in skipped, relative to the 'moov' box. The 'stsd' box is never skipped, it has the timecode
+// format. The sample tables have nothing to import or export, they make up most of the 'moov' box
+// of long recordings.
+
+static const XMP_Uns32 kSkippedTableSize = 64*1024;
+
+static void FindSkippedTables ( XMP_IO* fileRef, XMP_Uns64 moovPos, XMP_Uns64 childPos, XMP_Uns64 childEnd,
+								XMP_Uns32 parentType, ISOBaseMedia_Manager::SpaceList * skipped )
+{
+	ISOMedia::BoxInfo childInfo;
+
+	for ( XMP_Uns64 nextPos; childPos < childEnd; childPos = nextPos ) {
+
+		nextPos = ISOMedia::GetBoxInfo ( fileRef, childPos, childEnd, &childInfo );
+		if ( childInfo.headerSize < 8 ) break;	// Trailing padding.
+
+		XMP_Uns64 contentPos = childPos + childInfo.headerSize;
+		XMP_Uns32 childType = childInfo.boxType;
+
+		if ( parentType == ISOMedia::k_stbl ) {
+			if ( (childType != ISOMedia::k_stsd) && (childInfo.contentSize >= kSkippedTableSize) ) {
+				skipped->push_back ( ISOBaseMedia_Manager::SpaceInfo ( (contentPos - moovPos), childInfo.contentSize ) );
+			}
+		} else if ( ((parentType == ISOMedia::k_moov) && (childType == ISOMedia::k_trak)) ||
+					((parentType == ISOMedia::k_trak) && (childType == ISOMedia::k_mdia)) ||
+					((parentType == ISOMedia::k_mdia) && (childType == ISOMedia::k_minf)) ||
+					((parentType == ISOMedia::k_minf) && (childType == ISOMedia::k_stbl)) ) {
+			FindSkippedTables ( fileRef, moovPos, contentPos, nextPos, childType, skipped );
+		}
+
+	}
+
+}	// FindSkippedTables
+
+// =================================================================================================
+// ReadMoovSubtree
+// ===============
+//
+// Read the 'moov' box except for the skipped sample tables, which are left as zeroes. The rest is
+// read in as few pieces as possible.
+
+static void ReadMoovSubtree ( XMP_IO* fileRef, XMP_Uns64 moovPos, const ISOMedia::BoxInfo & moovInfo,
+							  RawDataBlock * moovData, ISOBaseMedia_Manager::SpaceList * skipped )
+{
+	XMP_Uns32 moovSize = (XMP_Uns32) (moovInfo.headerSize + moovInfo.contentSize);
+
+	skipped->clear();
+	FindSkippedTables ( fileRef, moovPos, (moovPos + moovInfo.headerSize), (moovPos + moovSize),
+						ISOMedia::k_moov, skipped );
+
+	moovData->assign ( moovSize, 0 );
+
+	XMP_Uns32 readPos = 0;
+	for ( size_t i = 0, limit = skipped->size(); i <= limit; ++i ) {
+		XMP_Uns32 readEnd = moovSize;
+		if ( i < limit ) readEnd = (XMP_Uns32) (*skipped)[i].offset;
+		if ( readEnd > readPos ) {
+			fileRef->Seek ( (moovPos + readPos), kXMP_SeekFromStart );
+			fileRef->Read ( &(*moovData)[readPos], (readEnd - readPos) );
+		}
+		if ( i < limit ) readPos = readEnd + (XMP_Uns32) (*skipped)[i].size;
+	}
+
+}	// ReadMoovSubtree
+
 // =================================================================================================
 // MPEG4_MetaHandler::CacheFileData
 // ================================
 //
 // There are 3 file variants: normal ISO Base Media, modern QuickTime, and classic QuickTime. The
 // XMP is placed differently between the ISO and two QuickTime forms, and there is different but not
-// colliding native metadata. The entire 'moov' subtree is cached, along with the top level 'uuid'
-// box of XMP if present.
+// colliding native metadata. The 'moov' subtree is cached without the content of large sample
+// tables, along with the top level 'uuid' box of XMP if present. The skipped content is loaded by
+// LoadSkippedMoovData when the 'moov' box has to be rewritten as a whole.
 
 void MPEG4_MetaHandler::CacheFileData()
 {
@@ -2003,9 +2074,7 @@ void MPEG4_MetaHandler::CacheFileData()
 				XMP_Throw ( "Oversize 'moov' box", kXMPErr_EnforceFailure );
 			}
 
-			this->moovMgr.fullSubtree.assign ( (XMP_Uns32)fullMoovSize, 0 );
-			fileRef->Seek ( boxPos, kXMP_SeekFromStart );
-			fileRef->Read ( &this->moovMgr.fullSubtree[0], (XMP_Uns32)fullMoovSize );
+			ReadMoovSubtree ( fileRef, boxPos, currBox, &this->moovMgr.fullSubtree, &this->skippedMoovData );
 
 			this->moovBoxPos = boxPos;
 			this->moovBoxSize = (XMP_Uns32)fullMoovSize;
@@ -2292,6 +2361,7 @@ bool MPEG4_MetaHandler::ParseTimecodeTrack()
 
 		tempRef = this->moovMgr.GetTypeChild ( stblRef, ISOMedia::k_stsc, &tempInfo );
 		if ( tempRef == 0 ) return false;
+		this->LoadSkippedMoovBox ( tempRef );
 		if ( tempInfo.contentSize < (8 + sizeof ( MOOV_Manager::Content_stsc_entry )) ) return false;
 		if ( GetUns32BE ( tempInfo.content + 4 ) == 0 ) return false;	// Make sure the entry count is non-zero.
 
@@ -2301,6 +2371,7 @@ bool MPEG4_MetaHandler::ParseTimecodeTrack()
 
 		if ( tempRef != 0 ) {
 
+			this->LoadSkippedMoovBox ( tempRef );
 			if ( tempInfo.contentSize < (8 + 4) ) return false;
 			XMP_Uns32 stcoCount = GetUns32BE ( tempInfo.content + 4 );
 			if ( stcoCount < firstChunkNumber ) return false;
@@ -2311,6 +2382,7 @@ bool MPEG4_MetaHandler::ParseTimecodeTrack()
 
 			tempRef = this->moovMgr.GetTypeChild ( stblRef, ISOMedia::k_co64, &tempInfo );
 			if ( (tempRef == 0) || (tempInfo.contentSize < (8 + 8)) ) return false;
+			this->LoadSkippedMoovBox ( tempRef );
 			XMP_Uns32 co64Count = GetUns32BE ( tempInfo.content + 4 );
 			if ( co64Count < firstChunkNumber ) return false;
 			XMP_Uns64 * co64Ptr = (XMP_Uns64*) (tempInfo.content + 8);
@@ -2375,6 +2447,76 @@ bool MPEG4_MetaHandler::ParseTimecodeTrack()
 
 }	// MPEG4_MetaHandler::ParseTimecodeTrack
 
+// =================================================================================================
+// MPEG4_MetaHandler::LoadSkippedMoovData
+// ======================================
+//
+// Read the skipped sample table content that overlaps the given part of the 'moov' box, from the
+// 'moov' box in the file. Local read-only files are closed after CacheFileData, reopen those.
+
+void MPEG4_MetaHandler::LoadSkippedMoovData ( XMP_Uns32 offset /* = 0 */, XMP_Uns32 limit /* = 0xFFFFFFFF */ )
+{
+	if ( this->skippedMoovData.empty() ) return;
+
+	XMPFiles_IO* localFile = 0;
+
+	if ( this->parent->ioRef == 0 ) {
+		XMP_Assert ( this->parent->UsesLocalIO() );
+		localFile = XMPFiles_IO::New_XMPFiles_IO ( this->parent->GetFilePath().c_str(), Host_IO::openReadOnly, &this->parent->errorCallback );
+		XMP_Enforce ( localFile != 0 );
+		this->parent->ioRef = localFile;
+	}
+
+	try {
+
+		XMP_IO* fileRef = this->parent->ioRef;
+		ISOBaseMedia_Manager::SpaceList::iterator skipPos = this->skippedMoovData.begin();
+
+		while ( skipPos != this->skippedMoovData.end() ) {
+			XMP_Uns32 skipOffset = (XMP_Uns32) skipPos->offset;
+			XMP_Uns32 skipSize   = (XMP_Uns32) skipPos->size;
+			if ( (skipOffset >= limit) || ((skipOffset + skipSize) <= offset) ) {
+				++skipPos;
+				continue;
+			}
+			fileRef->Seek ( (this->moovBoxPos + skipOffset), kXMP_SeekFromStart );
+			fileRef->Read ( &this->moovMgr.fullSubtree[skipOffset], skipSize );
+			skipPos = this->skippedMoovData.erase ( skipPos );
+		}
+
+	} catch ( ... ) {
+		if ( localFile != 0 ) {
+			delete localFile;
+			this->parent->ioRef = 0;
+		}
+		throw;
+	}
+
+	if ( localFile != 0 ) {
+		localFile->Close();
+		delete localFile;
+		this->parent->ioRef = 0;
+	}
+
+}	// MPEG4_MetaHandler::LoadSkippedMoovData
+
+// =================================================================================================
+// MPEG4_MetaHandler::LoadSkippedMoovBox
+// =====================================
+
+void MPEG4_MetaHandler::LoadSkippedMoovBox ( MOOV_Manager::BoxRef boxRef )
+{
+	if ( this->skippedMoovData.empty() ) return;
+
+	XMP_Uns32 boxOffset = this->moovMgr.GetParsedOffset ( boxRef );
+	if ( boxOffset == 0 ) return;	// Changed since parsing, the content is in memory.
+
+	MOOV_Manager::BoxInfo boxInfo;
+	this->moovMgr.GetBoxInfo ( boxRef, &boxInfo );
+	this->LoadSkippedMoovData ( boxOffset, (boxOffset + this->moovMgr.GetHeaderSize ( boxRef ) + boxInfo.contentSize) );
+
+}	// MPEG4_MetaHandler::LoadSkippedMoovBox
+
 // =================================================================================================
 // MPEG4_MetaHandler::UpdateTopLevelBox
 // ====================================
@@ -2521,6 +2663,72 @@ void MPEG4_MetaHandler::UpdateTopLevelBox ( XMP_Uns64 oldOffset, XMP_Uns32 oldSi
 
 }	// MPEG4_MetaHandler::UpdateTopLevelBox
 
+// =================================================================================================
+// MPEG4_MetaHandler::UpdateMoovInPlace
+// ====================================
+//
+// Write the updated 'moov' box over the old one if it fits there, using a following 'free' or 'skip'
+// box as growth room. Only the part after keptSize was recomposed, in front of that just the loaded
+// content is written. That includes the header and content changed in place, but not the skipped
+// sample tables. Returns false if the box does not fit, it then has to be moved as a whole.
+
+bool MPEG4_MetaHandler::UpdateMoovInPlace ( XMP_Uns32 keptSize )
+{
+	XMP_IO* fileRef = this->parent->ioRef;
+	XMP_Uns64 fileSize = fileRef->Length();
+
+	const RawDataBlock & newMoov = this->moovMgr.fullSubtree;
+	XMP_Uns32 newSize = (XMP_Uns32) newMoov.size();
+
+	XMP_Uns64 oldEnd = this->moovBoxPos + this->moovBoxSize;
+	XMP_Uns64 totalRoom = this->moovBoxSize;
+	bool atEnd = (oldEnd == fileSize);
+	bool nextIsFree = false;
+
+	if ( (! atEnd) && (newSize != this->moovBoxSize) ) {
+
+		ISOMedia::BoxInfo nextBoxInfo;
+		(void) ISOMedia::GetBoxInfo ( fileRef, oldEnd, fileSize, &nextBoxInfo, true /* throw errors */ );
+		nextIsFree = (nextBoxInfo.boxType == ISOMedia::k_free) || (nextBoxInfo.boxType == ISOMedia::k_skip);
+		if ( nextIsFree ) totalRoom += nextBoxInfo.headerSize + nextBoxInfo.contentSize;
+
+		bool haveEnoughRoom = (newSize == totalRoom) ||
+							  ( (newSize < totalRoom) && ((totalRoom - newSize) >= 8) );
+		if ( ! haveEnoughRoom ) return false;
+
+	}
+
+	XMP_Uns32 writePos = 0;
+	for ( size_t i = 0, limit = this->skippedMoovData.size(); i <= limit; ++i ) {
+		XMP_Uns32 writeEnd = keptSize;
+		if ( i < limit ) writeEnd = (XMP_Uns32) this->skippedMoovData[i].offset;
+		XMP_Assert ( writeEnd <= keptSize );
+		if ( writeEnd > writePos ) {
+			fileRef->Seek ( (this->moovBoxPos + writePos), kXMP_SeekFromStart );
+			fileRef->Write ( &newMoov[writePos], (writeEnd - writePos) );
+		}
+		if ( i < limit ) writePos = writeEnd + (XMP_Uns32) this->skippedMoovData[i].size;
+	}
+
+	fileRef->Seek ( (this->moovBoxPos + keptSize), kXMP_SeekFromStart );
+	if ( newSize > keptSize ) fileRef->Write ( &newMoov[keptSize], (newSize - keptSize) );
+
+	if ( atEnd ) {
+		fileRef->Truncate ( (this->moovBoxPos + newSize) );	// Does nothing if new size is bigger.
+	} else if ( newSize < totalRoom ) {
+		if ( nextIsFree ) {
+			// Don't wipe, at most 7 old bytes left, it will be covered by the free header.
+			this->moovMgr.WriteBoxHeader ( fileRef, ISOMedia::k_free, (totalRoom - newSize) );
+		} else {
+			this->moovMgr.WipeBoxFree ( fileRef, (this->moovBoxPos + newSize), (XMP_Uns32)(totalRoom - newSize) );
+		}
+	}
+
+	this->moovBoxSize = newSize;
+	return true;
+
+}	// MPEG4_MetaHandler::UpdateMoovInPlace
+
 // =================================================================================================
 // AdjustOffset
 // ============
@@ -2620,6 +2828,7 @@ void MPEG4_MetaHandler::OptimizeFileLayout()
 	}
 
 	if ( ! needsOptimization ) return;
+	this->LoadSkippedMoovData();	// The 'stco' and 'co64' tables get adjusted.
 
 	// The file needs to be optimized. Make sure that a file over 4 GB has 'co64', not 'stco' boxes.
 	// These are needed to hold 64-bit offsets. We don't go to the effort of changing from 'stco'
@@ -2957,12 +3166,17 @@ void MPEG4_MetaHandler::UpdateFile ( bool doSafeUpdate )
 	// Update the 'moov' subtree if necessary, and finally update the timecode sample.
 
 	if ( this->moovMgr.IsChanged() ) {
+		XMP_Uns32 keptSize = this->moovMgr.GetUnchangedPrefix();
+		this->LoadSkippedMoovData ( keptSize );	// The rest is recomposed from memory.
 		this->moovMgr.UpdateMemoryTree();
 		if ( progressTracker != 0 ) {
 			progressTracker->AddTotalWork ( (float)this->moovMgr.fullSubtree.size() );
 		}
-		this->UpdateTopLevelBox ( moovBoxPos, moovBoxSize, &this->moovMgr.fullSubtree[0],
-								  (XMP_Uns32)this->moovMgr.fullSubtree.size() );
+		if ( ! this->UpdateMoovInPlace ( keptSize ) ) {
+			this->LoadSkippedMoovData();
+			this->UpdateTopLevelBox ( moovBoxPos, moovBoxSize, &this->moovMgr.fullSubtree[0],
+									  (XMP_Uns32)this->moovMgr.fullSubtree.size() );
+		}
 	}
 
 	if ( this->tmcdInfo.sampleOffset != 0 ) {
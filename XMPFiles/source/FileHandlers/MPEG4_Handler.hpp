@@ -79,6 +79,10 @@ private:
 
 	bool ParseTimecodeTrack();
 	void UpdateTopLevelBox ( XMP_Uns64 oldOffset, XMP_Uns32 oldSize, const XMP_Uns8 * newBox, XMP_Uns32 newSize );
+	bool UpdateMoovInPlace ( XMP_Uns32 keptSize );
+
+	void LoadSkippedMoovData ( XMP_Uns32 offset = 0, XMP_Uns32 limit = 0xFFFFFFFF );
+	void LoadSkippedMoovBox ( MOOV_Manager::BoxRef boxRef );
 
 	void OptimizeFileLayout();
 
@@ -87,6 +91,8 @@ private:
 	XMP_Uns64 xmpBoxPos;	// The file offset of the XMP box (the size field, not the content).
 	XMP_Uns64 moovBoxPos;	// The file offset of the 'moov' box (the size field, not the content).
 	XMP_Uns32 xmpBoxSize, moovBoxSize;	// The full size of the boxes, not just the content.
+
+	ISOBaseMedia_Manager::SpaceList skippedMoovData;	// Sample table content not read, relative to the 'moov' box.
 	
 	MOOV_Manager moovMgr;
 
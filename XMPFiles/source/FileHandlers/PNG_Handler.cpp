@@ -44,14 +44,13 @@ bool PNG_CheckFormat ( XMP_FileFormat format,
                        XMP_IO*    fileRef,
                        XMPFiles *     parent )
 {
-	IgnoreParam(format); IgnoreParam(filePath); IgnoreParam(parent);
+	IgnoreParam(format); IgnoreParam(filePath);
 	XMP_Assert ( format == kXMP_PNGFile );
 
 	if ( fileRef->Length() < PNG_SIGNATURE_LEN ) return false;
 	XMP_Uns8 buffer [PNG_SIGNATURE_LEN];
 
-	fileRef->Rewind();
-	fileRef->Read ( buffer, PNG_SIGNATURE_LEN );
+	parent->ReadFileHeader ( fileRef, buffer, PNG_SIGNATURE_LEN );
 	if ( ! CheckBytes ( buffer, PNG_SIGNATURE_DATA, PNG_SIGNATURE_LEN ) ) return false;
 
 	return true;
@@ -40,6 +40,11 @@ static const XMP_OptionBits kPNG_HandlerFlags = ( kXMPFiles_CanInjectXMP |
 												  kXMPFiles_ReturnsRawPacket |
 												  kXMPFiles_NeedsReadOnlyPacket );
 
+static const XMPFileSignature kPNG_Signatures [] = {
+	{ PNG_SIGNATURE_DATA, 0, PNG_SIGNATURE_LEN, true },
+	{ 0, 0, 0, false }
+};
+
 class PNG_MetaHandler : public XMPFileHandler
 {
 public:
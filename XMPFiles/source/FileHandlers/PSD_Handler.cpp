@@ -51,16 +51,15 @@ bool PSD_CheckFormat ( XMP_FileFormat format,
                        XMP_IO*    	  fileRef,
                        XMPFiles *     parent )
 {
-	IgnoreParam(format); IgnoreParam(filePath); IgnoreParam(parent);
+	IgnoreParam(format); IgnoreParam(filePath);
 	XMP_Assert ( format == kXMP_PhotoshopFile );
 
-	fileRef->Rewind ( );
 	if ( fileRef->Length() < 34 ) return false;	// 34 = header plus 2 lengths
 
-	XMP_Uns8 buffer [4];
-	fileRef->ReadAll ( buffer, 4 );
+	XMP_Uns8 buffer [6];
+	if ( parent->ReadFileHeader ( fileRef, buffer, 6 ) != 6 ) return false;
 	if ( ! CheckBytes ( buffer, "8BPS", 4 ) ) return false;
-	XMP_Uns16 version = XIO::ReadUns16_BE ( fileRef );
+	XMP_Uns16 version = GetUns16BE ( &buffer[4] );
 	if ( (version != 1) && (version != 2) ) return false;
 
 	return true;
@@ -41,6 +41,12 @@ static const XMP_OptionBits kPSD_HandlerFlags = (kXMPFiles_CanInjectXMP |
                                                  kXMPFiles_AllowsSafeUpdate |
 												 kXMPFiles_CanNotifyProgress);
 
+static const XMPFileSignature kPSD_Signatures [] = {
+	{ "8BPS\x00\x01", 0, 6, false },
+	{ "8BPS\x00\x02", 0, 6, false },
+	{ 0, 0, 0, false }
+};
+
 class PSD_MetaHandler : public XMPFileHandler
 {
 public:
@@ -19,6 +19,7 @@
 #include "XMPFiles/source/FileHandlers/PostScript_Handler.hpp"
 
 #include "XMPFiles/source/FormatSupport/XMPScanner.hpp"
+#include "XMPFiles/source/FormatSupport/PacketScanning_Support.hpp"
 #include "XMPFiles/source/FileHandlers/Scanner_Handler.hpp"
 
 #include <algorithm>
@@ -218,78 +219,52 @@ int PostScript_MetaHandler::FindPostScriptHint()
 // PostScript_MetaHandler::FindFirstPacket
 // =======================================
 //
-// Run the packet scanner until we find a valid packet. The first one is the main. For simplicity,
-// the state of all snips is checked after each buffer is read. In theory only the last of the
-// previous snips might change from partial to valid, but then we would have to special case the
-// first pass when there is no previous set of snips. Since we have to get a full report to look at
-// the last snip anyway, it costs virtually nothing extra to recheck all of the snips.
+// Run the packet scanner over the whole file. The first valid packet is the main one, the last one
+// is also remembered.
 
 bool PostScript_MetaHandler::FindFirstPacket()
 {
 	int		snipCount;
 	/*bool 	found	= false;*/
-	size_t	bufPos, bufLen;
 
 	XMP_IO* fileRef = this->parent->ioRef;
-	XMP_Int64   fileLen = fileRef->Length();
 	XMP_PacketInfo & packetInfo_ = this->packetInfo;
 
-	XMPScanner scanner ( fileLen );
 	XMPScanner::SnipInfoVector snips;
 
-	enum { kBufferSize = 64*1024 };
-	XMP_Uns8	buffer [kBufferSize];
-
 	XMP_AbortProc abortProc  = this->parent->abortProc;
 	void *        abortArg   = this->parent->abortArg;
-	const bool    checkAbort = (abortProc != 0);
-
-	bufPos = 0;
-	bufLen = 0;
 
-	fileRef->Rewind();	// Seek back to the beginning of the file.
 	bool firstfound=false;
 
-	while ( true ) 
-	{
-
-		if ( checkAbort && abortProc(abortArg) ) 
-		{
-			XMP_Throw ( "PostScript_MetaHandler::FindFirstPacket - User abort", kXMPErr_UserAbort );
-		}
+	// The whole file is scanned, large local files in parallel.
 
-		bufPos += bufLen;
-		bufLen = fileRef->Read ( buffer, kBufferSize );
-		if ( bufLen == 0 ) return firstfound;	// Must be at EoF, no packets found.
+	PacketScanning_Support::ScanFile ( fileRef, this->parent->GetFilePath().c_str(), &snips, abortProc, abortArg );
+	snipCount = (int)snips.size();
 
-		scanner.Scan ( buffer, bufPos, bufLen );
-		snipCount = (int)scanner.GetSnipCount();
-		scanner.Report ( snips );
-		for ( int i = 0; i < snipCount; ++i ) 
+	for ( int i = 0; i < snipCount; ++i ) 
+	{
+		if ( snips[i].fState == XMPScanner::eValidPacketSnip ) 
 		{
-			if ( snips[i].fState == XMPScanner::eValidPacketSnip ) 
+			if (!firstfound)
 			{
-				if (!firstfound)
-				{
-					if ( snips[i].fLength > 0x7FFFFFFF ) XMP_Throw ( "PostScript_MetaHandler::FindFirstPacket: Oversize packet", kXMPErr_BadXMP );
-					packetInfo_.offset = snips[i].fOffset;
-					packetInfo_.length = (XMP_Int32)snips[i].fLength;
-					packetInfo_.charForm  = snips[i].fCharForm;
-					packetInfo_.writeable = (snips[i].fAccess == 'w');
-					firstPacketInfo=packetInfo_;
-					lastPacketInfo=packetInfo_;
-					firstfound=true;
-				}
-				else
-				{					
-					lastPacketInfo.offset = snips[i].fOffset;
-					lastPacketInfo.length = (XMP_Int32)snips[i].fLength;
-					lastPacketInfo.charForm  = snips[i].fCharForm;
-					lastPacketInfo.writeable = (snips[i].fAccess == 'w');
-				}
+				if ( snips[i].fLength > 0x7FFFFFFF ) XMP_Throw ( "PostScript_MetaHandler::FindFirstPacket: Oversize packet", kXMPErr_BadXMP );
+				packetInfo_.offset = snips[i].fOffset;
+				packetInfo_.length = (XMP_Int32)snips[i].fLength;
+				packetInfo_.charForm  = snips[i].fCharForm;
+				packetInfo_.writeable = (snips[i].fAccess == 'w');
+				firstPacketInfo=packetInfo_;
+				lastPacketInfo=packetInfo_;
+				firstfound=true;
+			}
+			else
+			{					
+				lastPacketInfo.offset = snips[i].fOffset;
+				lastPacketInfo.length = (XMP_Int32)snips[i].fLength;
+				lastPacketInfo.charForm  = snips[i].fCharForm;
+				lastPacketInfo.writeable = (snips[i].fAccess == 'w');
 			}
 		}
-
 	}
 	
 	return firstfound;
@@ -307,44 +282,22 @@ bool PostScript_MetaHandler::FindFirstPacket()
 
 bool PostScript_MetaHandler::FindLastPacket()
 {
-	size_t	bufPos, bufLen;
-
 	XMP_IO* fileRef = this->parent->ioRef;
-	XMP_Int64   fileLen = fileRef->Length();
 	XMP_PacketInfo & packetInfo_ = this->packetInfo;
 
-	// ------------------------------------------------------
-	// Scan the entire file to find all of the valid packets.
-
-	XMPScanner	scanner ( fileLen );
-
-	enum { kBufferSize = 64*1024 };
-	XMP_Uns8	buffer [kBufferSize];
+	// ------------------------------------------------------------------------------------
+	// Scan the entire file to find all of the valid packets, large local files in parallel.
 
 	XMP_AbortProc abortProc  = this->parent->abortProc;
 	void *        abortArg   = this->parent->abortArg;
-	const bool    checkAbort = (abortProc != 0);
 
-	fileRef->Rewind();	// Seek back to the beginning of the file.
-
-	for ( bufPos = 0; bufPos < (size_t)fileLen; bufPos += bufLen )
-	{
-		if ( checkAbort && abortProc(abortArg) ) 
-		{
-			XMP_Throw ( "PostScript_MetaHandler::FindLastPacket - User abort", kXMPErr_UserAbort );
-		}
-		bufLen = fileRef->Read ( buffer, kBufferSize );
-		if ( bufLen == 0 ) XMP_Throw ( "PostScript_MetaHandler::FindLastPacket: Read failure", kXMPErr_ExternalFailure );
-		scanner.Scan ( buffer, bufPos, bufLen );
-	}
+	XMPScanner::SnipInfoVector snips;
+	PacketScanning_Support::ScanFile ( fileRef, this->parent->GetFilePath().c_str(), &snips, abortProc, abortArg );
 
 	// -------------------------------
 	// Pick the last the valid packet.
 
-	int snipCount = (int)scanner.GetSnipCount();
-
-	XMPScanner::SnipInfoVector snips ( snipCount );
-	scanner.Report ( snips );
+	int snipCount = (int)snips.size();
 
 	bool lastfound=false;
 	for ( int i = 0; i < snipCount; ++i ) 
@@ -42,14 +42,13 @@ bool RIFF_CheckFormat ( XMP_FileFormat  format,
 			           XMP_IO*      	file,
 			           XMPFiles*        parent )
 {
-	IgnoreParam(filePath); IgnoreParam(parent);
+	IgnoreParam(filePath);
 	XMP_Assert ( (format == kXMP_AVIFile) || (format == kXMP_WAVFile) );
 
 	if ( file->Length() < 12 ) return false;
-	file ->Rewind();
 
 	XMP_Uns8 chunkID[12];
-	file->ReadAll ( chunkID, 12 );
+	if ( parent->ReadFileHeader ( file, chunkID, 12 ) != 12 ) return false;
 	if ( ! CheckBytes( &chunkID[0], "RIFF", 4 )) return false;
 
 	if ( CheckBytes(&chunkID[8],"AVI ",4) && format == kXMP_AVIFile ) return true;
@@ -35,6 +35,11 @@ static const XMP_OptionBits kRIFF_HandlerFlags = (kXMPFiles_CanInjectXMP |
 												  kXMPFiles_CanReconcile
 												 );
 
+static const XMPFileSignature kAVI_Signatures [] = {
+	{ "RIFF????AVI ", "xxxx????xxxx", 12, true },
+	{ 0, 0, 0, false }
+};
+
 class RIFF_MetaHandler : public XMPFileHandler
 {
 public:
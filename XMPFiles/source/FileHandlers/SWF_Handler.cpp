@@ -48,16 +48,15 @@ bool SWF_CheckFormat ( XMP_FileFormat format,
                        XMP_IO *       fileRef,
                        XMPFiles *     parent )
 {
-	IgnoreParam(format); IgnoreParam(filePath); IgnoreParam(parent);
+	IgnoreParam(format); IgnoreParam(filePath);
 	XMP_Assert ( format == kXMP_SWFFile );
 	
 	// Make sure the file is long enough for an empty SWF stream. Check the signature.
 
 	if ( fileRef->Length() < (XMP_Int64)SWF_IO::HeaderPrefixSize ) return false;
 
-	fileRef->Rewind();
 	XMP_Uns8 buffer [4];
-	fileRef->ReadAll ( buffer, 4 );
+	if ( parent->ReadFileHeader ( fileRef, buffer, 4 ) != 4 ) return false;
 	XMP_Uns32 signature = GetUns32LE ( &buffer[0] ) & 0xFFFFFF;	// Discard the version byte.
 	
 	return ( (signature == SWF_IO::CompressedSignature) || (signature == SWF_IO::ExpandedSignature) );
@@ -39,6 +39,12 @@ static const XMP_OptionBits kSWF_HandlerFlags = ( kXMPFiles_CanInjectXMP |
 												  kXMPFiles_AllowsOnlyXMP |
 												  kXMPFiles_ReturnsRawPacket );
 
+static const XMPFileSignature kSWF_Signatures [] = {
+	{ "FWS", 0, 3, false },
+	{ "CWS", 0, 3, false },
+	{ 0, 0, 0, false }
+};
+
 class SWF_MetaHandler : public XMPFileHandler {
 
 public:
@@ -17,6 +17,7 @@
 #include "source/XIO.hpp"
 
 #include "XMPFiles/source/FormatSupport/XMPScanner.hpp"
+#include "XMPFiles/source/FormatSupport/PacketScanning_Support.hpp"
 #include "XMPFiles/source/FileHandlers/Scanner_Handler.hpp"
 
 #include <vector>
@@ -244,33 +245,20 @@ void Scanner_MetaHandler::CacheFileData()
 
 	try {
 
-		// ------------------------------------------------------
-		// Scan the entire file to find all of the valid packets.
-
-		XMP_Int64  fileLen = fileRef->Length();
-		XMPScanner scanner ( fileLen );
+		// ------------------------------------------------------------------------
+		// Scan the entire file to find all of the valid packets, large local files
+		// are scanned in parallel.
 
 		enum { kBufferSize = 64*1024 };
 		XMP_Uns8	buffer [kBufferSize];
 
-		fileRef->Rewind();
-
-		for ( bufPos = 0; bufPos < fileLen; bufPos += bufLen ) {
-			if ( checkAbort && abortProc(abortArg) ) {
-				XMP_Throw ( "Scanner_MetaHandler::LocateXMP - User abort", kXMPErr_UserAbort );
-			}
-			bufLen = fileRef->Read ( buffer, kBufferSize );
-			if ( bufLen == 0 ) XMP_Throw ( "Scanner_MetaHandler::LocateXMP: Read failure", kXMPErr_ExternalFailure );
-			scanner.Scan ( buffer, bufPos, bufLen );
-		}
+		XMPScanner::SnipInfoVector snips;
+		PacketScanning_Support::ScanFile ( fileRef, this->parent->GetFilePath().c_str(), &snips, abortProc, abortArg );
 
 		// --------------------------------------------------------------
 		// Parse the valid packet snips, building a vector of candidates.
 
-		long snipCount = scanner.GetSnipCount();
-
-		XMPScanner::SnipInfoVector snips ( snipCount );
-		scanner.Report ( snips );
+		long snipCount = (long)snips.size();
 
 		for ( pkt = 0; pkt < snipCount; ++pkt ) {
 
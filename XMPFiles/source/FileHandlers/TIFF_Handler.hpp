@@ -41,6 +41,12 @@ static const XMP_OptionBits kTIFF_HandlerFlags = (kXMPFiles_CanInjectXMP |
                                                   kXMPFiles_AllowsSafeUpdate |
 												  kXMPFiles_CanNotifyProgress);
 
+static const XMPFileSignature kTIFF_Signatures [] = {
+	{ "II\x2A\x00", 0, 4, false },
+	{ "MM\x00\x2A", 0, 4, false },
+	{ 0, 0, 0, false }
+};
+
 class TIFF_MetaHandler : public XMPFileHandler
 {
 public:
@@ -124,6 +124,11 @@ static const XMP_OptionBits kUCF_HandlerFlags = (
 						kXMPFiles_NeedsReadOnlyPacket //UCF/zip has checksums...
 						);
 
+static const XMPFileSignature kUCF_Signatures [] = {
+	{ "PK\x03\x04", 0, 4, false },
+	{ 0, 0, 0, false }
+};
+
 enum {	// data descriptor
 	// may or may not have a signature: 0x08074b50
 	kUCF_DD_crc32				=   0,
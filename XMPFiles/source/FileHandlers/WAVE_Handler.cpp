@@ -44,13 +44,10 @@ XMPFileHandler * WAVE_MetaHandlerCTor ( XMPFiles * parent )
 bool WAVE_CheckFormat ( XMP_FileFormat  /*format*/,
 					   XMP_StringPtr    /*filePath*/,
 			           XMP_IO*			file,
-				   XMPFiles*        /*parent*/ )
+				   XMPFiles*        parent )
 {
-	// Reset file pointer position
-	file->Rewind();
-
 	XMP_Uns8 buffer[12];
-	XMP_Int32 got = file->Read ( buffer, 12 );
+	XMP_Int32 got = parent->ReadFileHeader ( file, buffer, 12 );
 	// Reset file pointer position
 	file->Rewind();
 
@@ -57,6 +57,12 @@ static const XMP_OptionBits kWAVE_HandlerFlags = (kXMPFiles_CanInjectXMP |
 												  kXMPFiles_CanNotifyProgress
 												 );
 
+static const XMPFileSignature kWAVE_Signatures [] = {
+	{ "RIFF????WAVE", "xxxx????xxxx", 12, true },
+	{ "RF64????WAVE", "xxxx????xxxx", 12, true },
+	{ 0, 0, 0, false }
+};
+
 /**
  * Main class for the the WAVE file handler.
  */
@@ -26,15 +26,14 @@ bool WEBP_CheckFormat(XMP_FileFormat format, XMP_StringPtr filePath,
                       XMP_IO* file, XMPFiles* parent)
 {
     IgnoreParam(filePath);
-    IgnoreParam(parent);
     XMP_Assert(format == kXMP_WEBPFile);
 
     if (file->Length() < 12)
         return false;
-    file->Rewind();
 
     XMP_Uns8 chunkID[12];
-    file->ReadAll(chunkID, 12);
+    if (parent->ReadFileHeader(file, chunkID, 12) != 12)
+        return false;
     if (!CheckBytes(&chunkID[0], "RIFF", 4)) {
         return false;
     }
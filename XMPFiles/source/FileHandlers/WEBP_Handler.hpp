@@ -23,6 +23,11 @@ static const XMP_OptionBits kWEBP_HandlerFlags =
      kXMPFiles_AllowsOnlyXMP | kXMPFiles_ReturnsRawPacket |
      kXMPFiles_CanReconcile);
 
+static const XMPFileSignature kWEBP_Signatures [] = {
+	{ "RIFF????WEBP", "xxxx????xxxx", 12, true },
+	{ 0, 0, 0, false }
+};
+
 class WEBP_MetaHandler
   : public XMPFileHandler {
 public:
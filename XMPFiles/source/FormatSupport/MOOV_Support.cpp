@@ -326,15 +326,89 @@ XMP_Uns8 * MOOV_Manager::AppendNewSubtree ( const BoxNode & node, const std::str
 	
 }	// MOOV_Manager::AppendNewSubtree
 
+// =================================================================================================
+// IsUnchangedSubtree
+// ==================
+//
+// True if no box of the subtree was replaced or added since parsing. Deleted boxes show up as a
+// size difference, MeasureUnchangedPrefix checks that.
+
+static bool IsUnchangedSubtree ( const ISOBaseMedia_Manager::BoxNode & node )
+{
+	if ( node.changed || (node.headerSize == 0) ) return false;
+
+	for ( size_t i = 0, limit = node.children.size(); i < limit; ++i ) {
+		if ( ! IsUnchangedSubtree ( node.children[i] ) ) return false;
+	}
+
+	return true;
+
+}	// IsUnchangedSubtree
+
+// =================================================================================================
+// MOOV_Manager::MeasureUnchangedPrefix
+// ====================================
+//
+// Walk the children of 'moov' in order while they are contiguous from the end of the header, have
+// not been replaced or added, and would be recomposed to their parsed size. Those are kept as is by
+// UpdateMemoryTree, along with any content changed in place.
+
+XMP_Uns32 MOOV_Manager::MeasureUnchangedPrefix ( size_t * keptChildren )
+{
+	*keptChildren = 0;
+
+	const BoxNode & moovNode = this->subtreeRootNode;
+	if ( this->fullSubtree.empty() || (moovNode.boxType != ISOMedia::k_moov) ) return 0;
+
+	const XMP_Uns8 * moovOrigin = &this->fullSubtree[0];
+	const XMP_Uns8 * moovLimit  = moovOrigin + this->fullSubtree.size();
+
+	XMP_Uns32 prefixSize = moovNode.headerSize;
+
+	for ( size_t i = 0, limit = moovNode.children.size(); i < limit; ++i ) {
+
+		const BoxNode & child = moovNode.children[i];
+		if ( (child.offset != prefixSize) || (! IsUnchangedSubtree ( child )) ) break;
+
+		ISOMedia::BoxInfo parsedInfo;
+		(void) ISOMedia::GetBoxInfo ( (moovOrigin + child.offset), moovLimit, &parsedInfo );
+		XMP_Uns32 parsedSize = (XMP_Uns32) (parsedInfo.headerSize + parsedInfo.contentSize);
+		if ( this->NewSubtreeSize ( child, "/moov" ) != parsedSize ) break;
+
+		prefixSize += parsedSize;
+		*keptChildren = i + 1;
+
+	}
+
+	return prefixSize;
+
+}	// MOOV_Manager::MeasureUnchangedPrefix
+
 // =================================================================================================
 // MOOV_Manager::UpdateMemoryTree
 // ==============================
+//
+// Keep the unchanged prefix as is and append the rest of the children. Recompose the whole 'moov'
+// box if no child is kept. Boxes with large sample tables usually come first and stay untouched,
+// with the changed 'udta' and 'meta' boxes following them.
 
 void MOOV_Manager::UpdateMemoryTree()
 {
 	if ( ! this->IsChanged() ) return;
 	
-	XMP_Uns32 newSize = this->NewSubtreeSize ( this->subtreeRootNode, "" );
+	size_t keptChildren;
+	XMP_Uns32 prefixSize = this->MeasureUnchangedPrefix ( &keptChildren );
+	if ( keptChildren == 0 ) prefixSize = 0;
+
+	XMP_Uns32 newSize;
+	if ( prefixSize == 0 ) {
+		newSize = this->NewSubtreeSize ( this->subtreeRootNode, "" );
+	} else {
+		newSize = prefixSize;
+		for ( size_t i = keptChildren, limit = this->subtreeRootNode.children.size(); i < limit; ++i ) {
+			newSize += this->NewSubtreeSize ( this->subtreeRootNode.children[i], "/moov" );
+		}
+	}
 	XMP_Enforce ( newSize < TopBoxSizeLimit);
 	
 	RawDataBlock newData;
@@ -344,11 +418,33 @@ void MOOV_Manager::UpdateMemoryTree()
 	XMP_Uns8 * newEnd = newPtr + newSize;
 
 	#if TraceUpdateMoovTree
-		fprintf ( stderr, "Starting MOOV_Manager::UpdateMemoryTree\n" );
+		fprintf ( stderr, "Starting MOOV_Manager::UpdateMemoryTree, keeping %d bytes\n", prefixSize );
 		newOrigin = newPtr;
 	#endif
 	
-	XMP_Uns8 * trueEnd = this->AppendNewSubtree ( this->subtreeRootNode, "", newPtr, newEnd );
+	XMP_Uns8 * trueEnd;
+
+	if ( prefixSize == 0 ) {
+
+		trueEnd = this->AppendNewSubtree ( this->subtreeRootNode, "", newPtr, newEnd );
+
+	} else {
+
+		memcpy ( newPtr, &this->fullSubtree[0], prefixSize );
+		if ( this->subtreeRootNode.headerSize == 16 ) {
+			PutUns32BE ( 1, newPtr );
+			PutUns64BE ( newSize, newPtr + 8 );
+		} else {
+			PutUns32BE ( newSize, newPtr );
+		}
+
+		trueEnd = newPtr + prefixSize;
+		for ( size_t i = keptChildren, limit = this->subtreeRootNode.children.size(); i < limit; ++i ) {
+			trueEnd = this->AppendNewSubtree ( this->subtreeRootNode.children[i], "/moov", trueEnd, newEnd );
+		}
+
+	}
+
 	XMP_Enforce ( trueEnd == newEnd );
 	
 	this->fullSubtree.swap ( newData );
@@ -53,11 +53,18 @@ public:
 
 
 	// ---------------------------------------------------------------------------------------------
-
+	// ParseMemoryTree - Build the BoxNode tree from fullSubtree.
+	// UpdateMemoryTree - Rebuild fullSubtree from the BoxNode tree and parse it again. The leading
+	//	part given by GetUnchangedPrefix is kept byte for byte, only the rest is recomposed.
+	// GetUnchangedPrefix - The size of the 'moov' header plus the leading children that are still at
+	//	their parsed offset and size, with no replaced, added, or deleted boxes. Content changed in
+	//	place is already in fullSubtree and part of the prefix.
 
 	void ParseMemoryTree ( XMP_Uns8 fileMode );
 	void UpdateMemoryTree();
 
+	XMP_Uns32 GetUnchangedPrefix() { size_t keptChildren; return this->MeasureUnchangedPrefix ( &keptChildren ); };
+
 	// ---------------------------------------------------------------------------------------------
 
 	#pragma pack (push, 1)	// ! These must match the file layout!
@@ -139,6 +146,8 @@ private:
 	
 	void ParseNestedBoxes ( BoxNode * parentNode, const std::string & parentPath, bool ignoreMetaBoxes );
 
+	XMP_Uns32 MeasureUnchangedPrefix ( size_t * keptChildren );
+
 	XMP_Uns32  NewSubtreeSize ( const BoxNode & node, const std::string & parentPath );
 	XMP_Uns8 * AppendNewSubtree ( const BoxNode & node, const std::string & parentPath,
 										 XMP_Uns8 * newPtr, XMP_Uns8 * newEnd );
@@ -0,0 +1,535 @@
+// =================================================================================================
+// Copyright Adobe
+// All Rights Reserved
+//
+// NOTICE: Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+#include "public/include/XMP_Environment.h"	// ! XMP_Environment.h must be the first included header.
+
+#include "public/include/XMP_Const.h"
+#include "public/include/XMP_Version.h"
+
+#include "XMPFiles/source/XMPFiles_Impl.hpp"
+#include "source/EndianUtils.hpp"
+#include "source/XMP_LibUtils.hpp"
+
+#include "XMPFiles/source/FormatSupport/MetadataCache_Support.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <list>
+#include <map>
+#include <vector>
+
+namespace MetadataCache_Support {
+
+// =================================================================================================
+
+static const char *    kRecordMagic   = "XMPC";
+static const XMP_Uns32 kRecordVersion = 2;	// ! Bump when the layout or any handler's output changes.
+static const char *    kRecordSuffix  = ".xmpc";
+
+static const XMP_OptionBits kUncachedHandlers = kXMPFiles_FolderBasedFormat | kXMPFiles_UsesSidecarXMP |
+												kXMPFiles_HandlerOwnsFile;
+
+struct CacheEntry {
+	XMP_Uns64 size;
+	std::list<std::string>::iterator use;
+};
+
+struct CacheState {
+	std::string folder;		// Ends with kDirChar.
+	XMP_Uns64   maxSize;
+	XMP_Uns64   totalSize;
+	std::list<std::string> useOrder;	// Record names, most recently used first.
+	std::map<std::string,CacheEntry> entries;
+	CacheState() : maxSize(0), totalSize(0) {};
+};
+
+static XMP_BasicMutex    sCacheLock;
+static CacheState *      sCache = 0;	// Protected by sCacheLock.
+static std::atomic<bool> sCacheEnabled ( false );
+
+struct CachedRecord {
+	Host_IO::FileIdentity identity;
+	XMP_OptionBits openFlags;
+	XMP_FileFormat requestedFormat;
+	XMP_FileFormat format;
+	XMP_OptionBits handlerFlags;
+	bool           containsXMP;
+	XMP_PacketInfo packetInfo;
+	std::string    xmpPacket;
+	std::string    xmpText;		// The reconciled XMP, serialized in the compact form.
+	CachedRecord() : openFlags(0), requestedFormat(0), format(0), handlerFlags(0), containsXMP(false) {};
+};
+
+// =================================================================================================
+// CachedHandler
+// =============
+//
+// Stands in for the file's handler when the read is answered from the cache. The XMP is already
+// processed and the file isn't open, there is nothing else to do. A read-only open never updates.
+
+class CachedHandler : public XMPFileHandler {
+public:
+	CachedHandler ( XMPFiles * _parent ) : XMPFileHandler ( _parent ) {};
+	~CachedHandler() {};
+
+	void CacheFileData() {};
+	void ProcessXMP() {};
+	void UpdateFile ( bool /*doSafeUpdate*/ )
+		{ XMP_Throw ( "MetadataCache_Support: Cached files can't be updated", kXMPErr_InternalFailure ); };
+	void WriteTempFile ( XMP_IO* /*tempRef*/ )
+		{ XMP_Throw ( "MetadataCache_Support: Cached files can't be updated", kXMPErr_InternalFailure ); };
+};
+
+// =================================================================================================
+// Record encoding
+// ===============
+//
+// All numbers are little endian. Strings are a 32 bit length and the bytes.
+
+static void AppendUns32 ( std::string * buffer, XMP_Uns32 value )
+{
+	char bytes [4];
+	PutUns32LE ( value, bytes );
+	buffer->append ( bytes, 4 );
+}
+
+static void AppendUns64 ( std::string * buffer, XMP_Uns64 value )
+{
+	char bytes [8];
+	PutUns64LE ( value, bytes );
+	buffer->append ( bytes, 8 );
+}
+
+static void AppendString ( std::string * buffer, const std::string & value )
+{
+	AppendUns32 ( buffer, (XMP_Uns32)value.size() );
+	buffer->append ( value );
+}
+
+struct RecordReader {
+	const char * ptr;
+	const char * end;
+	bool ok;
+	RecordReader ( const std::string & buffer ) : ptr(buffer.data()), end(buffer.data() + buffer.size()), ok(true) {};
+	bool Need ( size_t count ) { if ( (size_t)(this->end - this->ptr) < count ) this->ok = false; return this->ok; };
+	XMP_Uns32 Uns32() { if ( ! this->Need ( 4 ) ) return 0; XMP_Uns32 v = GetUns32LE ( this->ptr ); this->ptr += 4; return v; };
+	XMP_Uns64 Uns64() { if ( ! this->Need ( 8 ) ) return 0; XMP_Uns64 v = GetUns64LE ( this->ptr ); this->ptr += 8; return v; };
+	void String ( std::string * value ) {
+		XMP_Uns32 len = this->Uns32();
+		if ( this->Need ( len ) ) { value->assign ( this->ptr, len ); this->ptr += len; }
+	};
+};
+
+static void AppendIdentity ( std::string * buffer, const Host_IO::FileIdentity & identity )
+{
+	AppendUns64 ( buffer, identity.deviceID );
+	AppendUns64 ( buffer, identity.fileID );
+	AppendUns64 ( buffer, (XMP_Uns64)identity.length );
+	AppendUns64 ( buffer, (XMP_Uns64)identity.modifySeconds );
+	AppendUns64 ( buffer, (XMP_Uns64)identity.modifyNanoseconds );
+	AppendUns64 ( buffer, (XMP_Uns64)identity.changeSeconds );
+	AppendUns64 ( buffer, (XMP_Uns64)identity.changeNanoseconds );
+}
+
+static XMP_Uns32 ConfigFlags()
+{
+	return (ignoreLocalText ? 1 : 0);	// The global options that change what is reconciled.
+}
+
+static void EncodeRecord ( const CachedRecord & record, std::string * buffer )
+{
+	buffer->clear();
+	buffer->reserve ( 128 + record.xmpPacket.size() + record.xmpText.size() );
+
+	buffer->append ( kRecordMagic, 4 );
+	AppendUns32 ( buffer, kRecordVersion );
+	AppendString ( buffer, XMPFILES_API_VERSION_STRING );
+	AppendUns32 ( buffer, ConfigFlags() );
+	AppendIdentity ( buffer, record.identity );
+	AppendUns32 ( buffer, record.openFlags );
+	AppendUns32 ( buffer, record.requestedFormat );
+	AppendUns32 ( buffer, record.format );
+	AppendUns32 ( buffer, record.handlerFlags );
+	AppendUns32 ( buffer, (record.containsXMP ? 1 : 0) );
+
+	const XMP_PacketInfo & info = record.packetInfo;
+	AppendUns64 ( buffer, (XMP_Uns64)info.offset );
+	AppendUns32 ( buffer, (XMP_Uns32)info.length );
+	AppendUns32 ( buffer, (XMP_Uns32)info.padSize );
+	AppendUns32 ( buffer, ((XMP_Uns32)info.charForm << 16) | ((XMP_Uns32)info.writeable << 8) | (XMP_Uns32)info.hasWrapper );
+
+	AppendString ( buffer, record.xmpPacket );
+	AppendString ( buffer, record.xmpText );
+}
+
+static bool DecodeRecord ( const std::string & buffer, CachedRecord * record )
+{
+	if ( (buffer.size() < 8) || (memcmp ( buffer.data(), kRecordMagic, 4 ) != 0) ) return false;
+
+	RecordReader reader ( buffer );
+	reader.ptr += 4;
+	if ( reader.Uns32() != kRecordVersion ) return false;
+	std::string version;
+	reader.String ( &version );
+	if ( version != XMPFILES_API_VERSION_STRING ) return false;
+	if ( reader.Uns32() != ConfigFlags() ) return false;
+
+	record->identity.deviceID = reader.Uns64();
+	record->identity.fileID = reader.Uns64();
+	record->identity.length = (XMP_Int64)reader.Uns64();
+	record->identity.modifySeconds = (XMP_Int64)reader.Uns64();
+	record->identity.modifyNanoseconds = (XMP_Int64)reader.Uns64();
+	record->identity.changeSeconds = (XMP_Int64)reader.Uns64();
+	record->identity.changeNanoseconds = (XMP_Int64)reader.Uns64();
+	record->openFlags = reader.Uns32();
+	record->requestedFormat = reader.Uns32();
+	record->format = reader.Uns32();
+	record->handlerFlags = reader.Uns32();
+	record->containsXMP = (reader.Uns32() != 0);
+
+	XMP_PacketInfo & info = record->packetInfo;
+	info.offset = (XMP_Int64)reader.Uns64();
+	info.length = (XMP_Int32)reader.Uns32();
+	info.padSize = (XMP_Int32)reader.Uns32();
+	XMP_Uns32 bits = reader.Uns32();
+	info.charForm = (XMP_Uns8)(bits >> 16);
+	info.writeable = (XMP_Bool)((bits >> 8) & 0xFF);
+	info.hasWrapper = (XMP_Bool)(bits & 0xFF);
+
+	reader.String ( &record->xmpPacket );
+	reader.String ( &record->xmpText );
+	return reader.ok && (reader.ptr == reader.end);
+}
+
+// =================================================================================================
+// Record files
+// ============
+
+static std::string RecordName ( const Host_IO::FileIdentity & identity )
+{
+	char name [48];
+	snprintf ( name, sizeof(name), "%llx-%llx", (unsigned long long)identity.deviceID, (unsigned long long)identity.fileID );
+	return std::string ( name ) + kRecordSuffix;
+}
+
+static bool ReadRecordFile ( const std::string & path, std::string * buffer )
+{
+	Host_IO::FileRef fileRef = Host_IO::Open ( path.c_str(), Host_IO::openReadOnly );
+	if ( fileRef == Host_IO::noFileRef ) return false;
+
+	bool ok = false;
+	try {
+		XMP_Int64 length = Host_IO::Length ( fileRef );
+		if ( (length > 0) && (length < 0x7FFFFFFF) ) {
+			buffer->resize ( (size_t)length );
+			ok = (Host_IO::Read ( fileRef, &(*buffer)[0], (XMP_Uns32)length ) == (XMP_Uns32)length);
+		}
+	} catch ( ... ) {
+		ok = false;
+	}
+	Host_IO::Close ( fileRef );
+	return ok;
+}
+
+static void WriteRecordFile ( const std::string & path, const std::string & buffer )
+{
+	std::string tempPath = Host_IO::CreateTemp ( path.c_str() );
+
+	try {
+		Host_IO::FileRef fileRef = Host_IO::Open ( tempPath.c_str(), Host_IO::openReadWrite );
+		if ( fileRef == Host_IO::noFileRef ) XMP_Throw ( "MetadataCache_Support: Can't open temp file", kXMPErr_ExternalFailure );
+		try {
+			Host_IO::Write ( fileRef, buffer.data(), (XMP_Uns32)buffer.size() );
+		} catch ( ... ) {
+			Host_IO::Close ( fileRef );
+			throw;
+		}
+		Host_IO::Close ( fileRef );
+		Host_IO::Replace ( tempPath.c_str(), path.c_str() );	// A reader sees the old record or the new one.
+	} catch ( ... ) {
+		try { Host_IO::Delete ( tempPath.c_str() ); } catch ( ... ) { /* Do nothing. */ }
+		throw;
+	}
+}
+
+// =================================================================================================
+// Size accounting
+// ===============
+//
+// These are called with sCacheLock held.
+
+static void NoteUse ( CacheState * cache, const std::string & name, XMP_Uns64 size )
+{
+	std::map<std::string,CacheEntry>::iterator pos = cache->entries.find ( name );
+
+	if ( pos == cache->entries.end() ) {
+		cache->useOrder.push_front ( name );
+		CacheEntry entry = { size, cache->useOrder.begin() };
+		cache->entries[name] = entry;
+		cache->totalSize += size;
+	} else {
+		cache->useOrder.splice ( cache->useOrder.begin(), cache->useOrder, pos->second.use );
+		cache->totalSize += size;
+		cache->totalSize -= pos->second.size;
+		pos->second.size = size;
+	}
+}
+
+static void ForgetEntry ( CacheState * cache, const std::string & name )
+{
+	std::map<std::string,CacheEntry>::iterator pos = cache->entries.find ( name );
+	if ( pos == cache->entries.end() ) return;
+	cache->totalSize -= pos->second.size;
+	cache->useOrder.erase ( pos->second.use );
+	cache->entries.erase ( pos );
+}
+
+static void EvictOldEntries ( CacheState * cache )
+{
+	while ( (cache->totalSize > cache->maxSize) && (! cache->useOrder.empty()) ) {
+		std::string name = cache->useOrder.back();
+		try {
+			Host_IO::Delete ( (cache->folder + name).c_str() );
+		} catch ( ... ) {
+			// Do nothing, forget it anyway so one stuck file doesn't stop the eviction.
+		}
+		ForgetEntry ( cache, name );
+	}
+}
+
+// =================================================================================================
+// InitializeGlobals
+// =================
+
+bool InitializeGlobals()
+{
+	InitializeBasicMutex ( sCacheLock );
+	return true;
+}
+
+// =================================================================================================
+// TerminateGlobals
+// ================
+
+void TerminateGlobals()
+{
+	sCacheEnabled = false;
+	delete sCache;
+	sCache = 0;
+	TerminateBasicMutex ( sCacheLock );
+}
+
+// =================================================================================================
+// SetCacheFolder
+// ==============
+
+void SetCacheFolder ( XMP_StringPtr cacheFolder, XMP_Uns64 maxCacheSize )
+{
+	CacheState * newCache = 0;
+
+	if ( (cacheFolder != 0) && (*cacheFolder != 0) ) {
+
+		if ( Host_IO::GetFileMode ( cacheFolder ) != Host_IO::kFMode_IsFolder ) {
+			XMP_Throw ( "XMPFiles::SetMetadataCache - The cache path is not a folder", kXMPErr_BadParam );
+		}
+
+		newCache = new CacheState();
+		newCache->folder = cacheFolder;
+		if ( newCache->folder[newCache->folder.size()-1] != kDirChar ) newCache->folder += kDirChar;
+		newCache->maxSize = (maxCacheSize == 0) ? (XMP_Uns64)kDefaultMaxCacheSize : maxCacheSize;
+
+		// Pick up the records already in the folder, the newest ones count as the most recently used.
+
+		try {
+			struct FoundRecord {
+				XMP_Int64 modifySeconds;
+				XMP_Int64 length;
+				std::string name;
+				bool operator< ( const FoundRecord & other ) const { return this->modifySeconds < other.modifySeconds; };
+			};
+			std::vector<FoundRecord> found;
+			const size_t suffixLen = strlen ( kRecordSuffix );
+
+			Host_IO::AutoFolder folder;
+			folder.folder = Host_IO::OpenFolder ( cacheFolder );
+			std::string childName;
+			while ( Host_IO::GetNextChild ( folder.folder, &childName ) ) {
+				if ( (childName.size() <= suffixLen) ||
+					 (childName.compare ( childName.size() - suffixLen, suffixLen, kRecordSuffix ) != 0) ) continue;
+				Host_IO::FileIdentity identity;
+				if ( ! Host_IO::GetFileIdentity ( (newCache->folder + childName).c_str(), &identity ) ) continue;
+				FoundRecord record = { identity.modifySeconds, identity.length, childName };
+				found.push_back ( record );
+			}
+			folder.Close();
+
+			std::stable_sort ( found.begin(), found.end() );
+			for ( size_t i = 0; i < found.size(); ++i ) NoteUse ( newCache, found[i].name, found[i].length );
+			EvictOldEntries ( newCache );
+		} catch ( ... ) {
+			delete newCache;
+			throw;
+		}
+
+	}
+
+	XMP_AutoMutex cacheLock ( &sCacheLock );
+	delete sCache;
+	sCache = newCache;
+	sCacheEnabled = (newCache != 0);
+}
+
+// =================================================================================================
+// IsEnabled
+// =========
+
+bool IsEnabled()
+{
+	return sCacheEnabled;
+}
+
+// =================================================================================================
+// GetOpenKey
+// ==========
+
+bool GetOpenKey ( XMP_StringPtr filePath, XMP_OptionBits openFlags, XMP_FileFormat format, OpenKey * key )
+{
+	*key = OpenKey();
+	if ( ! sCacheEnabled ) return false;
+	if ( ! Host_IO::GetFileIdentity ( filePath, &key->identity ) ) return false;
+
+	key->openFlags = openFlags;
+	key->format = format;
+	key->valid = true;
+	return true;
+}
+
+// =================================================================================================
+// LookupHandler
+// =============
+
+XMPFileHandler * LookupHandler ( XMPFiles * parent, const OpenKey & key )
+{
+	if ( (! key.valid) || (! sCacheEnabled) ) return 0;
+
+	try {
+
+		const std::string name = RecordName ( key.identity );
+		std::string folder;
+		{
+			XMP_AutoMutex cacheLock ( &sCacheLock );
+			if ( sCache == 0 ) return 0;
+			folder = sCache->folder;
+		}
+
+		std::string buffer;
+		CachedRecord record;
+		if ( ! ReadRecordFile ( folder + name, &buffer ) ) return 0;
+		if ( ! DecodeRecord ( buffer, &record ) ) return 0;
+		if ( (record.identity != key.identity) || (record.openFlags != key.openFlags) ||
+			 (record.requestedFormat != key.format) ) return 0;	// ! A stale record is replaced by the next store.
+
+		CachedHandler * handler = new CachedHandler ( parent );
+		try {
+			handler->handlerFlags = record.handlerFlags;
+			handler->containsXMP = record.containsXMP;
+			handler->processedXMP = true;
+			handler->packetInfo = record.packetInfo;
+			handler->xmpPacket.swap ( record.xmpPacket );
+			if ( ! record.xmpText.empty() ) {
+				handler->xmpObj.ParseFromBuffer ( record.xmpText.c_str(), (XMP_StringLen)record.xmpText.size() );
+			}
+		} catch ( ... ) {
+			delete handler;
+			throw;
+		}
+
+		{
+			XMP_AutoMutex cacheLock ( &sCacheLock );
+			if ( (sCache != 0) && (sCache->folder == folder) ) NoteUse ( sCache, name, buffer.size() );
+		}
+
+		parent->format = record.format;
+		return handler;
+
+	} catch ( ... ) {
+		return 0;	// Read the file instead.
+	}
+}
+
+// =================================================================================================
+// StoreHandler
+// ============
+
+void StoreHandler ( const OpenKey & key, XMP_StringPtr filePath, const XMPFileHandler * handler, XMP_FileFormat format )
+{
+	if ( (! key.valid) || (! sCacheEnabled) ) return;
+	if ( (! handler->processedXMP) || (handler->handlerFlags & kUncachedHandlers) ) return;
+
+	try {
+
+		CachedRecord record;
+		record.identity = key.identity;
+		record.openFlags = key.openFlags;
+		record.requestedFormat = key.format;
+		record.format = format;
+		record.handlerFlags = handler->handlerFlags;
+		record.containsXMP = handler->containsXMP;
+		record.packetInfo = handler->packetInfo;
+		record.xmpPacket = handler->xmpPacket;
+		handler->xmpObj.SerializeToBuffer ( &record.xmpText, (kXMP_OmitPacketWrapper | kXMP_UseCompactFormat) );
+
+		std::string buffer;
+		EncodeRecord ( record, &buffer );
+
+		// The file might have changed while it was read, then the XMP isn't known to match either.
+		Host_IO::FileIdentity identity;
+		if ( (! Host_IO::GetFileIdentity ( filePath, &identity )) || (identity != key.identity) ) return;
+
+		const std::string name = RecordName ( key.identity );
+		std::string folder;
+		{
+			XMP_AutoMutex cacheLock ( &sCacheLock );
+			if ( (sCache == 0) || (buffer.size() > sCache->maxSize) ) return;
+			folder = sCache->folder;
+		}
+
+		WriteRecordFile ( folder + name, buffer );
+
+		XMP_AutoMutex cacheLock ( &sCacheLock );
+		if ( (sCache != 0) && (sCache->folder == folder) ) {
+			NoteUse ( sCache, name, buffer.size() );
+			EvictOldEntries ( sCache );
+		}
+
+	} catch ( ... ) {
+		// Do nothing, the read is just not cached.
+	}
+}
+
+// =================================================================================================
+// Remove
+// ======
+
+void Remove ( const OpenKey & key )
+{
+	if ( (! key.valid) || (! sCacheEnabled) ) return;
+
+	try {
+		const std::string name = RecordName ( key.identity );
+		XMP_AutoMutex cacheLock ( &sCacheLock );
+		if ( sCache == 0 ) return;
+		Host_IO::Delete ( (sCache->folder + name).c_str() );
+		ForgetEntry ( sCache, name );
+	} catch ( ... ) {
+		// Do nothing, a stale record doesn't match the updated file anyway.
+	}
+}
+
+}	// namespace MetadataCache_Support
@@ -0,0 +1,85 @@
+#ifndef __MetadataCache_Support_hpp__
+#define __MetadataCache_Support_hpp__ 1
+
+// =================================================================================================
+// Copyright Adobe
+// All Rights Reserved
+//
+// NOTICE: Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+#include "public/include/XMP_Environment.h"	// ! XMP_Environment.h must be the first included header.
+
+#include "public/include/XMP_Const.h"
+
+#include "source/Host_IO.hpp"
+
+class XMPFiles;
+class XMPFileHandler;
+
+// =================================================================================================
+// MetadataCache_Support
+// =====================
+//
+// An optional on-disk cache of the XMP read from local files, set up by XMPFiles::SetMetadataCache.
+// There is one record file per cached file, named after the device and file ID. A record holds the
+// file identity it was made from (device, file ID, length and modification time), the open flags,
+// the requested and found format, the handler flags, the packet info, the raw packet, and the
+// reconciled XMP serialized in the compact form. A record is only used if all of these match, so
+// a changed or replaced file is never answered from a stale record. The library version is part of
+// the record, a new version of the handlers doesn't use the records of the old one.
+//
+// A hit costs one stat call and the read of the record, the file itself isn't opened. Records are
+// written to a temp file and renamed, so a reader never sees a partial one. The cache size is kept
+// under its limit by deleting the least recently used records known to this process. Records only
+// seen in the folder when the cache was set up are ordered by their modification time.
+//
+// Only handlers that get all of their XMP from the one file are cached, not folder based formats,
+// sidecar files, or plugin handlers that own the file. Only SetCacheFolder throws, for a bad cache
+// folder. The lookups and stores never throw, a failure just means the cache isn't used.
+
+namespace MetadataCache_Support {
+
+	enum { kDefaultMaxCacheSize = 64*1024*1024 };
+
+	// What a read is cached by, filled in when a local file is opened.
+
+	struct OpenKey {
+		Host_IO::FileIdentity identity;
+		XMP_OptionBits openFlags;
+		XMP_FileFormat format;	// The format passed to OpenFile.
+		bool valid;
+		OpenKey() : openFlags(0), format(kXMP_UnknownFile), valid(false) {};
+	};
+
+	bool InitializeGlobals();
+	void TerminateGlobals();
+
+	// Sets the cache folder, a null or empty path turns the cache off. A maxCacheSize of 0 means
+	// kDefaultMaxCacheSize. Throws kXMPErr_BadParam if the path is not a folder.
+
+	void SetCacheFolder ( XMP_StringPtr cacheFolder, XMP_Uns64 maxCacheSize );
+
+	bool IsEnabled();
+
+	// Fills in the key for a file, returns false if the path is not a file or the cache is off.
+
+	bool GetOpenKey ( XMP_StringPtr filePath, XMP_OptionBits openFlags, XMP_FileFormat format, OpenKey * key );
+
+	// Returns a handler with the cached XMP already processed, 0 if there is no matching record.
+	// Sets the parent's format.
+
+	XMPFileHandler * LookupHandler ( XMPFiles * parent, const OpenKey & key );
+
+	// Stores the processed XMP of a handler, if the file still has the key's identity.
+
+	void StoreHandler ( const OpenKey & key, XMP_StringPtr filePath, const XMPFileHandler * handler, XMP_FileFormat format );
+
+	// Removes the record for a file that is being updated.
+
+	void Remove ( const OpenKey & key );
+
+}	// namespace MetadataCache_Support
+
+#endif	// __MetadataCache_Support_hpp__
@@ -0,0 +1,287 @@
+// =================================================================================================
+// Copyright Adobe
+// All Rights Reserved
+//
+// NOTICE: Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+#include "public/include/XMP_Environment.h"	// ! XMP_Environment.h must be the first included header.
+
+#include "public/include/XMP_Const.h"
+#include "public/include/XMP_IO.hpp"
+
+#include "XMPFiles/source/XMPFiles_Impl.hpp"
+#include "source/XMPFiles_IO.hpp"
+
+#include "XMPFiles/source/FormatSupport/PacketScanning_Support.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#if EnablePacketScanning
+
+namespace PacketScanning_Support {
+
+// =================================================================================================
+
+struct RangeScan {
+	XMP_Int64 start;					// The part of the file this scan is responsible for.
+	XMP_Int64 end;
+	XMP_Int64 exactEnd;					// The packets before this are those of a sequential scan.
+	std::vector<XMP_Int64> pendingAt;	// Buffer ends before end where a packet was pending.
+	XMPScanner::SnipInfoVector packets;
+	std::exception_ptr error;
+	RangeScan() : start(0), end(0), exactEnd(0) {};
+};
+
+struct AbortCheck {
+	XMP_AbortProc abortProc;	// Only set for the calling thread.
+	void * abortArg;
+	std::atomic<bool> * aborted;
+	bool Check() const {
+		if ( (this->abortProc != 0) && this->abortProc ( this->abortArg ) ) *this->aborted = true;
+		return *this->aborted;
+	}
+};
+
+// =================================================================================================
+// ScanFrom
+// ========
+//
+// Scans from the given offset with a new scanner, which starts out as a sequential scan would right
+// after a packet or a buffer without a pending packet. The buffers end at multiples of
+// kScanBufferSize. The scan stops at the first buffer end at or past rangeEnd where no packet that
+// started before rangeEnd is pending. With syncWith, it also stops at the first buffer end before
+// rangeEnd where neither scan had a pending packet. From there on the two scans see the same input
+// in the same state, so syncWith's packets are used. The sync point is returned, -1 if none.
+
+static void ScanFrom ( XMP_IO *           fileRef,
+					   XMP_Int64          fileLen,
+					   XMP_Int64          from,
+					   XMP_Int64          rangeEnd,
+					   const RangeScan *  syncWith,
+					   RangeScan *        result,
+					   XMP_Int64 *        syncPoint,
+					   const AbortCheck & abort )
+{
+	XMPScanner scanner ( fileLen );
+	std::vector<XMP_Uns8> buffer ( kScanBufferSize );
+
+	XMP_Int64 bufPos = from;
+	result->exactEnd = fileLen;
+	if ( syncPoint != 0 ) *syncPoint = -1;
+
+	fileRef->Seek ( from, kXMP_SeekFromStart );
+
+	while ( bufPos < fileLen ) {
+
+		if ( abort.Check() ) XMP_Throw ( "PacketScanning_Support::ScanFile - User abort", kXMPErr_UserAbort );
+
+		XMP_Int64 bufEnd = ((bufPos / kScanBufferSize) + 1) * kScanBufferSize;
+		if ( bufEnd > fileLen ) bufEnd = fileLen;
+		const XMP_Uns32 bufLen = (XMP_Uns32) (bufEnd - bufPos);
+
+		fileRef->ReadAll ( &buffer[0], bufLen );
+		scanner.Scan ( &buffer[0], bufPos, bufLen );
+		bufPos = bufEnd;
+
+		XMP_Int64 packetStart;
+		const bool pending = scanner.PendingPacket ( &packetStart );
+
+		if ( bufPos < rangeEnd ) {
+			if ( pending ) {
+				result->pendingAt.push_back ( bufPos );
+			} else if ( (syncWith != 0) && (bufPos > syncWith->start) &&
+						(! std::binary_search ( syncWith->pendingAt.begin(), syncWith->pendingAt.end(), bufPos )) ) {
+				*syncPoint = bufPos;
+				result->exactEnd = bufPos;
+				break;
+			}
+		} else if ( ! pending ) {
+			result->exactEnd = bufPos;
+			break;
+		} else if ( packetStart >= rangeEnd ) {
+			result->exactEnd = packetStart;	// The packet is the next range's business.
+			break;
+		}
+
+	}
+
+	XMPScanner::SnipInfoVector snips ( scanner.GetSnipCount() );
+	scanner.Report ( snips );
+
+	for ( size_t i = 0; i < snips.size(); ++i ) {
+		const XMPScanner::SnipState state = snips[i].fState;
+		if ( (state != XMPScanner::eValidPacketSnip) && (state != XMPScanner::eBadPacketSnip) ) continue;
+		if ( snips[i].fOffset >= result->exactEnd ) continue;
+		result->packets.push_back ( snips[i] );
+		result->packets.back().fEncodingAttr = "";	// ! Points into the scanner.
+	}
+
+}	// ScanFrom
+
+// =================================================================================================
+// ScanRange
+// =========
+
+static void ScanRange ( XMP_IO * fileRef, XMP_Int64 fileLen, RangeScan * range, AbortCheck abort )
+{
+
+	try {
+		ScanFrom ( fileRef, fileLen, range->start, range->end, 0, range, 0, abort );
+	} catch ( ... ) {
+		*abort.aborted = true;	// Let the other threads stop early, the whole scan fails.
+		range->error = std::current_exception();
+	}
+
+}	// ScanRange
+
+static void RunRangeWorker ( XMP_IO * fileRef, XMP_Int64 fileLen, RangeScan * range, AbortCheck abort,
+							 std::atomic<size_t> * doneCount )
+{
+	ScanRange ( fileRef, fileLen, range, abort );
+	++(*doneCount);
+}	// RunRangeWorker
+
+// =================================================================================================
+// ScanFile
+// ========
+
+void ScanFile ( XMP_IO *                     fileRef,
+				XMP_StringPtr                filePath,
+				XMPScanner::SnipInfoVector * packets,
+				XMP_AbortProc                abortProc /* = 0 */,
+				void *                       abortArg /* = 0 */,
+				size_t                       threadCount /* = 0 */,
+				XMP_Int64                    minRangeLength /* = kMinParallelRange */ )
+{
+	packets->clear();
+
+	const XMP_Int64 fileLen = fileRef->Length();
+	if ( fileLen == 0 ) return;
+
+	if ( threadCount == 0 ) {
+		threadCount = std::thread::hardware_concurrency();
+		if ( threadCount == 0 ) threadCount = 1;
+	}
+	if ( (filePath == 0) || (*filePath == 0) ) threadCount = 1;	// Client-managed I/O can't be shared.
+	if ( minRangeLength < 1 ) minRangeLength = 1;
+	if ( (XMP_Int64)threadCount > (fileLen / minRangeLength) ) threadCount = (size_t) (fileLen / minRangeLength);
+	if ( threadCount == 0 ) threadCount = 1;
+
+	// Split the file into ranges starting at buffer boundaries, open a file handle for each extra
+	// thread. Scan on the calling thread alone if a handle can't be opened.
+
+	XMP_Int64 rangeLength = (fileLen + threadCount - 1) / threadCount;
+	rangeLength = ((rangeLength + kScanBufferSize - 1) / kScanBufferSize) * kScanBufferSize;
+	const size_t rangeCount = (size_t) ((fileLen + rangeLength - 1) / rangeLength);
+
+	std::vector<RangeScan> ranges ( rangeCount );
+	for ( size_t i = 0; i < rangeCount; ++i ) {
+		ranges[i].start = i * rangeLength;
+		ranges[i].end = std::min ( fileLen, ranges[i].start + rangeLength );
+	}
+
+	std::vector<XMP_IO *> rangeFiles ( rangeCount, (XMP_IO *)0 );
+	rangeFiles[0] = fileRef;
+	for ( size_t i = 1; i < rangeCount; ++i ) {
+		rangeFiles[i] = XMPFiles_IO::New_XMPFiles_IO ( filePath, Host_IO::openReadOnly );
+		if ( rangeFiles[i] == 0 ) break;
+	}
+	if ( (rangeCount > 1) && (rangeFiles.back() == 0) ) {
+		for ( size_t i = 1; i < rangeCount; ++i ) delete rangeFiles[i];
+		rangeFiles.resize ( 1 );
+		ranges.resize ( 1 );
+		ranges[0].end = fileLen;
+	}
+
+	// Start threads for as many ranges as the worker budget allows, the calling thread scans the
+	// others. While waiting for the workers it keeps calling the abort proc, they only see the
+	// shared flag.
+
+	std::atomic<bool> aborted ( false );
+	AbortCheck callerAbort = { abortProc, abortArg, &aborted };
+	AbortCheck workerAbort = { 0, 0, &aborted };
+
+	const size_t reserved = ReserveWorkerThreads ( ranges.size() - 1 );
+	std::atomic<size_t> workersDone ( 0 );
+	std::vector<std::thread> workers;
+	size_t startable = reserved;
+	try {
+		workers.reserve ( reserved );	// A push_back that reallocates must not throw with a joinable thread in hand.
+	} catch ( ... ) {
+		startable = 0;
+	}
+	for ( size_t i = 1; i < ranges.size(); ++i ) {
+		bool started = false;
+		if ( workers.size() < startable ) {
+			try {
+				workers.push_back ( std::thread ( RunRangeWorker, rangeFiles[i], fileLen, &ranges[i], workerAbort, &workersDone ) );
+				started = true;
+			} catch ( ... ) {
+				// Out of threads, do it here.
+			}
+		}
+		if ( ! started ) ScanRange ( rangeFiles[i], fileLen, &ranges[i], callerAbort );
+	}
+	ScanRange ( fileRef, fileLen, &ranges[0], callerAbort );
+	while ( workersDone < workers.size() ) {
+		callerAbort.Check();
+		std::this_thread::sleep_for ( std::chrono::milliseconds ( 10 ) );
+	}
+	for ( size_t i = 0; i < workers.size(); ++i ) workers[i].join();
+	ReleaseWorkerThreads ( reserved );
+	for ( size_t i = 1; i < rangeFiles.size(); ++i ) delete rangeFiles[i];
+
+	for ( size_t i = 0; i < ranges.size(); ++i ) {
+		if ( ranges[i].error ) std::rethrow_exception ( ranges[i].error );
+	}
+	if ( aborted ) XMP_Throw ( "PacketScanning_Support::ScanFile - User abort", kXMPErr_UserAbort );
+
+	// Merge the ranges in file order. The cursor is where a sequential scan would be looking for a
+	// new packet. If an earlier range went past the start of this one, rescan from the cursor.
+
+	XMP_Int64 cursor = 0;
+
+	for ( size_t i = 0; i < ranges.size(); ++i ) {
+
+		const RangeScan & range = ranges[i];
+		if ( cursor >= range.end ) continue;
+
+		XMP_Int64 firstKept = 0;
+
+		if ( cursor > range.start ) {
+
+			RangeScan rescan;
+			XMP_Int64 syncPoint;
+			ScanFrom ( fileRef, fileLen, cursor, range.end, &range, &rescan, &syncPoint, callerAbort );
+			packets->insert ( packets->end(), rescan.packets.begin(), rescan.packets.end() );
+
+			if ( syncPoint < 0 ) {
+				cursor = rescan.exactEnd;
+				continue;
+			}
+
+			// A big endian packet whose '<' follows the sync point starts up to 3 bytes before it.
+			// No packet found before the sync point can start there, packets are longer than that.
+			firstKept = syncPoint - 3;
+
+		}
+
+		for ( size_t p = 0; p < range.packets.size(); ++p ) {
+			if ( range.packets[p].fOffset >= firstKept ) packets->push_back ( range.packets[p] );
+		}
+		cursor = range.exactEnd;
+
+	}
+
+}	// ScanFile
+
+}	// namespace PacketScanning_Support
+
+#endif	// EnablePacketScanning
@@ -0,0 +1,55 @@
+#ifndef __PacketScanning_Support_hpp__
+#define __PacketScanning_Support_hpp__ 1
+
+// =================================================================================================
+// Copyright Adobe
+// All Rights Reserved
+//
+// NOTICE: Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+#include "public/include/XMP_Environment.h"	// ! XMP_Environment.h must be the first included header.
+
+#include "public/include/XMP_Const.h"
+#include "public/include/XMP_IO.hpp"
+
+#include "XMPFiles/source/FormatSupport/XMPScanner.hpp"
+
+// =================================================================================================
+// PacketScanning_Support
+// ======================
+//
+// Runs the packet scanner over a whole file. A large local file is split into ranges that are
+// scanned on separate threads, each with its own file handle. A range's scanner keeps going past
+// the range end until a packet that started within the range is finished, so packets crossing a
+// range boundary are found. The range results are merged in file order. If a packet or a failed
+// packet header runs into the next range, that range is rescanned sequentially from where the
+// previous one stopped, until both scans agree that no packet is pending at a buffer boundary.
+// The result is always what a single sequential scan would have found.
+
+namespace PacketScanning_Support {
+
+	enum {
+		kScanBufferSize     = 256*1024,	// Buffer boundaries are multiples of this, for all ranges.
+		kMinParallelRange   = 16*1024*1024	// Smaller files are scanned on the calling thread.
+	};
+
+	// Scans all of fileRef, returning the valid and bad packet snips in file order. The filePath is
+	// used to open the extra file handles for the parallel scan, pass null for client-managed I/O.
+	// A threadCount of 0 means one range per core. Threads are only started for the ranges that
+	// ReserveWorkerThreads allows, the calling thread scans the rest. The abortProc is only called
+	// on the calling thread, also while it waits for the others. Throws kXMPErr_UserAbort or the
+	// first read error from any of the threads.
+
+	void ScanFile ( XMP_IO *                     fileRef,
+					XMP_StringPtr                filePath,
+					XMPScanner::SnipInfoVector * packets,
+					XMP_AbortProc                abortProc = 0,
+					void *                       abortArg = 0,
+					size_t                       threadCount = 0,
+					XMP_Int64                    minRangeLength = kMinParallelRange );
+
+}	// namespace PacketScanning_Support
+
+#endif	// __PacketScanning_Support_hpp__
@@ -21,10 +21,10 @@
 /// \brief TIFF_FileWriter is used for memory-based read-write access and all file-based access.
 ///
 /// \c TIFF_FileWriter is used for memory-based read-write access and all file-based access. The
-/// main internal data structure is the InternalTagMap, a std::map that uses the tag number as the
-/// key and InternalTagInfo as the value. There are 5 of these maps, one for each of the recognized
-/// IFDs. The maps contain an entry for each tag in the IFD, whether we capture the data or not. The
-/// dataPtr and dataLen fields in the InternalTagInfo are zero if the tag is not captured.
+/// main internal data structure is the InternalTagMap, a vector sorted by tag number that points to
+/// the InternalTagInfo values in a tag store. There are 5 of these maps, one for each of the
+/// recognized IFDs. The maps contain an entry for each tag in the IFD, whether we capture the data
+/// or not. The dataPtr and dataLen fields in the InternalTagInfo are zero if the tag is not captured.
 // =================================================================================================
 
 // =================================================================================================
@@ -115,7 +115,7 @@ const TIFF_FileWriter::InternalTagInfo* TIFF_FileWriter::FindTagInIFD ( XMP_Uns8
 
 	InternalTagMap::const_iterator tagPos = currIFD.find ( id );
 	if ( tagPos == currIFD.end() ) return 0;
-	return &tagPos->second;
+	return tagPos->second;
 
 }	// TIFF_FileWriter::FindTagInIFD
 
@@ -136,7 +136,7 @@ bool TIFF_FileWriter::GetIFD ( XMP_Uns8 ifd, TagInfoMap* ifdMap ) const
 
 	if ( ifdMap != 0 ) {
 		for ( ; tagPos != tagEnd; ++tagPos ) {
-			const InternalTagInfo& intInfo = tagPos->second;
+			const InternalTagInfo& intInfo = *tagPos->second;
 			TagInfo extInfo ( intInfo.id, intInfo.type, intInfo.count, intInfo.dataPtr, intInfo.dataLen  );
 			(*ifdMap)[intInfo.id] = extInfo;
 		}
@@ -201,13 +201,11 @@ void TIFF_FileWriter::SetTag ( XMP_Uns8 ifd, XMP_Uns16 id, XMP_Uns16 type, XMP_U
 	if ( tagPos == currIFD.end() ) {
 
 		// The tag does not yet exist, add it.
-		InternalTagMap::value_type mapValue ( id, InternalTagInfo ( id, type, count, this->fileParsed ) );
-		tagPos = currIFD.insert ( tagPos, mapValue );
-		tagPtr = &tagPos->second;
+		tagPtr = this->containedIFDs[ifd].AddTag ( id, type, count, this->fileParsed );
 
 	} else {
 
-		tagPtr = &tagPos->second;
+		tagPtr = tagPos->second;
 
 		// The tag already exists, make sure the value is actually changing.
 		if ( (type == tagPtr->type) && (count == tagPtr->count) &&
@@ -265,7 +263,7 @@ void TIFF_FileWriter::DeleteTag ( XMP_Uns8 ifd, XMP_Uns16 id )
 	InternalTagMap::iterator tagPos = currIFD.find ( id );
 	if ( tagPos == currIFD.end() ) return;	// ! Don't set the changed flags if the tag didn't exist.
 
-	currIFD.erase ( tagPos );
+	this->containedIFDs[ifd].DeleteTag ( tagPos );
 	this->containedIFDs[ifd].changed = true;
 	this->changed = true;
 	if ( (ifd != kTIFF_PrimaryIFD) || (id != kTIFF_XMP) ) this->legacyDeleted = true;
@@ -557,7 +555,7 @@ bool TIFF_FileWriter::IsLegacyChanged()
 		InternalTagMap::iterator tagEnd = thisIFD.tagMap.end();
 
 		for ( tagPos = thisIFD.tagMap.begin(); tagPos != tagEnd; ++tagPos ) {
-			InternalTagInfo & thisTag = tagPos->second;
+			InternalTagInfo & thisTag = *tagPos->second;
 			if ( thisTag.changed && (thisTag.id != kTIFF_XMP) ) return true;
 		}
 
@@ -652,7 +650,7 @@ void TIFF_FileWriter::ParseMemoryStream ( const void* data, XMP_Uns32 length, bo
 			InternalTagMap::iterator tagPos;
 			InternalTagMap::iterator tagEnd = thisIFD.tagMap.end();
 			for ( tagPos = thisIFD.tagMap.begin(); tagPos != tagEnd; ++tagPos ) {
-				InternalTagInfo & thisTag = tagPos->second;
+				InternalTagInfo & thisTag = *tagPos->second;
 				printf ( "      Tag %d, smallValue 0x%X, origDataLen %d, origDataOffset %d (0x%X)\n",
 						 thisTag.id, thisTag.smallValue, thisTag.origDataLen, thisTag.origDataOffset, thisTag.origDataOffset );
 			}
@@ -692,6 +690,7 @@ XMP_Uns32 TIFF_FileWriter::ProcessMemoryIFD ( XMP_Uns32 ifdOffset, XMP_Uns8 ifd
 
 	ifdInfo.origIFDOffset = ifdOffset;
 	ifdInfo.origCount  = tagCount1;
+	ifdInfo.tagMap.reserve ( tagCount1 );
 
 	for ( size_t i = 0; i < tagCount1; ++i ) {
 
@@ -702,9 +701,7 @@ XMP_Uns32 TIFF_FileWriter::ProcessMemoryIFD ( XMP_Uns32 ifdOffset, XMP_Uns8 ifd
 		XMP_Uns16 tagID    = this->GetUns16 ( &rawTag->id );
 		XMP_Uns32 tagCnt = this->GetUns32 ( &rawTag->count );
 
-		InternalTagMap::value_type mapValue ( tagID, InternalTagInfo ( tagID, tagType, tagCnt, kIsMemoryBased ) );
-		InternalTagMap::iterator newPos = ifdInfo.tagMap.insert ( ifdInfo.tagMap.end(), mapValue );
-		InternalTagInfo& mapTag = newPos->second;
+		InternalTagInfo& mapTag = *ifdInfo.AddTag ( tagID, tagType, tagCnt, kIsMemoryBased );
 
 		mapTag.dataLen = mapTag.origDataLen = mapTag.count * (XMP_Uns32)kTIFF_TypeSizes[mapTag.type];
 #if SUNOS_SPARC
@@ -831,7 +828,7 @@ void TIFF_FileWriter::ParseFileStream ( XMP_IO* fileRef )
 			InternalTagMap::iterator tagPos;
 			InternalTagMap::iterator tagEnd = thisIFD.tagMap.end();
 			for ( tagPos = thisIFD.tagMap.begin(); tagPos != tagEnd; ++tagPos ) {
-				InternalTagInfo & thisTag = tagPos->second;
+				InternalTagInfo & thisTag = *tagPos->second;
 				printf ( "      Tag %d, smallValue 0x%X, origDataLen %d, origDataOffset %d (0x%X)\n",
 						 thisTag.id, thisTag.smallValue, thisTag.origDataLen, thisTag.origDataOffset, thisTag.origDataOffset );
 			}
@@ -879,12 +876,12 @@ XMP_Uns32 TIFF_FileWriter::ProcessFileIFD ( XMP_Uns8 ifd, XMP_Uns32 ifdOffset, X
 
 	ifdInfo.origIFDOffset = ifdOffset;
 	ifdInfo.origCount  = tagCount1;
+	ifdInfo.tagMap.reserve ( tagCount1 );
 
 	// ---------------------------------------------------------------------------------------------
 	// First create all of the IFD map entries, capturing short values, and get the next IFD offset.
-	// We're using a std::map for storage, it automatically eliminates duplicates and provides
-	// sorted output. Plus the "map[key] = value" assignment conveniently keeps the last encountered
-	// value, following Photoshop's behavior.
+	// The tag map is kept sorted, it automatically eliminates duplicates and provides sorted output.
+	// A duplicate tag keeps the first encountered value.
 
 	XMP_Uns8* ifdPtr = &ifdBuffer[0];	// Move to the first IFD entry.
 
@@ -897,9 +894,7 @@ XMP_Uns32 TIFF_FileWriter::ProcessFileIFD ( XMP_Uns8 ifd, XMP_Uns32 ifdOffset, X
 		XMP_Uns16 tagID    = this->GetUns16 ( &rawTag->id );
 		XMP_Uns32 tagCnt = this->GetUns32 ( &rawTag->count );
 
-		InternalTagMap::value_type mapValue ( tagID, InternalTagInfo ( tagID, tagType, tagCnt, kIsFileBased ) );
-		InternalTagMap::iterator newPos = ifdInfo.tagMap.insert ( ifdInfo.tagMap.end(), mapValue );
-		InternalTagInfo& mapTag = newPos->second;
+		InternalTagInfo& mapTag = *ifdInfo.AddTag ( tagID, tagType, tagCnt, kIsFileBased );
 
 		mapTag.dataLen = mapTag.origDataLen = mapTag.count * (XMP_Uns32)kTIFF_TypeSizes[mapTag.type];
 		mapTag.smallValue = GetUns32AsIs ( &rawTag->dataOrOffset );	// Keep the value or offset in stream byte ordering.
@@ -933,7 +928,7 @@ XMP_Uns32 TIFF_FileWriter::ProcessFileIFD ( XMP_Uns8 ifd, XMP_Uns32 ifdOffset, X
 
 	for ( ; tagPos != tagEnd; ++tagPos ) {
 
-		InternalTagInfo* currTag = &tagPos->second;
+		InternalTagInfo* currTag = tagPos->second;
 
 		if ( currTag->dataLen <= 4 ) continue;	// Short values are already in the smallValue field.
 
@@ -980,9 +975,7 @@ void TIFF_FileWriter::IntegrateFromPShop6 ( const void * buriedPtr, size_t burie
 
 void* TIFF_FileWriter::CopyTagToMainIFD ( const TagInfo & ps6Tag, InternalIFDInfo * mainIFD )
 {
-	InternalTagMap::value_type mapValue ( ps6Tag.id, InternalTagInfo ( ps6Tag.id, ps6Tag.type, ps6Tag.count, this->fileParsed ) );
-	InternalTagMap::iterator newPos = mainIFD->tagMap.insert ( mainIFD->tagMap.end(), mapValue );
-	InternalTagInfo& newTag = newPos->second;
+	InternalTagInfo& newTag = *mainIFD->AddTag ( ps6Tag.id, ps6Tag.type, ps6Tag.count, this->fileParsed );
 
 	newTag.dataLen = ps6Tag.dataLen;
 
@@ -1000,7 +993,7 @@ void* TIFF_FileWriter::CopyTagToMainIFD ( const TagInfo & ps6Tag, InternalIFDInf
 
 	mainIFD->changed = true;
 
-	return newPos->second.dataPtr;	// ! Return the address within the map entry for small values.
+	return newTag.dataPtr;	// ! Return the address within the map entry for small values.
 
 }	// TIFF_FileWriter::CopyTagToMainIFD
 
@@ -1259,7 +1252,7 @@ XMP_Uns32 TIFF_FileWriter::DetermineVisibleLength()
 		InternalTagMap::iterator tagEnd = ifdInfo.tagMap.end();
 
 		for ( ; tagPos != tagEnd; ++tagPos ) {
-			InternalTagInfo & currTag ( tagPos->second );
+			InternalTagInfo & currTag ( *tagPos->second );
 			if ( currTag.dataLen > 4 ) visibleLength += ((currTag.dataLen + 1) & 0xFFFFFFFE);	// ! Round to even lengths.
 		}
 
@@ -1302,7 +1295,7 @@ XMP_Uns32 TIFF_FileWriter::DetermineAppendInfo ( XMP_Uns32 appendedOrigin,
 			InternalTagMap::iterator tagPos;
 			InternalTagMap::iterator tagEnd = thisIFD.tagMap.end();
 			for ( tagPos = thisIFD.tagMap.begin(); tagPos != tagEnd; ++tagPos ) {
-				InternalTagInfo & thisTag = tagPos->second;
+				InternalTagInfo & thisTag = *tagPos->second;
 				printf ( "      Tag %d, smallValue 0x%X, origDataLen %d, origDataOffset %d (0x%X)",
 						 thisTag.id, thisTag.smallValue, thisTag.origDataLen, thisTag.origDataOffset, thisTag.origDataOffset );
 				if ( thisTag.changed ) printf ( ", changed" );
@@ -1366,7 +1359,7 @@ XMP_Uns32 TIFF_FileWriter::DetermineAppendInfo ( XMP_Uns32 appendedOrigin,
 
 		for ( ; tagPos != tagEnd; ++tagPos ) {
 
-			InternalTagInfo & currTag ( tagPos->second );
+			InternalTagInfo & currTag ( *tagPos->second );
 			if ( (! (appendAll | currTag.changed)) || (currTag.dataLen <= 4) ) continue;
 
 			if ( (currTag.dataLen <= currTag.origDataLen) && (! appendAll) ) {
@@ -1406,7 +1399,7 @@ XMP_Uns32 TIFF_FileWriter::DetermineAppendInfo ( XMP_Uns32 appendedOrigin,
 			InternalTagMap::iterator tagPos;
 			InternalTagMap::iterator tagEnd = thisIFD.tagMap.end();
 			for ( tagPos = thisIFD.tagMap.begin(); tagPos != tagEnd; ++tagPos ) {
-				InternalTagInfo & thisTag = tagPos->second;
+				InternalTagInfo & thisTag = *tagPos->second;
 				printf ( "      Tag %d, smallValue 0x%X, origDataLen %d, origDataOffset %d (0x%X)",
 						 thisTag.id, thisTag.smallValue, thisTag.origDataLen, thisTag.origDataOffset, thisTag.origDataOffset );
 				if ( thisTag.changed ) printf ( ", changed" );
@@ -1495,7 +1488,7 @@ void TIFF_FileWriter::UpdateMemByAppend ( XMP_Uns8** newStream_out, XMP_Uns32* n
 
 			for ( ; tagPos != tagEnd; ++tagPos ) {
 
-				InternalTagInfo & currTag ( tagPos->second );
+				InternalTagInfo & currTag ( *tagPos->second );
 
 				this->PutUns16 ( currTag.id, ifdPtr );
 				ifdPtr += 2;
@@ -1883,7 +1876,7 @@ void TIFF_FileWriter::UpdateFileStream ( XMP_IO* fileRef, XMP_ProgressTracker* p
 			InternalTagMap::iterator tagEnd = thisIFD.tagMap.end();
 
 			for ( tagPos = thisIFD.tagMap.begin(); tagPos != tagEnd; ++tagPos ) {
-				InternalTagInfo & thisTag = tagPos->second;
+				InternalTagInfo & thisTag = *tagPos->second;
 				if ( (! thisTag.changed) || (thisTag.dataLen <= 4)  ) continue;
 				filesize += (thisTag.dataLen) ;
 			}
@@ -1921,7 +1914,7 @@ void TIFF_FileWriter::UpdateFileStream ( XMP_IO* fileRef, XMP_ProgressTracker* p
 		InternalTagMap::iterator tagEnd = thisIFD.tagMap.end();
 
 		for ( tagPos = thisIFD.tagMap.begin(); tagPos != tagEnd; ++tagPos ) {
-			InternalTagInfo & thisTag = tagPos->second;
+			InternalTagInfo & thisTag = *tagPos->second;
 			if ( (! thisTag.changed) || (thisTag.dataLen <= 4) || (thisTag.dataLen > thisTag.origDataLen) ) continue;
 			#if Trace_UpdateFileStream
 				printf ( "    Updating tag %d in IFD %d in-place at offset %d (0x%X)\n", thisTag.id, ifd, thisTag.origDataOffset, thisTag.origDataOffset );
@@ -1957,7 +1950,7 @@ void TIFF_FileWriter::UpdateFileStream ( XMP_IO* fileRef, XMP_ProgressTracker* p
 		InternalTagMap::iterator tagEnd = thisIFD.tagMap.end();
 
 		for ( tagPos = thisIFD.tagMap.begin(); tagPos != tagEnd; ++tagPos ) {
-			InternalTagInfo & thisTag = tagPos->second;
+			InternalTagInfo & thisTag = *tagPos->second;
 			if ( (! thisTag.changed) || (thisTag.dataLen <= 4) || (thisTag.dataLen <= thisTag.origDataLen) ) continue;
 			#if Trace_UpdateFileStream
 				XMP_Uns32 newOffset = this->GetUns32(&thisTag.origDataOffset);
@@ -1999,7 +1992,7 @@ void TIFF_FileWriter::UpdateFileStream ( XMP_IO* fileRef, XMP_ProgressTracker* p
 		InternalTagMap::iterator tagEnd = thisIFD.tagMap.end();
 
 		for ( tagPos = thisIFD.tagMap.begin(); tagPos != tagEnd; ++tagPos ) {
-			InternalTagInfo & thisTag = tagPos->second;
+			InternalTagInfo & thisTag = *tagPos->second;
 			if ( ! thisTag.changed ) continue;
 			thisTag.changed = false;
 			thisTag.origDataLen = thisTag.dataLen;
@@ -2032,7 +2025,7 @@ void TIFF_FileWriter::WriteFileIFD ( XMP_IO* fileRef, InternalIFDInfo & thisIFD
 
 	for ( tagPos = thisIFD.tagMap.begin(); tagPos != tagEnd; ++tagPos ) {
 
-		InternalTagInfo & thisTag = tagPos->second;
+		InternalTagInfo & thisTag = *tagPos->second;
 		RawIFDEntry ifdEntry;
 
 		this->PutUns16 ( thisTag.id, &ifdEntry.id );
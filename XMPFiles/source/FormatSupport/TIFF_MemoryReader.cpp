@@ -205,6 +205,7 @@ XMP_Uns32 TIFF_MemoryReader::GetValueOffset ( XMP_Uns8 ifd, XMP_Uns16 id ) const
 	if ( thisTag == 0 ) return 0;
 
 	XMP_Uns8 * valuePtr = (XMP_Uns8*) this->GetDataPtr ( thisTag );
+	if ( valuePtr == 0 ) return 0;
 
 	return (XMP_Uns32)(valuePtr - this->tiffStream);	// ! TIFF streams can't exceed 4GB.
 
@@ -425,6 +426,7 @@ bool TIFF_MemoryReader::GetTag_Rational ( XMP_Uns8 ifd, XMP_Uns16 id, Rational*
 
 	if ( data != 0 ) {
 		XMP_Uns32* dataPtr = (XMP_Uns32*) this->GetDataPtr ( thisTag );
+		if ( dataPtr == 0 ) return false;
 		data->num = this->GetUns32 ( dataPtr );
 		data->denom = this->GetUns32 ( dataPtr+1 );
 	}
@@ -445,6 +447,7 @@ bool TIFF_MemoryReader::GetTag_SRational ( XMP_Uns8 ifd, XMP_Uns16 id, SRational
 
 	if ( data != 0 ) {
 		XMP_Uns32* dataPtr = (XMP_Uns32*) this->GetDataPtr ( thisTag );
+		if ( dataPtr == 0 ) return false;
 		data->num = (XMP_Int32) this->GetUns32 ( dataPtr );
 		data->denom = (XMP_Int32) this->GetUns32 ( dataPtr+1 );
 	}
@@ -483,6 +486,7 @@ bool TIFF_MemoryReader::GetTag_Double ( XMP_Uns8 ifd, XMP_Uns16 id, double* data
 
 	if ( data != 0 ) {
 		double* dataPtr = (double*) this->GetDataPtr ( thisTag );
+		if ( dataPtr == 0 ) return false;
 		*data = this->GetDouble ( dataPtr );
 	}
 
@@ -500,8 +504,11 @@ bool TIFF_MemoryReader::GetTag_ASCII ( XMP_Uns8 ifd, XMP_Uns16 id, XMP_StringPtr
 	if ( thisTag == 0 ) return false;
 	if ( thisTag->type != kTIFF_ASCIIType ) return false;
 
+	const void* valuePtr = this->GetDataPtr ( thisTag );
+	if ( valuePtr == 0 ) return false;
+
 	if ( dataPtr != 0 ) {
-		*dataPtr = (XMP_StringPtr) this->GetDataPtr ( thisTag );
+		*dataPtr = (XMP_StringPtr) valuePtr;
 	}
 
 	if ( dataLen != 0 ) *dataLen = thisTag->bytes;
@@ -522,7 +529,10 @@ bool TIFF_MemoryReader::GetTag_EncodedString ( XMP_Uns8 ifd, XMP_Uns16 id, std::
 
 	if ( utf8Str == 0 ) return true;	// Return true if the converted string is not wanted.
 
-	bool ok = this->DecodeString ( this->GetDataPtr ( thisTag ), thisTag->bytes, utf8Str );
+	const void* valuePtr = this->GetDataPtr ( thisTag );
+	if ( valuePtr == 0 ) return false;
+
+	bool ok = this->DecodeString ( valuePtr, thisTag->bytes, utf8Str );
 	return ok;
 
 }	// TIFF_MemoryReader::GetTag_EncodedString
@@ -601,13 +611,13 @@ void TIFF_MemoryReader::ParseMemoryStream ( const void* data, XMP_Uns32 length,
 	}
 
 	const TweakedIFDEntry* exifIFDTag = this->FindTagInIFD ( kTIFF_PrimaryIFD, kTIFF_ExifIFDPointer );
-	if ( (exifIFDTag != 0) && (exifIFDTag->type == kTIFF_LongType) && (GetUns32AsIs(&exifIFDTag->bytes) == 4) ) {
+	if ( (exifIFDTag != 0) && ((exifIFDTag->type == kTIFF_LongType) || (exifIFDTag->type == kTIFF_IFDType)) && (GetUns32AsIs(&exifIFDTag->bytes) == 4) ) {
 		XMP_Uns32 exifOffset = this->GetUns32 ( &exifIFDTag->dataOrPos );
 		(void) this->ProcessOneIFD ( exifOffset, kTIFF_ExifIFD );
 	}
 
 	const TweakedIFDEntry* gpsIFDTag = this->FindTagInIFD ( kTIFF_PrimaryIFD, kTIFF_GPSInfoIFDPointer );
-	if ( (gpsIFDTag != 0) && (gpsIFDTag->type == kTIFF_LongType) && (GetUns32AsIs(&gpsIFDTag->bytes) == 4) ) {
+	if ( (gpsIFDTag != 0) && ((gpsIFDTag->type == kTIFF_LongType) || (gpsIFDTag->type == kTIFF_IFDType)) && (GetUns32AsIs(&gpsIFDTag->bytes) == 4) ) {
 		XMP_Uns32 gpsOffset = this->GetUns32 ( &gpsIFDTag->dataOrPos );
 		if ( IsOffsetValid ( gpsOffset, 8, ifdLimit ) ) {	// Ignore a bad GPS IFD offset.
 			(void) this->ProcessOneIFD ( gpsOffset, kTIFF_GPSInfoIFD );
@@ -618,7 +628,7 @@ void TIFF_MemoryReader::ParseMemoryStream ( const void* data, XMP_Uns32 length,
 	}
 
 	const TweakedIFDEntry* interopIFDTag = this->FindTagInIFD ( kTIFF_ExifIFD, kTIFF_InteroperabilityIFDPointer );
-	if ( (interopIFDTag != 0) && (interopIFDTag->type == kTIFF_LongType) && (GetUns32AsIs(&interopIFDTag->bytes) == 4) ) {
+	if ( (interopIFDTag != 0) && ((interopIFDTag->type == kTIFF_LongType) || (interopIFDTag->type == kTIFF_IFDType)) && (GetUns32AsIs(&interopIFDTag->bytes) == 4) ) {
 		XMP_Uns32 interopOffset = this->GetUns32 ( &interopIFDTag->dataOrPos );
 		if ( IsOffsetValid ( interopOffset, 8, ifdLimit ) ) {	// Ignore a bad Interoperability IFD offset.
 			(void) this->ProcessOneIFD ( interopOffset, kTIFF_InteropIFD );
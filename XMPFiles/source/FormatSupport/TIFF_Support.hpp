@@ -12,7 +12,11 @@
 
 #include "public/include/XMP_Environment.h"	// ! This must be the first include.
 
+#include <algorithm>
+#include <deque>
 #include <map>
+#include <new>
+#include <vector>
 #include <stdlib.h>
 #include <string.h>
 
@@ -477,6 +481,68 @@ static const XMP_Uns16* sKnownTags[kTIFF_KnownIFDCount] = { sKnownPrimaryIFDTags
 // =================================================================================================
 
 
+// =================================================================================================
+// TIFF_TagMap
+// ===========
+//
+// A map from tag number to T, kept as a vector sorted by tag number. This is used instead of a
+// std::map for the IFDs. The reconciliation probes a few hundred tag numbers per file, a binary
+// search over contiguous entries beats chasing tree nodes. Parsing inserts in tag order, that is
+// an append without a node allocation per tag. Only the std::map operations needed for the IFDs
+// are provided. Unlike a std::map, inserts and erases move the entries, iterators and entry
+// addresses are only stable while the map is not changed.
+
+template <class T>
+class TIFF_TagMap {
+public:
+
+	typedef std::pair<XMP_Uns16,T> value_type;
+	typedef typename std::vector<value_type>::iterator       iterator;
+	typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+	iterator       begin()       { return this->entries.begin(); };
+	iterator       end()         { return this->entries.end(); };
+	const_iterator begin() const { return this->entries.begin(); };
+	const_iterator end()   const { return this->entries.end(); };
+
+	size_t size()  const { return this->entries.size(); };
+	bool   empty() const { return this->entries.empty(); };
+	void   clear()       { this->entries.clear(); };
+	void   reserve ( size_t count ) { this->entries.reserve ( count ); };
+
+	iterator lower_bound ( XMP_Uns16 id )
+		{ return std::lower_bound ( this->entries.begin(), this->entries.end(), id, KeyLess ); };
+	const_iterator lower_bound ( XMP_Uns16 id ) const
+		{ return std::lower_bound ( this->entries.begin(), this->entries.end(), id, KeyLess ); };
+
+	iterator find ( XMP_Uns16 id )
+		{ iterator pos = this->lower_bound ( id ); return ((pos != this->end()) && (pos->first == id)) ? pos : this->end(); };
+	const_iterator find ( XMP_Uns16 id ) const
+		{ const_iterator pos = this->lower_bound ( id ); return ((pos != this->end()) && (pos->first == id)) ? pos : this->end(); };
+
+	std::pair<iterator,bool> insert ( const value_type & value )	// ! Like std::map, an existing entry is kept.
+	{
+		if ( this->entries.empty() || (this->entries.back().first < value.first) ) {	// The common case when parsing.
+			this->entries.push_back ( value );
+			return std::make_pair ( this->entries.end() - 1, true );
+		}
+		iterator pos = this->lower_bound ( value.first );
+		if ( (pos != this->end()) && (pos->first == value.first) ) return std::make_pair ( pos, false );
+		return std::make_pair ( this->entries.insert ( pos, value ), true );
+	};
+
+	T & operator[] ( XMP_Uns16 id ) { return this->insert ( value_type ( id, T() ) ).first->second; };
+
+	void erase ( iterator pos ) { this->entries.erase ( pos ); };
+
+private:
+
+	static bool KeyLess ( const value_type & entry, XMP_Uns16 id ) { return entry.first < id; };
+
+	std::vector<value_type> entries;
+
+};	// TIFF_TagMap
+
 // =================================================================================================
 // TIFF_Manager
 // ============
@@ -505,7 +571,7 @@ public:
 			: id(_id), type(_type), count(_count), dataPtr(_dataPtr), dataLen(_dataLen) {};
 	};
 
-	typedef std::map<XMP_Uns16,TagInfo> TagInfoMap;
+	typedef TIFF_TagMap<TagInfo> TagInfoMap;
 
 	struct Rational  { XMP_Uns32 num, denom; };
 	struct SRational { XMP_Int32 num, denom; };
@@ -808,7 +874,7 @@ private:
 		  	return &tifdEntry->dataOrPos;
 		  } else {
 			XMP_Uns32 pos = GetUns32AsIs(&tifdEntry->dataOrPos);
-			if (pos + GetUns32AsIs (&tifdEntry->bytes) > this->tiffLength) {
+			if (((XMP_Uns64)pos + GetUns32AsIs (&tifdEntry->bytes)) > this->tiffLength) {
 				// Invalid file.
 				// The data is past the length of the TIFF.
 				return NULL;
@@ -956,7 +1022,12 @@ private:
 
 	};
 
-	typedef std::map<XMP_Uns16,InternalTagInfo> InternalTagMap;
+	// The tag map is a sorted index into the tag store. The store is a deque so that adding a tag
+	// never moves the others, the dataPtr of a small value points into its InternalTagInfo and is
+	// handed out by GetTag. A deleted tag's data is released and its slot goes on the free list, the
+	// next added tag reuses it. Repeated delete and add cycles don't grow the store.
+
+	typedef TIFF_TagMap<InternalTagInfo*> InternalTagMap;
 
 	struct InternalIFDInfo {
 		bool changed;
@@ -964,6 +1035,8 @@ private:
 		XMP_Uns32 origIFDOffset;	// Original stream offset of the IFD.
 		XMP_Uns32 origNextIFD;		// Original stream offset of the following IFD.
 		InternalTagMap tagMap;
+		std::deque<InternalTagInfo> tagStore;
+		std::vector<InternalTagInfo*> freeTags;	// Unused slots of the tag store.
 		InternalIFDInfo() : changed(false), origCount(0), origIFDOffset(0), origNextIFD(0) {};
 		inline void clear()
 		{
@@ -971,6 +1044,31 @@ private:
 			this->origCount = 0;
 			this->origIFDOffset = this->origNextIFD = 0;
 			this->tagMap.clear();
+			this->tagStore.clear();
+			this->freeTags.clear();
+		};
+		inline InternalTagInfo* AddTag ( XMP_Uns16 id, XMP_Uns16 type, XMP_Uns32 count, bool fileBased )
+		{	// ! Like std::map::insert, returns an existing tag unchanged.
+			InternalTagMap::iterator tagPos = this->tagMap.lower_bound ( id );
+			if ( (tagPos != this->tagMap.end()) && (tagPos->first == id) ) return tagPos->second;
+			InternalTagInfo* newTag;
+			if ( this->freeTags.empty() ) {
+				this->tagStore.emplace_back ( id, type, count, fileBased );
+				newTag = &this->tagStore.back();
+			} else {
+				newTag = this->freeTags.back();
+				this->freeTags.pop_back();
+				newTag->~InternalTagInfo();	// ! The data is already released, this is for form.
+				new ( newTag ) InternalTagInfo ( id, type, count, fileBased );
+			}
+			(void) this->tagMap.insert ( InternalTagMap::value_type ( id, newTag ) );
+			return newTag;
+		};
+		inline void DeleteTag ( InternalTagMap::iterator tagPos )
+		{
+			tagPos->second->FreeData();
+			this->freeTags.push_back ( tagPos->second );
+			this->tagMap.erase ( tagPos );
 		};
 	};
 
@@ -23,10 +23,12 @@
 
 
 #include "XMPFiles/source/FormatSupport/XMPScanner.hpp"
+#include "source/SSE2Utils.hpp"
 
 #include <cassert>
 #include <string>
 #include <cstdlib>
+#include <cstring>
 
 #if DEBUG
 	#include <iostream>
@@ -169,6 +171,82 @@ XMPScanner::PacketMachine::ResetMachine ()
 
 }	// ResetMachine
 
+// =================================================================================================
+// IsHeadCandidate
+// ===============
+//
+// Decides if the '<' at ptr could begin a packet header. The header's '<' is followed by 0, 1, or 3
+// nulls and then the '?' of kPacketHead, for the 8, 16, and 32 bit forms. Any other '<' fails in
+// RecordStart or at the '?', with the search resuming at the failing byte. Nothing between the '<'
+// and that byte is another '<', so skipping the '<' right away gives the same result. A '<' too
+// close to the end of the buffer to decide is accepted, the state machine handles the split.
+
+static inline bool IsHeadCandidate ( const char * ptr, const char * limit )
+{
+	const size_t available = (size_t) (limit - ptr);
+
+	if ( available < 2 ) return true;
+	if ( ptr[1] == '?' ) return true;
+	if ( ptr[1] != 0 ) return false;
+
+	if ( available < 3 ) return true;
+	if ( ptr[2] == '?' ) return true;
+	if ( ptr[2] != 0 ) return false;
+
+	if ( available < 5 ) return true;
+	return ( (ptr[3] == 0) && (ptr[4] == '?') );
+
+}	// IsHeadCandidate
+
+// =================================================================================================
+// FindHeadCandidate
+// =================
+//
+// Returns the first '<' in [ptr, limit) that passes IsHeadCandidate, or limit if there is none.
+// Most of a large file has no packet at all, so this is where the packet scanning time goes. With
+// SSE2 a 16 byte block is compared against '<', and the blocks 1, 2, and 4 bytes later against '?'.
+// Only the positions where both hit are looked at individually. Otherwise memchr is used, which
+// the C libraries vectorize for the platform.
+
+static const char * FindHeadCandidate ( const char * ptr, const char * limit )
+{
+
+	#if XMP_UseSSE2
+
+		const __m128i lessThan = _mm_set1_epi8 ( '<' );
+		const __m128i question = _mm_set1_epi8 ( '?' );
+
+		for ( ; (limit - ptr) >= (16 + 4); ptr += 16 ) {
+
+			const __m128i block = _mm_loadu_si128 ( (const __m128i *) ptr );
+			unsigned int mask = (unsigned int) _mm_movemask_epi8 ( _mm_cmpeq_epi8 ( block, lessThan ) );
+			if ( mask == 0 ) continue;
+
+			__m128i next = _mm_cmpeq_epi8 ( _mm_loadu_si128 ( (const __m128i *) (ptr + 1) ), question );
+			next = _mm_or_si128 ( next, _mm_cmpeq_epi8 ( _mm_loadu_si128 ( (const __m128i *) (ptr + 2) ), question ) );
+			next = _mm_or_si128 ( next, _mm_cmpeq_epi8 ( _mm_loadu_si128 ( (const __m128i *) (ptr + 4) ), question ) );
+			mask &= (unsigned int) _mm_movemask_epi8 ( next );
+
+			for ( ; mask != 0; mask &= (mask - 1) ) {
+				const char * candidate = ptr + FirstBitIndex ( mask );
+				if ( IsHeadCandidate ( candidate, limit ) ) return candidate;
+			}
+
+		}
+
+	#endif
+
+	while ( ptr < limit ) {
+		const char * candidate = (const char *) memchr ( ptr, '<', (size_t) (limit - ptr) );
+		if ( candidate == 0 ) break;
+		if ( IsHeadCandidate ( candidate, limit ) ) return candidate;
+		ptr = candidate + 1;
+	}
+
+	return limit;
+
+}	// FindHeadCandidate
+
 // =================================================================================================
 // FindLessThan
 // ============
@@ -186,10 +264,8 @@ XMPScanner::PacketMachine::FindLessThan ( PacketMachine * ths, const char * whic
 		ths->fCharForm = eChar8Bit;	// We might have just failed from a bogus 16 or 32 bit case.
 		ths->fBytesPerChar = 1;
 
-		while ( ths->fBufferPtr < ths->fBufferLimit ) {	// Don't skip nulls for the header's '<'!
-			if ( *ths->fBufferPtr == '<' ) break;
-			ths->fBufferPtr++;
-		}
+		if ( ths->fBufferPtr >= ths->fBufferLimit ) return eTriNo;	// ! The pointer can be past the limit.
+		ths->fBufferPtr = FindHeadCandidate ( ths->fBufferPtr, ths->fBufferLimit );	// Don't skip nulls for the header's '<'!
 
 		if ( ths->fBufferPtr >= ths->fBufferLimit ) return eTriNo;
 		ths->fBufferPtr++;
@@ -204,6 +280,11 @@ XMPScanner::PacketMachine::FindLessThan ( PacketMachine * ths, const char * whic
 
 		const int bytesPerChar = ths->fBytesPerChar;
 
+		if ( (bytesPerChar == 1) && (ths->fBufferPtr < ths->fBufferLimit) ) {
+			const char * lessThan = (const char *) memchr ( ths->fBufferPtr, '<', (size_t) (ths->fBufferLimit - ths->fBufferPtr) );
+			ths->fBufferPtr = (lessThan != 0) ? lessThan : ths->fBufferLimit;
+		}
+
 		while ( ths->fBufferPtr < ths->fBufferLimit ) {
 			if ( *ths->fBufferPtr == '<' ) break;
 			ths->fBufferPtr += bytesPerChar;
@@ -1422,6 +1503,26 @@ XMPScanner::Scan ( const void * bufferOrigin, XMP_Int64 bufferOffset, XMP_Int64
 
 }	// Scan
 
+// =================================================================================================
+// PendingPacket
+// =============
+//
+// The last snip that has been seen is the one that input would be merged with by the next Scan.
+
+bool
+XMPScanner::PendingPacket ( XMP_Int64 * packetStart )
+{
+	InternalSnipList::reverse_iterator	snipPos	= fInternalSnips.rbegin();
+	InternalSnipList::reverse_iterator	endPos	= fInternalSnips.rend();
+
+	while ( (snipPos != endPos) && (snipPos->fInfo.fState == eNotSeenSnip) ) ++snipPos;
+	if ( (snipPos == endPos) || (snipPos->fInfo.fState != ePartialPacketSnip) ) return false;
+
+	*packetStart = snipPos->fInfo.fOffset;
+	return true;
+
+}	// PendingPacket
+
 // =================================================================================================
 // Report
 // ======
@@ -141,6 +141,10 @@ public:
 	void Report ( SnipInfoVector & snips );
 	// Produces a report of what is known about the input stream. 
 
+	bool PendingPacket ( XMP_Int64 * packetStart );
+	// Returns true if the input seen so far ends within a possible packet, whose start is returned.
+	// A scan that stops here and resumes with a new scanner would not find that packet.
+
 	class ScanError : public std::logic_error {
 	public:
 		ScanError() throw() : std::logic_error ( "" ) {}
@@ -134,29 +134,29 @@ void HandlerRegistry::initialize()
 	// Register the file-oriented handlers that don't want to open and close the file themselves.
 
 #if EnablePhotoHandlers
-	allOK &= this->registerNormalHandler ( kXMP_JPEGFile, kJPEG_HandlerFlags, JPEG_CheckFormat, JPEG_MetaHandlerCTor );
-	allOK &= this->registerNormalHandler ( kXMP_PhotoshopFile, kPSD_HandlerFlags, PSD_CheckFormat, PSD_MetaHandlerCTor );
-	allOK &= this->registerNormalHandler ( kXMP_TIFFFile, kTIFF_HandlerFlags, TIFF_CheckFormat, TIFF_MetaHandlerCTor );
-	allOK &= this->registerNormalHandler( kXMP_GIFFile, kGIF_HandlerFlags, GIF_CheckFormat, GIF_MetaHandlerCTor );
+	allOK &= this->registerNormalHandler ( kXMP_JPEGFile, kJPEG_HandlerFlags, JPEG_CheckFormat, JPEG_MetaHandlerCTor, false, kJPEG_Signatures );
+	allOK &= this->registerNormalHandler ( kXMP_PhotoshopFile, kPSD_HandlerFlags, PSD_CheckFormat, PSD_MetaHandlerCTor, false, kPSD_Signatures );
+	allOK &= this->registerNormalHandler ( kXMP_TIFFFile, kTIFF_HandlerFlags, TIFF_CheckFormat, TIFF_MetaHandlerCTor, false, kTIFF_Signatures );
+	allOK &= this->registerNormalHandler( kXMP_GIFFile, kGIF_HandlerFlags, GIF_CheckFormat, GIF_MetaHandlerCTor, false, kGIF_Signatures );
 #endif
 
 #if EnableDynamicMediaHandlers
-	allOK &= this->registerNormalHandler ( kXMP_WMAVFile, kASF_HandlerFlags, ASF_CheckFormat, ASF_MetaHandlerCTor );
-	allOK &= this->registerNormalHandler ( kXMP_MP3File, kMP3_HandlerFlags, MP3_CheckFormat, MP3_MetaHandlerCTor );
-	allOK &= this->registerNormalHandler ( kXMP_WAVFile, kWAVE_HandlerFlags, WAVE_CheckFormat, WAVE_MetaHandlerCTor );
-	allOK &= this->registerNormalHandler ( kXMP_AVIFile, kRIFF_HandlerFlags, RIFF_CheckFormat, RIFF_MetaHandlerCTor );
-	allOK &= this->registerNormalHandler ( kXMP_WEBPFile, kWEBP_HandlerFlags, WEBP_CheckFormat, WEBP_MetaHandlerCTor );
-	allOK &= this->registerNormalHandler ( kXMP_SWFFile, kSWF_HandlerFlags, SWF_CheckFormat, SWF_MetaHandlerCTor );
+	allOK &= this->registerNormalHandler ( kXMP_WMAVFile, kASF_HandlerFlags, ASF_CheckFormat, ASF_MetaHandlerCTor, false, kASF_Signatures );
+	allOK &= this->registerNormalHandler ( kXMP_MP3File, kMP3_HandlerFlags, MP3_CheckFormat, MP3_MetaHandlerCTor, false, kMP3_Signatures );
+	allOK &= this->registerNormalHandler ( kXMP_WAVFile, kWAVE_HandlerFlags, WAVE_CheckFormat, WAVE_MetaHandlerCTor, false, kWAVE_Signatures );
+	allOK &= this->registerNormalHandler ( kXMP_AVIFile, kRIFF_HandlerFlags, RIFF_CheckFormat, RIFF_MetaHandlerCTor, false, kAVI_Signatures );
+	allOK &= this->registerNormalHandler ( kXMP_WEBPFile, kWEBP_HandlerFlags, WEBP_CheckFormat, WEBP_MetaHandlerCTor, false, kWEBP_Signatures );
+	allOK &= this->registerNormalHandler ( kXMP_SWFFile, kSWF_HandlerFlags, SWF_CheckFormat, SWF_MetaHandlerCTor, false, kSWF_Signatures );
 	allOK &= this->registerNormalHandler ( kXMP_MPEG4File, kMPEG4_HandlerFlags, MPEG4_CheckFormat, MPEG4_MetaHandlerCTor );
 	allOK &= this->registerNormalHandler ( kXMP_MOVFile, kMPEG4_HandlerFlags, MPEG4_CheckFormat, MPEG4_MetaHandlerCTor );	// ! Yes, MPEG-4 includes MOV.
-	allOK &= this->registerNormalHandler ( kXMP_FLVFile, kFLV_HandlerFlags, FLV_CheckFormat, FLV_MetaHandlerCTor );
-	allOK &= this->registerNormalHandler ( kXMP_AIFFFile, kAIFF_HandlerFlags, AIFF_CheckFormat, AIFF_MetaHandlerCTor );
+	allOK &= this->registerNormalHandler ( kXMP_FLVFile, kFLV_HandlerFlags, FLV_CheckFormat, FLV_MetaHandlerCTor, false, kFLV_Signatures );
+	allOK &= this->registerNormalHandler ( kXMP_AIFFFile, kAIFF_HandlerFlags, AIFF_CheckFormat, AIFF_MetaHandlerCTor, false, kAIFF_Signatures );
 #endif
 
 #if EnableMiscHandlers
-	allOK &= this->registerNormalHandler ( kXMP_InDesignFile, kInDesign_HandlerFlags, InDesign_CheckFormat, InDesign_MetaHandlerCTor );
-	allOK &= this->registerNormalHandler ( kXMP_PNGFile, kPNG_HandlerFlags, PNG_CheckFormat, PNG_MetaHandlerCTor );
-	allOK &= this->registerNormalHandler ( kXMP_UCFFile, kUCF_HandlerFlags, UCF_CheckFormat, UCF_MetaHandlerCTor );
+	allOK &= this->registerNormalHandler ( kXMP_InDesignFile, kInDesign_HandlerFlags, InDesign_CheckFormat, InDesign_MetaHandlerCTor, false, kInDesign_Signatures );
+	allOK &= this->registerNormalHandler ( kXMP_PNGFile, kPNG_HandlerFlags, PNG_CheckFormat, PNG_MetaHandlerCTor, false, kPNG_Signatures );
+	allOK &= this->registerNormalHandler ( kXMP_UCFFile, kUCF_HandlerFlags, UCF_CheckFormat, UCF_MetaHandlerCTor, false, kUCF_Signatures );
 	// ! EPS and PostScript have the same handler, EPS is a proper subset of PostScript.
 	allOK &= this->registerNormalHandler ( kXMP_EPSFile, kPostScript_HandlerFlags, PostScript_CheckFormat, PostScript_MetaHandlerCTor );
 	allOK &= this->registerNormalHandler ( kXMP_PostScriptFile, kPostScript_HandlerFlags, PostScript_CheckFormat, PostScript_MetaHandlerCTor );
@@ -240,7 +240,8 @@ bool HandlerRegistry::registerNormalHandler( XMP_FileFormat			format,
 										     XMP_OptionBits			flags,
 										     CheckFileFormatProc	checkProc,
 											 XMPFileHandlerCTor		handlerCTor,
-											 bool					replaceExisting /*= false*/ )
+											 bool					replaceExisting /*= false*/,
+											 const XMPFileSignature *	signatures /*= 0*/ )
 {
 	XMP_Assert ( format != kXMP_UnknownFile );
 
@@ -286,8 +287,9 @@ bool HandlerRegistry::registerNormalHandler( XMP_FileFormat			format,
 	//
 	// register handler
 	//
-	XMPFileHandlerInfo handlerInfo ( format, flags, checkProc, handlerCTor );
+	XMPFileHandlerInfo handlerInfo ( format, flags, checkProc, handlerCTor, signatures );
 	mNormalHandlers->insert ( mNormalHandlers->end(), XMPFileHandlerTablePair ( format, handlerInfo ) );
+	this->compileSignatures();
 	return true;
 
 }	// HandlerRegistry::registerNormalHandler
@@ -367,6 +369,7 @@ void HandlerRegistry::removeHandler ( XMP_FileFormat format ) {
 	if ( handlerPos != mNormalHandlers->end() ) {
 		mNormalHandlers->erase ( handlerPos );
 		XMP_Assert ( ! this->getFormatInfo ( format ) );
+		this->compileSignatures();
 		return;
 	}
 
@@ -381,6 +384,100 @@ void HandlerRegistry::removeHandler ( XMP_FileFormat format ) {
 
 // =================================================================================================
 
+void HandlerRegistry::compileSignatures()
+{
+	for ( size_t i = 0; i < 256; ++i ) mSignaturesByFirst[i].clear();
+	mSignaturesAnyFirst.clear();
+
+	XMPFileHandlerTablePos handlerPos = mNormalHandlers->begin();
+
+	for ( ; handlerPos != mNormalHandlers->end(); ++handlerPos ) {
+
+		const XMPFileSignature * signature = handlerPos->second.signatures;
+		if ( signature == 0 ) continue;
+
+		for ( ; signature->bytes != 0; ++signature ) {
+
+			XMP_Assert ( (0 < signature->length) && (signature->length <= kSignatureBlockSize) );
+
+			SignatureEntry entry;
+			entry.format = handlerPos->first;
+			entry.signature = signature;
+
+			if ( (signature->mask != 0) && (signature->mask[0] == '?') ) {
+				mSignaturesAnyFirst.push_back ( entry );
+			} else {
+				mSignaturesByFirst[(XMP_Uns8)signature->bytes[0]].push_back ( entry );
+			}
+
+		}
+
+	}
+
+}	// HandlerRegistry::compileSignatures
+
+// =================================================================================================
+
+static bool MatchOneSignature ( const XMPFileSignature * signature, const XMP_Uns8 * header, XMP_Uns32 headerLen )
+{
+	if ( headerLen < signature->length ) return false;
+
+	for ( XMP_Uns8 i = 0; i < signature->length; ++i ) {
+		if ( (signature->mask != 0) && (signature->mask[i] == '?') ) continue;
+		if ( header[i] != (XMP_Uns8)signature->bytes[i] ) return false;
+	}
+
+	return true;
+
+}	// MatchOneSignature
+
+// =================================================================================================
+
+int HandlerRegistry::SignatureMatches::find ( XMP_FileFormat format ) const
+{
+	for ( XMP_Uns32 i = 0; i < this->count; ++i ) {
+		if ( this->formats[i] == format ) return (int)i;
+	}
+	return -1;
+
+}	// HandlerRegistry::SignatureMatches::find
+
+// =================================================================================================
+
+bool HandlerRegistry::matchSignatures ( const XMP_Uns8 * header, XMP_Uns32 headerLen, SignatureMatches * matches ) const
+{
+	matches->count = 0;
+	if ( headerLen == 0 ) return true;
+
+	const SignatureList * lists[2] = { &mSignaturesByFirst[header[0]], &mSignaturesAnyFirst };
+
+	for ( size_t l = 0; l < 2; ++l ) {
+
+		SignatureList::const_iterator entryPos = lists[l]->begin();
+
+		for ( ; entryPos != lists[l]->end(); ++entryPos ) {
+
+			if ( ! MatchOneSignature ( entryPos->signature, header, headerLen ) ) continue;
+
+			int index = matches->find ( entryPos->format );
+			if ( index < 0 ) {
+				if ( matches->count == kMaxSignatureMatches ) return false;
+				index = (int)matches->count++;
+				matches->formats[index] = entryPos->format;
+				matches->conclusive[index] = false;
+			}
+			if ( entryPos->signature->conclusive ) matches->conclusive[index] = true;
+
+		}
+
+	}
+
+	return true;
+
+}	// HandlerRegistry::matchSignatures
+
+// =================================================================================================
+
 XMP_FileFormat HandlerRegistry::getFileFormat( const std::string & fileExt, bool addIfNotFound /*= false*/ )
 {
 	if ( ! fileExt.empty() ) {
@@ -489,6 +586,22 @@ XMPFileHandlerInfo* HandlerRegistry::pickDefaultHandler ( XMP_FileFormat format,
 
 // =================================================================================================
 
+// Reads the first bytes of the session's file once, for the signature matching and for the
+// CheckProcs through XMPFiles::ReadFileHeader.
+
+static void PrefetchFileHeader ( XMPFiles * session )
+{
+	if ( (session->ioRef == 0) || (session->fileHeaderIO == session->ioRef) ) return;
+
+	session->ioRef->Rewind();
+	session->fileHeaderLen = session->ioRef->Read ( session->fileHeader, XMPFiles::kFileHeaderSize );
+	session->ioRef->Rewind();
+	session->fileHeaderIO = session->ioRef;
+
+}	// PrefetchFileHeader
+
+// =================================================================================================
+
 XMPFileHandlerInfo* HandlerRegistry::selectSmartHandler( XMPFiles* session, XMP_StringPtr clientPath, XMP_FileFormat format, XMP_OptionBits openFlags )
 {
 
@@ -611,6 +724,7 @@ XMPFileHandlerInfo* HandlerRegistry::selectSmartHandler( XMPFiles* session, XMP_
 
 	session->format	= kXMP_UnknownFile;	// Make sure it is preset for later checks.
 	session->openFlags = openFlags;
+	session->fileHeaderIO = 0;	// ! A new file might have the address of a deleted one.
 
 	// If the client passed in a format, try that first.
 
@@ -660,6 +774,7 @@ XMPFileHandlerInfo* HandlerRegistry::selectSmartHandler( XMPFiles* session, XMP_
 
 				if( tryThisHandler ) 
 				{
+					PrefetchFileHeader ( session );
 					CheckFileFormatProc CheckProc = (CheckFileFormatProc) (handlerInfo->checkProc);
 					foundHandler = CheckProc ( format, clientPath, session->ioRef, session );
 				}
@@ -763,9 +878,11 @@ XMPFileHandlerInfo* HandlerRegistry::selectSmartHandler( XMPFiles* session, XMP_
 			{
 				delete session->ioRef;	// Close is implicit in the destructor.
 				session->ioRef = 0;
+				session->fileHeaderIO = 0;
 			}
 			
 			session->format = handlerInfo->format;	// ! Hack to tell the CheckProc this is an initial call.
+			PrefetchFileHeader ( session );
 			CheckFileFormatProc CheckProc = (CheckFileFormatProc) (handlerInfo->checkProc);
 			foundHandler = CheckProc ( handlerInfo->format, clientPath, session->ioRef, session );
 			XMP_Assert ( foundHandler || (session->tempPtr == 0) );
@@ -782,12 +899,28 @@ XMPFileHandlerInfo* HandlerRegistry::selectSmartHandler( XMPFiles* session, XMP_
 		if ( session->ioRef == 0 ) return 0;
 	}
 	
+	// Match the leading bytes against the compiled handler signatures. A handler that declares
+	// signatures can only accept a file that starts with one of them, so its CheckProc is skipped
+	// unless one matched. A conclusive match selects the handler without calling the CheckProc.
+	// If too many formats match, fall back to calling every CheckProc. The CheckProcs get the same
+	// bytes through XMPFiles::ReadFileHeader, the header is read only once.
+
+	PrefetchFileHeader ( session );
+
+	SignatureMatches matches;
+	bool useSignatures = this->matchSignatures ( session->fileHeader, session->fileHeaderLen, &matches );
+
 	XMPFileHandlerTablePos handlerPos = mNormalHandlers->begin();
 
 	for( ; handlerPos != mNormalHandlers->end(); ++handlerPos ) 
 	{
 		session->format = kXMP_UnknownFile;	// ! Hack to tell the CheckProc this is not an initial call.
 		handlerInfo = &handlerPos->second;
+		if ( useSignatures && (handlerInfo->signatures != 0) ) {
+			int index = matches.find ( handlerInfo->format );
+			if ( index < 0 ) continue;
+			if ( matches.conclusive[index] ) return handlerInfo;
+		}
 		CheckFileFormatProc CheckProc = (CheckFileFormatProc) (handlerInfo->checkProc);
 		foundHandler = CheckProc ( handlerInfo->format, clientPath, session->ioRef, session );
 		XMP_Assert ( foundHandler || (session->tempPtr == 0) );
@@ -800,6 +933,7 @@ XMPFileHandlerInfo* HandlerRegistry::selectSmartHandler( XMPFiles* session, XMP_
 	{
 		delete session->ioRef;	// Close is implicit in the destructor.
 		session->ioRef = 0;
+		session->fileHeaderIO = 0;
 		handlerPos = mOwningHandlers->begin();
 
 		for( ; handlerPos != mOwningHandlers->end(); ++handlerPos ) 
@@ -34,22 +34,24 @@ struct XMPFileHandlerInfo
 	XMP_OptionBits		flags;
 	void*				checkProc;
 	XMPFileHandlerCTor	handlerCTor;
+	const XMPFileSignature * signatures;	// Null if the CheckProc must always be called.
 
-	XMPFileHandlerInfo() : format(0), flags(0), checkProc(0), handlerCTor(0) 
+	XMPFileHandlerInfo() : format(0), flags(0), checkProc(0), handlerCTor(0), signatures(0) 
 	{};
 	
 	XMPFileHandlerInfo( XMP_FileFormat _format, 
 						XMP_OptionBits _flags,
 						CheckFileFormatProc _checkProc, 
-						XMPFileHandlerCTor _handlerCTor )
-		: format(_format), flags(_flags), checkProc((void*)_checkProc), handlerCTor(_handlerCTor) 
+						XMPFileHandlerCTor _handlerCTor,
+						const XMPFileSignature * _signatures = 0 )
+		: format(_format), flags(_flags), checkProc((void*)_checkProc), handlerCTor(_handlerCTor), signatures(_signatures) 
 	{};
 	
 	XMPFileHandlerInfo( XMP_FileFormat _format, 
 						XMP_OptionBits _flags,
 						CheckFolderFormatProc _checkProc, 
 						XMPFileHandlerCTor _handlerCTor )
-		: format(_format), flags(_flags), checkProc((void*)_checkProc), handlerCTor(_handlerCTor) 
+		: format(_format), flags(_flags), checkProc((void*)_checkProc), handlerCTor(_handlerCTor), signatures(0) 
 	{};
 };
 
@@ -102,12 +104,14 @@ public:
 	 * @param checkProc			Check format function pointer
 	 * @param handlerCTor		Factory function pointer
 	 * @param replaceExisting	Replace an already existing handler
+	 * @param signatures		Magic signatures, one of which every file accepted by checkProc starts with
 	 */
 	bool				registerNormalHandler( XMP_FileFormat			format,
 											   XMP_OptionBits			flags,
 											   CheckFileFormatProc		checkProc,
 											   XMPFileHandlerCTor		handlerCTor,
-											   bool						replaceExisting = false );
+											   bool						replaceExisting = false,
+											   const XMPFileSignature *	signatures = 0 );
 
 	/**
 	 * Register a single owning file handler.
@@ -192,6 +196,37 @@ private:
 	 */
 	XMPFileHandlerInfo* pickDefaultHandler ( XMP_FileFormat format, const std::string & fileExt );
 
+	enum { kSignatureBlockSize = XMPFiles::kFileHeaderSize, kMaxSignatureMatches = 8 };
+
+	struct SignatureEntry {
+		XMP_FileFormat				format;
+		const XMPFileSignature *	signature;
+	};
+	typedef std::vector<SignatureEntry> SignatureList;
+
+	struct SignatureMatches {
+		XMP_Uns32		count;
+		XMP_FileFormat	formats [kMaxSignatureMatches];
+		bool			conclusive [kMaxSignatureMatches];
+		SignatureMatches() : count(0) {};
+		int find ( XMP_FileFormat format ) const;	// Returns -1 if not found.
+	};
+
+	/**
+	 * Rebuild the signature index after a normal handler is added or removed.
+	 */
+	void compileSignatures();
+
+	/**
+	 * Match a file's header block against the signatures of the normal handlers.
+	 *
+	 * @param header		The first bytes of the file
+	 * @param headerLen		The number of bytes in header, at most kSignatureBlockSize
+	 * @param matches		Filled in with the formats having a matching signature
+	 * @return				False if there were too many matches to record
+	 */
+	bool matchSignatures ( const XMP_Uns8 * header, XMP_Uns32 headerLen, SignatureMatches * matches ) const;
+
 #if EnableDynamicMediaHandlers
 	/**
 	 * Try to find folder based file handler.
@@ -230,6 +265,12 @@ private:
 
 	XMPFileHandlerTable*	mReplacedHandlers;	// All file handler that where replaced by a later one
 
+	// The signatures of the normal handlers, indexed by their first byte. Signatures whose first
+	// byte is masked out are in mSignaturesAnyFirst.
+	SignatureList			mSignaturesByFirst [256];
+	SignatureList			mSignaturesAnyFirst;
+
+
 	static HandlerRegistry*	sInstance;			// singleton instance
 };
 
@@ -154,6 +154,36 @@ void WXMPFiles_CheckFileFormat_1 ( XMP_StringPtr filePath,
 
 // -------------------------------------------------------------------------------------------------
 
+void WXMPFiles_ProcessBatch_1 ( const XMP_StringPtr * filePaths,
+                                XMP_Index             fileCount,
+                                XMP_OptionBits        openFlags,
+                                XMPFiles_BatchProc    batchProc,
+                                void *                context,
+                                XMP_Index             threadCount,
+                                WXMP_Result *         wResult )
+{
+	XMP_ENTER_Static ( "WXMPFiles_ProcessBatch_1" )
+
+		wResult->int32Result = XMPFiles::ProcessBatch ( filePaths, fileCount, openFlags, batchProc, context, threadCount );
+
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
+void WXMPFiles_SetMetadataCache_1 ( XMP_StringPtr cacheFolder,
+                                    XMP_Uns64     maxCacheSize,
+                                    WXMP_Result * wResult )
+{
+	XMP_ENTER_Static ( "WXMPFiles_SetMetadataCache_1" )
+
+		XMPFiles::SetMetadataCache ( cacheFolder, maxCacheSize );
+
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
 void WXMPFiles_CheckPackageFormat_1 ( XMP_StringPtr folderPath,
                        				  WXMP_Result * wResult )
 {
@@ -296,6 +326,21 @@ void WXMPFiles_GetFileInfo_1 ( XMPFilesRef      xmpObjRef,
 
 // -------------------------------------------------------------------------------------------------
 
+void WXMPFiles_GetIOStats_1 ( XMPFilesRef   xmpObjRef,
+                              XMP_IOStats * ioStats,
+                              WXMP_Result * wResult )
+{
+	XMP_ENTER_ObjRead ( XMPFiles, "WXMPFiles_GetIOStats_1" )
+
+		if ( ioStats == 0 ) XMP_Throw ( "Null output I/O stats pointer", kXMPErr_BadParam );
+		bool isOpen = thiz.GetIOStats ( ioStats );
+		wResult->int32Result = isOpen;
+
+	XMP_EXIT
+}
+
+// -------------------------------------------------------------------------------------------------
+
 void WXMPFiles_SetAbortProc_1 ( XMPFilesRef   xmpObjRef,
                          	    XMP_AbortProc abortProc,
 							    void *        abortArg,
@@ -11,6 +11,8 @@
 #include "public/include/XMP_Const.h"
 #include "public/include/XMP_IO.hpp"
 
+#include <atomic>
+#include <thread>
 #include <vector>
 #include <string.h>
 
@@ -27,6 +29,7 @@
 
 #include "XMPFiles/source/FormatSupport/ID3_Support.hpp"
 #include "XMPFiles/source/FormatSupport/ISOBaseMedia_Support.hpp"
+#include "XMPFiles/source/FormatSupport/MetadataCache_Support.hpp"
 
 #if EnablePacketScanning
 	#include "XMPFiles/source/FileHandlers/Scanner_Handler.hpp"
@@ -159,6 +162,7 @@ XMPFiles::Initialize( XMP_OptionBits options, const char* pluginFolder, const ch
 
 	if ( ! Initialize_LibUtils() ) return false;
 	if ( ! ID3_Support::InitializeGlobals() ) return false;
+	if ( ! MetadataCache_Support::InitializeGlobals() ) return false;
 
 	#if GatherPerformanceData
 		sAPIPerf = new APIPerfCollection;
@@ -184,6 +188,26 @@ XMPFiles::Initialize( XMP_OptionBits options, const char* pluginFolder, const ch
 		if ( ! ignoreLocalText ) XMP_Throw ( "Generic UNIX clients must pass kXMPFiles_IgnoreLocalText", kXMPErr_EnforceFailure );
 	#endif
 
+	XMPFiles_IO::SetMapReadOnlyFiles ( XMP_OptionIsSet ( options, kXMPFiles_MapReadOnlyFiles ) );
+
+	if ( XMP_OptionIsSet ( options, kXMPFiles_NoReadBuffer ) ) {
+		XMPFiles_IO::SetReadBufferSize ( 0 );
+	} else {
+		XMP_Uns32 log2Size = (options & kXMPFiles_ReadBufferSizeMask) >> kXMPFiles_ReadBufferSizeShift;
+		if ( log2Size == 0 ) log2Size = 16;	// The 64K default.
+		if ( log2Size < 12 ) log2Size = 12;
+		if ( log2Size > 24 ) log2Size = 24;
+		XMPFiles_IO::SetReadBufferSize ( (XMP_Uns32)1 << log2Size );
+	}
+
+	XMP_Uns32 paddingLog2 = (options & kXMPFiles_JPEGPaddingMask) >> kXMPFiles_JPEGPaddingShift;
+	if ( paddingLog2 == 0 ) {
+		jpegPacketPadding = 0;	// Keep the 2K padding from PackageForJPEG.
+	} else {
+		if ( paddingLog2 < 10 ) paddingLog2 = 10;
+		jpegPacketPadding = (XMP_Uns32)1 << paddingLog2;
+	}
+
 	#if EnablePluginManager
 		if ( pluginFolder != 0 ) {
 			std::string pluginList;
@@ -309,6 +333,7 @@ XMPFiles::Terminate()
 
 	ID3_Support::TerminateGlobals();
 	ISOMedia::TerminateGlobals();
+	MetadataCache_Support::TerminateGlobals();
 	Terminate_LibUtils();
 
 	#if UseGlobalLibraryLock & (! XMP_StaticBuild )
@@ -339,6 +364,8 @@ XMPFiles::XMPFiles()
 	, abortProc(0)
 	, abortArg(0)
 	, progressTracker(0)
+	, fileHeaderIO(0)
+	, fileHeaderLen(0)
 {
 	XMP_FILES_START
 	if ( sProgressDefault.clientProc != 0 ) {
@@ -365,6 +392,7 @@ static inline void CloseLocalFile ( XMPFiles* thiz )
 
 		if ( localFile != 0 ) {
 			localFile->Close();
+			thiz->closedIOStats = localFile->GetIOStats();	// Keep the counts of an update for GetIOStats.
 			delete localFile;
 			thiz->ioRef = 0;
 		}
@@ -395,6 +423,25 @@ XMPFiles::~XMPFiles() NO_EXCEPT_FALSE
 
 // =================================================================================================
 
+XMP_Uns32
+XMPFiles::ReadFileHeader ( XMP_IO * fileRef, void * buffer, XMP_Uns32 count )
+{
+
+	if ( (fileRef != 0) && (fileRef == this->fileHeaderIO) &&
+		 ((count <= this->fileHeaderLen) || (this->fileHeaderLen < kFileHeaderSize)) ) {
+		if ( count > this->fileHeaderLen ) count = this->fileHeaderLen;	// ! The file is that short.
+		memcpy ( buffer, this->fileHeader, count );	// AUDIT: Safe, count is at most fileHeaderLen.
+		fileRef->Seek ( count, kXMP_SeekFromStart );
+		return count;
+	}
+
+	fileRef->Rewind();
+	return fileRef->Read ( buffer, count );
+
+}	// XMPFiles::ReadFileHeader
+
+// =================================================================================================
+
 /* class static */
 bool
 XMPFiles::GetFormatInfo ( XMP_FileFormat   format,
@@ -458,17 +505,187 @@ XMPFiles::CheckPackageFormat ( XMP_StringPtr folderPath )
 
 }	// XMPFiles::CheckPackageFormat
 
+// =================================================================================================
+// ProcessBatch support
+// ====================
+//
+// The workers share one cursor into the path array and each takes the next unclaimed file when it
+// finishes one. Every file costs at least an open and a few reads, so taking one file at a time
+// balances the load without per-thread queues. Results are passed to the client under reportLock,
+// the client callback never runs concurrently.
+
+struct BatchInfo {
+	const XMP_StringPtr *  filePaths;
+	XMP_Index              fileCount;
+	XMP_OptionBits         openFlags;
+	XMPFiles_BatchProc     batchProc;
+	void *                 context;
+	std::atomic<XMP_Index> nextFile;
+	std::atomic<bool>      stopped;
+	XMP_Index              reportCount;	// Protected by reportLock.
+	XMP_BasicMutex         reportLock;
+};
+
+struct BatchFileError {
+	XMP_Int32   id;
+	std::string message;
+	BatchFileError() : id(0) {};
+	void Record ( XMP_Int32 _id, XMP_StringPtr _message )
+		{ if ( this->id == 0 ) { this->id = _id; this->message = _message; } };
+};
+
+static bool RecordBatchError ( void * context, XMP_StringPtr /*filePath*/, XMP_ErrorSeverity /*severity*/,
+							   XMP_Int32 cause, XMP_StringPtr message )
+{
+	((BatchFileError*)context)->Record ( cause, message );
+	return true;	// Recover when the severity allows it, as without a callback.
+}
+
+static XMP_Bool BatchErrorWrapper ( XMPFiles_ErrorCallbackProc clientProc, void * context, XMP_StringPtr filePath,
+									XMP_ErrorSeverity severity, XMP_Int32 cause, XMP_StringPtr message )
+{
+	return (*clientProc) ( context, filePath, severity, cause, message );
+}
+
+// -------------------------------------------------------------------------------------------------
+
+static void ProcessBatchFile ( BatchInfo * batch, XMP_Index fileIndex )
+{
+	BatchFileError fileError;
+	XMP_FileFormat format = kXMP_UnknownFile;
+	SXMPMeta xmpObj;
+	bool hasXMP = false;
+
+	try {
+		XMPFiles file;
+		file.SetErrorCallback ( BatchErrorWrapper, RecordBatchError, &fileError, 0 );
+		XMP_StringPtr filePath = batch->filePaths[fileIndex];
+		if ( (filePath != 0) && file.OpenFile ( filePath, kXMP_UnknownFile, batch->openFlags ) ) {
+			format = file.format;
+			hasXMP = file.GetXMP ( &xmpObj );
+			file.CloseFile();
+		}
+	} catch ( XMP_Error & xmpErr ) {
+		fileError.Record ( xmpErr.GetID(), xmpErr.GetErrMsg() );
+	} catch ( std::bad_alloc & ) {
+		fileError.Record ( kXMPErr_NoMemory, "Out of memory" );
+	} catch ( ... ) {
+		fileError.Record ( kXMPErr_Unknown, "Unknown exception" );
+	}
+
+	XMP_AutoMutex reportLock ( &batch->reportLock );
+	if ( batch->stopped ) return;
+	++batch->reportCount;
+	XMPMetaRef xmpRef = hasXMP ? xmpObj.GetInternalRef() : 0;
+	bool keepGoing = false;
+	try {
+		keepGoing = (*batch->batchProc) ( batch->context, fileIndex, format, xmpRef, fileError.id, fileError.message.c_str() );
+	} catch ( ... ) {
+		// Exceptions must not leave a worker thread, treat one as a request to stop.
+	}
+	if ( ! keepGoing ) batch->stopped = true;
+
+}	// ProcessBatchFile
+
+// -------------------------------------------------------------------------------------------------
+
+static void RunBatchWorker ( BatchInfo * batch )
+{
+	try {
+		while ( ! batch->stopped ) {
+			XMP_Index fileIndex = batch->nextFile++;
+			if ( fileIndex >= batch->fileCount ) break;
+			ProcessBatchFile ( batch, fileIndex );
+		}
+	} catch ( ... ) {
+		batch->stopped = true;	// Only a failure to create the XMP object gets here.
+	}
+
+}	// RunBatchWorker
+
+// =================================================================================================
+
+/* class static */
+XMP_Index
+XMPFiles::ProcessBatch ( const XMP_StringPtr * filePaths,
+						 XMP_Index             fileCount,
+						 XMP_OptionBits        openFlags,
+						 XMPFiles_BatchProc    batchProc,
+						 void *                context,
+						 XMP_Index             threadCount /* = 0 */ )
+{
+	XMP_FILES_STATIC_START
+	if ( (fileCount < 0) || ((filePaths == 0) && (fileCount > 0)) ) XMP_Throw ( "Invalid batch file list", kXMPErr_BadParam );
+	if ( batchProc == 0 ) XMP_Throw ( "Null batch callback", kXMPErr_BadParam );
+	if ( openFlags & kXMPFiles_OpenForUpdate ) XMP_Throw ( "Batch files can only be opened for reading", kXMPErr_BadOptions );
+
+	if ( threadCount <= 0 ) {
+		threadCount = (XMP_Index) std::thread::hardware_concurrency();
+		if ( threadCount <= 0 ) threadCount = 1;
+	}
+	#if UseGlobalLibraryLock
+		threadCount = 1;	// The library lock is held by the caller, workers would run unlocked.
+	#endif
+	if ( threadCount > fileCount ) threadCount = fileCount;
+
+	BatchInfo batch;
+	batch.filePaths = filePaths;
+	batch.fileCount = fileCount;
+	batch.openFlags = openFlags;
+	batch.batchProc = batchProc;
+	batch.context = context;
+	batch.nextFile = 0;
+	batch.stopped = false;
+	batch.reportCount = 0;
+	InitializeBasicMutex ( batch.reportLock );
+
+	// The extra threads come out of the budget shared with the parallel packet scan, so a batch of
+	// large files does not start a scan's threads on top of its own for every file.
+
+	const size_t reserved = (threadCount > 1) ? ReserveWorkerThreads ( (size_t)(threadCount - 1) ) : 0;
+	std::vector<std::thread> workers;
+	try {
+		workers.reserve ( reserved );	// A push_back that reallocates must not throw with a joinable thread in hand.
+		for ( size_t i = 0; i < reserved; ++i ) workers.push_back ( std::thread ( RunBatchWorker, &batch ) );
+	} catch ( ... ) {
+		// Run with the threads that could be started.
+	}
+	RunBatchWorker ( &batch );	// The calling thread is one of the workers.
+	for ( size_t i = 0; i < workers.size(); ++i ) workers[i].join();
+	ReleaseWorkerThreads ( reserved );
+
+	TerminateBasicMutex ( batch.reportLock );
+	return batch.reportCount;
+	XMP_FILES_STATIC_END1 ( kXMPErrSev_OperationFatal )
+	return 0;
+
+}	// XMPFiles::ProcessBatch
+
+// =================================================================================================
+
+/* class static */
+void
+XMPFiles::SetMetadataCache ( XMP_StringPtr cacheFolder, XMP_Uns64 maxCacheSize /* = 0 */ )
+{
+	XMP_FILES_STATIC_START
+	MetadataCache_Support::SetCacheFolder ( cacheFolder, maxCacheSize );
+	XMP_FILES_STATIC_END1 ( kXMPErrSev_OperationFatal )
+
+}	// XMPFiles::SetMetadataCache
+
 // =================================================================================================
 
 static bool FileIsExcluded (
 	XMP_StringPtr clientPath,
 	std::string * fileExt,
 	Host_IO::FileMode * clientMode,
-	const XMPFiles::ErrorCallbackInfo * _errorCallbackInfoPtr = NULL )
+	const XMPFiles::ErrorCallbackInfo * _errorCallbackInfoPtr = NULL,
+	bool knownFile = false )
 {
-	// ! Return true for excluded files, false for OK files.
+	// ! Return true for excluded files, false for OK files. Pass knownFile if the caller has
+	// ! already found that the path is a file.
 	
-	*clientMode = Host_IO::GetFileMode ( clientPath );
+	*clientMode = knownFile ? (Host_IO::FileMode)Host_IO::kFMode_IsFile : Host_IO::GetFileMode ( clientPath );
 
 	if ( (*clientMode == Host_IO::kFMode_IsFolder) || (*clientMode == Host_IO::kFMode_IsOther) ) {
 		XMP_Error error ( kXMPErr_FilePathNotAFile, "XMPFiles: path specified is not a file" );
@@ -947,12 +1164,14 @@ DoOpenFile ( XMPFiles *     thiz,
 
 	if ( thiz->handler != 0 ) XMP_Throw ( "File already open", kXMPErr_BadParam );
 	CloseLocalFile ( thiz );	// Sanity checks if prior call failed.
+	thiz->closedIOStats = XMP_IOStats();
 
 	thiz->ioRef = clientIO;
 	thiz->SetFilePath ( clientPath );
 
 	thiz->format = kXMP_UnknownFile;	// Make sure it is preset for later check.
 	thiz->openFlags = openFlags;
+	thiz->cacheKey = MetadataCache_Support::OpenKey();
 
 	bool readOnly = XMP_OptionIsClear ( openFlags, kXMPFiles_OpenForUpdate );
 
@@ -962,8 +1181,14 @@ DoOpenFile ( XMPFiles *     thiz,
 	if ( thiz->UsesClientIO() ) {
 		clientMode = Host_IO::kFMode_IsFile;
 	} else {
-		bool excluded = FileIsExcluded ( clientPath, &fileExt, &clientMode, &thiz->errorCallback );	// ! Fills in fileExt and clientMode.
+		bool knownFile = MetadataCache_Support::IsEnabled() &&
+						 MetadataCache_Support::GetOpenKey ( clientPath, openFlags, format, &thiz->cacheKey );
+		bool excluded = FileIsExcluded ( clientPath, &fileExt, &clientMode, &thiz->errorCallback, knownFile );	// ! Fills in fileExt and clientMode.
 		if ( excluded ) return false;
+		if ( knownFile && readOnly ) {
+			thiz->handler = MetadataCache_Support::LookupHandler ( thiz, thiz->cacheKey );	// ! Sets thiz->format.
+			if ( thiz->handler != 0 ) return true;
+		}
 	}
 
 	// Find the handler, fill in the XMPFiles member variables, cache the desired file data.
@@ -1109,6 +1334,7 @@ static bool DoOpenFile( XMPFiles* thiz,
 	}
 
 	if ( thiz->handler != 0 ) XMP_Throw ( "File already open", kXMPErr_BadParam );
+	thiz->closedIOStats = XMP_IOStats();
 
 	//
 	// setup members
@@ -1117,6 +1343,7 @@ static bool DoOpenFile( XMPFiles* thiz,
 	thiz->SetFilePath ( clientPath );
 	thiz->format	= hdlInfo.format;
 	thiz->openFlags = openFlags;
+	thiz->cacheKey	= MetadataCache_Support::OpenKey();
 
 	//
 	// create file handler instance
@@ -1259,6 +1486,10 @@ XMPFiles::CloseFile ( XMP_OptionBits closeFlags /* = 0 */ )
 		localFile->SetProgressTracker ( this->progressTracker );
 	}
 
+	// A cached read of the file would be stale once the update starts.
+
+	if ( needsUpdate || optimizeFileLayout ) MetadataCache_Support::Remove ( this->cacheKey );
+
 	// Try really hard to make sure the file is closed and the handler is deleted.
 
 	try {
@@ -1358,6 +1589,7 @@ XMPFiles::CloseFile ( XMP_OptionBits closeFlags /* = 0 */ )
 		this->format    = kXMP_UnknownFile;
 		this->ioRef     = 0;
 		this->openFlags = 0;
+		this->cacheKey  = MetadataCache_Support::OpenKey();
 
 		if ( this->tempPtr != 0 ) free ( this->tempPtr );	// ! Must have been malloc-ed!
 		this->tempPtr  = 0;
@@ -1376,6 +1608,7 @@ XMPFiles::CloseFile ( XMP_OptionBits closeFlags /* = 0 */ )
 	this->format    = kXMP_UnknownFile;
 	this->ioRef     = 0;
 	this->openFlags = 0;
+	this->cacheKey  = MetadataCache_Support::OpenKey();
 
 	if ( this->tempPtr != 0 ) free ( this->tempPtr );	// ! Must have been malloc-ed!
 	this->tempPtr  = 0;
@@ -1420,6 +1653,27 @@ XMPFiles::GetFileInfo ( XMP_StringPtr *  _filePath /* = 0 */,
 
 // =================================================================================================
 
+bool
+XMPFiles::GetIOStats ( XMP_IOStats * ioStats ) const
+{
+	XMP_FILES_START
+	if ( this->handler == 0 ) {
+		*ioStats = this->closedIOStats;
+		return false;
+	}
+
+	*ioStats = XMP_IOStats();
+	if ( this->UsesLocalIO() && (this->ioRef != 0) ) {
+		const XMPFiles_IO * localFile = (const XMPFiles_IO*)this->ioRef;
+		*ioStats = localFile->GetIOStats();
+	}
+	XMP_FILES_END1 ( kXMPErrSev_FileFatal )
+	return true;
+
+}	// XMPFiles::GetIOStats
+
+// =================================================================================================
+
 void
 XMPFiles::SetAbortProc ( XMP_AbortProc _abortProc,
 						 void *        _abortArg )
@@ -1511,6 +1765,9 @@ XMPFiles::GetXMP ( SXMPMeta *       xmpObj /* = 0 */,
 		if ((this->handler->handlerFlags &  kXMPFiles_NeedsLocalFileOpened) && !(this->openFlags & kXMPFiles_OpenForUpdate)) {
 			CloseLocalFile(this);
 		}
+		if ( this->cacheKey.valid && (! (this->openFlags & kXMPFiles_OpenForUpdate)) ) {
+			MetadataCache_Support::StoreHandler ( this->cacheKey, this->GetFilePath().c_str(), this->handler, this->format );
+		}
 	}
 
 	if ( ! this->handler->containsXMP ) return false;
@@ -19,6 +19,7 @@
 #include "public/include/XMP_IO.hpp"
 #include "source/SafeStringAPIs.h"
 #include "source/XMP_ProgressTracker.hpp"
+#include "XMPFiles/source/FormatSupport/MetadataCache_Support.hpp"
 
 class XMPFileHandler;
 namespace Common{ struct XMPFileHandlerInfo; }
@@ -182,6 +183,16 @@ public:
 	static XMP_FileFormat CheckFileFormat(XMP_StringPtr filePath);
 	static XMP_FileFormat CheckPackageFormat(XMP_StringPtr folderPath);
 
+	static XMP_Index ProcessBatch (
+		const XMP_StringPtr * filePaths,
+		XMP_Index             fileCount,
+		XMP_OptionBits        openFlags,
+		XMPFiles_BatchProc    batchProc,
+		void *                context,
+		XMP_Index             threadCount = 0 );
+
+	static void SetMetadataCache ( XMP_StringPtr cacheFolder, XMP_Uns64 maxCacheSize = 0 );
+
 	static bool GetAssociatedResources ( 
 		XMP_StringPtr              filePath,
         std::vector<std::string> * resourceList,
@@ -232,6 +243,8 @@ public:
 		XMP_FileFormat * format = 0,
 		XMP_OptionBits * handlerFlags = 0 ) const;
 
+	bool GetIOStats ( XMP_IOStats * ioStats ) const;
+
 	bool GetXMP(
 		SXMPMeta * xmpObj = 0,
 		XMP_StringPtr * xmpPacket = 0,
@@ -280,12 +293,20 @@ public:
 			XMP_StringPtr messsage) const;
 	};
 
-	inline bool UsesClientIO() { return this->filePath.empty(); };
-	inline bool UsesLocalIO() { return ( ! this->UsesClientIO() ); };
+	inline bool UsesClientIO() const { return this->filePath.empty(); };
+	inline bool UsesLocalIO() const { return ( ! this->UsesClientIO() ); };
 	inline void SetFilePath(XMP_StringPtr _filePath) { filePath = _filePath; errorCallback.filePath = _filePath; }
 	inline void ClearFilePath() { filePath.clear(); errorCallback.filePath.clear(); }
 	inline const std::string& GetFilePath() { return filePath; }
 
+	// For CheckProcs, reads the first count bytes of the file into buffer and returns the number of
+	// bytes read. Uses the header that HandlerRegistry::selectSmartHandler read for the current
+	// fileRef if it covers the request, else reads the file. Either way the file position is left
+	// after the bytes read.
+	XMP_Uns32 ReadFileHeader ( XMP_IO * fileRef, void * buffer, XMP_Uns32 count );
+
+	enum { kFileHeaderSize = 32 };
+
 	// Leave this data public so file handlers can see it.
 	XMP_Int32				clientRefs;	// ! Must be signed to allow decrement from zero.
 	XMP_ReadWriteLock		lock;
@@ -299,6 +320,11 @@ public:
 	void *					abortArg;
 	XMP_ProgressTracker *	progressTracker;
 	ErrorCallbackInfo		errorCallback;
+	XMP_IOStats				closedIOStats;	// The counts of the last closed local file.
+	MetadataCache_Support::OpenKey cacheKey;	// Valid if the metadata cache is on for this file.
+	const XMP_IO *			fileHeaderIO;	// The file the header was read from, null if none.
+	XMP_Uns32				fileHeaderLen;	// Less than kFileHeaderSize only for a shorter file.
+	XMP_Uns8				fileHeader [kFileHeaderSize];
 
 private:
 	std::string				filePath;	// Empty for client-managed I/O.
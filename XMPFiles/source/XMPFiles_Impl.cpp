@@ -17,6 +17,9 @@
 
 #include "source/UnicodeConversions.hpp"
 
+#include <atomic>
+#include <thread>
+
 using namespace std;
 
 // Internal code should be using #if with XMP_MacBuild, XMP_WinBuild, XMP_AndroidBuild, or XMP_UNIXBuild.
@@ -57,9 +60,12 @@ using namespace std;
 #endif
 
 bool ignoreLocalText = false;
+XMP_Uns32 jpegPacketPadding = 0;
 
 XMP_FileFormat voidFileFormat = 0;	// Used as sink for unwanted output parameters.
 
+static std::atomic<size_t> sWorkerThreads ( 0 );	// The reserved worker threads of all callers.
+
 //***** see CTECHXMP-4169947 *****
 
 //#if ! XMP_StaticBuild
@@ -353,6 +359,36 @@ void FillPacketInfo ( const std::string & packet, XMP_PacketInfo * info )
 
 }	// FillPacketInfo
 
+// =================================================================================================
+// ReserveWorkerThreads
+// ====================
+
+size_t ReserveWorkerThreads ( size_t wanted )
+{
+	size_t limit = std::thread::hardware_concurrency();
+	limit = (limit > 1) ? (limit - 1) : 0;	// The calling thread has a processor of its own.
+
+	size_t active = sWorkerThreads.load();
+	size_t granted;
+	do {
+		granted = (active < limit) ? std::min ( wanted, (limit - active) ) : 0;
+	} while ( (granted > 0) && (! sWorkerThreads.compare_exchange_weak ( active, (active + granted) )) );
+
+	return granted;
+
+}	// ReserveWorkerThreads
+
+// =================================================================================================
+// ReleaseWorkerThreads
+// ====================
+
+void ReleaseWorkerThreads ( size_t count )
+{
+	XMP_Assert ( count <= sWorkerThreads.load() );
+	sWorkerThreads -= count;
+
+}	// ReleaseWorkerThreads
+
 // =================================================================================================
 // ReadXMPPacket
 // =============
@@ -58,6 +58,15 @@
 typedef std::vector<XMP_Uns8> RawDataBlock;
 
 extern bool ignoreLocalText;
+extern XMP_Uns32 jpegPacketPadding;	// Padding for a rewritten JPEG XMP packet, 0 for the default 2K.
+
+// The worker threads started by ProcessBatch and the parallel packet scan share one budget of one
+// thread per processor, not counting the client threads that start them. ReserveWorkerThreads
+// returns how many of the wanted threads may be started, possibly 0. The count it returns must be
+// given back with ReleaseWorkerThreads once those threads are joined.
+
+extern size_t ReserveWorkerThreads ( size_t wanted );
+extern void ReleaseWorkerThreads ( size_t count );
 
 #ifndef EnablePhotoHandlers
 	#define EnablePhotoHandlers 1
@@ -336,6 +345,18 @@ typedef bool (* CheckFileFormatProc ) ( XMP_FileFormat format,
 									   XMP_IO *       fileRef,
 									   XMPFiles *     parent );
 
+// A magic signature that a file must start with for a file handler to accept it. A null mask
+// compares all bytes, otherwise bytes with '?' in the mask are not compared. The CheckProc is not
+// called for a conclusive signature, it must accept every file that matches. A handler's signatures
+// are an array that ends with a null bytes pointer, see HandlerRegistry::registerNormalHandler.
+
+struct XMPFileSignature {
+	const char * bytes;
+	const char * mask;
+	XMP_Uns8     length;
+	bool         conclusive;
+};
+
 typedef bool (*CheckFolderFormatProc ) ( XMP_FileFormat format,
 										const std::string & rootPath,
 										const std::string & gpName,
@@ -44,6 +44,7 @@
 #include <string>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 #define XMP_INCLUDE_XMPFILES 1
 #define TXMP_STRING_TYPE std::string
@@ -586,6 +587,63 @@ XmpFileType xmp_files_check_file_format(const char *filePath)
     return file_type;
 }
 
+struct BatchContext {
+    XmpBatchCallback callback;
+    void *context;
+};
+
+static bool batch_callback(void *context, XMP_Index fileIndex,
+                           XMP_FileFormat format, XMPMetaRef xmpRef,
+                           XMP_Int32 errorID, XMP_StringPtr)
+{
+    auto batch = reinterpret_cast<BatchContext *>(context);
+    if (xmpRef == 0) {
+        return batch->callback(batch->context, fileIndex, (XmpFileType)format,
+                               NULL, -errorID);
+    }
+    SXMPMeta xmp(xmpRef);
+    return batch->callback(batch->context, fileIndex, (XmpFileType)format,
+                           reinterpret_cast<XmpPtr>(&xmp), -errorID);
+}
+
+API_EXPORT
+size_t xmp_files_process_batch(const char **paths, size_t count,
+                               XmpOpenFileOptions options, unsigned int threads,
+                               XmpBatchCallback callback, void *context)
+{
+    CHECK_PTR(callback, 0);
+    RESET_ERROR;
+
+    if (count > 0x7FFFFFFF || threads > 0x7FFFFFFF) {
+        set_error(XMPErr_BadParam);
+        return 0;
+    }
+    BatchContext batch = { callback, context };
+    try {
+        return SXMPFiles::ProcessBatch(paths, (XMP_Index)count, options,
+                                       batch_callback, &batch,
+                                       (XMP_Index)threads);
+    }
+    catch (const XMP_Error &e) {
+        set_error(e);
+    }
+    return 0;
+}
+
+API_EXPORT
+bool xmp_files_set_metadata_cache(const char *folder, uint64_t max_size)
+{
+    RESET_ERROR;
+    try {
+        SXMPFiles::SetMetadataCache(folder, max_size);
+    }
+    catch (const XMP_Error &e) {
+        set_error(e);
+        return false;
+    }
+    return true;
+}
+
 API_EXPORT
 XmpPtr xmp_new_empty()
 {
@@ -643,6 +701,24 @@ bool xmp_parse(XmpPtr xmp, const char *buffer, size_t len)
     return true;
 }
 
+API_EXPORT
+bool xmp_parse_binary(XmpPtr xmp, const char *buffer, size_t len)
+{
+    CHECK_PTR(xmp, false);
+    CHECK_PTR(buffer, false);
+    RESET_ERROR;
+
+    SXMPMeta *txmp = (SXMPMeta *)xmp;
+    try {
+        txmp->ParseFromBuffer(buffer, len, kXMP_ParseBinary);
+    }
+    catch (const XMP_Error &e) {
+        set_error(e);
+        return false;
+    }
+    return true;
+}
+
 API_EXPORT
 bool xmp_serialize(XmpPtr xmp, XmpStringPtr buffer, uint32_t options,
                    uint32_t padding)
@@ -1064,6 +1140,192 @@ bool xmp_has_property(XmpPtr xmp, const char *schema, const char *name)
     return ret;
 }
 
+API_EXPORT
+XmpPathPtr xmp_path_new(const char *schema, const char *name)
+{
+    RESET_ERROR;
+
+    try {
+        return reinterpret_cast<XmpPathPtr>(SXMPMeta::CompilePath(schema, name));
+    }
+    catch (const XMP_Error &e) {
+        set_error(e);
+    }
+    return NULL;
+}
+
+API_EXPORT
+bool xmp_path_free(XmpPathPtr path)
+{
+    CHECK_PTR(path, false);
+    RESET_ERROR;
+    SXMPMeta::ReleasePath(reinterpret_cast<XMPPathRef>(path));
+    return true;
+}
+
+API_EXPORT
+bool xmp_get_property_path(XmpPtr xmp, XmpPathPtr path, XmpStringPtr property,
+                           uint32_t *propsBits)
+{
+    CHECK_PTR(xmp, false);
+    CHECK_PTR(path, false);
+    RESET_ERROR;
+
+    bool ret = false;
+    try {
+        auto txmp = reinterpret_cast<const SXMPMeta *>(xmp);
+        XMP_OptionBits optionBits;
+        ret = txmp->GetProperty(reinterpret_cast<XMPPathRef>(path),
+                                STRING(property), &optionBits);
+        if (propsBits) {
+            *propsBits = optionBits;
+        }
+    }
+    catch (const XMP_Error &e) {
+        set_error(e);
+    }
+    return ret;
+}
+
+API_EXPORT
+bool xmp_set_property_path(XmpPtr xmp, XmpPathPtr path, const char *value,
+                           uint32_t optionBits)
+{
+    CHECK_PTR(xmp, false);
+    CHECK_PTR(path, false);
+    RESET_ERROR;
+
+    bool ret = false;
+    auto txmp = reinterpret_cast<SXMPMeta *>(xmp);
+    // see xmp_set_property
+    if ((optionBits & (XMP_PROP_VALUE_IS_STRUCT | XMP_PROP_VALUE_IS_ARRAY)) &&
+        (*value == 0)) {
+        value = NULL;
+    }
+    try {
+        txmp->SetProperty(reinterpret_cast<XMPPathRef>(path), value,
+                          optionBits);
+        ret = true;
+    }
+    catch (const XMP_Error &e) {
+        set_error(e);
+    }
+    catch (...) {
+    }
+    return ret;
+}
+
+API_EXPORT
+bool xmp_delete_property_path(XmpPtr xmp, XmpPathPtr path)
+{
+    CHECK_PTR(xmp, false);
+    CHECK_PTR(path, false);
+    RESET_ERROR;
+
+    bool ret = true;
+    auto txmp = reinterpret_cast<SXMPMeta *>(xmp);
+    try {
+        txmp->DeleteProperty(reinterpret_cast<XMPPathRef>(path));
+    }
+    catch (const XMP_Error &e) {
+        set_error(e);
+        ret = false;
+    }
+    catch (...) {
+        ret = false;
+    }
+    return ret;
+}
+
+API_EXPORT
+bool xmp_has_property_path(XmpPtr xmp, XmpPathPtr path)
+{
+    CHECK_PTR(xmp, false);
+    CHECK_PTR(path, false);
+    RESET_ERROR;
+
+    bool ret = true;
+    auto txmp = reinterpret_cast<const SXMPMeta *>(xmp);
+    try {
+        ret = txmp->DoesPropertyExist(reinterpret_cast<XMPPathRef>(path));
+    }
+    catch (const XMP_Error &e) {
+        set_error(e);
+        ret = false;
+    }
+    catch (...) {
+        ret = false;
+    }
+    return ret;
+}
+
+API_EXPORT
+int32_t xmp_get_properties(XmpPtr xmp, const XmpPathPtr *paths, size_t count,
+                           XmpStringPtr values, int32_t *offsets,
+                           uint32_t *propsBits)
+{
+    CHECK_PTR(xmp, -1);
+    CHECK_PTR(paths, -1);
+    RESET_ERROR;
+
+    if (count > INT32_MAX) {
+        set_error(XMPErr_BadParam);
+        return -1;
+    }
+    int32_t ret = -1;
+    try {
+        auto txmp = reinterpret_cast<const SXMPMeta *>(xmp);
+        ret = txmp->GetProperties(reinterpret_cast<const XMPPathRef *>(paths),
+                                  static_cast<XMP_Index>(count), STRING(values),
+                                  offsets, propsBits);
+    }
+    catch (const XMP_Error &e) {
+        set_error(e);
+    }
+    catch (...) {
+    }
+    return ret;
+}
+
+API_EXPORT
+bool xmp_set_properties(XmpPtr xmp, const XmpPathPtr *paths, size_t count,
+                        const char *const *values, const uint32_t *optionBits)
+{
+    CHECK_PTR(xmp, false);
+    CHECK_PTR(paths, false);
+    CHECK_PTR(values, false);
+    RESET_ERROR;
+
+    if (count > INT32_MAX) {
+        set_error(XMPErr_BadParam);
+        return false;
+    }
+    bool ret = false;
+    auto txmp = reinterpret_cast<SXMPMeta *>(xmp);
+    try {
+        // see xmp_set_property
+        std::vector<XMP_StringPtr> setValues(values, values + count);
+        for (size_t i = 0; i < count; i++) {
+            if (optionBits &&
+                (optionBits[i] &
+                 (XMP_PROP_VALUE_IS_STRUCT | XMP_PROP_VALUE_IS_ARRAY)) &&
+                setValues[i] && (*setValues[i] == 0)) {
+                setValues[i] = NULL;
+            }
+        }
+        txmp->SetProperties(reinterpret_cast<const XMPPathRef *>(paths),
+                            static_cast<XMP_Index>(count), setValues.data(),
+                            optionBits);
+        ret = true;
+    }
+    catch (const XMP_Error &e) {
+        set_error(e);
+    }
+    catch (...) {
+    }
+    return ret;
+}
+
 API_EXPORT
 bool xmp_get_localized_text(XmpPtr xmp, const char *schema, const char *name,
                             const char *genericLang, const char *specificLang,
@@ -1218,6 +1480,24 @@ bool xmp_iterator_skip(XmpIteratorPtr iter, XmpIterSkipOptions options)
     return true;
 }
 
+API_EXPORT
+bool xmp_iterator_path(XmpIteratorPtr iter, XmpStringPtr path)
+{
+    CHECK_PTR(iter, false);
+    CHECK_PTR(path, false);
+    RESET_ERROR;
+
+    try {
+        auto titer = reinterpret_cast<const SXMPIterator *>(iter);
+        titer->GetPropPath(STRING(path));
+        return true;
+    }
+    catch (const XMP_Error &e) {
+        set_error(e);
+    }
+    return false;
+}
+
 API_EXPORT
 int xmp_datetime_compare(XmpDateTime *left, XmpDateTime *right)
 {
@@ -3,12 +3,29 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MAIN
 
+#include <fcntl.h>
 #include <math.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
 #include "../../XMPCore/source/XMPUtils.hpp"
+#include "../../XMPCore/source/XMPMeta.hpp"
+#include "../../XMPCore/source/XMPIterator.hpp"
 #include "../source/EndianUtils.hpp"
+#include "../source/XIO.hpp"
+#include "../source/XMPFiles_IO.hpp"
+#include "../../XMPFiles/source/FormatSupport/XMPScanner.hpp"
+#include "../../XMPFiles/source/FormatSupport/PacketScanning_Support.hpp"
+#include "../../XMPFiles/source/FormatSupport/TIFF_Support.hpp"
+#include "../../XMPFiles/source/XMPFiles.hpp"
 
 using boost::unit_test::test_suite;
 
@@ -139,4 +156,1711 @@ BOOST_AUTO_TEST_CASE(test_getFloat)
   BOOST_CHECK(resultD == (double)M_PI);
 }
 
+BOOST_AUTO_TEST_CASE(test_nodeArena)
+{
+  const char *packet =
+    "<x:xmpmeta xmlns:x='adobe:ns:meta/'>"
+    "<rdf:RDF xmlns:rdf='http://www.w3.org/1999/02/22-rdf-syntax-ns#'>"
+    "<rdf:Description rdf:about=''"
+    " xmlns:dc='http://purl.org/dc/elements/1.1/'"
+    " xmlns:xmp='http://ns.adobe.com/xap/1.0/'>"
+    "<xmp:Rating>3</xmp:Rating>"
+    "<dc:subject><rdf:Bag><rdf:li>a</rdf:li><rdf:li>b</rdf:li></rdf:Bag></dc:subject>"
+    "</rdf:Description></rdf:RDF></x:xmpmeta>";
+
+  XMP_StringPtr value;
+  XMP_StringLen len;
+  XMP_OptionBits options;
+
+  XMPMeta *meta = new XMPMeta;
+  BOOST_CHECK(meta->GetObjectOptions() == 0);
+  meta->SetObjectOptions(kXMP_UseNodeArena);
+  BOOST_CHECK(meta->GetObjectOptions() == kXMP_UseNodeArena);
+  BOOST_CHECK_THROW(meta->SetObjectOptions(0x8000), XMP_Error);
+
+  // Erase recycles the arena.
+  for (int i = 0; i < 3; i++) {
+    meta->ParseFromBuffer(packet, strlen(packet), 0);
+    BOOST_CHECK(meta->GetProperty(kXMP_NS_XMP, "Rating", &value, &len, &options));
+    BOOST_CHECK(strcmp(value, "3") == 0);
+    BOOST_CHECK(meta->GetProperty(kXMP_NS_DC, "subject[2]", &value, &len, &options));
+    BOOST_CHECK(strcmp(value, "b") == 0);
+    meta->SetProperty(kXMP_NS_XMP, "Label", "red", 0);
+    meta->DeleteProperty(kXMP_NS_DC, "subject");
+    BOOST_CHECK(!meta->GetProperty(kXMP_NS_DC, "subject[1]", &value, &len, &options));
+    meta->Erase();
+  }
+
+  meta->ParseFromBuffer(packet, strlen(packet), 0);
+  BOOST_CHECK_THROW(meta->SetObjectOptions(0), XMP_Error);
+
+  // A clone without the option must outlive the arena.
+  XMPMeta *clone = new XMPMeta;
+  meta->Clone(clone, 0);
+  BOOST_CHECK(clone->GetObjectOptions() == 0);
+
+  // Erasing while the clone shares the schemas must leave them alone.
+  meta->Erase();
+  BOOST_CHECK(!meta->GetProperty(kXMP_NS_XMP, "Rating", &value, &len, &options));
+  BOOST_CHECK(clone->GetProperty(kXMP_NS_XMP, "Rating", &value, &len, &options));
+  meta->ParseFromBuffer(packet, strlen(packet), 0);
+  BOOST_CHECK(meta->GetProperty(kXMP_NS_XMP, "Rating", &value, &len, &options));
+  BOOST_CHECK(strcmp(value, "3") == 0);
+  delete meta;
+  BOOST_CHECK(clone->GetProperty(kXMP_NS_DC, "subject[1]", &value, &len, &options));
+  BOOST_CHECK(strcmp(value, "a") == 0);
+  delete clone;
+}
+
+BOOST_AUTO_TEST_CASE(test_nodeNameAtoms)
+{
+  const char *packet =
+    "<x:xmpmeta xmlns:x='adobe:ns:meta/'>"
+    "<rdf:RDF xmlns:rdf='http://www.w3.org/1999/02/22-rdf-syntax-ns#'>"
+    "<rdf:Description rdf:about=''"
+    " xmlns:dc='http://purl.org/dc/elements/1.1/'"
+    " xmlns:xmp='http://ns.adobe.com/xap/1.0/'>"
+    "<xmp:Rating>3</xmp:Rating>"
+    "<dc:subject><rdf:Bag><rdf:li>a</rdf:li><rdf:li>b</rdf:li></rdf:Bag></dc:subject>"
+    "</rdf:Description></rdf:RDF></x:xmpmeta>";
+
+  XMP_StringPtr value;
+  XMP_StringLen len;
+  XMP_OptionBits options;
+
+  XMPMeta *first = new XMPMeta;
+  first->ParseFromBuffer(packet, strlen(packet), 0);
+  size_t atomCount = NodeNameAtoms().Count();
+
+  // The same names in another tree share the atoms.
+  XMPMeta *second = new XMPMeta;
+  second->ParseFromBuffer(packet, strlen(packet), 0);
+  BOOST_CHECK(NodeNameAtoms().Count() == atomCount);
+
+  const XMP_Node *firstRating =
+    FindConstChild(FindConstSchema(&first->tree, kXMP_NS_XMP), "xmp:Rating");
+  const XMP_Node *secondRating =
+    FindConstChild(FindConstSchema(&second->tree, kXMP_NS_XMP), "xmp:Rating");
+  BOOST_REQUIRE(firstRating != 0 && secondRating != 0);
+  BOOST_CHECK(firstRating->name == secondRating->name);
+  BOOST_CHECK(firstRating->name.c_str() == secondRating->name.c_str());
+  BOOST_CHECK(firstRating->name == "xmp:Rating");
+
+  // Looking up a name no node has does not add it.
+  BOOST_CHECK(!second->GetProperty(kXMP_NS_XMP, "NeverUsedAsAName", &value, &len, &options));
+  BOOST_CHECK(NodeNameAtoms().Count() == atomCount);
+
+  second->SetProperty(kXMP_NS_XMP, "NeverUsedAsAName", "x", 0);
+  BOOST_CHECK(NodeNameAtoms().Count() == atomCount + 1);
+  BOOST_CHECK(second->GetProperty(kXMP_NS_XMP, "NeverUsedAsAName", &value, &len, &options));
+  BOOST_CHECK(strcmp(value, "x") == 0);
+
+  delete first;
+  delete second;
+}
+
+BOOST_AUTO_TEST_CASE(test_atomTableThreads)
+{
+  // Lookups take no lock while other threads intern, enough to grow the index several times.
+  XMP_AtomTable table;
+  const XMP_VarString *rdfLi = table.Intern("rdf:li", 6);
+  const XMP_VarString *dcTitle = table.Intern("dc:title", 8);
+  std::atomic<bool> done(false);
+  std::atomic<long> misses(0);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < 2; ++t) {
+    threads.emplace_back([&] {
+      while (!done) {
+        if (table.Find("rdf:li", 6) != rdfLi || table.Intern("dc:title", 8) != dcTitle) {
+          ++misses;
+        }
+      }
+    });
+  }
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 4; ++t) {
+    writers.emplace_back([&table, t] {
+      for (int i = 0; i < 2000; ++i) {
+        std::string name = "ns" + std::to_string(i % 2) + ":Name" + std::to_string(t) + "x" + std::to_string(i);
+        table.Intern(name.c_str(), (XMP_StringLen)name.size());
+      }
+    });
+  }
+  for (auto &thread : writers) {
+    thread.join();
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  BOOST_CHECK(misses == 0);
+  BOOST_CHECK(table.Count() == 2 + 4 * 2000);
+  std::string name = "ns1:Name3x1999";
+  const XMP_VarString *atom = table.Find(name.c_str(), (XMP_StringLen)name.size());
+  BOOST_REQUIRE(atom != 0);
+  BOOST_CHECK(*atom == name);
+  BOOST_CHECK(table.Intern(name.c_str(), (XMP_StringLen)name.size()) == atom);
+
+}
+
+BOOST_AUTO_TEST_CASE(test_atomTableCap)
+{
+  // A full table still finds what it has but adds nothing.
+  XMP_AtomTable table(2);
+  const XMP_VarString *rdfLi = table.Intern("rdf:li", 6);
+  BOOST_REQUIRE(rdfLi != 0);
+  BOOST_CHECK(!table.IsFull());
+  BOOST_CHECK(table.Intern("dc:title", 8) != 0);
+  BOOST_CHECK(table.IsFull());
+  BOOST_CHECK(table.Intern("dc:creator", 10) == 0);
+  BOOST_CHECK(table.Find("dc:creator", 10) == 0);
+  BOOST_CHECK(table.Intern("rdf:li", 6) == rdfLi);
+  BOOST_CHECK(table.Count() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_rootNameNotInterned)
+{
+  // Every file has its own rdf:about, it must not be added to the process wide atoms.
+  const char *packet =
+    "<x:xmpmeta xmlns:x='adobe:ns:meta/'>"
+    "<rdf:RDF xmlns:rdf='http://www.w3.org/1999/02/22-rdf-syntax-ns#'>"
+    "<rdf:Description rdf:about='urn:test:root-name-not-interned'"
+    " xmlns:xmp='http://ns.adobe.com/xap/1.0/'>"
+    "<xmp:Rating>3</xmp:Rating>"
+    "</rdf:Description></rdf:RDF></x:xmpmeta>";
+  const char *aboutURI = "urn:test:root-name-not-interned";
+
+  XMPMeta *meta = new XMPMeta;
+  meta->ParseFromBuffer(packet, strlen(packet), 0);
+  BOOST_CHECK(meta->tree.name == aboutURI);
+  BOOST_CHECK(NodeNameAtoms().Find(aboutURI, (XMP_StringLen)strlen(aboutURI)) == 0);
+
+  XMPMeta *clone = new XMPMeta;
+  meta->Clone(clone, 0);
+  delete meta;
+  BOOST_CHECK(clone->tree.name == aboutURI);
+
+  std::string binary;
+  clone->SerializeToBuffer(&binary, kXMP_SerializeBinary, 0, "", "", 0);
+  XMPMeta *restored = new XMPMeta;
+  restored->ParseFromBuffer(binary.data(), (XMP_StringLen)binary.size(), kXMP_ParseBinary);
+  BOOST_CHECK(restored->tree.name == aboutURI);
+  BOOST_CHECK(NodeNameAtoms().Find(aboutURI, (XMP_StringLen)strlen(aboutURI)) == 0);
+
+  delete clone;
+  delete restored;
+}
+
+BOOST_AUTO_TEST_CASE(test_readWriteLock)
+{
+  // Writers keep the two counters equal, readers must never see them differ.
+  XMP_ReadWriteLock lock;
+  volatile long first = 0, second = 0;
+  std::atomic<long> mismatches(0);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 20000; ++i) {
+        XMP_AutoLock reader(&lock, kXMP_ReadLock);
+        if (first != second) {
+          ++mismatches;
+        }
+      }
+    });
+  }
+  threads.emplace_back([&] {
+    for (int i = 0; i < 2000; ++i) {
+      XMP_AutoLock writer(&lock, kXMP_WriteLock);
+      ++first;
+      std::this_thread::yield();
+      ++second;
+    }
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  BOOST_CHECK(mismatches == 0);
+  BOOST_CHECK(first == 2000 && second == 2000);
+}
+
+BOOST_AUTO_TEST_CASE(test_namespaceTableThreads)
+{
+  // Lookups take no lock while other threads register, enough to grow the index several times.
+  std::atomic<bool> done(false);
+  std::atomic<long> misses(0);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < 2; ++t) {
+    threads.emplace_back([&] {
+      while (!done) {
+        XMP_StringPtr prefix, uri;
+        XMP_StringLen len;
+        if (!XMPMeta::GetNamespacePrefix(kXMP_NS_DC, &prefix, &len) || strcmp(prefix, "dc:") != 0) {
+          ++misses;
+        }
+        if (!XMPMeta::GetNamespaceURI("xmp", &uri, &len) || strcmp(uri, kXMP_NS_XMP) != 0) {
+          ++misses;
+        }
+      }
+    });
+  }
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 4; ++t) {
+    writers.emplace_back([t] {
+      for (int i = 0; i < 100; ++i) {
+        std::string uri = "http://ns.example.com/lock/" + std::to_string(t) + "/" + std::to_string(i) + "/";
+        std::string prefix = "lk" + std::to_string(t) + "x" + std::to_string(i);
+        XMP_StringPtr regPrefix;
+        XMP_StringLen regLen;
+        XMPMeta::RegisterNamespace(uri.c_str(), prefix.c_str(), &regPrefix, &regLen);
+      }
+    });
+  }
+  for (auto &thread : writers) {
+    thread.join();
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  BOOST_CHECK(misses == 0);
+  for (int t = 0; t < 4; ++t) {
+    for (int i = 0; i < 100; ++i) {
+      std::string uri = "http://ns.example.com/lock/" + std::to_string(t) + "/" + std::to_string(i) + "/";
+      std::string prefix = "lk" + std::to_string(t) + "x" + std::to_string(i) + ":";
+      XMP_StringPtr found;
+      XMP_StringLen len;
+      BOOST_REQUIRE(XMPMeta::GetNamespacePrefix(uri.c_str(), &found, &len));
+      BOOST_CHECK(prefix == found);
+      BOOST_REQUIRE(XMPMeta::GetNamespaceURI(prefix.c_str(), &found, &len));
+      BOOST_CHECK(uri == found);
+    }
+  }
+
+  // A clash with a registered prefix still gets a unique one.
+  XMP_StringPtr regPrefix;
+  XMP_StringLen regLen;
+  BOOST_CHECK(!XMPMeta::RegisterNamespace("http://ns.example.com/clash/", "lk0x0", &regPrefix, &regLen));
+  BOOST_CHECK(strcmp(regPrefix, "lk0x0_1_:") == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_mappedReadOnlyIO)
+{
+  const char *srcdir = getenv("TEST_DIR");
+  std::string path = std::string(srcdir ? srcdir : ".") + "/../../samples/testfiles/BlueSquare.jpg";
+
+  // Mapping is off unless asked for.
+  XMPFiles_IO *plain = XMPFiles_IO::New_XMPFiles_IO(path.c_str(), Host_IO::openReadOnly);
+  BOOST_REQUIRE(plain != 0);
+  BOOST_CHECK(XIO::BorrowRange(plain, 0, 2) == 0);
+  delete plain;
+
+  // And then only local files are mapped.
+  Host_IO::FileRef hostRef = Host_IO::Open(path.c_str(), Host_IO::openReadOnly);
+  BOOST_REQUIRE(hostRef != Host_IO::noFileRef);
+  const bool isLocal = Host_IO::IsLocalFile(hostRef);
+  Host_IO::Close(hostRef);
+  if (!isLocal) {
+    BOOST_TEST_MESSAGE("Test files are not on a local volume, skipping the mapped reads");
+    return;
+  }
+
+  XMPFiles_IO::SetMapReadOnlyFiles(true);
+  XMPFiles_IO *mapped = XMPFiles_IO::New_XMPFiles_IO(path.c_str(), Host_IO::openReadOnly);
+  XMPFiles_IO *unmapped = XMPFiles_IO::New_XMPFiles_IO(path.c_str(), Host_IO::openReadWrite);
+  XMPFiles_IO::SetMapReadOnlyFiles(false);
+  BOOST_REQUIRE(mapped != 0 && unmapped != 0);
+  BOOST_CHECK(mapped->Length() == unmapped->Length());
+
+  // Only the read-only file is mapped, and reads and seeks agree with the host reads.
+  BOOST_CHECK(XIO::BorrowRange(unmapped, 0, 2) == 0);
+  const XMP_Uns8 *soi = XIO::BorrowRange(mapped, 0, 2);
+  BOOST_REQUIRE(soi != 0);
+  BOOST_CHECK(soi[0] == 0xFF && soi[1] == 0xD8);
+  BOOST_CHECK(XIO::BorrowRange(mapped, mapped->Length() - 1, 2) == 0);
+
+  char mappedBuffer[64], hostBuffer[64];
+  BOOST_CHECK(mapped->Seek(-64, kXMP_SeekFromEnd) == unmapped->Seek(-64, kXMP_SeekFromEnd));
+  BOOST_CHECK(mapped->Read(mappedBuffer, 100) == 64);
+  BOOST_CHECK(unmapped->Read(hostBuffer, 100) == 64);
+  BOOST_CHECK(memcmp(mappedBuffer, hostBuffer, 64) == 0);
+  BOOST_CHECK_THROW(mapped->Seek(1, kXMP_SeekFromEnd), XMP_Error);
+
+  std::string mappedRange, hostRange;
+  XIO::ReadRange(mapped, 20, 100, &mappedRange);
+  XIO::ReadRange(unmapped, 20, 100, &hostRange);
+  BOOST_CHECK(mappedRange.size() == 100 && mappedRange == hostRange);
+  BOOST_CHECK(mapped->Offset() == 120 && unmapped->Offset() == 120);
+
+  delete mapped;
+  delete unmapped;
+}
+
+BOOST_AUTO_TEST_CASE(test_readBufferIO)
+{
+  const char *path = "test-readbuffer.bin";
+  Host_IO::Delete(path);
+  Host_IO::Create(path);
+  XMPFiles_IO::SetReadBufferSize(4096);
+  XMPFiles_IO *file = XMPFiles_IO::New_XMPFiles_IO(path, Host_IO::openReadWrite);
+  BOOST_REQUIRE(file != 0);
+
+  std::vector<XMP_Uns8> expected(20000);
+  for (size_t i = 0; i < expected.size(); i++) {
+    expected[i] = (XMP_Uns8)(i * 7);
+  }
+  file->Write(expected.data(), (XMP_Uns32)expected.size());
+
+  // Small sequential reads are served from one host read, seeks never reach the host.
+  XMP_IOStats before = file->GetIOStats();
+  XMP_Uns8 buffer[8192];
+  bool same = true;
+  for (XMP_Int64 offset = 0; offset < 1600; offset += 16) {
+    BOOST_CHECK(file->Seek(offset, kXMP_SeekFromStart) == offset);
+    file->Read(buffer, 16, true);
+    same = same && (memcmp(buffer, &expected[offset], 16) == 0);
+  }
+  BOOST_CHECK(same);
+  XMP_IOStats after = file->GetIOStats();
+  BOOST_CHECK_EQUAL(after.hostReads - before.hostReads, 1);
+  BOOST_CHECK_EQUAL(after.savedReads - before.savedReads, 99);
+  BOOST_CHECK_EQUAL(after.hostSeeks - before.hostSeeks, 1);
+  BOOST_CHECK_EQUAL(after.savedSeeks - before.savedSeeks, 100);
+
+  // A read straddling the buffer end, then one larger than the buffer going to the host directly.
+  file->Seek(4000, kXMP_SeekFromStart);
+  file->Read(buffer, 200, true);
+  BOOST_CHECK(memcmp(buffer, &expected[4000], 200) == 0);
+  file->Read(buffer, 8192, true);
+  BOOST_CHECK(memcmp(buffer, &expected[4200], 8192) == 0);
+
+  // Writes and truncation keep the buffer coherent.
+  file->Seek(10, kXMP_SeekFromStart);
+  file->Read(buffer, 4, true);
+  file->Seek(10, kXMP_SeekFromStart);
+  file->Write("ABCD", 4);
+  memcpy(&expected[10], "ABCD", 4);
+  file->Seek(8, kXMP_SeekFromStart);
+  file->Read(buffer, 8, true);
+  BOOST_CHECK(memcmp(buffer, &expected[8], 8) == 0);
+
+  file->Truncate(12);
+  BOOST_CHECK(file->Seek(100, kXMP_SeekFromStart) == 100);
+  BOOST_CHECK(file->Length() == 100);
+  file->Seek(8, kXMP_SeekFromStart);
+  BOOST_CHECK(file->Read(buffer, 200) == 92);
+  BOOST_CHECK(memcmp(buffer, &expected[8], 4) == 0);
+  BOOST_CHECK(std::count(buffer + 4, buffer + 92, 0) == 88);
+
+  delete file;
+  XMPFiles_IO::SetReadBufferSize(64 * 1024);
+  Host_IO::Delete(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_copyRangeIO)
+{
+  const char *sourcePath = "test-copyrange-src.bin";
+  const char *destPath = "test-copyrange-dst.bin";
+  Host_IO::Delete(sourcePath);
+  Host_IO::Delete(destPath);
+  Host_IO::Create(sourcePath);
+  Host_IO::Create(destPath);
+  XMPFiles_IO *source = XMPFiles_IO::New_XMPFiles_IO(sourcePath, Host_IO::openReadWrite);
+  XMPFiles_IO *dest = XMPFiles_IO::New_XMPFiles_IO(destPath, Host_IO::openReadWrite);
+  BOOST_REQUIRE(source != 0 && dest != 0);
+
+  std::vector<XMP_Uns8> expected(300000);
+  for (size_t i = 0; i < expected.size(); i++) {
+    expected[i] = (XMP_Uns8)(i * 13 + (i >> 9));
+  }
+  source->Write(expected.data(), (XMP_Uns32)expected.size());
+  BOOST_CHECK_EQUAL(source->GetIOStats().hostWrites, 1);
+  BOOST_CHECK_EQUAL(source->GetIOStats().bytesWritten, expected.size());
+
+  // The host may copy any part of the range, without moving the I/O positions.
+  dest->Write("head", 4);
+  const XMP_Int64 length = 250000;
+  XMP_Int64 copied = source->HostCopy(1000, dest, 4, length);
+  BOOST_CHECK(copied >= 0 && copied <= length);
+  BOOST_CHECK(source->Offset() == (XMP_Int64)expected.size());
+  BOOST_CHECK(dest->Offset() == 4);
+  BOOST_CHECK_EQUAL(dest->GetIOStats().bytesCopied, (XMP_Uns64)copied);
+
+  // XIO::Copy gives the same bytes whether the host or memory copies them, each byte is counted once.
+  source->Seek(1000, kXMP_SeekFromStart);
+  XIO::Copy(source, dest, length);
+  BOOST_CHECK(dest->Length() == 4 + length);
+  BOOST_CHECK(source->Offset() == 1000 + length && dest->Offset() == 4 + length);
+  const XMP_IOStats &destStats = dest->GetIOStats();
+  BOOST_CHECK_EQUAL(destStats.bytesWritten + destStats.bytesCopied, (XMP_Uns64)(4 + copied + length));
+
+  std::vector<XMP_Uns8> buffer(length);
+  dest->Seek(4, kXMP_SeekFromStart);
+  dest->Read(buffer.data(), (XMP_Uns32)length, true);
+  BOOST_CHECK(memcmp(buffer.data(), &expected[1000], length) == 0);
+
+  // XIO::Move within one file, up past the EOF and back down, by more and less than a buffer.
+  std::vector<XMP_Uns8> model(expected);
+  const XMP_Int64 moves[][3] = { { 0, 100000, 200000 }, { 100000, 0, 200000 }, { 5000, 5100, 150000 }, { 9000, 10, 100 } };
+  for (const XMP_Int64 *move : moves) {
+    if ((size_t)(move[1] + move[2]) > model.size()) model.resize(move[1] + move[2]);
+    memmove(&model[move[1]], &model[move[0]], move[2]);
+    XIO::Move(source, move[0], source, move[1], move[2]);
+  }
+  BOOST_REQUIRE(source->Length() == (XMP_Int64)model.size());
+  buffer.resize(model.size());
+  source->Seek(0, kXMP_SeekFromStart);
+  source->Read(buffer.data(), (XMP_Uns32)buffer.size(), true);
+  BOOST_CHECK(buffer == model);
+
+  delete source;
+  delete dest;
+  Host_IO::Delete(sourcePath);
+  Host_IO::Delete(destPath);
+}
+
+static std::string readWholeFile(const char *path)
+{
+  std::string data;
+  FILE *file = fopen(path, "rb");
+  if (file == 0) return data;
+  char buffer[4096];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) data.append(buffer, count);
+  fclose(file);
+  return data;
+}
+
+static void updateLabel(const char *path, XMP_FileFormat format, const std::string &label, XMP_IOStats *stats)
+{
+  XMPFiles file;
+  BOOST_REQUIRE(file.OpenFile(path, format, kXMPFiles_OpenForUpdate | kXMPFiles_OpenUseSmartHandler));
+  SXMPMeta meta;
+  BOOST_REQUIRE(file.GetXMP(&meta));
+  meta.SetProperty(kXMP_NS_XMP, "Label", label);
+  file.PutXMP(meta);
+  file.CloseFile();
+  BOOST_CHECK(! file.GetIOStats(stats));	// Closed, the counts of the update remain.
+}
+
+BOOST_AUTO_TEST_CASE(test_jpegFillerUpdate)
+{
+  BOOST_REQUIRE(XMPFiles::Initialize(kXMPFiles_IgnoreLocalText, 0));
+
+  // Update a sample JPEG once, so its legacy metadata is settled and later updates only change the
+  // XMP. Then put an 8000 byte COM filler segment right after the XMP APP1.
+  const char *srcdir = getenv("TEST_DIR");
+  std::string samplePath = std::string(srcdir ? srcdir : ".") + "/../../samples/testfiles/BlueSquare.jpg";
+  std::string jpeg = readWholeFile(samplePath.c_str());
+  BOOST_REQUIRE(jpeg.size() > 4);
+
+  const char *path = "test-jpegfiller.jpg";
+  FILE *out = fopen(path, "wb");
+  BOOST_REQUIRE(out != 0);
+  fwrite(jpeg.data(), 1, jpeg.size(), out);
+  fclose(out);
+  XMP_IOStats stats;
+  updateLabel(path, kXMP_JPEGFile, "settled", &stats);
+  jpeg = readWholeFile(path);
+
+  size_t pos = 2;
+  size_t xmpStart = 0, xmpEnd = 0;
+  while (pos + 4 <= jpeg.size() && xmpEnd == 0) {
+    size_t segmentLength = 2 + (((XMP_Uns8)jpeg[pos + 2] << 8) | (XMP_Uns8)jpeg[pos + 3]);
+    if ((XMP_Uns8)jpeg[pos + 1] == 0xE1 && jpeg.compare(pos + 4, 29, "http://ns.adobe.com/xap/1.0/\0", 29) == 0) {
+      xmpStart = pos;
+      xmpEnd = pos + segmentLength;
+    }
+    pos += segmentLength;
+  }
+  BOOST_REQUIRE(xmpEnd != 0);
+  const size_t fillerLength = 8000;
+  std::string filler = "\xFF\xFE";
+  filler += (char)((fillerLength + 2) >> 8);
+  filler += (char)((fillerLength + 2) & 0xFF);
+  filler.append(fillerLength, '\0');
+  jpeg.insert(xmpEnd, filler);
+  out = fopen(path, "wb");
+  BOOST_REQUIRE(out != 0);
+  fwrite(jpeg.data(), 1, jpeg.size(), out);
+  fclose(out);
+
+  // A packet that fits the APP1 plus the filler is written in place, the file keeps its length.
+  const std::string grownLabel(5000, 'g');
+  updateLabel(path, kXMP_JPEGFile, grownLabel, &stats);
+  std::string updated = readWholeFile(path);
+  BOOST_CHECK_EQUAL(updated.size(), jpeg.size());
+  BOOST_CHECK(stats.bytesWritten > grownLabel.size() && stats.bytesWritten < 12000);
+  BOOST_CHECK_EQUAL(stats.bytesCopied, 0);
+  BOOST_CHECK(updated.compare(xmpEnd + fillerLength + 4, std::string::npos, jpeg, xmpEnd + fillerLength + 4, std::string::npos) == 0);
+
+  // The grown packet is what an exact length serialize makes, only its padding was resized.
+  size_t grownLength = (((XMP_Uns8)updated[xmpStart + 2] << 8) | (XMP_Uns8)updated[xmpStart + 3]) - 2 - 29;
+  std::string grownPacket = updated.substr(xmpStart + 4 + 29, grownLength);
+  SXMPMeta grown(grownPacket.c_str(), (XMP_StringLen)grownPacket.size());
+  std::string exactPacket;
+  grown.SerializeToBuffer(&exactPacket, kXMP_UseCompactFormat | kXMP_ExactPacketLength, (XMP_StringLen)grownLength);
+  BOOST_CHECK(exactPacket == grownPacket);
+
+  // A packet that does not fit is rewritten, all of the new file is written or copied once.
+  const std::string largeLabel(30000, 'L');
+  updateLabel(path, kXMP_JPEGFile, largeLabel, &stats);
+  updated = readWholeFile(path);
+  BOOST_CHECK(updated.size() > jpeg.size());
+  BOOST_CHECK_EQUAL(stats.bytesWritten + stats.bytesCopied, (XMP_Uns64)updated.size());
+
+  XMPFiles file;
+  BOOST_REQUIRE(file.OpenFile(path, kXMP_JPEGFile, kXMPFiles_OpenForRead | kXMPFiles_OpenUseSmartHandler));
+  SXMPMeta meta;
+  BOOST_REQUIRE(file.GetXMP(&meta));
+  std::string label;
+  BOOST_CHECK(meta.GetProperty(kXMP_NS_XMP, "Label", &label, 0));
+  BOOST_CHECK(label == largeLabel);
+  file.CloseFile();
+
+  Host_IO::Delete(path);
+  XMPFiles::Terminate();
+}
+
+static std::string isoBox(const char *type, const std::string &content)
+{
+  std::string box;
+  XMP_Uns32 size = (XMP_Uns32)(8 + content.size());
+  for (int shift = 24; shift >= 0; shift -= 8) box += (char)((size >> shift) & 0xFF);
+  box.append(type, 4);
+  return box + content;
+}
+
+static std::string readLabel(const char *path, XMP_FileFormat format)
+{
+  XMPFiles file;
+  BOOST_REQUIRE(file.OpenFile(path, format, kXMPFiles_OpenForRead | kXMPFiles_OpenUseSmartHandler));
+  SXMPMeta meta;
+  BOOST_REQUIRE(file.GetXMP(&meta));
+  std::string label;
+  meta.GetProperty(kXMP_NS_XMP, "Label", &label, 0);
+  file.CloseFile();
+  return label;
+}
+
+BOOST_AUTO_TEST_CASE(test_mpeg4MoovUpdate)
+{
+  BOOST_REQUIRE(XMPFiles::Initialize(kXMPFiles_IgnoreLocalText, 0));
+
+  // A QuickTime movie with a 200K 'stsz' sample table, followed by an 8K 'free' box and the 'mdat'.
+  std::string stsz(12, '\0');
+  for (XMP_Uns32 i = 0; i < 50000; i++) {
+    XMP_Uns32 sampleSize = 1000 + (i % 997);
+    for (int shift = 24; shift >= 0; shift -= 8) stsz += (char)((sampleSize >> shift) & 0xFF);
+  }
+  stsz[8] = (char)(50000 >> 24); stsz[9] = (char)((50000 >> 16) & 0xFF);
+  stsz[10] = (char)((50000 >> 8) & 0xFF); stsz[11] = (char)(50000 & 0xFF);
+  std::string stbl = isoBox("stsd", std::string(8, '\0')) + isoBox("stsz", stsz);
+  std::string hdlr(24, '\0');
+  hdlr.replace(8, 4, "vide");
+  std::string mdia = isoBox("mdhd", std::string(24, '\0')) + isoBox("hdlr", hdlr) +
+                     isoBox("minf", isoBox("stbl", stbl));
+  std::string mvhd(100, '\0');
+  mvhd[15] = 100;  // Time scale.
+  std::string moov = isoBox("moov", isoBox("mvhd", mvhd) +
+                                    isoBox("trak", isoBox("tkhd", std::string(84, '\0')) + isoBox("mdia", mdia)));
+  const std::string ftyp = isoBox("ftyp", std::string("qt  \0\0\0\0qt  ", 12));
+  std::string movie = ftyp + moov + isoBox("free", std::string(8000, '\0')) + isoBox("mdat", std::string(64, 'm'));
+
+  const char *path = "test-moovupdate.mov";
+  FILE *out = fopen(path, "wb");
+  BOOST_REQUIRE(out != 0);
+  fwrite(movie.data(), 1, movie.size(), out);
+  fclose(out);
+
+  // The new 'udta' box follows the untouched 'trak' box and grows into the 'free' box. Neither the
+  // sample table nor the 'mdat' box is written.
+  XMP_IOStats stats;
+  updateLabel(path, kXMP_MOVFile, "in place", &stats);
+  std::string updated = readWholeFile(path);
+  BOOST_CHECK_EQUAL(updated.size(), movie.size());
+  BOOST_CHECK(stats.bytesWritten < 8000);
+  BOOST_CHECK(updated.compare(0, ftyp.size() + moov.size(), movie, 0, ftyp.size() + moov.size()) != 0);
+  BOOST_CHECK(updated.find(stsz) == movie.find(stsz));
+  BOOST_CHECK(readLabel(path, kXMP_MOVFile) == "in place");
+
+  // A change that no longer fits moves the whole 'moov' box, the sample table goes with it.
+  const std::string largeLabel(20000, 'L');
+  updateLabel(path, kXMP_MOVFile, largeLabel, &stats);
+  updated = readWholeFile(path);
+  BOOST_CHECK(updated.size() > movie.size());
+  BOOST_CHECK(stats.bytesWritten > stsz.size());
+  BOOST_CHECK(updated.find(stsz) > movie.size());
+  BOOST_CHECK(updated.compare(movie.size() - 72, 72, movie, movie.size() - 72, 72) == 0);
+  BOOST_CHECK(readLabel(path, kXMP_MOVFile) == largeLabel);
+
+  Host_IO::Delete(path);
+  XMPFiles::Terminate();
+}
+
+static std::string readLabelStats(const char *path, XMP_IOStats *stats)
+{
+  XMPFiles file;
+  BOOST_REQUIRE(file.OpenFile(path, kXMP_JPEGFile, kXMPFiles_OpenForRead | kXMPFiles_OpenUseSmartHandler));
+  SXMPMeta meta;
+  BOOST_REQUIRE(file.GetXMP(&meta));
+  std::string label;
+  meta.GetProperty(kXMP_NS_XMP, "Label", &label, 0);
+  file.CloseFile();
+  file.GetIOStats(stats);
+  return label;
+}
+
+BOOST_AUTO_TEST_CASE(test_tiffTagReuse)
+{
+  // Little endian, a primary IFD with just an ImageWidth tag.
+  static const XMP_Uns8 tiff[] = {
+    'I', 'I', 0x2A, 0, 8, 0, 0, 0,
+    1, 0,
+    0x00, 0x01, 3, 0, 1, 0, 0, 0, 16, 0, 0, 0,
+    0, 0, 0, 0
+  };
+  TIFF_FileWriter writer;
+  writer.ParseMemoryStream(tiff, sizeof(tiff));
+
+  // A deleted tag's slot is reused by the next added tag. The small value of a tag lives in its
+  // slot, so the same data pointer means the same slot.
+  const std::string artist(100, 'a');
+  TIFF_Manager::TagInfo info;
+  const void *firstSlot = 0;
+  for (int cycle = 0; cycle < 1000; ++cycle) {
+    writer.SetTag(kTIFF_PrimaryIFD, kTIFF_Software, kTIFF_ASCIIType, 4, "abc");
+    writer.SetTag(kTIFF_PrimaryIFD, kTIFF_Artist, kTIFF_ASCIIType, (XMP_Uns32)artist.size() + 1, artist.c_str());
+    BOOST_REQUIRE(writer.GetTag(kTIFF_PrimaryIFD, kTIFF_Software, &info));
+    if (cycle == 0) firstSlot = info.dataPtr;
+    BOOST_CHECK(info.dataPtr == firstSlot);
+    writer.DeleteTag(kTIFF_PrimaryIFD, kTIFF_Artist);
+    writer.DeleteTag(kTIFF_PrimaryIFD, kTIFF_Software);	// Freed last, reused first.
+  }
+
+  // The tags set after the cycles survive a round trip through the stream.
+  writer.SetTag(kTIFF_PrimaryIFD, kTIFF_Software, kTIFF_ASCIIType, 4, "xyz");
+  writer.SetTag(kTIFF_PrimaryIFD, kTIFF_Artist, kTIFF_ASCIIType, (XMP_Uns32)artist.size() + 1, artist.c_str());
+  void *stream = 0;
+  XMP_Uns32 length = writer.UpdateMemoryStream(&stream, true);
+  BOOST_REQUIRE(length > sizeof(tiff));
+
+  TIFF_FileWriter reader;
+  reader.ParseMemoryStream(stream, length);
+  XMP_Uns32 width = 0;
+  BOOST_CHECK(reader.GetTag_Integer(kTIFF_PrimaryIFD, kTIFF_ImageWidth, &width));
+  BOOST_CHECK_EQUAL(width, 16);
+  XMP_StringPtr value = 0;
+  XMP_StringLen valueLen = 0;
+  BOOST_CHECK(reader.GetTag_ASCII(kTIFF_PrimaryIFD, kTIFF_Software, &value, &valueLen));
+  BOOST_CHECK(std::string(value) == "xyz");
+  BOOST_CHECK(reader.GetTag_ASCII(kTIFF_PrimaryIFD, kTIFF_Artist, &value, &valueLen));
+  BOOST_CHECK(std::string(value) == artist);
+  TIFF_Manager::TagInfoMap ifdMap;
+  BOOST_CHECK(reader.GetIFD(kTIFF_PrimaryIFD, &ifdMap));
+  BOOST_CHECK_EQUAL(ifdMap.size(), 3);
+}
+
+static size_t countCacheRecords(const char *folderPath)
+{
+  size_t count = 0;
+  Host_IO::AutoFolder folder;
+  folder.folder = Host_IO::OpenFolder(folderPath);
+  std::string child;
+  while (Host_IO::GetNextChild(folder.folder, &child)) {
+    if (child.size() > 5 && child.compare(child.size() - 5, 5, ".xmpc") == 0) count++;
+  }
+  return count;
+}
+
+BOOST_AUTO_TEST_CASE(test_metadataCache)
+{
+  BOOST_REQUIRE(XMPFiles::Initialize(kXMPFiles_IgnoreLocalText, 0));
+
+  const char *srcdir = getenv("TEST_DIR");
+  std::string samplePath = std::string(srcdir ? srcdir : ".") + "/../../samples/testfiles/BlueSquare.jpg";
+  std::string jpeg = readWholeFile(samplePath.c_str());
+  BOOST_REQUIRE(jpeg.size() > 4);
+  const char *path = "test-metadatacache.jpg";
+  FILE *out = fopen(path, "wb");
+  BOOST_REQUIRE(out != 0);
+  fwrite(jpeg.data(), 1, jpeg.size(), out);
+  fclose(out);
+  XMP_IOStats stats;
+  updateLabel(path, kXMP_JPEGFile, "cached", &stats);
+
+  const char *folder = "test-metadatacache";
+  mkdir(folder, 0755);
+  XMPFiles::SetMetadataCache(folder);
+  BOOST_CHECK_THROW(XMPFiles::SetMetadataCache(path), XMP_Error);
+
+  // The first read stores a record, the second one doesn't touch the file.
+  BOOST_CHECK(readLabelStats(path, &stats) == "cached");
+  BOOST_CHECK(stats.hostReads + stats.savedReads > 0);
+  BOOST_CHECK_EQUAL(countCacheRecords(folder), 1);
+  BOOST_CHECK(readLabelStats(path, &stats) == "cached");
+  BOOST_CHECK_EQUAL(stats.hostReads + stats.savedReads, 0);
+
+  // An update removes the record, a file changed behind the cache's back doesn't match it.
+  updateLabel(path, kXMP_JPEGFile, "updated", &stats);
+  BOOST_CHECK_EQUAL(countCacheRecords(folder), 0);
+  BOOST_CHECK(readLabelStats(path, &stats) == "updated");
+  BOOST_CHECK(stats.hostReads + stats.savedReads > 0);
+  out = fopen(path, "ab");
+  BOOST_REQUIRE(out != 0);
+  fputc(0, out);
+  fclose(out);
+  BOOST_CHECK(readLabelStats(path, &stats) == "updated");
+  BOOST_CHECK(stats.hostReads + stats.savedReads > 0);
+  BOOST_CHECK(readLabelStats(path, &stats) == "updated");
+  BOOST_CHECK_EQUAL(stats.hostReads + stats.savedReads, 0);
+
+  // Nor does one edited in place that keeps its length and modification time.
+  struct stat before;
+  BOOST_REQUIRE(stat(path, &before) == 0);
+  std::string edited = readWholeFile(path);
+  size_t labelPos = edited.find("\"updated\"");
+  BOOST_REQUIRE(labelPos != std::string::npos);
+  edited.replace(labelPos + 1, 7, "changed");
+  out = fopen(path, "r+b");
+  BOOST_REQUIRE(out != 0);
+  fwrite(edited.data(), 1, edited.size(), out);
+  fclose(out);
+  struct timespec times[2] = { before.st_atim, before.st_mtim };
+  BOOST_REQUIRE(utimensat(AT_FDCWD, path, times, 0) == 0);
+  BOOST_CHECK(readLabelStats(path, &stats) == "changed");
+  BOOST_CHECK(stats.hostReads + stats.savedReads > 0);
+
+  // Records over the size limit are evicted.
+  XMPFiles::SetMetadataCache(folder, 16);
+  BOOST_CHECK_EQUAL(countCacheRecords(folder), 0);
+  BOOST_CHECK(readLabelStats(path, &stats) == "changed");
+  BOOST_CHECK_EQUAL(countCacheRecords(folder), 0);
+
+  XMPFiles::SetMetadataCache(0);
+  Host_IO::Delete(folder);
+  Host_IO::Delete(path);
+  XMPFiles::Terminate();
+}
+
+static std::string encodePacket(const std::u32string &text, XMPScanner::CharacterForm form)
+{
+  std::string bytes;
+  for (char32_t ch : text) {
+    if (form == XMPScanner::eChar8Bit) {
+      if (ch == 0xFEFF) {
+        bytes += "\xEF\xBB\xBF";
+      } else {
+        bytes += (char)ch;
+      }
+      continue;
+    }
+    size_t width = CharFormIs16Bit(form) ? 2 : 4;
+    for (size_t i = 0; i < width; i++) {
+      size_t shift = CharFormIsBigEndian(form) ? (width - 1 - i) * 8 : i * 8;
+      bytes += (char)((ch >> shift) & 0xFF);
+    }
+  }
+  return bytes;
+}
+
+BOOST_AUTO_TEST_CASE(test_packetScanner)
+{
+  const std::u32string packet = U"<?xpacket begin=\"\uFEFF\" id=\"W5M0MpCehiHzreSzNTczkc9d\"?>"
+    U"<x:xmpmeta xmlns:x=\"adobe:ns:meta/\"/>  <?xpacket end=\"w\"?>";
+  const XMPScanner::CharacterForm forms[] = {
+    XMPScanner::eChar8Bit, XMPScanner::eChar16BitBig, XMPScanner::eChar16BitLittle,
+    XMPScanner::eChar32BitBig, XMPScanner::eChar32BitLittle
+  };
+  // Near misses for the header search, each followed by a byte that is not '?'.
+  const std::string decoys[] = {
+    std::string("<"), std::string("<\0", 2), std::string("<\0\0", 3), std::string("<\0\0\0", 4),
+    std::string("<?xpack"), std::string("<\0?\0x\0", 6)
+  };
+
+  std::string stream;
+  std::vector<XMP_Int64> offsets;
+  unsigned int seed = 1;
+  for (int round = 0; round < 3; round++) {
+    for (auto form : forms) {
+      for (int i = 0; i < 300 + 37 * round; i++) {
+        seed = seed * 1103515245 + 12345;
+        stream += (char)(seed >> 16);
+        if ((seed >> 8) % 50 == 0) {
+          stream += decoys[(seed >> 4) % 6];
+        }
+      }
+      offsets.push_back((XMP_Int64)stream.size());
+      stream += encodePacket(packet, form);
+    }
+  }
+
+  // The result must not depend on how the input is split into buffers.
+  for (size_t chunk : { (size_t)1, (size_t)13, (size_t)4096, stream.size() }) {
+    XMPScanner scanner(stream.size());
+    for (size_t offset = 0; offset < stream.size(); offset += chunk) {
+      scanner.Scan(stream.data() + offset, offset, std::min(chunk, stream.size() - offset));
+    }
+    XMPScanner::SnipInfoVector snips(scanner.GetSnipCount());
+    scanner.Report(snips);
+
+    size_t found = 0;
+    for (const auto &snip : snips) {
+      if (snip.fState != XMPScanner::eValidPacketSnip) continue;
+      BOOST_REQUIRE(found < offsets.size());
+      BOOST_CHECK_EQUAL(snip.fOffset, offsets[found]);
+      BOOST_CHECK_EQUAL(snip.fCharForm, forms[found % 5]);
+      BOOST_CHECK_EQUAL(snip.fLength, (XMP_Int64)encodePacket(packet, forms[found % 5]).size());
+      found++;
+    }
+    BOOST_CHECK_EQUAL(found, offsets.size());
+  }
+}
+
+static std::vector<std::pair<XMP_Int64, XMP_Int64>> scanPackets(const std::string &data, size_t threads)
+{
+  const char *path = "test-packetscan.bin";
+  Host_IO::Delete(path);
+  Host_IO::Create(path);
+  XMPFiles_IO *file = XMPFiles_IO::New_XMPFiles_IO(path, Host_IO::openReadWrite);
+  file->Write(data.data(), (XMP_Uns32)data.size());
+
+  XMPScanner::SnipInfoVector snips;
+  PacketScanning_Support::ScanFile(file, path, &snips, 0, 0, threads, 1);
+  delete file;
+  Host_IO::Delete(path);
+
+  std::vector<std::pair<XMP_Int64, XMP_Int64>> packets;
+  for (const auto &snip : snips) {
+    packets.push_back(std::make_pair(snip.fOffset, snip.fLength));
+  }
+  return packets;
+}
+
+BOOST_AUTO_TEST_CASE(test_parallelPacketScan)
+{
+  const size_t kRange = 2 * PacketScanning_Support::kScanBufferSize;	// With 4 threads on 8 buffers.
+  const std::u32string body = U"<?xpacket begin=\"\uFEFF\" id=\"W5M0MpCehiHzreSzNTczkc9d\"?>"
+    U"<x:xmpmeta xmlns:x=\"adobe:ns:meta/\"/>";
+  const std::u32string trailer = U"<?xpacket end=\"w\"?>";
+  const std::string packet8 = encodePacket(body + trailer, XMPScanner::eChar8Bit);
+  const std::string packet16 = encodePacket(body + trailer, XMPScanner::eChar16BitBig);
+
+  // A packet straddling each range and buffer boundary, a big endian one whose '<' is the first
+  // byte of a range, a header inside a packet body across a range boundary, and a header without
+  // a trailer hiding everything after it.
+  struct Layout {
+    std::vector<std::pair<size_t, std::string>> pieces;
+  };
+  std::vector<Layout> layouts(3);
+  for (size_t b = 1; b < 8; b++) {
+    layouts[0].pieces.push_back(std::make_pair(b * PacketScanning_Support::kScanBufferSize - 40, packet8));
+  }
+  layouts[1].pieces.push_back(std::make_pair(kRange - 1, packet16));
+  layouts[1].pieces.push_back(std::make_pair(2 * kRange - 30, encodePacket(body, XMPScanner::eChar8Bit)));
+  layouts[1].pieces.push_back(std::make_pair(2 * kRange + 10, packet8));
+  layouts[1].pieces.push_back(std::make_pair(3 * kRange + 100, packet8));
+  layouts[2].pieces.push_back(std::make_pair(100, packet8));
+  layouts[2].pieces.push_back(std::make_pair(kRange - 20, encodePacket(body, XMPScanner::eChar8Bit)));
+  layouts[2].pieces.push_back(std::make_pair(2 * kRange + 10, packet8));
+
+  for (const auto &layout : layouts) {
+    std::string data(4 * kRange, 'x');
+    for (size_t i = 0; i < data.size(); i += 97) {
+      data[i] = '<';
+    }
+    for (const auto &piece : layout.pieces) {
+      data.replace(piece.first, piece.second.size(), piece.second);
+    }
+
+    XMPScanner sequential(data.size());
+    sequential.Scan(data.data(), 0, data.size());
+    XMPScanner::SnipInfoVector snips(sequential.GetSnipCount());
+    sequential.Report(snips);
+    std::vector<std::pair<XMP_Int64, XMP_Int64>> expected;
+    for (const auto &snip : snips) {
+      if (snip.fState == XMPScanner::eValidPacketSnip || snip.fState == XMPScanner::eBadPacketSnip) {
+        expected.push_back(std::make_pair(snip.fOffset, snip.fLength));
+      }
+    }
+    BOOST_CHECK(!expected.empty());
+
+    BOOST_CHECK(scanPackets(data, 1) == expected);
+    BOOST_CHECK(scanPackets(data, 4) == expected);
+
+    // With the worker budget used up, the calling thread scans every range.
+    size_t held = ReserveWorkerThreads(1000);
+    BOOST_CHECK(scanPackets(data, 4) == expected);
+    ReleaseWorkerThreads(held);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_workerThreadBudget)
+{
+  size_t processors = std::thread::hardware_concurrency();
+  size_t limit = (processors > 1) ? processors - 1 : 0;
+
+  size_t first = ReserveWorkerThreads(1000);
+  BOOST_CHECK_EQUAL(first, limit);
+  BOOST_CHECK_EQUAL(ReserveWorkerThreads(1), 0);
+  ReleaseWorkerThreads(first);
+
+  if (limit > 0) {
+    BOOST_CHECK_EQUAL(ReserveWorkerThreads(1), 1);
+    BOOST_CHECK_EQUAL(ReserveWorkerThreads(1000), limit - 1);
+    ReleaseWorkerThreads(limit);
+  }
+  BOOST_CHECK_EQUAL(ReserveWorkerThreads(1000), limit);
+  ReleaseWorkerThreads(limit);
+}
+
+static std::string parseAndSerialize(const std::string &packet, XMP_OptionBits options, size_t chunk)
+{
+  XMPMeta meta;
+  if (chunk == 0) {
+    meta.ParseFromBuffer(packet.c_str(), packet.size(), options);
+  } else {
+    for (size_t offset = 0; offset < packet.size(); offset += chunk) {
+      size_t len = std::min(chunk, packet.size() - offset);
+      meta.ParseFromBuffer(packet.c_str() + offset, len, options | kXMP_ParseMoreBuffers);
+    }
+    meta.ParseFromBuffer("", 0, options);
+  }
+  std::string result;
+  meta.SerializeToBuffer(&result, kXMP_OmitPacketWrapper, 0, "\n", " ", 0);
+  return result;
+}
+
+BOOST_AUTO_TEST_CASE(test_streamingParse)
+{
+  std::string history;
+  for (int i = 0; i < 50; i++) {
+    history += "<rdf:li rdf:parseType='Resource'><stEvt:action>saved</stEvt:action>"
+      "<stEvt:instanceID>xmp.iid:" + std::to_string(i) + "</stEvt:instanceID></rdf:li>\n";
+  }
+  const std::string packets[] = {
+    "<?xpacket begin='' id='W5M0MpCehiHzreSzNTczkc9d'?>"
+    "<x:xmpmeta xmlns:x='adobe:ns:meta/'>"
+    "<rdf:RDF xmlns:rdf='http://www.w3.org/1999/02/22-rdf-syntax-ns#'>"
+    " <rdf:Description rdf:about='' xmlns:xmpMM='http://ns.adobe.com/xap/1.0/mm/'"
+    "  xmlns:stEvt='http://ns.adobe.com/xap/1.0/sType/ResourceEvent#'>"
+    "  <xmpMM:History><rdf:Seq>" + history + "</rdf:Seq></xmpMM:History>"
+    " </rdf:Description>"
+    " <rdf:Description rdf:about='' xmlns:dc='http://purl.org/dc/elements/1.1/' dc:format='image/jpeg'>"
+    "  <dc:title><rdf:Alt><rdf:li xml:lang='x-default'>T</rdf:li><rdf:li xml:lang='en'>T</rdf:li></rdf:Alt></dc:title>"
+    "  <dc:creator><rdf:Seq><rdf:li>A</rdf:li><rdf:li rdf:parseType='Resource'>"
+    "   <rdf:value>B</rdf:value><stEvt:action>q</stEvt:action></rdf:li></rdf:Seq></dc:creator>"
+    "  <dc:subject><rdf:Bag><rdf:li>a</rdf:li></rdf:Bag> <rdf:Bag><rdf:li>b</rdf:li></rdf:Bag></dc:subject>"
+    " </rdf:Description>"
+    "</rdf:RDF></x:xmpmeta><?xpacket end='w'?>",
+    // Bare rdf:RDF, only streamed without kXMP_RequireXMPMeta.
+    "<rdf:RDF xmlns:rdf='http://www.w3.org/1999/02/22-rdf-syntax-ns#'>"
+    "<rdf:Description xmlns:dc='http://purl.org/dc/elements/1.1/'>"
+    "<dc:subject><rdf:Bag><rdf:li>a</rdf:li></rdf:Bag></dc:subject>"
+    "</rdf:Description></rdf:RDF>",
+    // Not an outermost x:xmpmeta, left to the normal processing.
+    "<svg><x:xmpmeta xmlns:x='adobe:ns:meta/'>"
+    "<rdf:RDF xmlns:rdf='http://www.w3.org/1999/02/22-rdf-syntax-ns#'>"
+    "<rdf:Description xmlns:dc='http://purl.org/dc/elements/1.1/'>"
+    "<dc:subject><rdf:Bag><rdf:li>a</rdf:li></rdf:Bag></dc:subject>"
+    "</rdf:Description></rdf:RDF></x:xmpmeta></svg>",
+  };
+
+  for (const std::string &packet : packets) {
+    for (XMP_OptionBits options : { 0UL, (unsigned long)kXMP_RequireXMPMeta }) {
+      std::string expected;
+      try {
+        expected = parseAndSerialize(packet, options, 0);
+      } catch (const XMP_Error &) {
+        expected = "exception";
+      }
+      for (size_t chunk : { 0, 1, 13 }) {
+        std::string streamed;
+        try {
+          streamed = parseAndSerialize(packet, options | kXMP_ParseStreaming, chunk);
+        } catch (const XMP_Error &) {
+          streamed = "exception";
+        }
+        BOOST_CHECK_EQUAL(streamed, expected);
+      }
+    }
+  }
+
+  XMP_StringPtr value;
+  XMP_StringLen len;
+  XMP_OptionBits options;
+  XMPMeta meta;
+  meta.ParseFromBuffer(packets[0].c_str(), packets[0].size(), kXMP_ParseStreaming);
+  BOOST_CHECK(meta.GetProperty(kXMP_NS_XMP_MM, "History[50]/stEvt:instanceID", &value, &len, &options));
+  BOOST_CHECK(strcmp(value, "xmp.iid:49") == 0);
+}
+
+static XMP_Status appendToString(void *refCon, XMP_StringPtr buffer, XMP_StringLen bufferSize)
+{
+  static_cast<std::string *>(refCon)->append(buffer, bufferSize);
+  return 0;
+}
+
+static XMP_Status failOutput(void *, XMP_StringPtr, XMP_StringLen)
+{
+  return 1;
+}
+
+BOOST_AUTO_TEST_CASE(test_serializeToSink)
+{
+  XMPMeta meta;
+  meta.SetProperty(kXMP_NS_XMP, "CreatorTool", "a & b < c > d \"e\"\tf\ng", 0);
+  meta.SetProperty(kXMP_NS_XMP, "Label", std::string(40000, 'x').c_str(), 0);
+  meta.SetLocalizedText(kXMP_NS_DC, "title", "", "x-default", "Title", 0);
+  meta.SetQualifier(kXMP_NS_XMP, "CreatorTool", kXMP_NS_DC, "source", "q\"q", 0);
+  meta.AppendArrayItem(kXMP_NS_DC, "subject", kXMP_PropArrayIsUnordered, "one", 0);
+  meta.SetStructField(kXMP_NS_XMP_MM, "DerivedFrom", kXMP_NS_XMP_ResourceRef, "documentID", "id&1", 0);
+
+  const XMP_OptionBits optionSets[] = {
+    0, kXMP_UseCompactFormat, kXMP_UseCanonicalFormat, kXMP_OmitPacketWrapper, kXMP_ReadOnlyPacket,
+    kXMP_IncludeRDFHash, kXMP_OmitAllFormatting, kXMP_ExactPacketLength,
+    kXMP_ExactPacketLength | kXMP_UseCompactFormat | kXMP_IncludeRDFHash, kXMP_EncodeUTF16Big,
+    kXMP_EncodeUTF32Little | kXMP_ExactPacketLength
+  };
+
+  for (XMP_OptionBits options : optionSets) {
+    XMP_StringLen padding = (options & kXMP_ExactPacketLength) ? 200000 : 0;
+    std::string buffered, streamed;
+    meta.SerializeToBuffer(&buffered, options, padding, "", "", 0);
+    meta.SerializeToSink(appendToString, &streamed, options, padding, "", "", 0);
+    BOOST_CHECK(streamed == buffered);
+    if (options & kXMP_ExactPacketLength) {
+      BOOST_CHECK_EQUAL(buffered.size(), padding);
+    }
+    if (options & kXMP_IncludeRDFHash) {
+      BOOST_CHECK(buffered.find(" rdfhash=\"") != std::string::npos);
+    }
+  }
+
+  std::string indented, streamed;
+  meta.SerializeToBuffer(&indented, kXMP_UseCompactFormat, 100, "\r\n", "\t", 2);
+  meta.SerializeToSink(appendToString, &streamed, kXMP_UseCompactFormat, 100, "\r\n", "\t", 2);
+  BOOST_CHECK(streamed == indented);
+
+  BOOST_CHECK_THROW(meta.SerializeToBuffer(&streamed, kXMP_ExactPacketLength, 1000, "", "", 0), XMP_Error);
+  try {
+    meta.SerializeToSink(failOutput, 0, 0, 0, "", "", 0);
+    BOOST_ERROR("SerializeToSink did not fail");
+  } catch (const XMP_Error &e) {
+    BOOST_CHECK_EQUAL(e.GetID(), kXMPErr_ExternalFailure);
+  }
+}
+
+static size_t findXMLEscapeRef(const std::string &text, size_t pos, bool forAttribute)
+{
+  for (; pos < text.size(); pos++) {
+    unsigned char ch = text[pos];
+    if (ch < 0x20 || ch == '&' || ch == '<' || ch == '>' || (forAttribute && ch == '"')) break;
+  }
+  return pos;
+}
+
+BOOST_AUTO_TEST_CASE(test_xmlTextScan)
+{
+  // Mostly plain text, with the bytes each scan stops at sprinkled in.
+  const char special[] = { '&', '<', '>', '"', ' ', '\t', '\n', '\r', 0x01, 0x7F, '\x80', '\xE9' };
+  std::string text;
+  unsigned int seed = 7;
+  for (int i = 0; i < 4000; i++) {
+    seed = seed * 1103515245 + 12345;
+    text += ((seed >> 8) % 23 == 0) ? special[(seed >> 16) % sizeof(special)] : (char)('a' + (seed >> 16) % 26);
+  }
+  text += std::string(100, 'x') + "&" + std::string(100, ' ') + "\t";
+
+  const XMP_Uns8 *base = (const XMP_Uns8 *)text.data();
+  for (size_t start = 0; start < text.size(); start += 1 + start % 5) {
+    for (size_t len : { (size_t)0, (size_t)7, (size_t)16, (size_t)33, text.size() - start }) {
+      if (start + len > text.size()) continue;
+      const std::string run = text.substr(0, start + len);
+      const XMP_Uns8 *limit = base + start + len;
+
+      BOOST_CHECK_EQUAL(XMP_FindXMLEscape(base + start, limit, false) - base,
+                        (ptrdiff_t)findXMLEscapeRef(run, start, false));
+      BOOST_CHECK_EQUAL(XMP_FindXMLEscape(base + start, limit, true) - base,
+                        (ptrdiff_t)findXMLEscapeRef(run, start, true));
+
+      size_t plain = start;
+      while (plain < run.size() && (unsigned char)run[plain] >= 0x20 && (unsigned char)run[plain] <= 0x7E && run[plain] != '&') plain++;
+      BOOST_CHECK_EQUAL(XMP_SkipPlainASCII(base + start, limit) - base, (ptrdiff_t)plain);
+
+      size_t white = run.find_first_not_of(" \t\n\r", start);
+      if (white == std::string::npos) white = run.size();
+      BOOST_CHECK_EQUAL(XMP_SkipXMLWhitespace(base + start, limit) - base, (ptrdiff_t)white);
+    }
+  }
+
+  // Escaped values, in elements and in the compact form's attributes, must come back unchanged.
+  const std::string value = std::string(40, 'v') + "\t<tag attr=\"1\"> & \r\n" + std::string(40, 'w') + "\"";
+  for (XMP_OptionBits options : { (XMP_OptionBits)0, (XMP_OptionBits)kXMP_UseCompactFormat }) {
+    XMPMeta meta;
+    meta.SetProperty(kXMP_NS_XMP, "Label", value.c_str(), 0);
+    std::string packet;
+    meta.SerializeToBuffer(&packet, options, 0, "", "", 0);
+    XMPMeta parsed;
+    parsed.ParseFromBuffer(packet.c_str(), (XMP_StringLen)packet.size(), 0);
+    XMP_StringPtr parsedValue;
+    XMP_StringLen parsedLen;
+    XMP_OptionBits parsedOptions;
+    BOOST_REQUIRE(parsed.GetProperty(kXMP_NS_XMP, "Label", &parsedValue, &parsedLen, &parsedOptions));
+    BOOST_CHECK_EQUAL(std::string(parsedValue, parsedLen), value);
+  }
+}
+
+static std::string serializeRDF(const XMPMeta &meta)
+{
+  std::string rdf;
+  meta.SerializeToBuffer(&rdf, kXMP_OmitPacketWrapper, 0, "", "", 0);
+  return rdf;
+}
+
+BOOST_AUTO_TEST_CASE(test_binarySerialize)
+{
+  XMP_StringPtr regPrefix;
+  XMP_StringLen regLen;
+  XMPMeta::RegisterNamespace("ns:binarytest/", "bt", &regPrefix, &regLen);
+
+  XMPMeta meta;
+  meta.SetObjectName("about:binary");
+  meta.SetProperty(kXMP_NS_XMP, "CreatorTool", "a & b < c", 0);
+  meta.SetQualifier(kXMP_NS_XMP, "CreatorTool", kXMP_NS_DC, "source", "q", 0);
+  meta.SetLocalizedText(kXMP_NS_DC, "title", "", "x-default", "Title", 0);
+  meta.SetLocalizedText(kXMP_NS_DC, "title", "fr", "fr-FR", std::string(300, 't').c_str(), 0);
+  meta.AppendArrayItem(kXMP_NS_DC, "subject", kXMP_PropArrayIsUnordered, "one", 0);
+  meta.AppendArrayItem(kXMP_NS_DC, "subject", kXMP_PropArrayIsUnordered, "", 0);
+  meta.SetStructField(kXMP_NS_XMP_MM, "DerivedFrom", kXMP_NS_XMP_ResourceRef, "documentID", "id&1", 0);
+  meta.SetStructField("ns:binarytest/", "Struct", "ns:binarytest/", "Field", "bt value", 0);
+  meta.SetProperty("ns:binarytest/", "Empty", 0, kXMP_PropValueIsStruct);
+
+  std::string binary;
+  meta.SerializeToBuffer(&binary, kXMP_SerializeBinary, 0, "", "", 0);
+  BOOST_CHECK(binary.size() < serializeRDF(meta).size());
+
+  XMPMeta loaded;
+  loaded.ParseFromBuffer(binary.data(), (XMP_StringLen)binary.size(), kXMP_ParseBinary);
+  BOOST_CHECK_EQUAL(serializeRDF(loaded), serializeRDF(meta));
+
+  std::string streamed;
+  meta.SerializeToSink(appendToString, &streamed, kXMP_SerializeBinary, 0, "", "", 0);
+  BOOST_CHECK(streamed == binary);
+
+  // A packet parsed from RDF comes back the same.
+  const char *srcdir = getenv("TEST_DIR");
+  BOOST_REQUIRE(srcdir != nullptr);
+  std::string path = std::string(srcdir) + "/test1.xmp";
+  FILE *file = fopen(path.c_str(), "rb");
+  BOOST_REQUIRE(file != nullptr);
+  std::string packet;
+  char buffer[4096];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) packet.append(buffer, count);
+  fclose(file);
+  XMPMeta parsed;
+  parsed.ParseFromBuffer(packet.c_str(), (XMP_StringLen)packet.size(), 0);
+  std::string parsedBinary;
+  parsed.SerializeToBuffer(&parsedBinary, kXMP_SerializeBinary, 0, "", "", 0);
+  XMPMeta parsedLoaded;
+  parsedLoaded.ParseFromBuffer(parsedBinary.data(), (XMP_StringLen)parsedBinary.size(), kXMP_ParseBinary);
+  BOOST_CHECK_EQUAL(serializeRDF(parsedLoaded), serializeRDF(parsed));
+
+  // A prefix the reader has registered differently is changed to the registered one.
+  std::string renamed = binary;
+  for (size_t pos = renamed.find("bt:"); pos != std::string::npos; pos = renamed.find("bt:", pos)) {
+    renamed[pos + 1] = 'x';
+  }
+  XMPMeta remapped;
+  remapped.ParseFromBuffer(renamed.data(), (XMP_StringLen)renamed.size(), kXMP_ParseBinary);
+  BOOST_CHECK_EQUAL(serializeRDF(remapped), serializeRDF(meta));
+
+  // A new namespace whose prefix another URI took is renamed after the read,
+  // the lookups must see the new names of a wide, indexed schema.
+  XMPMeta::RegisterNamespace("ns:binaryclash/", "bc", &regPrefix, &regLen);
+  XMPMeta wide;
+  for (int i = 0; i < 20; i++) {
+    std::string field = "Field" + std::to_string(i);
+    wide.SetProperty("ns:binaryclash/", field.c_str(), "value", 0);
+  }
+  std::string wideBinary;
+  wide.SerializeToBuffer(&wideBinary, kXMP_SerializeBinary, 0, "", "", 0);
+  for (size_t pos = wideBinary.find("ns:binaryclash/"); pos != std::string::npos;
+       pos = wideBinary.find("ns:binaryclash/", pos)) {
+    wideBinary.replace(pos, 15, "ns:binaryclazz/");
+  }
+  XMPMeta clashed;
+  clashed.ParseFromBuffer(wideBinary.data(), (XMP_StringLen)wideBinary.size(), kXMP_ParseBinary);
+  BOOST_CHECK(XMPMeta::GetNamespacePrefix("ns:binaryclazz/", &regPrefix, &regLen));
+  BOOST_CHECK(std::string(regPrefix, regLen) != "bc:");
+  BOOST_CHECK(clashed.DoesPropertyExist("ns:binaryclazz/", "Field7"));
+  XMP_StringPtr fieldValue;
+  XMP_StringLen fieldLen;
+  XMP_OptionBits fieldOptions;
+  BOOST_CHECK(clashed.GetProperty("ns:binaryclazz/", "Field19", &fieldValue, &fieldLen, &fieldOptions));
+  clashed.SetProperty("ns:binaryclazz/", "Field3", "changed", 0);
+  BOOST_REQUIRE_EQUAL(clashed.tree.children.size(), 1U);
+  BOOST_CHECK_EQUAL(clashed.tree.children[0]->children.size(), 20U);
+
+  // Every truncation, and RDF, is malformed and leaves the object empty.
+  for (size_t len = 0; len < binary.size(); len++) {
+    XMPMeta truncated;
+    truncated.SetProperty(kXMP_NS_XMP, "Label", "old", 0);
+    try {
+      truncated.ParseFromBuffer(binary.data(), (XMP_StringLen)len, kXMP_ParseBinary);
+      BOOST_ERROR("No exception for a truncated binary packet");
+    } catch (const XMP_Error &e) {
+      BOOST_CHECK_EQUAL(e.GetID(), kXMPErr_BadXMP);
+    }
+    BOOST_CHECK(truncated.tree.children.empty());
+  }
+  BOOST_CHECK_THROW(loaded.ParseFromBuffer(packet.c_str(), (XMP_StringLen)packet.size(), kXMP_ParseBinary), XMP_Error);
+
+  try {
+    meta.SerializeToBuffer(&binary, kXMP_SerializeBinary | kXMP_EncodeUTF16Big, 0, "", "", 0);
+    BOOST_ERROR("No exception for a binary encoding");
+  } catch (const XMP_Error &e) {
+    BOOST_CHECK_EQUAL(e.GetID(), kXMPErr_BadOptions);
+  }
+  try {
+    loaded.ParseFromBuffer(binary.data(), (XMP_StringLen)binary.size(), kXMP_ParseBinary | kXMP_ParseMoreBuffers);
+    BOOST_ERROR("No exception for a buffered binary parse");
+  } catch (const XMP_Error &e) {
+    BOOST_CHECK_EQUAL(e.GetID(), kXMPErr_BadOptions);
+  }
+}
+
+// A hand made binary packet. The names are the indices of kBinaryNames, the root has the given
+// children.
+static const char *kBinaryNames[] = { kXMP_NS_DC, "dc:subject", "[]", "xml:lang", "dc:title",
+                                      "rdf:type", "ns:binarymalformed/", "bm:prop" };
+enum { kDC, kSubject, kItem, kLang, kTitle, kType, kBMSchema, kBMProp };
+
+static void appendBinaryVarint(std::string &out, XMP_Uns32 number)
+{
+  while (number >= 0x80) {
+    out.push_back((char)((number & 0x7F) | 0x80));
+    number >>= 7;
+  }
+  out.push_back((char)number);
+}
+
+static void appendBinaryString(std::string &out, const std::string &str)
+{
+  appendBinaryVarint(out, (XMP_Uns32)str.size());
+  out += str;
+}
+
+static std::string binaryNode(XMP_Uns32 name, XMP_OptionBits options, const std::string &value,
+                              const std::vector<std::string> &qualifiers = {},
+                              const std::vector<std::string> &children = {})
+{
+  std::string node;
+  appendBinaryVarint(node, name);
+  appendBinaryVarint(node, options);
+  appendBinaryString(node, value);
+  appendBinaryVarint(node, (XMP_Uns32)qualifiers.size());
+  for (const auto &qual : qualifiers) node += qual;
+  appendBinaryVarint(node, (XMP_Uns32)children.size());
+  for (const auto &child : children) node += child;
+  return node;
+}
+
+static std::string binaryPacket(const std::vector<std::string> &schemas)
+{
+  std::string packet("\x89XMB", 4);
+  appendBinaryVarint(packet, 1);
+  appendBinaryVarint(packet, sizeof(kBinaryNames) / sizeof(kBinaryNames[0]));
+  for (const char *name : kBinaryNames) appendBinaryString(packet, name);
+  appendBinaryVarint(packet, 4);
+  appendBinaryString(packet, kXMP_NS_DC);
+  appendBinaryString(packet, "dc:");
+  appendBinaryString(packet, kXMP_NS_XML);
+  appendBinaryString(packet, "xml:");
+  appendBinaryString(packet, kXMP_NS_RDF);
+  appendBinaryString(packet, "rdf:");
+  appendBinaryString(packet, "ns:binarymalformed/");
+  appendBinaryString(packet, "bm:");
+  appendBinaryString(packet, "");
+  appendBinaryVarint(packet, 0);
+  appendBinaryString(packet, "");
+  appendBinaryVarint(packet, 0);
+  appendBinaryVarint(packet, (XMP_Uns32)schemas.size());
+  for (const auto &schema : schemas) packet += schema;
+  return packet;
+}
+
+static std::string subjectPacket(const std::string &item, XMP_OptionBits arrayOptions = kXMP_PropValueIsArray)
+{
+  return binaryPacket({ binaryNode(kDC, kXMP_SchemaNode, "", {},
+                                   { binaryNode(kSubject, arrayOptions, "", {}, { item }) }) });
+}
+
+BOOST_AUTO_TEST_CASE(test_binaryMalformed)
+{
+  const XMP_OptionBits qualified = kXMP_PropHasQualifiers | kXMP_PropHasLang;
+  const std::string lang = binaryNode(kLang, kXMP_PropIsQualifier, "en");
+  const std::string title = binaryNode(kTitle, kXMP_PropIsQualifier, "q");
+  const std::string type = binaryNode(kType, kXMP_PropIsQualifier, "t");
+
+  const std::string schemaProp = binaryNode(kDC, kXMP_SchemaNode, "", {}, { binaryNode(kTitle, 0, "t") });
+  const std::vector<std::string> malformed = {
+    // Options that claim qualifiers that are not there.
+    subjectPacket(binaryNode(kItem, kXMP_PropHasLang, "one")),
+    subjectPacket(binaryNode(kItem, kXMP_PropHasQualifiers, "one")),
+    subjectPacket(binaryNode(kItem, qualified, "one")),
+    subjectPacket(binaryNode(kItem, kXMP_PropHasQualifiers | kXMP_PropHasType, "one", { lang })),
+    // Qualifiers the options don't mention.
+    subjectPacket(binaryNode(kItem, 0, "one", { title })),
+    subjectPacket(binaryNode(kItem, kXMP_PropHasQualifiers, "one", { lang })),
+    subjectPacket(binaryNode(kItem, kXMP_PropHasQualifiers, "one", { type })),
+    // An xml:lang that is not first, a qualifier without kXMP_PropIsQualifier.
+    subjectPacket(binaryNode(kItem, qualified, "one", { title, lang })),
+    subjectPacket(binaryNode(kItem, qualified, "one", { binaryNode(kLang, 0, "en") })),
+    // Array items not named [], a struct that is also an array, schema nodes out of place.
+    subjectPacket(binaryNode(kTitle, 0, "one")),
+    subjectPacket(binaryNode(kItem, 0, "one"), kXMP_PropValueIsArray | kXMP_PropValueIsStruct),
+    subjectPacket(binaryNode(kItem, kXMP_SchemaNode, "one")),
+    binaryPacket({ binaryNode(kTitle, 0, "t") }),
+    binaryPacket({ binaryNode(kDC, 0, "", {}, { binaryNode(kTitle, 0, "t") }) }),
+    binaryPacket({ binaryNode(kDC, kXMP_SchemaNode, "", {}, { binaryNode(kItem, 0, "t") }) }),
+    binaryPacket({ binaryNode(kDC, kXMP_SchemaNode, "", {}, { schemaProp }) }),
+    // Siblings with the same name: struct fields, qualifiers, properties, and schemas.
+    binaryPacket({ binaryNode(kDC, kXMP_SchemaNode, "", {},
+                              { binaryNode(kSubject, kXMP_PropValueIsStruct, "", {},
+                                           { binaryNode(kTitle, 0, "a"), binaryNode(kTitle, 0, "b") }) }) }),
+    subjectPacket(binaryNode(kItem, kXMP_PropHasQualifiers, "one", { title, title })),
+    binaryPacket({ binaryNode(kDC, kXMP_SchemaNode, "", {}, { binaryNode(kTitle, 0, "a"), binaryNode(kTitle, 0, "b") }) }),
+    binaryPacket({ binaryNode(kDC, kXMP_SchemaNode, "", {}, { binaryNode(kTitle, 0, "a") }),
+                   binaryNode(kDC, kXMP_SchemaNode, "", {}, { binaryNode(kSubject, 0, "b") }) }),
+    // A bad tree under a namespace that is not registered yet.
+    binaryPacket({ binaryNode(kBMSchema, kXMP_SchemaNode, "", {}, { binaryNode(kBMProp, kXMP_PropHasLang, "v") }) }),
+  };
+
+  for (const auto &packet : malformed) {
+    XMPMeta meta;
+    meta.SetProperty(kXMP_NS_XMP, "Label", "old", 0);
+    try {
+      meta.ParseFromBuffer(packet.data(), (XMP_StringLen)packet.size(), kXMP_ParseBinary);
+      BOOST_ERROR("No exception for a malformed binary packet");
+    } catch (const XMP_Error &e) {
+      BOOST_CHECK_EQUAL(e.GetID(), kXMPErr_BadXMP);
+    }
+    BOOST_CHECK(meta.tree.children.empty());
+  }
+
+  // None of the failed packets registered their namespaces.
+  XMP_StringPtr prefix;
+  XMP_StringLen prefixLen;
+  BOOST_CHECK(!XMPMeta::GetNamespacePrefix("ns:binarymalformed/", &prefix, &prefixLen));
+
+  // The good packets load, and a lang qualified item can be used by ApplyTemplate.
+  XMPMeta loaded;
+  std::string plain = subjectPacket(binaryNode(kItem, 0, "one"));
+  loaded.ParseFromBuffer(plain.data(), (XMP_StringLen)plain.size(), kXMP_ParseBinary);
+  std::string good = subjectPacket(binaryNode(kItem, qualified | kXMP_PropHasType, "one", { lang, type, title }));
+  loaded.ParseFromBuffer(good.data(), (XMP_StringLen)good.size(), kXMP_ParseBinary);
+  XMP_StringPtr value;
+  XMP_StringLen valueLen;
+  XMP_OptionBits options;
+  BOOST_CHECK(loaded.GetProperty(kXMP_NS_DC, "subject[1]/?xml:lang", &value, &valueLen, &options));
+  BOOST_CHECK_EQUAL(std::string(value, valueLen), "en");
+  XMPMeta working;
+  working.ParseFromBuffer(good.data(), (XMP_StringLen)good.size(), kXMP_ParseBinary);
+  XMPUtils::ApplyTemplate(&working, loaded, kXMPTemplate_AddNewProperties);
+  BOOST_CHECK_EQUAL(serializeRDF(working), serializeRDF(loaded));
+
+  std::string withNamespace =
+    binaryPacket({ binaryNode(kBMSchema, kXMP_SchemaNode, "", {}, { binaryNode(kBMProp, 0, "v") }) });
+  loaded.ParseFromBuffer(withNamespace.data(), (XMP_StringLen)withNamespace.size(), kXMP_ParseBinary);
+  BOOST_CHECK(XMPMeta::GetNamespacePrefix("ns:binarymalformed/", &prefix, &prefixLen));
+  BOOST_CHECK(loaded.GetProperty("ns:binarymalformed/", "bm:prop", &value, &valueLen, &options));
+  BOOST_CHECK_EQUAL(std::string(value, valueLen), "v");
+
+  // A new namespace whose prefix is taken is registered with another one, and its names follow.
+  std::string conflict = withNamespace;
+  for (size_t pos = conflict.find("bm:"); pos != std::string::npos; pos = conflict.find("bm:", pos)) {
+    conflict.replace(pos, 2, "iX");
+  }
+  for (size_t pos = conflict.find("malformed/"); pos != std::string::npos; pos = conflict.find("malformed/", pos)) {
+    conflict.replace(pos, 10, "conflicts/");
+  }
+  loaded.ParseFromBuffer(conflict.data(), (XMP_StringLen)conflict.size(), kXMP_ParseBinary);
+  BOOST_REQUIRE(XMPMeta::GetNamespacePrefix("ns:binaryconflicts/", &prefix, &prefixLen));
+  std::string propName = std::string(prefix, prefixLen) + "prop";
+  BOOST_CHECK(propName != "iX:prop");
+  BOOST_CHECK(loaded.GetProperty("ns:binaryconflicts/", propName.c_str(), &value, &valueLen, &options));
+  BOOST_CHECK_EQUAL(std::string(value, valueLen), "v");
+}
+
+BOOST_AUTO_TEST_CASE(test_cloneCopyOnWrite)
+{
+  XMPMeta source;
+  source.SetProperty(kXMP_NS_XMP, "CreatorTool", "tool", 0);
+  source.SetProperty(kXMP_NS_XMP, "Label", "label", 0);
+  source.SetLocalizedText(kXMP_NS_DC, "title", "", "x-default", "Title", 0);
+  source.AppendArrayItem(kXMP_NS_DC, "subject", kXMP_PropArrayIsUnordered, "b", 0);
+  source.AppendArrayItem(kXMP_NS_DC, "subject", kXMP_PropArrayIsUnordered, "a", 0);
+  source.SetStructField(kXMP_NS_XMP_MM, "DerivedFrom", kXMP_NS_XMP_ResourceRef, "documentID", "id", 0);
+  const std::string sourceRDF = serializeRDF(source);
+
+  // The clone starts out with the schemas of the source.
+  XMPMeta clone;
+  source.Clone(&clone, 0);
+  BOOST_REQUIRE_EQUAL(clone.tree.children.size(), source.tree.children.size());
+  for (size_t i = 0; i < source.tree.children.size(); ++i) {
+    BOOST_CHECK(clone.tree.children[i] == source.tree.children[i]);
+  }
+  BOOST_CHECK_EQUAL(serializeRDF(clone), sourceRDF);
+
+  // A change copies just the schema it is in, the source doesn't see it.
+  clone.SetProperty(kXMP_NS_XMP, "Label", "changed", 0);
+  BOOST_CHECK(FindConstSchema(&clone.tree, kXMP_NS_XMP) != FindConstSchema(&source.tree, kXMP_NS_XMP));
+  BOOST_CHECK(FindConstSchema(&clone.tree, kXMP_NS_DC) == FindConstSchema(&source.tree, kXMP_NS_DC));
+  BOOST_CHECK_EQUAL(serializeRDF(source), sourceRDF);
+  XMP_StringPtr valuePtr;
+  XMP_StringLen valueLen;
+  XMP_OptionBits options;
+  BOOST_CHECK(clone.GetProperty(kXMP_NS_XMP, "Label", &valuePtr, &valueLen, &options));
+  BOOST_CHECK_EQUAL(valuePtr, "changed");
+
+  // A change to the source is not seen by the clone either, aliases included.
+  const std::string cloneRDF = serializeRDF(clone);
+  source.SetProperty(kXMP_NS_PDF, "Author", "author", 0);
+  source.AppendArrayItem(kXMP_NS_DC, "subject", kXMP_PropArrayIsUnordered, "c", 0);
+  BOOST_CHECK(FindConstSchema(&clone.tree, kXMP_NS_DC) != FindConstSchema(&source.tree, kXMP_NS_DC));
+  BOOST_CHECK_EQUAL(serializeRDF(clone), cloneRDF);
+
+  // A clone outlives its source, the schemas it is left with are taken over without a copy.
+  XMPMeta *temp = new XMPMeta;
+  temp->SetProperty(kXMP_NS_XMP, "Rating", "3", 0);
+  XMPMeta orphan;
+  temp->Clone(&orphan, 0);
+  const XMP_Node *sharedSchema = orphan.tree.children[0];
+  delete temp;
+  orphan.SetProperty(kXMP_NS_XMP, "Rating", "4", 0);
+  BOOST_CHECK(orphan.tree.children[0] == sharedSchema);
+  BOOST_CHECK(sharedSchema->parent == &orphan.tree);
+
+  // Deleting the last property, sorting, and removing properties leave the source alone.
+  const std::string changedSourceRDF = serializeRDF(source);
+  XMPMeta deleted, sorted, removed;
+  source.Clone(&deleted, 0);
+  deleted.DeleteProperty(kXMP_NS_XMP_MM, "DerivedFrom");
+  BOOST_CHECK(FindConstSchema(&deleted.tree, kXMP_NS_XMP_MM) == 0);
+  source.Clone(&sorted, 0);
+  sorted.Sort();
+  source.Clone(&removed, 0);
+  XMPUtils::RemoveProperties(&removed, "", "", kXMPUtil_DoAllProperties);
+  BOOST_CHECK(removed.tree.children.empty());
+  BOOST_CHECK_EQUAL(serializeRDF(source), changedSourceRDF);
+
+  // Threads clone one template and change their own copies.
+  std::vector<std::thread> threads;
+  std::atomic<long> failures(0);
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < 200; ++i) {
+        XMPMeta copy;
+        source.Clone(&copy, 0);
+        std::string label = std::to_string(t) + "/" + std::to_string(i);
+        copy.SetProperty(kXMP_NS_XMP, "Label", label.c_str(), 0);
+        copy.AppendArrayItem(kXMP_NS_DC, "subject", kXMP_PropArrayIsUnordered, label.c_str(), 0);
+        XMP_StringPtr found;
+        XMP_StringLen len;
+        XMP_OptionBits bits;
+        if (!copy.GetProperty(kXMP_NS_XMP, "Label", &found, &len, &bits) || label != found) {
+          ++failures;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  BOOST_CHECK(failures == 0);
+  BOOST_CHECK_EQUAL(serializeRDF(source), changedSourceRDF);
+}
+
+BOOST_AUTO_TEST_CASE(test_compiledPath)
+{
+  XMPMeta meta;
+  meta.SetProperty(kXMP_NS_XMP, "Rating", "3", 0);
+  meta.SetQualifier(kXMP_NS_XMP, "Rating", kXMP_NS_XMP, "Label", "q", 0);
+  meta.AppendArrayItem(kXMP_NS_DC, "creator", kXMP_PropArrayIsOrdered, "first", 0);
+  meta.AppendArrayItem(kXMP_NS_DC, "creator", kXMP_PropArrayIsOrdered, "second", 0);
+  meta.SetLocalizedText(kXMP_NS_DC, "title", "", "x-default", "Title", 0);
+  meta.SetLocalizedText(kXMP_NS_DC, "title", "fr", "fr-FR", "Titre", 0);
+  meta.SetStructField(kXMP_NS_XMP_MM, "DerivedFrom", kXMP_NS_XMP_ResourceRef, "documentID", "id", 0);
+  meta.AppendArrayItem(kXMP_NS_XMP_MM, "History", kXMP_PropArrayIsOrdered, 0, kXMP_PropValueIsStruct);
+  meta.SetStructField(kXMP_NS_XMP_MM, "History[1]", kXMP_NS_XMP_ResourceEvent, "action", "saved", 0);
+
+  // Every path finds what the string form finds.
+  const char *paths[][2] = {
+    { kXMP_NS_XMP, "Rating" },
+    { kXMP_NS_XMP, "Rating/?xmp:Label" },
+    { kXMP_NS_XMP, "Nothing" },
+    { kXMP_NS_DC, "creator[2]" },
+    { kXMP_NS_DC, "creator[3]" },
+    { kXMP_NS_DC, "creator[last()]" },
+    { kXMP_NS_DC, "title[?xml:lang=\"FR-fr\"]" },
+    { kXMP_NS_DC, "title[?xml:lang=\"de\"]" },
+    { kXMP_NS_XMP_MM, "DerivedFrom/stRef:documentID" },
+    { kXMP_NS_XMP_MM, "History[stEvt:action=\"saved\"]/stEvt:action" },
+    { kXMP_NS_PDF, "Author" },
+    { kXMP_NS_XMP, "Title" },
+  };
+  for (auto &path : paths) {
+    XMP_CompiledPath compiled(path[0], path[1]);
+    XMP_StringPtr value = 0, compiledValue = 0;
+    XMP_StringLen len = 0, compiledLen = 0;
+    XMP_OptionBits options = 0, compiledOptions = 0;
+    bool found = meta.GetProperty(path[0], path[1], &value, &len, &options);
+    BOOST_CHECK_EQUAL(meta.GetProperty(compiled, &compiledValue, &compiledLen, &compiledOptions), found);
+    BOOST_CHECK_EQUAL(meta.DoesPropertyExist(compiled), found);
+    if (found) {
+      BOOST_CHECK_EQUAL(std::string(compiledValue, compiledLen), std::string(value, len));
+      BOOST_CHECK_EQUAL(compiledOptions, options);
+    }
+  }
+
+  // Steps that don't compile still behave like the string form.
+  XMP_CompiledPath zeroIndex(kXMP_NS_DC, "creator[0]");
+  BOOST_CHECK(zeroIndex.steps.empty());
+  BOOST_CHECK_THROW(meta.DoesPropertyExist(kXMP_NS_DC, "creator[0]"), XMP_Error);
+  BOOST_CHECK_THROW(meta.DoesPropertyExist(zeroIndex), XMP_Error);
+  XMP_CompiledPath notArray(kXMP_NS_XMP, "Rating[1]");
+  BOOST_CHECK_THROW(meta.DoesPropertyExist(notArray), XMP_Error);
+  BOOST_CHECK_THROW(XMP_CompiledPath(kXMP_NS_XMP, "Rating/?"), XMP_Error);
+
+  // Set, through an alias too, and delete.
+  XMP_CompiledPath rating(kXMP_NS_XMP, "Rating");
+  meta.SetProperty(rating, "5", 0);
+  XMP_StringPtr value;
+  XMP_StringLen len;
+  XMP_OptionBits options;
+  BOOST_CHECK(meta.GetProperty(kXMP_NS_XMP, "Rating", &value, &len, &options));
+  BOOST_CHECK_EQUAL(value, "5");
+  BOOST_CHECK(meta.DoesQualifierExist(kXMP_NS_XMP, "Rating", kXMP_NS_XMP, "Label"));
+  XMP_CompiledPath author(kXMP_NS_PDF, "Author");
+  meta.DeleteProperty(kXMP_NS_DC, "creator");
+  BOOST_CHECK(!meta.DoesPropertyExist(author));
+  meta.SetProperty(author, "someone", 0);
+  BOOST_CHECK(meta.GetProperty(kXMP_NS_DC, "creator[1]", &value, &len, &options));
+  BOOST_CHECK_EQUAL(value, "someone");
+  meta.DeleteProperty(rating);
+  BOOST_CHECK(!meta.DoesPropertyExist(rating));
+  meta.DeleteProperty(rating);
+
+  // Writing through a compiled path leaves a clone alone.
+  XMPMeta clone;
+  meta.Clone(&clone, 0);
+  XMP_CompiledPath documentID(kXMP_NS_XMP_MM, "DerivedFrom/stRef:documentID");
+  clone.SetProperty(documentID, "other", 0);
+  BOOST_CHECK(meta.GetProperty(documentID, &value, &len, &options));
+  BOOST_CHECK_EQUAL(value, "id");
+}
+
+static std::vector<std::string> iterateNodes(const XMPMeta &meta, const char *schemaNS, const char *propName,
+                                             XMP_OptionBits options, size_t skipAt, XMP_OptionBits skipOptions)
+{
+  XMPIterator iter(meta, schemaNS, propName, options);
+  std::vector<std::string> nodes;
+  XMP_StringPtr ns, path, value;
+  XMP_StringLen nsLen, pathLen, valueLen;
+  XMP_OptionBits nodeOptions;
+  while (iter.Next(&ns, &nsLen, &path, &pathLen, &value, &valueLen, &nodeOptions)) {
+    std::string fullPath;
+    iter.GetPropPath(&fullPath);
+    std::string shownPath(path, pathLen);
+    if ((options & kXMP_IterCursor) && !(options & kXMP_IterJustLeafName)) {
+      shownPath = fullPath;
+    } else if (!(options & kXMP_IterJustLeafName)) {
+      BOOST_CHECK_EQUAL(fullPath, shownPath);
+    }
+    nodes.push_back(std::string(ns, nsLen) + "|" + shownPath + "|" + fullPath + "|" +
+                    std::string(value, valueLen) + "|" + std::to_string(nodeOptions));
+    if (nodes.size() == skipAt) {
+      iter.Skip(skipOptions);
+    }
+  }
+  std::string afterEnd;
+  BOOST_CHECK_THROW(iter.GetPropPath(&afterEnd), XMP_Error);
+  return nodes;
+}
+
+BOOST_AUTO_TEST_CASE(test_cursorIterator)
+{
+  static const char *rdf =
+    "<rdf:RDF xmlns:rdf='http://www.w3.org/1999/02/22-rdf-syntax-ns#'>"
+    " <rdf:Description rdf:about='' xmlns:xmpTest='http://ns.adobe.com/xmpTest/'"
+    "  xmlns:dc='http://purl.org/dc/elements/1.1/'>"
+    "  <xmpTest:MySimpleProp rdf:parseType='Resource'>"
+    "   <rdf:value>A Value</rdf:value><xmpTest:MyQual>Qual Value</xmpTest:MyQual>"
+    "  </xmpTest:MySimpleProp>"
+    "  <xmpTest:MyTopStruct rdf:parseType='Resource'>"
+    "   <xmpTest:MySecondStruct rdf:parseType='Resource'>"
+    "    <xmpTest:MyThirdStruct rdf:parseType='Resource'>"
+    "     <xmpTest:MyThirdStructField>Field Value 3</xmpTest:MyThirdStructField>"
+    "    </xmpTest:MyThirdStruct>"
+    "    <xmpTest:MySecondStructField>Field Value 2</xmpTest:MySecondStructField>"
+    "   </xmpTest:MySecondStruct>"
+    "   <xmpTest:MyTopStructField>Field Value 1</xmpTest:MyTopStructField>"
+    "  </xmpTest:MyTopStruct>"
+    "  <xmpTest:MyArrayWithNestedArray><rdf:Bag><rdf:li><rdf:Seq>"
+    "   <rdf:li>Item 1</rdf:li><rdf:li>Item 2</rdf:li>"
+    "  </rdf:Seq></rdf:li></rdf:Bag></xmpTest:MyArrayWithNestedArray>"
+    "  <xmpTest:MyArrayWithStructures><rdf:Seq>"
+    "   <rdf:li rdf:parseType='Resource'><rdf:value>Field Value 1</rdf:value>"
+    "    <xmpTest:FirstQual>Qual Value 1</xmpTest:FirstQual></rdf:li>"
+    "   <rdf:li rdf:parseType='Resource'><xmpTest:Field>Field Value 2</xmpTest:Field></rdf:li>"
+    "  </rdf:Seq></xmpTest:MyArrayWithStructures>"
+    "  <dc:title><rdf:Alt><rdf:li xml:lang='x-default'>Title</rdf:li></rdf:Alt></dc:title>"
+    "  <dc:subject><rdf:Bag><rdf:li>one</rdf:li><rdf:li>two</rdf:li><rdf:li>three</rdf:li></rdf:Bag></dc:subject>"
+    " </rdf:Description>"
+    "</rdf:RDF>";
+  XMPMeta meta;
+  meta.ParseFromBuffer(rdf, strlen(rdf), 0);
+
+  // Every option, root, and skip gives the nodes of the plain iteration, in the same order.
+  const XMP_OptionBits optionSets[] = {
+    0, kXMP_IterJustChildren, kXMP_IterJustLeafNodes, kXMP_IterJustLeafName, kXMP_IterOmitQualifiers,
+    kXMP_IterJustLeafNodes | kXMP_IterJustLeafName, kXMP_IterJustChildren | kXMP_IterJustLeafNodes,
+  };
+  const char *roots[][2] = {
+    { "", "" },
+    { kXMP_NS_DC, "" },
+    { "http://ns.adobe.com/xmpTest/", "MyArrayWithStructures" },
+    { "http://ns.adobe.com/xmpTest/", "MyArrayWithStructures[1]" },
+    { "http://ns.adobe.com/xmpTest/", "MySimpleProp" },
+    { "http://ns.adobe.com/xmpTest/", "Nothing" },
+    { "http://ns.adobe.com/NoSchema/", "" },
+  };
+  const XMP_OptionBits skips[] = { kXMP_IterSkipSubtree, kXMP_IterSkipSiblings };
+  for (auto options : optionSets) {
+    for (auto &root : roots) {
+      auto plain = iterateNodes(meta, root[0], root[1], options, 0, 0);
+      BOOST_CHECK(iterateNodes(meta, root[0], root[1], options | kXMP_IterCursor, 0, 0) == plain);
+      for (size_t skipAt = 1; skipAt <= plain.size(); ++skipAt) {
+        for (auto skip : skips) {
+          BOOST_CHECK(iterateNodes(meta, root[0], root[1], options | kXMP_IterCursor, skipAt, skip) ==
+                      iterateNodes(meta, root[0], root[1], options, skipAt, skip));
+        }
+      }
+    }
+  }
+
+  auto nodes = iterateNodes(meta, kXMP_NS_DC, "subject", kXMP_IterCursor, 0, 0);
+  BOOST_REQUIRE_EQUAL(nodes.size(), 4);
+  BOOST_CHECK_EQUAL(nodes[3], std::string(kXMP_NS_DC) + "|dc:subject[3]|dc:subject[3]|three|0");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -163,6 +163,54 @@ BOOST_AUTO_TEST_CASE(test_exempi_core)
   BOOST_CHECK(xmp_get_property(xmp, NS_XAP, "Rating", the_prop, NULL));
   BOOST_CHECK(strcmp("3", xmp_string_cstr(the_prop)) == 0);
 
+  // compiled paths
+  BOOST_CHECK(xmp_path_new(NS_DC, "") == NULL);
+  XmpPathPtr make_path = xmp_path_new(NS_TIFF, "Make");
+  BOOST_CHECK(make_path != NULL);
+  BOOST_CHECK(xmp_has_property_path(xmp, make_path));
+  BOOST_CHECK(xmp_get_property_path(xmp, make_path, the_prop, NULL));
+  BOOST_CHECK(strcmp("Leica", xmp_string_cstr(the_prop)) == 0);
+  BOOST_CHECK(xmp_set_property_path(xmp, make_path, "Nikon", 0));
+  BOOST_CHECK(xmp_get_property(xmp, NS_TIFF, "Make", the_prop, NULL));
+  BOOST_CHECK(strcmp("Nikon", xmp_string_cstr(the_prop)) == 0);
+  BOOST_CHECK(xmp_delete_property_path(xmp, make_path));
+  BOOST_CHECK(!xmp_has_property_path(xmp, make_path));
+  BOOST_CHECK(!xmp_get_property_path(xmp, make_path, the_prop, NULL));
+  BOOST_CHECK(xmp_path_free(make_path));
+
+  XmpPathPtr item_path = xmp_path_new(NS_DC, "creator[last()]");
+  BOOST_CHECK(xmp_get_property_path(xmp, item_path, the_prop, &bits));
+  BOOST_CHECK(strcmp("foo", xmp_string_cstr(the_prop)) == 0);
+
+  // several properties at once
+  XmpPathPtr record_paths[] = {
+    xmp_path_new(NS_XAP, "Rating"), item_path, xmp_path_new(NS_TIFF, "Make"),
+    xmp_path_new(NS_DC, "subject")
+  };
+  const char *record_values[] = { "4", "bar", "Pentax", "" };
+  uint32_t record_options[] = { 0, 0, 0, XMP_PROP_VALUE_IS_ARRAY };
+  BOOST_CHECK(xmp_set_properties(xmp, record_paths, 4, record_values,
+                                 record_options));
+  int32_t offsets[4];
+  uint32_t props_bits[4];
+  BOOST_CHECK(xmp_get_properties(xmp, record_paths, 4, the_prop, offsets,
+                                 props_bits) == 4);
+  const char *record = xmp_string_cstr(the_prop);
+  BOOST_CHECK(strcmp(record + offsets[0], "4") == 0);
+  BOOST_CHECK(strcmp(record + offsets[1], "bar") == 0);
+  BOOST_CHECK(strcmp(record + offsets[2], "Pentax") == 0);
+  BOOST_CHECK(strcmp(record + offsets[3], "") == 0);
+  BOOST_CHECK(XMP_IS_PROP_ARRAY(props_bits[3]));
+  BOOST_CHECK(xmp_delete_property(xmp, NS_TIFF, "Make"));
+  BOOST_CHECK(xmp_get_properties(xmp, record_paths, 4, NULL, offsets, NULL) ==
+              3);
+  BOOST_CHECK(offsets[2] == -1);
+  BOOST_CHECK(xmp_get_properties(xmp, record_paths, 0, the_prop, NULL,
+                                 NULL) == 0);
+  for (auto path : record_paths) {
+    BOOST_CHECK(xmp_path_free(path));
+  }
+
   xmp_string_free(the_prop);
 
   // testing date time get
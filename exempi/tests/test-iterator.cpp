@@ -144,6 +144,52 @@ BOOST_AUTO_TEST_CASE(test_exempi_iterate)
     BOOST_CHECK(xmp_iterator_free(iter));
   }
 
+  {
+    // cursor iteration, the full paths are the ones of a plain iteration.
+    const XmpIterOptions iter_options[] = {
+      XMP_ITER_PROPERTIES, XMP_ITER_JUSTLEAFNODES, XMP_ITER_OMITQUALIFIERS
+    };
+    for (auto iter_option : iter_options) {
+      std::vector<tuple3> plain_props, cursor_props;
+      XmpIteratorPtr iter = xmp_iterator_new(xmp, NULL, NULL, iter_option);
+      while (xmp_iterator_next(iter, the_schema, the_path, the_prop, &options)) {
+        plain_props.push_back(tuple3 {{
+            xmp_string_cstr(the_schema),
+            xmp_string_cstr(the_path),
+            xmp_string_cstr(the_prop)
+          }});
+      }
+      BOOST_CHECK(!xmp_iterator_path(iter, the_path));
+      BOOST_CHECK(xmp_iterator_free(iter));
+
+      iter = xmp_iterator_new(xmp, NULL, NULL,
+                              XmpIterOptions(iter_option | XMP_ITER_CURSOR));
+      BOOST_CHECK(!xmp_iterator_path(iter, the_path));
+      while (xmp_iterator_next(iter, the_schema, NULL, the_prop, &options)) {
+        BOOST_CHECK(xmp_iterator_path(iter, the_path));
+        cursor_props.push_back(tuple3 {{
+            xmp_string_cstr(the_schema),
+            xmp_string_cstr(the_path),
+            xmp_string_cstr(the_prop)
+          }});
+      }
+      BOOST_CHECK(xmp_iterator_free(iter));
+      BOOST_CHECK(!plain_props.empty());
+      BOOST_CHECK(cursor_props == plain_props);
+    }
+
+    XmpIteratorPtr iter =
+      xmp_iterator_new(xmp, NS_DC, "rights", XMP_ITER_CURSOR);
+    BOOST_CHECK(xmp_iterator_next(iter, NULL, the_path, NULL, NULL));
+    BOOST_CHECK(strcmp(xmp_string_cstr(the_path), "dc:rights") == 0);
+    BOOST_CHECK(xmp_iterator_next(iter, NULL, the_path, the_prop, NULL));
+    BOOST_CHECK(strcmp(xmp_string_cstr(the_path), "[1]") == 0);
+    BOOST_CHECK(strcmp(xmp_string_cstr(the_prop), "2006, Hubert Figuiere") == 0);
+    BOOST_CHECK(xmp_iterator_path(iter, the_path));
+    BOOST_CHECK(strcmp(xmp_string_cstr(the_path), "dc:rights[1]") == 0);
+    BOOST_CHECK(xmp_iterator_free(iter));
+  }
+
   {
     // Iterator with property but no NS is invalid.
     XmpIteratorPtr iter =
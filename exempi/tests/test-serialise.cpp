@@ -44,6 +44,7 @@
 
 #include "utils.h"
 #include "xmpconsts.h"
+#include "xmperrors.h"
 #include "xmp.h"
 
 boost::unit_test::test_suite* init_unit_test_suite(int argc, char * argv[])
@@ -90,6 +91,23 @@ BOOST_AUTO_TEST_CASE(test_serialise)
   // find a way to compare that.
   //	BOOST_CHECK_EQUAL(b1, b2);
 
+  // The binary form loads back to the same XMP.
+  XmpStringPtr binary = xmp_string_new();
+  BOOST_CHECK(xmp_serialize(xmp, binary, XMP_SERIAL_BINARY, 0));
+  BOOST_CHECK(xmp_get_error() == 0);
+  XmpPtr xmp2 = xmp_new_empty();
+  BOOST_CHECK(xmp_parse_binary(xmp2, xmp_string_cstr(binary), xmp_string_len(binary)));
+  BOOST_CHECK(xmp_get_error() == 0);
+  XmpStringPtr output2 = xmp_string_new();
+  BOOST_CHECK(xmp_serialize_and_format(
+    xmp2, output2, XMP_SERIAL_OMITPACKETWRAPPER, 0, "\n", " ", 0));
+  BOOST_CHECK_EQUAL(b2, std::string(xmp_string_cstr(output2)));
+  BOOST_CHECK(!xmp_parse_binary(xmp2, buffer, len));
+  BOOST_CHECK(xmp_get_error() == XMPErr_BadXMP);
+  xmp_string_free(output2);
+  xmp_string_free(binary);
+  BOOST_CHECK(xmp_free(xmp2));
+
   xmp_string_free(output);
   BOOST_CHECK(xmp_free(xmp));
 
@@ -148,3 +148,75 @@ BOOST_AUTO_TEST_CASE(test_write_new_property)
   BOOST_CHECK(!g_lt->check_leaks());
   BOOST_CHECK(!g_lt->check_errors());
 }
+
+// Wide structs and schemas switch to an indexed lookup. Make sure the
+// lookups, the deletions and the serialization order stay right.
+BOOST_AUTO_TEST_CASE(test_write_wide_struct)
+{
+  BOOST_CHECK(xmp_init());
+
+  XmpPtr xmp = xmp_new_empty();
+  BOOST_CHECK(xmp != NULL);
+
+  char path[64];
+  char value[64];
+  for (int i = 0; i < 100; i++) {
+    snprintf(path, sizeof(path), "Wide/xmp:Field%d", i);
+    snprintf(value, sizeof(value), "value %d", i);
+    BOOST_CHECK(xmp_set_property(xmp, NS_XAP, path, value, 0));
+    snprintf(path, sizeof(path), "Prop%d", i);
+    BOOST_CHECK(xmp_set_property(xmp, NS_XAP, path, value, 0));
+  }
+
+  XmpStringPtr the_prop = xmp_string_new();
+  for (int i = 0; i < 100; i++) {
+    snprintf(path, sizeof(path), "Wide/xmp:Field%d", i);
+    snprintf(value, sizeof(value), "value %d", i);
+    BOOST_CHECK(xmp_get_property(xmp, NS_XAP, path, the_prop, NULL));
+    BOOST_CHECK(strcmp(value, xmp_string_cstr(the_prop)) == 0);
+  }
+  BOOST_CHECK(!xmp_has_property(xmp, NS_XAP, "Wide/xmp:Field100"));
+
+  // Delete every other field, then put some back. They go at the end.
+  for (int i = 0; i < 100; i += 2) {
+    snprintf(path, sizeof(path), "Wide/xmp:Field%d", i);
+    BOOST_CHECK(xmp_delete_property(xmp, NS_XAP, path));
+  }
+  for (int i = 0; i < 100; i++) {
+    snprintf(path, sizeof(path), "Wide/xmp:Field%d", i);
+    BOOST_CHECK(xmp_has_property(xmp, NS_XAP, path) == (i % 2 == 1));
+  }
+  BOOST_CHECK(xmp_set_property(xmp, NS_XAP, "Wide/xmp:Field0", "again", 0));
+  BOOST_CHECK(xmp_get_property(xmp, NS_XAP, "Wide/xmp:Field0", the_prop, NULL));
+  BOOST_CHECK(strcmp("again", xmp_string_cstr(the_prop)) == 0);
+
+  XmpStringPtr output = xmp_string_new();
+  BOOST_CHECK(xmp_serialize(xmp, output, XMP_SERIAL_OMITPACKETWRAPPER, 0));
+  std::string packet = xmp_string_cstr(output);
+  size_t pos99 = packet.find("<xmp:Field99>");
+  size_t pos0 = packet.find("<xmp:Field0>");
+  BOOST_CHECK(packet.find("<xmp:Field1>") < pos99);
+  BOOST_CHECK(pos99 != std::string::npos);
+  BOOST_CHECK(pos0 != std::string::npos);
+  BOOST_CHECK(pos99 < pos0);
+
+  // And it parses back to the same thing.
+  XmpPtr xmp2 = xmp_new(packet.c_str(), packet.size());
+  BOOST_CHECK(xmp2 != NULL);
+  for (int i = 1; i < 100; i += 2) {
+    snprintf(path, sizeof(path), "Wide/xmp:Field%d", i);
+    snprintf(value, sizeof(value), "value %d", i);
+    BOOST_CHECK(xmp_get_property(xmp2, NS_XAP, path, the_prop, NULL));
+    BOOST_CHECK(strcmp(value, xmp_string_cstr(the_prop)) == 0);
+    snprintf(path, sizeof(path), "Prop%d", i);
+    BOOST_CHECK(xmp_get_property(xmp2, NS_XAP, path, the_prop, NULL));
+    BOOST_CHECK(strcmp(value, xmp_string_cstr(the_prop)) == 0);
+  }
+  BOOST_CHECK(xmp_free(xmp2));
+
+  xmp_string_free(output);
+  xmp_string_free(the_prop);
+  BOOST_CHECK(xmp_free(xmp));
+
+  xmp_terminate();
+}
@@ -38,14 +38,17 @@
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include <string>
+#include <vector>
 
 #include <boost/test/included/unit_test.hpp>
 
 #include "utils.h"
 #include "xmp.h"
 #include "xmpconsts.h"
+#include "xmperrors.h"
 
 boost::unit_test::test_suite* init_unit_test_suite(int argc, char * argv[])
 {
@@ -128,3 +131,179 @@ BOOST_AUTO_TEST_CASE(test_xmpfiles)
   BOOST_CHECK(!g_lt->check_leaks());
   BOOST_CHECK(!g_lt->check_errors());
 }
+
+struct BatchResult {
+  bool seen = false;
+  XmpFileType format = XMP_FT_UNKNOWN;
+  bool has_xmp = false;
+  std::string icc_profile;
+  int error = 0;
+};
+
+static bool batch_callback(void *context, size_t index, XmpFileType file_format,
+                           XmpPtr xmp, int error)
+{
+  auto results = static_cast<std::vector<BatchResult> *>(context);
+  BatchResult &result = (*results)[index];
+  result.seen = true;
+  result.format = file_format;
+  result.error = error;
+  result.has_xmp = (xmp != NULL);
+  if (xmp) {
+    XmpStringPtr the_prop = xmp_string_new();
+    if (xmp_get_property(xmp, NS_PHOTOSHOP, "ICCProfile", the_prop, NULL)) {
+      result.icc_profile = xmp_string_cstr(the_prop);
+    }
+    xmp_string_free(the_prop);
+  }
+  return true;
+}
+
+BOOST_AUTO_TEST_CASE(test_xmpfiles_format_signatures)
+{
+  BOOST_CHECK(xmp_init());
+
+  // Without an extension the format comes from the file content alone.
+  std::string dir = g_testfile.substr(0, g_testfile.rfind('/') + 1);
+  const struct {
+    const char *name;
+    XmpFileType format;
+  } samples[] = {
+    { "BlueSquare.jpg", XMP_FT_JPEG },     { "BlueSquare.png", XMP_FT_PNG },
+    { "BlueSquare.tif", XMP_FT_TIFF },     { "BlueSquare.gif", XMP_FT_GIF },
+    { "BlueSquare.psd", XMP_FT_PHOTOSHOP }, { "BlueSquare.wav", XMP_FT_WAV },
+    { "BlueSquare.avi", XMP_FT_AVI },      { "BlueSquare.webp", XMP_FT_WEBP },
+    { "BlueSquare.mp3", XMP_FT_MP3 },      { "BlueSquare.indd", XMP_FT_INDESIGN },
+  };
+
+  for (const auto &sample : samples) {
+    BOOST_CHECK(copy_file(dir + sample.name, "test-signature"));
+    BOOST_CHECK_MESSAGE(
+      xmp_files_check_file_format("test-signature") == sample.format,
+      sample.name);
+    unlink("test-signature");
+  }
+
+  xmp_terminate();
+}
+
+static bool stop_callback(void *context, size_t, XmpFileType, XmpPtr, int)
+{
+  ++*static_cast<int *>(context);
+  return false;
+}
+
+BOOST_AUTO_TEST_CASE(test_xmpfiles_batch)
+{
+  BOOST_CHECK(xmp_init());
+
+  std::string dir = g_testfile.substr(0, g_testfile.rfind('/') + 1);
+  std::vector<std::string> names = { "BlueSquare.jpg", "DoesNotExist.jpg",
+                                     "BlueSquare.png", "BlueSquare.tif" };
+  std::vector<std::string> paths;
+  std::vector<const char *> path_ptrs;
+  for (const auto &name : names) {
+    paths.push_back(dir + name);
+  }
+  for (const auto &path : paths) {
+    path_ptrs.push_back(path.c_str());
+  }
+
+  std::vector<BatchResult> results(paths.size());
+  BOOST_CHECK(xmp_files_process_batch(path_ptrs.data(), path_ptrs.size(),
+                                      XMP_OPEN_READ, 2, batch_callback,
+                                      &results) == paths.size());
+  BOOST_CHECK(results[0].seen && results[0].format == XMP_FT_JPEG);
+  BOOST_CHECK(results[0].has_xmp && results[0].error == 0);
+  BOOST_CHECK(results[0].icc_profile == "sRGB IEC61966-2.1");
+  BOOST_CHECK(results[1].seen && results[1].format == XMP_FT_UNKNOWN);
+  BOOST_CHECK(!results[1].has_xmp && results[1].error != 0);
+  BOOST_CHECK(results[2].seen && results[2].format == XMP_FT_PNG);
+  BOOST_CHECK(results[2].has_xmp);
+  BOOST_CHECK(results[3].seen && results[3].format == XMP_FT_TIFF);
+  BOOST_CHECK(results[3].has_xmp);
+
+  // The callback stops the batch, no further results are delivered.
+  int calls = 0;
+  BOOST_CHECK(xmp_files_process_batch(path_ptrs.data(), path_ptrs.size(),
+                                      XMP_OPEN_READ, 2, stop_callback,
+                                      &calls) == 1);
+  BOOST_CHECK(calls == 1);
+
+  BOOST_CHECK(xmp_files_process_batch(path_ptrs.data(), path_ptrs.size(),
+                                      XMP_OPEN_FORUPDATE, 2, stop_callback,
+                                      &calls) == 0);
+  BOOST_CHECK(xmp_get_error() == XMPErr_BadOptions);
+
+  xmp_terminate();
+}
+
+static std::string read_and_serialize(const char *path, XmpOpenFileOptions options)
+{
+  std::string result;
+  XmpFilePtr f = xmp_files_open_new(path, options);
+  BOOST_CHECK(f != NULL);
+  if (f == NULL) {
+    return result;
+  }
+  XmpPtr xmp = xmp_files_get_new_xmp(f);
+  BOOST_CHECK(xmp != NULL);
+  if (xmp != NULL) {
+    XmpStringPtr buffer = xmp_string_new();
+    BOOST_CHECK(xmp_serialize(xmp, buffer, XMP_SERIAL_OMITPACKETWRAPPER, 0));
+    result = xmp_string_cstr(buffer);
+    xmp_string_free(buffer);
+    xmp_free(xmp);
+  }
+  BOOST_CHECK(xmp_files_close(f, XMP_CLOSE_NOOPTION));
+  xmp_files_free(f);
+  return result;
+}
+
+BOOST_AUTO_TEST_CASE(test_xmpfiles_tiff_read_only)
+{
+  BOOST_CHECK(xmp_init());
+
+  // A read-only open parses the TIFF in a file mapping. It must import the
+  // same metadata as the file-based parsing used for update.
+  std::string dir = g_testfile.substr(0, g_testfile.rfind('/') + 1);
+  BOOST_CHECK(copy_file(dir + "BlueSquare.tif", "test-read-only.tif"));
+  BOOST_CHECK(chmod("test-read-only.tif", S_IRUSR | S_IWUSR) == 0);
+
+  std::string read_only = read_and_serialize("test-read-only.tif", XMP_OPEN_READ);
+  BOOST_CHECK(read_only.find("<tiff:Orientation>") != std::string::npos);
+  BOOST_CHECK(read_only ==
+              read_and_serialize("test-read-only.tif", XMP_OPEN_FORUPDATE));
+
+  // Little endian, unsorted primary IFD, Exif IFD pointer of type IFD.
+  static const uint8_t tiff[] = {
+    'I', 'I', 0x2A, 0, 8, 0, 0, 0,
+    4, 0,
+    0x10, 0x01, 2, 0, 12, 0, 0, 0, 62, 0, 0, 0,
+    0x00, 0x01, 3, 0, 1, 0, 0, 0, 16, 0, 0, 0,
+    0x69, 0x87, 13, 0, 1, 0, 0, 0, 74, 0, 0, 0,
+    0x01, 0x01, 3, 0, 1, 0, 0, 0, 8, 0, 0, 0,
+    0, 0, 0, 0,
+    'T', 'e', 's', 't', 'C', 'a', 'm', 'e', 'r', 'a', '1', 0,
+    1, 0,
+    0x03, 0x90, 2, 0, 20, 0, 0, 0, 92, 0, 0, 0,
+    0, 0, 0, 0,
+    '2', '0', '2', '4', ':', '0', '5', ':', '0', '6', ' ',
+    '0', '7', ':', '0', '8', ':', '0', '9', 0,
+  };
+  FILE *out = fopen("test-read-only.tif", "wb");
+  BOOST_CHECK(out != NULL);
+  if (out != NULL) {
+    BOOST_CHECK(fwrite(tiff, 1, sizeof(tiff), out) == sizeof(tiff));
+    fclose(out);
+  }
+
+  read_only = read_and_serialize("test-read-only.tif", XMP_OPEN_READ);
+  BOOST_CHECK(read_only.find("TestCamera1") != std::string::npos);
+  BOOST_CHECK(read_only.find("2024-05-06T07:08:09") != std::string::npos);
+  BOOST_CHECK(read_only ==
+              read_and_serialize("test-read-only.tif", XMP_OPEN_FORUPDATE));
+
+  unlink("test-read-only.tif");
+  xmp_terminate();
+}
@@ -34,6 +34,11 @@ inline void release(XmpPtr ptr)
     xmp_free(ptr);
 }
 
+inline void release(XmpPathPtr ptr)
+{
+    xmp_path_free(ptr);
+}
+
 /**
  * @brief a scoped pointer for Xmp opaque types
  */
@@ -191,7 +191,11 @@ typedef enum {
                                          * path, default is the full path. */
     XMP_ITER_INCLUDEALIASES = 0x0800UL, /**< Include aliases, default is just
                                          * actual properties. */
-    XMP_ITER_OMITQUALIFIERS = 0x1000UL  /* Omit all qualifiers. */
+    XMP_ITER_OMITQUALIFIERS = 0x1000UL, /* Omit all qualifiers. */
+    XMP_ITER_CURSOR = 0x2000UL          /**< Walk the packet in place, return
+                                         * just the leaf part of the path.
+                                         * See xmp_iterator_path(). The packet
+                                         * must not be changed meanwhile. */
 } XmpIterOptions;
 
 typedef enum {
@@ -315,6 +319,8 @@ enum {                                          /* Options for xmp_serialize */
                                                   * comments. */
        XMP_SERIAL_OMITALLFORMATTING = 0x0800UL,  /**< Omit all formatting
                                                   * whitespace. */
+       XMP_SERIAL_BINARY = 0x4000UL,             /**< Write the compact binary
+                                                  * form, see xmp_parse_binary. */
 
        _XMP_LITTLEENDIAN_BIT =
            0x0001UL, /* ! Don't use directly, see the combined values below! */
@@ -334,6 +340,7 @@ typedef struct _Xmp *XmpPtr;
 typedef struct _XmpFile *XmpFilePtr;
 typedef struct _XmpString *XmpStringPtr;
 typedef struct _XmpIterator *XmpIteratorPtr;
+typedef struct _XmpPath *XmpPathPtr;
 
 typedef struct _XmpDateTime {
     int32_t year;
@@ -479,6 +486,48 @@ bool xmp_files_get_format_info(XmpFileType format,
  */
 XmpFileType xmp_files_check_file_format(const char *filePath);
 
+/** Callback receiving the result for one file of %xmp_files_process_batch.
+ * Calls are made from the worker threads, but never concurrently.
+ * @param context the context passed to %xmp_files_process_batch
+ * @param index the index of the file in the path array
+ * @param file_format the file format, XMP_FT_UNKNOWN if it could not be opened
+ * @param xmp the XMP packet of the file, NULL if there is none. Only valid
+ * during the call, use %xmp_copy to keep it.
+ * @param error 0, or the error code %xmp_get_error would have returned.
+ * @return false to stop the batch.
+ */
+typedef bool (*XmpBatchCallback)(void *context, size_t index,
+                                 XmpFileType file_format, XmpPtr xmp,
+                                 int error);
+
+/** Read the XMP packets of many files using a pool of worker threads.
+ * Each file is opened for reading, read and closed before its result is
+ * passed to the callback. An error only affects the file it occurs in.
+ * @param paths the file paths
+ * @param count the number of paths
+ * @param options open flags, XMP_OPEN_FORUPDATE is not allowed
+ * @param threads the most worker threads to use, 0 for one per processor.
+ * Fewer are started when the library's other worker threads already use
+ * every processor.
+ * @param callback the callback receiving the results
+ * @param context passed to the callback
+ * @return the number of files passed to the callback. Call %xmp_get_error to
+ * retrieve the error code if the batch could not run.
+ */
+size_t xmp_files_process_batch(const char **paths, size_t count,
+                               XmpOpenFileOptions options, unsigned int threads,
+                               XmpBatchCallback callback, void *context);
+
+/** Turn on an on-disk cache of the XMP read from local files.
+ * A file opened for reading is answered from the cache if it has not changed
+ * since it was cached. Updating a file removes its record.
+ * @param folder an existing folder for the cache records, NULL to turn the
+ * cache off
+ * @param max_size the size limit of the records in bytes, 0 for the default
+ * @return false if error. Call %xmp_get_error to retrieve the error code.
+ */
+bool xmp_files_set_metadata_cache(const char *folder, uint64_t max_size);
+
 /** Register a new namespace to add properties to
  *  This is done automatically when reading the metadata block
  *  @param namespaceURI the namespace URI to register
@@ -539,6 +588,16 @@ bool xmp_free(XmpPtr xmp);
  */
 bool xmp_parse(XmpPtr xmp, const char *buffer, size_t len);
 
+/** Load the compact binary form written by xmp_serialize with
+ * XMP_SERIAL_BINARY. It is much faster to load than the XML, but it is
+ * only for the use of exempi, for example in a cache, not in files.
+ * @param xmp the XMP packet.
+ * @param buffer the buffer.
+ * @param len the length of the buffer.
+ * @return false if the buffer is not valid binary XMP.
+ */
+bool xmp_parse_binary(XmpPtr xmp, const char *buffer, size_t len);
+
 /** Serialize the XMP Packet to the given buffer
  * @param xmp the XMP Packet
  * @param buffer the buffer to write the XMP to
@@ -669,6 +728,83 @@ bool xmp_delete_property(XmpPtr xmp, const char *schema, const char *name);
  */
 bool xmp_has_property(XmpPtr xmp, const char *schema, const char *name);
 
+/** Compile a property path for repeated use with the xmp_*_property_path
+ * functions. The path is parsed and its alias resolved once, the accessors
+ * then do no parsing. It is not tied to an XMP packet.
+ * @param schema the schema of the property. Can't be NULL or empty.
+ * @param name the name of the property, can be a path expression. Can't be
+ * NULL or empty.
+ * @return the compiled path, NULL if error. Must be freed with xmp_path_free()
+ */
+XmpPathPtr xmp_path_new(const char *schema, const char *name);
+
+/** Free a compiled path
+ * @param path the compiled path to free
+ */
+bool xmp_path_free(XmpPathPtr path);
+
+/** Get an XMP property through a compiled path. See xmp_get_property.
+ * @param xmp the XMP packet
+ * @param path the compiled path
+ * @param property the allocated XmpStringPtr
+ * @param propsBits pointer to the option bits. Pass NULL if not needed
+ * @return true if found
+ */
+bool xmp_get_property_path(XmpPtr xmp, XmpPathPtr path, XmpStringPtr property,
+                           uint32_t *propsBits);
+
+/** Set an XMP property through a compiled path. See xmp_set_property.
+ * @param xmp the XMP packet
+ * @param path the compiled path
+ * @param value 0 terminated string
+ * @param optionBits
+ * @return false if failure
+ */
+bool xmp_set_property_path(XmpPtr xmp, XmpPathPtr path, const char *value,
+                           uint32_t optionBits);
+
+/** Delete a property through a compiled path.
+ * @param xmp the XMP packet
+ * @param path the compiled path
+ */
+bool xmp_delete_property_path(XmpPtr xmp, XmpPathPtr path);
+
+/** Determines if a property exists, through a compiled path.
+ * @param xmp the XMP packet
+ * @param path the compiled path
+ * @return true is the property exists
+ */
+bool xmp_has_property_path(XmpPtr xmp, XmpPathPtr path);
+
+/** Get several XMP properties through compiled paths in one call.
+ * The packet is locked once. The values are returned one after the other in
+ * %values, each nul terminated.
+ * @param xmp the XMP packet
+ * @param paths an array of %count compiled paths
+ * @param count the number of paths
+ * @param values the allocated XmpStringPtr for the values. Pass NULL if not
+ * needed.
+ * @param offsets an array of %count offsets of the values in %values, -1 for
+ * a property that doesn't exist. Pass NULL if not needed.
+ * @param propsBits an array of %count option bits. Pass NULL if not needed.
+ * @return the number of properties found, -1 if error.
+ */
+int32_t xmp_get_properties(XmpPtr xmp, const XmpPathPtr *paths, size_t count,
+                           XmpStringPtr values, int32_t *offsets,
+                           uint32_t *propsBits);
+
+/** Set several XMP properties through compiled paths in one call.
+ * The packet is locked once. See xmp_set_property.
+ * @param xmp the XMP packet
+ * @param paths an array of %count compiled paths
+ * @param count the number of paths
+ * @param values an array of %count 0 terminated strings
+ * @param optionBits an array of %count option bits. Pass NULL if all 0.
+ * @return false if failure. The properties before the failing one are set.
+ */
+bool xmp_set_properties(XmpPtr xmp, const XmpPathPtr *paths, size_t count,
+                        const char *const *values, const uint32_t *optionBits);
+
 /** Get a localised text from a localisable property.
  * @param xmp the XMP packet
  * @param schema the schema
@@ -761,6 +897,15 @@ bool xmp_iterator_next(XmpIteratorPtr iter, XmpStringPtr schema,
  */
 bool xmp_iterator_skip(XmpIteratorPtr iter, XmpIterSkipOptions options);
 
+/** Get the full path of the property last returned by xmp_iterator_next.
+ * With XMP_ITER_CURSOR this is the only way to get it, and it is only
+ * composed when asked for.
+ * @param iter the iterator
+ * @param path the full path, empty for a schema.
+ * @return false if there is no current property.
+ */
+bool xmp_iterator_path(XmpIteratorPtr iter, XmpStringPtr path);
+
 /** Compare two XmpDateTime
  * @param left value
  * @param right value
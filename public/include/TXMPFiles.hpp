@@ -100,7 +100,16 @@ public:
     /// @brief Initializes the XMPFiles library; must be called before creating an \c SXMPFiles object.
     ///
     /// This overload of TXMPFiles::Initialize() accepts option bits to customize the initialization
-    /// actions. At this time no option is defined.
+    /// actions. These bit-flag constants are defined:
+    ///
+    ///   \li \c #kXMPFiles_IgnoreLocalText - Ignore non-XMP text that uses an undefined "local" encoding.
+    ///   \li \c #kXMPFiles_NoReadBuffer - Pass every read of a file that is not memory mapped to the host.
+    ///   \li \c #kXMPFiles_MapReadOnlyFiles - Memory map files opened only for reading, if they are on
+    ///   a local volume. Only safe if no other process truncates the files while they are open.
+    ///   \li \c #kXMPFiles_ReadBufferLog2 - Size the read buffer for files that are not memory mapped,
+    ///   the default is 64K.
+    ///   \li \c #kXMPFiles_JPEGPaddingLog2 - Size the padding of the XMP packet when a JPEG file is
+    ///   rewritten, leaving room for later in-place updates. The default is 2K.
     ///
     /// The main action is to activate the available smart file handlers. Must be called before
     /// using any methods except \c GetVersionInfo().
@@ -336,6 +345,62 @@ public:
 
     static XMP_FileFormat CheckFileFormat ( XMP_StringPtr filePath );
 
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c ProcessBatch() reads the XMP from many files using a pool of worker threads.
+    ///
+    /// Each file is opened for reading, its XMP is read as by \c GetXMP(), and the file is closed
+    /// before the result is passed to \c batchProc. Each worker has at most one file open at a
+    /// time, so memory use does not grow with the number of files. An error only affects the file
+    /// it occurs in; it is passed to \c batchProc and the batch continues.
+    ///
+    /// @param filePaths The paths of the files, as would be passed to \c OpenFile().
+    ///
+    /// @param fileCount The number of paths in \c filePaths.
+    ///
+    /// @param openFlags The flags passed to \c OpenFile(). \c #kXMPFiles_OpenForUpdate is not
+    /// allowed.
+    ///
+    /// @param batchProc The callback receiving the result for each file, see
+    /// \c #XMPFiles_BatchProc.
+    ///
+    /// @param context A pointer to caller-defined data passed to \c batchProc.
+    ///
+    /// @param threadCount The most worker threads to use, including the calling thread. Zero uses
+    /// one thread per processor. Fewer threads are started when other batches or large file scans
+    /// already keep every processor busy, the library never runs more than one worker thread per
+    /// processor besides the client's own threads.
+    ///
+    /// @return The number of files passed to \c batchProc, less than \c fileCount if it stopped
+    /// the batch.
+
+    static XMP_Index ProcessBatch ( const XMP_StringPtr * filePaths,
+                                    XMP_Index             fileCount,
+                                    XMP_OptionBits        openFlags,
+                                    XMPFiles_BatchProc    batchProc,
+                                    void *                context,
+                                    XMP_Index             threadCount = 0 );
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c SetMetadataCache() turns on an on-disk cache of the XMP read from local files.
+    ///
+    /// When a local file is opened for reading, \c OpenFile() looks for a record of an earlier read
+    /// of the same file with the same open flags and format. A record is only used if the file's
+    /// device, file ID, length and modification time are the ones it was made from. Then the file
+    /// itself is not opened, \c GetXMP() returns the cached XMP, raw packet and packet info. The
+    /// record is written by the first \c GetXMP() after an open that found none. Updating a file
+    /// through \c CloseFile() removes its record. When the records exceed the size limit, the least
+    /// recently used ones are deleted.
+    ///
+    /// Folder based formats, sidecar files and plugin handlers are not cached.
+    ///
+    /// @param cacheFolder The folder for the cache records, which must exist. It can be shared by
+    /// several processes. Pass null or an empty string to turn the cache off.
+    ///
+    /// @param maxCacheSize The size limit of the cache records in bytes. Zero means 64 MB.
+
+    static void SetMetadataCache ( XMP_StringPtr cacheFolder,
+                                   XMP_Uns64     maxCacheSize = 0 );
+
     // ---------------------------------------------------------------------------------------------
     /// @brief \c CheckPackageFormat() tries to determine the format of a "package" folder.
     ///
@@ -572,6 +637,20 @@ public:
                        XMP_FileFormat * format = 0,
                        XMP_OptionBits * handlerFlags = 0 );
 
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c GetIOStats() reports the host I/O an opened file has made so far.
+    ///
+    /// The counts are only kept for files opened by path, they are all zero for a client \c XMP_IO
+    /// object or a folder-based format. After \c CloseFile() the counts of the closed file remain
+    /// available until the next \c OpenFile(), so the writes made by an update can be checked.
+    ///
+    /// @param ioStats [out] A buffer in which to return the counts. Must not be null.
+    ///
+    /// @return True if the file object is in the open state, false otherwise. The counts are
+    /// returned in either case.
+
+    bool GetIOStats ( XMP_IOStats * ioStats );
+
     // ---------------------------------------------------------------------------------------------
     /// @brief \c SetAbortProc() registers a callback function used to check for a user-signaled abort.
     ///
@@ -72,6 +72,10 @@
 ///   \li \c #kXMP_IterJustLeafName - Return just the leaf component of the node names. The default
 ///   is to return the full path name.
 ///   \li \c #kXMP_IterOmitQualifiers - Do not visit the qualifiers of a node.
+///   \li \c #kXMP_IterCursor - Walk the XMP object in place instead of taking a copy of its node
+///   names. Only the leaf component of the path is returned, \c TXMPIterator::GetPropPath()
+///   composes the full path when it is wanted. The memory used does not grow with the size of the
+///   XMP object, but the XMP object must not be changed while the iteration is in progress.
 // =================================================================================================
 
 #include "client-glue/WXMPIterator.hpp"
@@ -120,6 +124,7 @@ public:
     ///   \li \c #kXMP_IterJustLeafNodes - Visit only the leaf nodes; default visits all nodes.
     ///   \li \c #kXMP_IterJustLeafName - Return just the leaf part of the path; default returns the full path.
     ///   \li \c #kXMP_IterOmitQualifiers - Omit all qualifiers.
+    ///   \li \c #kXMP_IterCursor - Walk the XMP object in place; the XMP object must not be changed.
     ///
     ///
 
@@ -145,6 +150,7 @@ public:
     ///   \li \c #kXMP_IterJustLeafNodes - Visit only the leaf nodes; default visits all nodes.
     ///   \li \c #kXMP_IterJustLeafName - Return just the leaf part of the path; default returns the full path.
     ///   \li \c #kXMP_IterOmitQualifiers - Omit all qualifiers.
+    ///   \li \c #kXMP_IterCursor - Walk the XMP object in place; the XMP object must not be changed.
     ///
     ///
 
@@ -166,6 +172,7 @@ public:
     ///   \li \c #kXMP_IterJustLeafNodes - Visit only the leaf nodes; default visits all nodes.
     ///   \li \c #kXMP_IterJustLeafName - Return just the leaf part of the path; default returns the full path.
     ///   \li \c #kXMP_IterOmitQualifiers - Omit all qualifiers.
+    ///   \li \c #kXMP_IterCursor - Walk the XMP object in place; the XMP object must not be changed.
 
 
     TXMPIterator ( const TXMPMeta<tStringObj> & xmpObj,
@@ -219,6 +226,18 @@ public:
 
     void Skip ( XMP_OptionBits options );
 
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c GetPropPath() returns the full path of the node last visited by \c Next().
+    ///
+    /// This is the path \c Next() returns without \c #kXMP_IterJustLeafName or \c #kXMP_IterCursor.
+    /// A cursor iteration composes it only when this is called. Throws if there is no current node,
+    /// before the first call to \c Next() or after it has returned false.
+    ///
+    /// @param propPath [out] A string object in which to return the path. It is empty for a schema
+    /// node.
+
+    void GetPropPath ( tStringObj * propPath ) const;
+
 private:
 
     XMPIteratorRef  iterRef;
@@ -893,6 +893,137 @@ public:
 
     /// @}
 
+    // =============================================================================================
+    /// \name Accessing properties through compiled paths.
+    /// @{
+    ///
+    /// A compiled path holds a property path already expanded and checked against the namespace
+    /// table, with any alias resolved to its actual property. Clients that read the same paths from
+    /// many XMP objects compile them once, the accessors then do no path parsing. A compiled path is
+    /// not tied to an XMP object, and can be used by several threads at once. Compose struct field,
+    /// qualifier, and array item paths with the \c TXMPUtils path composition functions before
+    /// compiling them.
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c CompilePath() compiles a property path for the compiled path accessors.
+    ///
+    /// @param schemaNS The namespace URI for the property; see \c GetProperty().
+    ///
+    /// @param propName The name of the property. Can be a general path expression; see
+    /// \c GetProperty().
+    ///
+    /// @return The compiled path, it must be released with \c ReleasePath(). Throws for a bad path.
+
+    static XMPPathRef CompilePath ( XMP_StringPtr schemaNS,
+                                    XMP_StringPtr propName );
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c ReleasePath() releases a compiled path.
+    ///
+    /// @param path The compiled path from \c CompilePath(), null is allowed.
+
+    static void ReleasePath ( XMPPathRef path );
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c GetProperty() retrieves a property through a compiled path.
+    ///
+    /// Otherwise the same as the basic form of \c GetProperty().
+    ///
+    /// @param path The compiled path of the property.
+    ///
+    /// @param propValue [out] A string object in which to return the value of the property. Can be
+    /// null if the value is not wanted.
+    ///
+    /// @param options A buffer in which to return option flags describing the property. Can be null
+    /// if the flags are not wanted.
+    ///
+    /// @return True if the property exists.
+
+    bool GetProperty ( XMPPathRef       path,
+                       tStringObj *     propValue,
+                       XMP_OptionBits * options ) const;
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c SetProperty() creates or sets a property value through a compiled path.
+    ///
+    /// Otherwise the same as the basic form of \c SetProperty().
+
+    void SetProperty ( XMPPathRef     path,
+                       XMP_StringPtr  propValue,
+                       XMP_OptionBits options = 0 );
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c SetProperty() creates or sets a property value through a compiled path using a
+    /// string object.
+
+    void SetProperty ( XMPPathRef         path,
+                       const tStringObj & propValue,
+                       XMP_OptionBits     options = 0 );
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c DeleteProperty() deletes an XMP subtree through a compiled path.
+    ///
+    /// It is not an error if the property does not exist.
+
+    void DeleteProperty ( XMPPathRef path );
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c DoesPropertyExist() reports whether a property exists, through a compiled path.
+
+    bool DoesPropertyExist ( XMPPathRef path ) const;
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c GetProperties() retrieves several properties through compiled paths in one call.
+    ///
+    /// The XMP object is locked once for the whole list. The values are returned one after the
+    /// other in a single string, each followed by a nul byte, so that a value is found at its
+    /// offset without any more copying. Composite properties have an empty value.
+    ///
+    /// @param paths An array of \c count compiled paths.
+    ///
+    /// @param count The number of paths.
+    ///
+    /// @param values [out] A string object in which to return the values. Can be null if the
+    /// values are not wanted.
+    ///
+    /// @param offsets [out] An array of \c count offsets, each is the offset of the value in
+    /// \c values, or -1 if the property does not exist. The offset is 0 for an existing property if
+    /// \c values is null. Can be null if not wanted.
+    ///
+    /// @param options [out] An array of \c count option flags describing the properties, 0 for a
+    /// property that does not exist. Can be null if not wanted.
+    ///
+    /// @return The number of properties that exist.
+
+    XMP_Index GetProperties ( const XMPPathRef * paths,
+                              XMP_Index          count,
+                              tStringObj *       values,
+                              XMP_Index *        offsets,
+                              XMP_OptionBits *   options = 0 ) const;
+
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c SetProperties() creates or sets several properties through compiled paths in one
+    /// call.
+    ///
+    /// The XMP object is locked once for the whole list. Each property is set as by
+    /// \c SetProperty(). The properties are set in order; if one throws, the ones before it stay set.
+    ///
+    /// @param paths An array of \c count compiled paths.
+    ///
+    /// @param count The number of paths.
+    ///
+    /// @param values An array of \c count values. A value can be null to create an empty struct or
+    /// array, the whole array can be null if all of them are.
+    ///
+    /// @param options An array of \c count option flags, can be null if they are all 0.
+
+    void SetProperties ( const XMPPathRef *    paths,
+                         XMP_Index             count,
+                         const XMP_StringPtr * values,
+                         const XMP_OptionBits * options = 0 );
+
+    /// @}
+
     // =============================================================================================
     // Specialized Get and Set functions
     // =============================================================================================
@@ -1423,6 +1554,13 @@ public:
     /// OR of these bit-flag constants:
     ///   \li \c #kXMP_ParseMoreBuffers - This is not the last buffer of input, more calls follow.
     ///   \li \c #kXMP_RequireXMPMeta - The \c x:xmpmeta XML element is required around \c rdf:RDF.
+    ///   \li \c #kXMP_ParseStreaming - Build the XMP tree as the XML is parsed, instead of from a
+    ///   complete XML tree. The result is the same, but the peak memory use is much lower for large
+    ///   packets. Must be passed with the first buffer of the parse stream.
+    ///   \li \c #kXMP_ParseBinary - The buffer holds the compact binary form written by
+    ///   \c SerializeToBuffer() with \c #kXMP_SerializeBinary, not RDF. It must all be in one buffer,
+    ///   \c #kXMP_ParseMoreBuffers and \c #kXMP_ParseStreaming can't be used. Namespaces are
+    ///   registered as in an RDF parse. A malformed buffer throws \c #kXMPErr_BadXMP.
     ///
     /// @see \c TXMPFiles::GetXMP()
 
@@ -1453,6 +1591,11 @@ public:
     ///   The actual amount of padding is computed. An exception is thrown if the packet exceeds
     ///   this length with no padding.	Cannot be specified together with
     ///   \c kXMP_OmitPacketWrapper.
+    ///   \li \c kXMP_SerializeBinary - Write the compact binary form of the XMP tree instead of RDF,
+    ///   to be read back with \c ParseFromBuffer() and \c #kXMP_ParseBinary. It loads much faster
+    ///   than RDF but is only meant for the XMP Toolkit, not for files. The other options and the
+    ///   formatting parameters are ignored, except that an encoding other than UTF-8 or
+    ///   \c kXMP_ExactPacketLength throws an exception. The string can contain nul bytes.
     ///
     /// In addition to the above options, you can include one of the following encoding options:
     ///   \li \c #kXMP_EncodeUTF8 - Encode as UTF-8, the default.
@@ -1504,6 +1647,11 @@ public:
     ///   The actual amount of padding is computed. An exception is thrown if the packet exceeds
     ///   this length with no padding.	Cannot be specified together with
     ///   \c kXMP_OmitPacketWrapper.
+    ///   \li \c kXMP_SerializeBinary - Write the compact binary form of the XMP tree instead of RDF,
+    ///   to be read back with \c ParseFromBuffer() and \c #kXMP_ParseBinary. It loads much faster
+    ///   than RDF but is only meant for the XMP Toolkit, not for files. The other options and the
+    ///   formatting parameters are ignored, except that an encoding other than UTF-8 or
+    ///   \c kXMP_ExactPacketLength throws an exception. The string can contain nul bytes.
     ///
     /// In addition to the above options, you can include one of the following encoding options:
     ///   \li \c #kXMP_EncodeUTF8 - Encode as UTF-8, the default.
@@ -1519,6 +1667,30 @@ public:
 							 XMP_OptionBits options = 0,
 							 XMP_StringLen  padding = 0 ) const;
 
+    // ---------------------------------------------------------------------------------------------
+    /// @brief \c SerializeToSink() serializes metadata in this XMP object as RDF, passing the text
+    /// to a callback instead of building a string.
+    ///
+    /// The output is exactly what \c SerializeToBuffer() would return, given to the callback in
+    /// pieces of up to 16 KB in order. Use this to write a packet straight into a file, for example
+    /// with a callback that calls \c XMP_IO::Write(). UTF-8 output is never held in memory as a
+    /// whole, other encodings are converted in memory first.
+    ///
+    /// @param outProc The client's callback function, called with successive pieces of the packet.
+    /// A nonzero return aborts the serialization with an exception.
+    ///
+    /// @param refCon A pointer to client-defined data to pass to the callback.
+    ///
+    /// @param options, padding, newline, indent, baseIndent The same as for \c SerializeToBuffer().
+
+    void SerializeToSink ( XMP_TextOutputProc outProc,
+						   void *             refCon,
+						   XMP_OptionBits     options = 0,
+						   XMP_StringLen      padding = 0,
+						   XMP_StringPtr      newline = "",
+						   XMP_StringPtr      indent = "",
+						   XMP_Index          baseIndent = 0 ) const;
+
     /// @}
     // =============================================================================================
     // Miscellaneous Member Functions
@@ -1630,6 +1802,10 @@ public:
     /// The assignment to \c clone3 creates a temporary object, initializes it with the clone,
     /// assigns the address of the temporary to \c clone3, then deletes the temporary.
     ///
+    /// The clone behaves as a deep copy, but its schemas are shared with the original until one of
+    /// the two objects changes them. The first change to a schema copies just that schema, so
+    /// cloning a large template and changing a few properties is cheap.
+    ///
     /// @param options Option flags, not currently defined..
     ///
     /// @return An XMP object cloned from the original.
@@ -1667,11 +1843,24 @@ public:
                  			void *	           clientData ) const;
 
     // ---------------------------------------------------------------------------------------------
-    /// @brief Not implemented
+    /// @brief \c GetObjectOptions() retrieves the storage options of the XMP object.
+    ///
+    /// @return The option flags, see \c #kXMP_UseNodeArena.
+
     XMP_OptionBits GetObjectOptions() const;
 
     // ---------------------------------------------------------------------------------------------
-    /// \brief Not implemented
+    /// @brief \c SetObjectOptions() selects how the XMP object stores its properties.
+    ///
+    /// With \c #kXMP_UseNodeArena the property nodes are allocated from an arena owned by the
+    /// object. Parsing makes far fewer heap allocations, and \c Erase() or destroying the object
+    /// releases the nodes all at once.
+    ///
+    /// The options can only be changed while the object is empty, typically right after
+    /// construction.
+    ///
+    /// @param options Option flags, a combination of \c #kXMP_UseNodeArena or 0.
+
     void SetObjectOptions ( XMP_OptionBits options );
 
     /// @}
@@ -151,6 +151,10 @@ typedef struct __XMPDocOps__ *    XMPDocOpsRef;
 /// file-handling object across  client DLL boundaries. See \c TXMPFiles.
 typedef struct __XMPFiles__ *       XMPFilesRef;
 
+/// @brief An "ABI safe" pointer to a compiled property path. Use to pass a compiled path across
+/// client DLL boundaries. See \c TXMPMeta::CompilePath().
+typedef struct __XMPPath__ *        XMPPathRef;
+
 // =================================================================================================
 
 /// \name General scalar types and constants
@@ -705,6 +709,17 @@ enum {
 
 // -------------------------------------------------------------------------------------------------
 
+/// @brief Option bit flags for \c TXMPMeta::SetObjectOptions() and \c TXMPMeta::GetObjectOptions().
+enum {
+
+	/// Allocate the property nodes from a per-object arena, freed as a whole by \c Erase() or
+	/// when the object is destroyed. Faster parsing and teardown of large packets.
+    kXMP_UseNodeArena = 0x0001UL,
+
+	kXMP_AllObjectOptionsMask = kXMP_UseNodeArena
+
+};
+
 /// @brief Option bit flags for \c TXMPMeta::ParseFromBuffer().
 enum {
 
@@ -715,7 +730,14 @@ enum {
     kXMP_ParseMoreBuffers = 0x0002UL,
 
 	/// Do not reconcile alias differences, throw an exception.
-    kXMP_StrictAliasing   = 0x0004UL
+    kXMP_StrictAliasing   = 0x0004UL,
+
+	/// Build the XMP tree while the XML is parsed instead of from a complete XML tree. Uses much
+	/// less memory for large packets. Must be passed with the first buffer.
+    kXMP_ParseStreaming   = 0x0008UL,
+
+	/// The buffer holds the compact binary form written with \c kXMP_SerializeBinary, not RDF.
+    kXMP_ParseBinary      = 0x0010UL
 
 };
 
@@ -751,6 +773,9 @@ enum {
 	/// Include a rdf Hash and Merged flag in x:xmpmeta element.
 	kXMP_IncludeRDFHash      = 0x2000UL,
 
+	/// Write the compact binary form of the XMP tree instead of RDF, see \c kXMP_ParseBinary.
+	kXMP_SerializeBinary     = 0x4000UL,
+
     _XMP_LittleEndian_Bit    = 0x0001UL,  // ! Don't use directly, see the combined values below!
     _XMP_UTF16_Bit           = 0x0002UL,
     _XMP_UTF32_Bit           = 0x0004UL,
@@ -802,7 +827,11 @@ enum {
     kXMP_IterJustLeafName   = 0x0400UL,
 
 	 /// Omit all qualifiers.
-    kXMP_IterOmitQualifiers = 0x1000UL
+    kXMP_IterOmitQualifiers = 0x1000UL,
+
+	/// Walk the XMP object in place and return just the leaf part of the path, see
+	/// \c TXMPIterator::GetPropPath().
+    kXMP_IterCursor         = 0x2000UL
 
 };
 
@@ -1119,7 +1148,65 @@ enum {
     /// Ignore non-XMP text that uses an undefined "local" encoding.
     kXMPFiles_IgnoreLocalText = 0x0002,
     /// Combination of flags necessary for server products using XMPFiles.
-    kXMPFiles_ServerMode      = kXMPFiles_IgnoreLocalText
+    kXMPFiles_ServerMode      = kXMPFiles_IgnoreLocalText,
+
+    /// Do not buffer reads of files that are not memory mapped, pass every read to the host.
+    kXMPFiles_NoReadBuffer    = 0x0004,
+    /// Memory map files that are opened only for reading and are on a local volume. Only use this
+    /// if no other process can truncate the files while they are open, an access to a page lost
+    /// that way raises SIGBUS on UNIX or an in-page exception on Windows.
+    kXMPFiles_MapReadOnlyFiles = 0x0008,
+    /// Bits holding the log2 of the read buffer size, see \c kXMPFiles_ReadBufferLog2. Zero selects
+    /// the default of 64K, other values are limited to 12 (4K) through 24 (16M).
+    kXMPFiles_ReadBufferSizeMask  = 0x1F00,
+    /// Shift for \c kXMPFiles_ReadBufferSizeMask.
+    kXMPFiles_ReadBufferSizeShift = 8,
+    /// Bits holding the log2 of the padding given to a rewritten JPEG XMP packet, see
+    /// \c kXMPFiles_JPEGPaddingLog2. Zero selects the default of 2K, other values are limited to
+    /// 10 (1K) through 15 (32K).
+    kXMPFiles_JPEGPaddingMask     = 0xF0000,
+    /// Shift for \c kXMPFiles_JPEGPaddingMask.
+    kXMPFiles_JPEGPaddingShift    = 16
+};
+
+/// \def kXMPFiles_ReadBufferLog2
+/// \brief Option bits for \c TXMPFiles::Initialize() selecting a read buffer of 2^log2Size bytes.
+#define kXMPFiles_ReadBufferLog2(log2Size) \
+	( ((XMP_OptionBits)(log2Size) << kXMPFiles_ReadBufferSizeShift) & kXMPFiles_ReadBufferSizeMask )
+
+/// \def kXMPFiles_JPEGPaddingLog2
+/// \brief Option bits for \c TXMPFiles::Initialize() padding rewritten JPEG XMP to 2^log2Size bytes.
+#define kXMPFiles_JPEGPaddingLog2(log2Size) \
+	( ((XMP_OptionBits)(log2Size) << kXMPFiles_JPEGPaddingShift) & kXMPFiles_JPEGPaddingMask )
+
+/// @brief Host I/O counters for one opened file, see \c TXMPFiles::GetIOStats().
+///
+/// Files opened only for reading are memory mapped when \c kXMPFiles_MapReadOnlyFiles is passed to
+/// \c TXMPFiles::Initialize() and the host allows it, other files are read through a buffer sized by
+/// the \c TXMPFiles::Initialize() options. The saved counts are the reads and
+/// seeks that were satisfied without calling the host file system. The write counts cover the
+/// update made by \c TXMPFiles::CloseFile(), including a rewrite through a temporary file.
+struct XMP_IOStats {
+
+	/// Reads passed to the host file system.
+	XMP_Uns32 hostReads;
+	/// Reads satisfied from the memory mapping or read buffer.
+	XMP_Uns32 savedReads;
+	/// Seeks passed to the host file system.
+	XMP_Uns32 hostSeeks;
+	/// Seeks that only moved the logical file position.
+	XMP_Uns32 savedSeeks;
+	/// Writes passed to the host file system.
+	XMP_Uns32 hostWrites;
+	/// Bytes passed to the host file system by those writes.
+	XMP_Uns64 bytesWritten;
+	/// Bytes copied between files by the host file system, without being read and written.
+	XMP_Uns64 bytesCopied;
+
+	/// Default constructor.
+	XMP_IOStats() : hostReads(0), savedReads(0), hostSeeks(0), savedSeeks(0),
+					hostWrites(0), bytesWritten(0), bytesCopied(0) {};
+
 };
 
 /// @brief Option bit flags for \c TXMPFiles::GetFormatInfo().
@@ -1547,6 +1634,32 @@ typedef XMP_Status (* XMP_TextOutputProc) ( void *        refCon,
 
 typedef bool (* XMP_AbortProc) ( void * arg );
 
+// -------------------------------------------------------------------------------------------------
+/// @brief The signature of a client-defined callback receiving the result for one file of a batch.
+///
+/// Calls are made from the batch worker threads in completion order, but never concurrently.
+///
+/// @param context A pointer to caller-defined data passed from the batch call.
+///
+/// @param fileIndex The index of the file in the path array passed to the batch call.
+///
+/// @param format The format of the file, \c #kXMP_UnknownFile if it could not be opened.
+///
+/// @param xmpRef The file's XMP, null if it has none or could not be read. The object is released
+/// after the callback returns, construct an \c SXMPMeta from the reference to keep it.
+///
+/// @param errorID The ID of the first error reported for the file, 0 if there was none. Files that
+/// recovered from an error can have both XMP and a nonzero error ID.
+///
+/// @param errorMessage The message of that error, an empty string if there was none.
+///
+/// @return True to continue the batch, false to stop it after the files already in progress.
+///
+/// @see \c TXMPFiles::ProcessBatch()
+
+typedef bool (* XMPFiles_BatchProc) ( void * context, XMP_Index fileIndex, XMP_FileFormat format,
+                                      XMPMetaRef xmpRef, XMP_Int32 errorID, XMP_StringPtr errorMessage );
+
 // -------------------------------------------------------------------------------------------------
 /// @brief The signature of a client-defined callback for progress report notifications.
 ///
@@ -85,6 +85,12 @@ inline XMP_Bool WrapFilesErrorNotify ( XMPFiles_ErrorCallbackProc proc, void * c
 #define zXMPFiles_CheckFileFormat_1(filePath) \
 	WXMPFiles_CheckFileFormat_1 ( filePath, &wResult )
 
+#define zXMPFiles_ProcessBatch_1(filePaths,fileCount,openFlags,batchProc,context,threadCount) \
+	WXMPFiles_ProcessBatch_1 ( filePaths, fileCount, openFlags, batchProc, context, threadCount, &wResult )
+
+#define zXMPFiles_SetMetadataCache_1(cacheFolder,maxCacheSize) \
+	WXMPFiles_SetMetadataCache_1 ( cacheFolder, maxCacheSize, &wResult )
+
 #define zXMPFiles_CheckPackageFormat_1(folderPath) \
 	WXMPFiles_CheckPackageFormat_1 ( folderPath, &wResult )
 
@@ -111,6 +117,9 @@ inline XMP_Bool WrapFilesErrorNotify ( XMPFiles_ErrorCallbackProc proc, void * c
 #define zXMPFiles_GetFileInfo_1(clientPath,openFlags,format,handlerFlags,SetClientString) \
 	WXMPFiles_GetFileInfo_1 ( this->xmpFilesRef, clientPath, openFlags, format, handlerFlags, SetClientString, &wResult )
 
+#define zXMPFiles_GetIOStats_1(ioStats) \
+	WXMPFiles_GetIOStats_1 ( this->xmpFilesRef, ioStats, &wResult )
+
 #define zXMPFiles_SetAbortProc_1(abortProc,abortArg) \
 	WXMPFiles_SetAbortProc_1 ( this->xmpFilesRef, abortProc, abortArg, &wResult )
 
@@ -165,6 +174,18 @@ extern void WXMPFiles_GetFormatInfo_1 ( XMP_FileFormat   format,
 extern void WXMPFiles_CheckFileFormat_1 ( XMP_StringPtr filePath,
                                			  WXMP_Result * result );
 
+extern void WXMPFiles_ProcessBatch_1 ( const XMP_StringPtr * filePaths,
+                                       XMP_Index             fileCount,
+                                       XMP_OptionBits        openFlags,
+                                       XMPFiles_BatchProc    batchProc,
+                                       void *                context,
+                                       XMP_Index             threadCount,
+                                       WXMP_Result *         result );
+
+extern void WXMPFiles_SetMetadataCache_1 ( XMP_StringPtr cacheFolder,
+                                           XMP_Uns64     maxCacheSize,
+                                           WXMP_Result * result );
+
 extern void WXMPFiles_CheckPackageFormat_1 ( XMP_StringPtr folderPath,
                       						 WXMP_Result * result );
 
@@ -214,6 +235,10 @@ extern void WXMPFiles_GetFileInfo_1 ( XMPFilesRef      xmpFilesRef,
 					                  SetClientStringProc SetClientString,
                                       WXMP_Result *    result );
 
+extern void WXMPFiles_GetIOStats_1 ( XMPFilesRef   xmpFilesRef,
+                                     XMP_IOStats * ioStats,
+                                     WXMP_Result * result );
+
 extern void WXMPFiles_SetAbortProc_1 ( XMPFilesRef   xmpFilesRef,
                                        XMP_AbortProc abortProc,
 									   void *        abortArg,
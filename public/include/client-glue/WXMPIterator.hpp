@@ -30,6 +30,9 @@ extern "C" {
 #define zXMPIterator_Skip_1(options) \
     WXMPIterator_Skip_1 ( this->iterRef, options, &wResult );
 
+#define zXMPIterator_GetPropPath_1(propPath,SetClientString) \
+    WXMPIterator_GetPropPath_1 ( this->iterRef, propPath, SetClientString, &wResult );
+
 // -------------------------------------------------------------------------------------------------
 
 extern void
@@ -59,6 +62,12 @@ XMP_PUBLIC WXMPIterator_Skip_1 ( XMPIteratorRef iterRef,
                       XMP_OptionBits options,
                       WXMP_Result *  wResult );
 
+extern void
+XMP_PUBLIC WXMPIterator_GetPropPath_1 ( XMPIteratorRef iterRef,
+                             void *         propPath,
+                             SetClientStringProc SetClientString,
+                             WXMP_Result *  wResult );
+
 // =================================================================================================
 
 #if __cplusplus
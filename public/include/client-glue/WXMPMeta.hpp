@@ -113,6 +113,30 @@ static inline XMP_Bool WrapErrorNotify ( XMPMeta_ErrorCallbackProc proc, void *
 #define zXMPMeta_DoesQualifierExist_1(schemaNS,propName,qualNS,qualName) \
     WXMPMeta_DoesQualifierExist_1 ( this->xmpRef, schemaNS, propName, qualNS, qualName, &wResult )
 
+#define zXMPMeta_CompilePath_1(schemaNS,propName) \
+    WXMPMeta_CompilePath_1 ( schemaNS, propName, &wResult )
+
+#define zXMPMeta_ReleasePath_1(pathRef) \
+    WXMPMeta_ReleasePath_1 ( pathRef, &wResult )
+
+#define zXMPMeta_GetCompiledProperty_1(pathRef,propValue,options,SetClientString) \
+    WXMPMeta_GetCompiledProperty_1 ( this->xmpRef, pathRef, propValue, options, SetClientString, &wResult )
+
+#define zXMPMeta_SetCompiledProperty_1(pathRef,propValue,options) \
+    WXMPMeta_SetCompiledProperty_1 ( this->xmpRef, pathRef, propValue, options, &wResult )
+
+#define zXMPMeta_DeleteCompiledProperty_1(pathRef) \
+    WXMPMeta_DeleteCompiledProperty_1 ( this->xmpRef, pathRef, &wResult )
+
+#define zXMPMeta_DoesCompiledPropertyExist_1(pathRef) \
+    WXMPMeta_DoesCompiledPropertyExist_1 ( this->xmpRef, pathRef, &wResult )
+
+#define zXMPMeta_GetProperties_1(pathRefs,count,values,offsets,options,SetClientString) \
+    WXMPMeta_GetProperties_1 ( this->xmpRef, pathRefs, count, values, offsets, options, SetClientString, &wResult )
+
+#define zXMPMeta_SetProperties_1(pathRefs,count,values,options) \
+    WXMPMeta_SetProperties_1 ( this->xmpRef, pathRefs, count, values, options, &wResult )
+
 #define zXMPMeta_GetLocalizedText_1(schemaNS,altTextName,genericLang,specificLang,clientLang,clientValue,options,SetClientString) \
     WXMPMeta_GetLocalizedText_1 ( this->xmpRef, schemaNS, altTextName, genericLang, specificLang, clientLang, clientValue, options, SetClientString, &wResult )
 
@@ -160,6 +184,9 @@ static inline XMP_Bool WrapErrorNotify ( XMPMeta_ErrorCallbackProc proc, void *
 #define zXMPMeta_GetObjectOptions_1() \
     WXMPMeta_GetObjectOptions_1 ( this->xmpRef, &wResult )
 
+#define zXMPMeta_SetObjectOptions_1(options) \
+    WXMPMeta_SetObjectOptions_1 ( this->xmpRef, options, &wResult )
+
 #define zXMPMeta_Sort_1() \
     WXMPMeta_Sort_1 ( this->xmpRef, &wResult )
 
@@ -181,6 +208,9 @@ static inline XMP_Bool WrapErrorNotify ( XMPMeta_ErrorCallbackProc proc, void *
 #define zXMPMeta_SerializeToBuffer_1(pktString,options,padding,newline,indent,baseIndent,SetClientString) \
     WXMPMeta_SerializeToBuffer_1 ( this->xmpRef, pktString, options, padding, newline, indent, baseIndent, SetClientString, &wResult )
 
+#define zXMPMeta_SerializeToSink_1(outProc,refCon,options,padding,newline,indent,baseIndent) \
+    WXMPMeta_SerializeToSink_1 ( this->xmpRef, outProc, refCon, options, padding, newline, indent, baseIndent, &wResult )
+
 #define zXMPMeta_SetDefaultErrorCallback_1(proc,context,limit) \
 	WXMPMeta_SetDefaultErrorCallback_1 ( WrapErrorNotify, proc, context, limit, &wResult )
 	
@@ -408,6 +438,60 @@ XMP_PUBLIC WXMPMeta_DoesQualifierExist_1 ( XMPMetaRef    xmpRef,
 
 // -------------------------------------------------------------------------------------------------
 
+extern void
+XMP_PUBLIC WXMPMeta_CompilePath_1 ( XMP_StringPtr schemaNS,
+                         XMP_StringPtr propName,
+                         WXMP_Result * wResult );
+
+extern void
+XMP_PUBLIC WXMPMeta_ReleasePath_1 ( XMPPathRef    pathRef,
+                         WXMP_Result * wResult );
+
+extern void
+XMP_PUBLIC WXMPMeta_GetCompiledProperty_1 ( XMPMetaRef       xmpRef,
+                                 XMPPathRef       pathRef,
+                                 void *           propValue,
+                                 XMP_OptionBits * options,
+                                 SetClientStringProc SetClientString,
+                                 WXMP_Result *    wResult ) /* const */ ;
+
+extern void
+XMP_PUBLIC WXMPMeta_SetCompiledProperty_1 ( XMPMetaRef     xmpRef,
+                                 XMPPathRef     pathRef,
+                                 XMP_StringPtr  propValue,
+                                 XMP_OptionBits options,
+                                 WXMP_Result *  wResult );
+
+extern void
+XMP_PUBLIC WXMPMeta_DeleteCompiledProperty_1 ( XMPMetaRef    xmpRef,
+                                    XMPPathRef    pathRef,
+                                    WXMP_Result * wResult );
+
+extern void
+XMP_PUBLIC WXMPMeta_DoesCompiledPropertyExist_1 ( XMPMetaRef    xmpRef,
+                                       XMPPathRef    pathRef,
+                                       WXMP_Result * wResult ) /* const */ ;
+
+extern void
+XMP_PUBLIC WXMPMeta_GetProperties_1 ( XMPMetaRef         xmpRef,
+                           const XMPPathRef * pathRefs,
+                           XMP_Index          count,
+                           void *             values,
+                           XMP_Index *        offsets,
+                           XMP_OptionBits *   options,
+                           SetClientStringProc SetClientString,
+                           WXMP_Result *      wResult ) /* const */ ;
+
+extern void
+XMP_PUBLIC WXMPMeta_SetProperties_1 ( XMPMetaRef             xmpRef,
+                           const XMPPathRef *     pathRefs,
+                           XMP_Index              count,
+                           const XMP_StringPtr *  values,
+                           const XMP_OptionBits * options,
+                           WXMP_Result *          wResult );
+
+// -------------------------------------------------------------------------------------------------
+
 extern void
 XMP_PUBLIC WXMPMeta_GetLocalizedText_1 ( XMPMetaRef       xmpRef,
                               XMP_StringPtr    schemaNS,
@@ -537,6 +621,11 @@ extern void
 XMP_PUBLIC WXMPMeta_GetObjectOptions_1 ( XMPMetaRef    xmpRef,
                               WXMP_Result * wResult ) /* const */ ;
 
+extern void
+XMP_PUBLIC WXMPMeta_SetObjectOptions_1 ( XMPMetaRef     xmpRef,
+                              XMP_OptionBits options,
+                              WXMP_Result *  wResult );
+
 extern void
 XMP_PUBLIC WXMPMeta_Sort_1 ( XMPMetaRef    xmpRef,
                   WXMP_Result * wResult );
@@ -582,6 +671,17 @@ XMP_PUBLIC WXMPMeta_SerializeToBuffer_1 ( XMPMetaRef     xmpRef,
                                SetClientStringProc SetClientString,
                                WXMP_Result *  wResult ) /* const */ ;
 
+extern void
+XMP_PUBLIC WXMPMeta_SerializeToSink_1 ( XMPMetaRef         xmpRef,
+                             XMP_TextOutputProc outProc,
+                             void *             refCon,
+                             XMP_OptionBits     options,
+                             XMP_StringLen      padding,
+                             XMP_StringPtr      newline,
+                             XMP_StringPtr      indent,
+                             XMP_Index          baseIndent,
+                             WXMP_Result *      wResult ) /* const */ ;
+
 // -------------------------------------------------------------------------------------------------
 
 extern void
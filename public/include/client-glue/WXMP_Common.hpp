@@ -112,6 +112,10 @@ extern "C" {
     InvokeCheck(WCallProto);                  \
     XMPDocOpsRef result = XMPDocOpsRef(wResult.ptrResult)
 
+#define WrapCheckPathRef(result,WCallProto) \
+    InvokeCheck(WCallProto);                \
+    XMPPathRef result = XMPPathRef(wResult.ptrResult)
+
 #define  WrapCheckNewMetadata(result,WCallProto) \
     InvokeCheck(WCallProto);                  \
     void * result = wResult.ptrResult
@@ -0,0 +1,131 @@
+// =================================================================================================
+// Copyright Adobe
+// All Rights Reserved.
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+/**
+* Measures building and tearing down XMP trees with and without the kXMP_UseNodeArena object
+* option. A packet with a long xmpMM:History is serialized once, then parsed and erased over and
+* over by one object, and parsed into a fresh object that is then destroyed. The parse and the
+* teardown are timed separately, in milliseconds per packet.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <chrono>
+
+#define TXMP_STRING_TYPE std::string
+#include "public/include/XMP.incl_cpp"
+#include "public/include/XMP.hpp"
+
+using namespace std;
+
+static const size_t kHistoryCount = 3000;
+
+// =================================================================================================
+
+static string
+BuildPacket()
+{
+	SXMPMeta meta;
+	char buffer [100];
+	for ( size_t i = 1; i <= kHistoryCount; ++i ) {
+		meta.AppendArrayItem ( kXMP_NS_XMP_MM, "History", kXMP_PropArrayIsOrdered, 0, kXMP_PropValueIsStruct );
+		string itemPath;
+		SXMPUtils::ComposeArrayItemPath ( kXMP_NS_XMP_MM, "History", kXMP_ArrayLastItem, &itemPath );
+		meta.SetStructField ( kXMP_NS_XMP_MM, itemPath.c_str(), kXMP_NS_XMP_ResourceEvent, "action", "saved" );
+		snprintf ( buffer, sizeof(buffer), "xmp.iid:%08X-0F1E-2D3C-4B5A-69788796A5B4", (unsigned int)i );
+		meta.SetStructField ( kXMP_NS_XMP_MM, itemPath.c_str(), kXMP_NS_XMP_ResourceEvent, "instanceID", buffer );
+		meta.SetStructField ( kXMP_NS_XMP_MM, itemPath.c_str(), kXMP_NS_XMP_ResourceEvent, "softwareAgent", "Adobe Photoshop 27.0 (Macintosh)" );
+	}
+	string packet;
+	meta.SerializeToBuffer ( &packet, kXMP_OmitPacketWrapper );
+	return packet;
+}	// BuildPacket
+
+// =================================================================================================
+
+typedef std::chrono::steady_clock::time_point TimePoint;
+
+static double
+Millis ( TimePoint start, TimePoint end )
+{
+	return std::chrono::duration<double, std::milli> ( end - start ).count();
+}	// Millis
+
+// =================================================================================================
+
+static void
+MeasureOption ( const char * label, XMP_OptionBits objOptions, const string & packet, size_t cycles )
+{
+	double parseMillis = 0.0, eraseMillis = 0.0, freshParseMillis = 0.0, deleteMillis = 0.0;
+	TimePoint start, middle, end;
+
+	SXMPMeta reused;
+	reused.SetObjectOptions ( objOptions );
+
+	for ( size_t cycle = 0; cycle < cycles; ++cycle ) {
+		start = std::chrono::steady_clock::now();
+		reused.ParseFromBuffer ( packet.c_str(), (XMP_StringLen) packet.size() );
+		middle = std::chrono::steady_clock::now();
+		reused.Erase();
+		end = std::chrono::steady_clock::now();
+		parseMillis += Millis ( start, middle );
+		eraseMillis += Millis ( middle, end );
+	}
+
+	for ( size_t cycle = 0; cycle < cycles; ++cycle ) {
+		start = std::chrono::steady_clock::now();
+		SXMPMeta * fresh = new SXMPMeta;
+		fresh->SetObjectOptions ( objOptions );
+		fresh->ParseFromBuffer ( packet.c_str(), (XMP_StringLen) packet.size() );
+		middle = std::chrono::steady_clock::now();
+		delete fresh;
+		end = std::chrono::steady_clock::now();
+		freshParseMillis += Millis ( start, middle );
+		deleteMillis += Millis ( middle, end );
+	}
+
+	printf ( "%-8s reused: parse %7.2f ms, erase %6.2f ms    fresh: parse %7.2f ms, delete %6.2f ms\n",
+			 label, parseMillis / cycles, eraseMillis / cycles, freshParseMillis / cycles, deleteMillis / cycles );
+
+}	// MeasureOption
+
+// =================================================================================================
+
+extern "C" int
+main ( int argc, const char * argv [] )
+{
+
+	size_t cycles = 50;
+	if ( argc > 1 ) cycles = (size_t) atoi ( argv[1] );
+	if ( cycles == 0 ) {
+		printf ( "usage: ArenaPerformance [cycles]\n" );
+		return 0;
+	}
+
+	if ( ! SXMPMeta::Initialize() ) {
+		printf ( "Could not initialize the toolkit\n" );
+		return 1;
+	}
+
+	try {
+		string packet = BuildPacket();
+		printf ( "Packet of %zu bytes, %zu history entries\n", packet.size(), kHistoryCount );
+		for ( int pass = 0; pass < 2; ++pass ) {	// The first pass warms up the heap.
+			MeasureOption ( "heap", 0, packet, cycles );
+			MeasureOption ( "arena", kXMP_UseNodeArena, packet, cycles );
+		}
+	} catch ( XMP_Error & excep ) {
+		printf ( "Caught XMP_Error %d : %s\n", excep.GetID(), excep.GetErrMsg() );
+	}
+
+	SXMPMeta::Terminate();
+	return 0;
+
+}
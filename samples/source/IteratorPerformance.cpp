@@ -0,0 +1,206 @@
+// =================================================================================================
+// Copyright Adobe
+// All Rights Reserved.
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+/**
+* Measures the throughput of the property iterator, with and without kXMP_IterCursor. The packets
+* are the custom XMP of the XMPIterations sample, the same XMP with a long xmpMM:History, and the
+* main XMP of any files named on the command line. Each packet is walked with a plain iteration,
+* a cursor iteration, and a cursor iteration that also asks for every full path. The rate in
+* thousands of nodes per second is printed for each.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <chrono>
+
+#define TXMP_STRING_TYPE std::string
+#define XMP_INCLUDE_XMPFILES 1
+#include "public/include/XMP.incl_cpp"
+#include "public/include/XMP.hpp"
+
+using namespace std;
+
+static const size_t kHistoryCount = 5000;
+
+// The custom XMP of the XMPIterations sample.
+static const char * rdf =
+"<rdf:RDF xmlns:rdf='http://www.w3.org/1999/02/22-rdf-syntax-ns#'>"
+"  <rdf:Description rdf:about='' xmlns:xmpTest='http://ns.adobe.com/xmpTest/'>"
+"	 <xmpTest:MySimpleProp rdf:parseType='Resource'>"
+"		<rdf:value>A Value</rdf:value>"
+"		<xmpTest:MyQual>Qual Value</xmpTest:MyQual>"
+"  </xmpTest:MySimpleProp>"
+"		<xmpTest:MyTopStruct rdf:parseType='Resource'>"
+"			<xmpTest:MySecondStruct rdf:parseType='Resource'>"
+"				<xmpTest:MyThirdStruct rdf:parseType='Resource'>"
+"					<xmpTest:MyThirdStructField>Field Value 3</xmpTest:MyThirdStructField>"
+"       </xmpTest:MyThirdStruct>"
+"				<xmpTest:MySecondStructField>Field Value 2</xmpTest:MySecondStructField>"
+"     </xmpTest:MySecondStruct>"
+"    <xmpTest:MyTopStructField>Field Value 1</xmpTest:MyTopStructField>"
+"   </xmpTest:MyTopStruct>"
+"   <xmpTest:MyArrayWithNestedArray>"
+"			<rdf:Bag>"
+"				<rdf:li>"
+"					<rdf:Seq>"
+"						<rdf:li>Item 1</rdf:li>"
+"           <rdf:li>Item 2</rdf:li>"
+"         </rdf:Seq>"
+"				</rdf:li>"
+"			</rdf:Bag>"
+"   </xmpTest:MyArrayWithNestedArray>"
+"   <xmpTest:MyArrayWithStructures>"
+"			<rdf:Seq>"
+"				<rdf:li rdf:parseType='Resource'>"
+"					<rdf:value>Field Value 1</rdf:value>"
+"						<xmpTest:FirstQual>Qual Value 1</xmpTest:FirstQual>"
+"           <xmpTest:SecondQual>Qual Value 2</xmpTest:SecondQual>"
+"        </rdf:li>"
+"        <rdf:li rdf:parseType='Resource'>"
+"					<rdf:value>Field Value 2</rdf:value>"
+"						<xmpTest:FirstQual>Qual Value 3</xmpTest:FirstQual>"
+"           <xmpTest:SecondQual>Qual Value 4</xmpTest:SecondQual>"
+"        </rdf:li>"
+"     </rdf:Seq>"
+"   </xmpTest:MyArrayWithStructures>"
+"   <xmpTest:MyStructureWithArray rdf:parseType='Resource'>"
+"			<xmpTest:NestedArray>"
+"				<rdf:Bag>"
+"					<rdf:li>Item 3</rdf:li>"
+"				</rdf:Bag>"
+"			</xmpTest:NestedArray>"
+"			<xmpTest:NestedArray2>"
+"				<rdf:Bag>"
+"					<rdf:li>Item 4</rdf:li>"
+"					<rdf:li>Item 5</rdf:li>"
+"					<rdf:li>Item 6</rdf:li>"
+"				</rdf:Bag>"
+"			</xmpTest:NestedArray2>"
+"   </xmpTest:MyStructureWithArray>"
+"  </rdf:Description>"
+"</rdf:RDF>";
+
+// =================================================================================================
+
+static void
+BuildHistory ( SXMPMeta * meta )
+{
+	char buffer [100];
+	for ( size_t i = 1; i <= kHistoryCount; ++i ) {
+		meta->AppendArrayItem ( kXMP_NS_XMP_MM, "History", kXMP_PropArrayIsOrdered, 0, kXMP_PropValueIsStruct );
+		string itemPath;
+		SXMPUtils::ComposeArrayItemPath ( kXMP_NS_XMP_MM, "History", kXMP_ArrayLastItem, &itemPath );
+		meta->SetStructField ( kXMP_NS_XMP_MM, itemPath.c_str(), kXMP_NS_XMP_ResourceEvent, "action", "saved" );
+		snprintf ( buffer, sizeof(buffer), "xmp.iid:%08X-0F1E-2D3C-4B5A-69788796A5B4", (unsigned int)i );
+		meta->SetStructField ( kXMP_NS_XMP_MM, itemPath.c_str(), kXMP_NS_XMP_ResourceEvent, "instanceID", buffer );
+		meta->SetStructField ( kXMP_NS_XMP_MM, itemPath.c_str(), kXMP_NS_XMP_ResourceEvent, "softwareAgent", "Adobe Photoshop 27.0 (Macintosh)" );
+	}
+}	// BuildHistory
+
+// =================================================================================================
+
+static double
+RateKNodes ( size_t nodes, size_t cycles, std::chrono::steady_clock::time_point start )
+{
+	double seconds = std::chrono::duration<double> ( std::chrono::steady_clock::now() - start ).count();
+	return (seconds > 0.0) ? ((double)nodes * cycles / seconds / 1.0e3) : 0.0;
+}	// RateKNodes
+
+// =================================================================================================
+
+static size_t
+Iterate ( const SXMPMeta & meta, XMP_OptionBits options, bool fullPaths )
+{
+	SXMPIterator iter ( meta, options );
+	string schemaNS, propPath, propValue, fullPath;
+	size_t nodes = 0;
+	while ( iter.Next ( &schemaNS, &propPath, &propValue ) ) {
+		if ( fullPaths ) iter.GetPropPath ( &fullPath );
+		++nodes;
+	}
+	return nodes;
+}	// Iterate
+
+// =================================================================================================
+
+static void
+MeasurePacket ( const char * label, const SXMPMeta & meta, size_t cycles )
+{
+	std::chrono::steady_clock::time_point start;
+	const size_t nodes = Iterate ( meta, 0, false );
+
+	start = std::chrono::steady_clock::now();
+	for ( size_t i = 0; i < cycles; ++i ) Iterate ( meta, 0, false );
+	double plainRate = RateKNodes ( nodes, cycles, start );
+
+	start = std::chrono::steady_clock::now();
+	for ( size_t i = 0; i < cycles; ++i ) Iterate ( meta, kXMP_IterCursor, false );
+	double cursorRate = RateKNodes ( nodes, cycles, start );
+
+	start = std::chrono::steady_clock::now();
+	for ( size_t i = 0; i < cycles; ++i ) Iterate ( meta, kXMP_IterCursor, true );
+	double pathsRate = RateKNodes ( nodes, cycles, start );
+
+	printf ( "%-24s %7zu nodes, plain %9.1f Knodes/s, cursor %9.1f Knodes/s, cursor+paths %9.1f Knodes/s\n",
+			 label, nodes, plainRate, cursorRate, pathsRate );
+
+}	// MeasurePacket
+
+// =================================================================================================
+
+extern "C" int
+main ( int argc, const char * argv [] )
+{
+
+	size_t cycles = 200;
+	if ( argc > 1 ) cycles = (size_t) atoi ( argv[1] );
+	if ( cycles == 0 ) {
+		printf ( "usage: IteratorPerformance [cycles] [file ...]\n" );
+		return 0;
+	}
+
+	XMP_OptionBits options = 0;
+	#if UNIX_ENV
+		options |= kXMPFiles_ServerMode;
+	#endif
+	if ( (! SXMPMeta::Initialize()) || (! SXMPFiles::Initialize ( options )) ) {
+		printf ( "Could not initialize the toolkit\n" );
+		return 1;
+	}
+
+	try {
+
+		SXMPMeta custom ( rdf, (XMP_StringLen) strlen ( rdf ) );
+		MeasurePacket ( "XMPIterations", custom, cycles );
+
+		SXMPMeta history ( rdf, (XMP_StringLen) strlen ( rdf ) );
+		BuildHistory ( &history );
+		MeasurePacket ( "XMPIterations+History", history, cycles / 20 + 1 );
+
+		for ( int argNum = 2; argNum < argc; ++argNum ) {
+			SXMPFiles file;
+			SXMPMeta meta;
+			if ( file.OpenFile ( argv[argNum], kXMP_UnknownFile, kXMPFiles_OpenForRead ) && file.GetXMP ( &meta ) ) {
+				MeasurePacket ( argv[argNum], meta, cycles );
+			} else {
+				printf ( "%-24s no XMP\n", argv[argNum] );
+			}
+			file.CloseFile();
+		}
+
+	} catch ( XMP_Error & excep ) {
+		printf ( "Caught XMP_Error %d : %s\n", excep.GetID(), excep.GetErrMsg() );
+	}
+
+	SXMPFiles::Terminate();
+	SXMPMeta::Terminate();
+	return 0;
+
+}
@@ -0,0 +1,112 @@
+// =================================================================================================
+// Copyright Adobe
+// All Rights Reserved.
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+/**
+* Measures property lookups by name as a struct gets wider. A struct with the given number of
+* fields is built, then every field is read with GetStructField and rewritten with SetStructField.
+* Below kXMP_NodeIndexThreshold fields the lookups are linear, above it they go through the name
+* index, so the time per lookup should stay flat from there on. The time in nanoseconds per call
+* is printed for each width.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#define TXMP_STRING_TYPE std::string
+#include "public/include/XMP.incl_cpp"
+#include "public/include/XMP.hpp"
+
+using namespace std;
+
+static const size_t kWidths[] = { 4, 8, 16, 64, 256, 1024, 4096 };
+static const size_t kLookupsPerWidth = 1000000;
+
+// =================================================================================================
+
+static double
+NanosPerCall ( size_t calls, std::chrono::steady_clock::time_point start )
+{
+	double seconds = std::chrono::duration<double> ( std::chrono::steady_clock::now() - start ).count();
+	return (calls > 0) ? (seconds * 1.0e9 / (double)calls) : 0.0;
+}	// NanosPerCall
+
+// =================================================================================================
+
+static void
+MeasureWidth ( size_t width, size_t lookups )
+{
+	SXMPMeta meta;
+	vector<string> fieldNames ( width );
+	char buffer [32];
+
+	for ( size_t fieldNum = 0; fieldNum < width; ++fieldNum ) {
+		snprintf ( buffer, sizeof(buffer), "Field%zu", fieldNum );
+		fieldNames[fieldNum] = buffer;
+		meta.SetStructField ( kXMP_NS_XMP, "Wide", kXMP_NS_XMP, buffer, "value" );
+	}
+
+	const size_t cycles = (lookups / width) + 1;
+	std::chrono::steady_clock::time_point start;
+	string fieldValue;
+	size_t found = 0;
+
+	start = std::chrono::steady_clock::now();
+	for ( size_t cycle = 0; cycle < cycles; ++cycle ) {
+		for ( size_t fieldNum = 0; fieldNum < width; ++fieldNum ) {
+			if ( meta.GetStructField ( kXMP_NS_XMP, "Wide", kXMP_NS_XMP, fieldNames[fieldNum].c_str(), &fieldValue, 0 ) ) ++found;
+		}
+	}
+	double getNanos = NanosPerCall ( cycles * width, start );
+
+	start = std::chrono::steady_clock::now();
+	for ( size_t cycle = 0; cycle < cycles; ++cycle ) {
+		for ( size_t fieldNum = 0; fieldNum < width; ++fieldNum ) {
+			meta.SetStructField ( kXMP_NS_XMP, "Wide", kXMP_NS_XMP, fieldNames[fieldNum].c_str(), "new value" );
+		}
+	}
+	double setNanos = NanosPerCall ( cycles * width, start );
+
+	if ( found != cycles * width ) printf ( "Width %zu: only %zu of %zu lookups found a field\n", width, found, cycles * width );
+	printf ( "%6zu fields, get %8.1f ns/call, set %8.1f ns/call\n", width, getNanos, setNanos );
+
+}	// MeasureWidth
+
+// =================================================================================================
+
+extern "C" int
+main ( int argc, const char * argv [] )
+{
+
+	size_t lookups = kLookupsPerWidth;
+	if ( argc > 1 ) lookups = (size_t) atoi ( argv[1] );
+	if ( lookups == 0 ) {
+		printf ( "usage: NodeLookupPerformance [lookups per width]\n" );
+		return 0;
+	}
+
+	if ( ! SXMPMeta::Initialize() ) {
+		printf ( "Could not initialize the toolkit\n" );
+		return 1;
+	}
+
+	try {
+		for ( size_t widthNum = 0; widthNum < sizeof(kWidths)/sizeof(kWidths[0]); ++widthNum ) {
+			MeasureWidth ( kWidths[widthNum], lookups );
+		}
+	} catch ( XMP_Error & excep ) {
+		printf ( "Caught XMP_Error %d : %s\n", excep.GetID(), excep.GetErrMsg() );
+	}
+
+	SXMPMeta::Terminate();
+	return 0;
+
+}
@@ -0,0 +1,100 @@
+// =================================================================================================
+// Copyright Adobe
+// All Rights Reserved.
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+/**
+* Measures reading the main XMP of files, with the default buffered host reads and with
+* kXMPFiles_MapReadOnlyFiles. Each file named on the command line is opened for reading, its XMP is
+* fetched, and it is closed, over and over. The time per file and the host reads and seeks of the
+* last open are printed for both modes. A file on a network volume is never mapped, its counts are
+* the same in both modes.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <chrono>
+
+#define TXMP_STRING_TYPE std::string
+#define XMP_INCLUDE_XMPFILES 1
+#include "public/include/XMP.incl_cpp"
+#include "public/include/XMP.hpp"
+
+using namespace std;
+
+// =================================================================================================
+
+static void
+MeasureMode ( const char * label, XMP_OptionBits filesOptions, int fileCount, const char ** filePaths, size_t cycles )
+{
+	#if UNIX_ENV
+		filesOptions |= kXMPFiles_ServerMode;
+	#endif
+	if ( ! SXMPFiles::Initialize ( filesOptions ) ) {
+		printf ( "Could not initialize XMPFiles\n" );
+		return;
+	}
+
+	for ( int fileNum = 0; fileNum < fileCount; ++fileNum ) {
+
+		XMP_IOStats ioStats;
+		bool haveXMP = false;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for ( size_t cycle = 0; cycle < cycles; ++cycle ) {
+			SXMPFiles file;
+			SXMPMeta meta;
+			if ( ! file.OpenFile ( filePaths[fileNum], kXMP_UnknownFile, (kXMPFiles_OpenForRead | kXMPFiles_OpenUseSmartHandler) ) ) {
+				printf ( "%-8s %-32s no smart handler\n", label, filePaths[fileNum] );
+				break;
+			}
+			haveXMP = file.GetXMP ( &meta );
+			file.CloseFile();
+			file.GetIOStats ( &ioStats );	// ! Some handlers close the host file before GetXMP.
+		}
+		double micros = std::chrono::duration<double, std::micro> ( std::chrono::steady_clock::now() - start ).count();
+		if ( ioStats.hostReads + ioStats.savedReads == 0 ) continue;	// The open failed.
+
+		printf ( "%-8s %-32s %9.1f us/file, %5u host reads, %5u saved reads, %5u host seeks%s\n",
+				 label, filePaths[fileNum], micros / cycles, ioStats.hostReads, ioStats.savedReads,
+				 ioStats.hostSeeks, (haveXMP ? "" : ", no XMP") );
+
+	}
+
+	SXMPFiles::Terminate();
+
+}	// MeasureMode
+
+// =================================================================================================
+
+extern "C" int
+main ( int argc, const char * argv [] )
+{
+
+	size_t cycles = (argc > 1) ? (size_t) atoi ( argv[1] ) : 0;
+	if ( (cycles == 0) || (argc < 3) ) {
+		printf ( "usage: ReadPerformance cycles file ...\n" );
+		return 0;
+	}
+
+	if ( ! SXMPMeta::Initialize() ) {
+		printf ( "Could not initialize the toolkit\n" );
+		return 1;
+	}
+
+	try {
+		MeasureMode ( "buffered", 0, argc - 2, argv + 2, cycles );
+		MeasureMode ( "mapped", kXMPFiles_MapReadOnlyFiles, argc - 2, argv + 2, cycles );
+	} catch ( XMP_Error & excep ) {
+		printf ( "Caught XMP_Error %d : %s\n", excep.GetID(), excep.GetErrMsg() );
+	}
+
+	SXMPMeta::Terminate();
+	return 0;
+
+}
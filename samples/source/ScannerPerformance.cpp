@@ -0,0 +1,112 @@
+// =================================================================================================
+// Copyright Adobe
+// All Rights Reserved.
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+/**
+* Measures the throughput of the XMP packet scanner. Each file is read in large blocks and fed to an
+* XMPScanner, only the time spent in XMPScanner::Scan is counted. The number of packets found and
+* the scan rate in GB/s are printed for each file and for the whole run.
+*/
+
+#include <cstdio>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <chrono>
+
+#include <cstdlib>
+
+#if XMP_WinBuild
+	#pragma warning ( disable : 4127 )	// conditional expression is constant
+	#pragma warning ( disable : 4996 )	// '...' was declared deprecated
+	#define fseeko _fseeki64
+	#define ftello _ftelli64
+#endif
+
+#include "public/include/XMP_Environment.h"
+#include "public/include/XMP_Const.h"
+
+#include "XMPFiles/source/FormatSupport/XMPScanner.hpp"
+#include "XMPFiles/source/FormatSupport/XMPScanner.cpp"
+
+using namespace std;
+
+static const size_t kBlockSize = 16*1024*1024;
+
+static XMP_Int64 sTotalBytes = 0;
+static double    sTotalSeconds = 0.0;
+
+// =================================================================================================
+
+static bool
+ProcessFile ( const char * fileName, std::vector<char> & buffer )
+{
+	FILE * inFile = fopen ( fileName, "rb" );
+	if ( inFile == 0 ) {
+		printf ( "Can't open \"%s\"\n", fileName );
+		return false;
+	}
+
+	fseeko ( inFile, 0, SEEK_END );
+	XMP_Int64 fileLen = ftello ( inFile );
+	fseeko ( inFile, 0, SEEK_SET );
+
+	XMPScanner scanner ( fileLen );
+	double seconds = 0.0;
+	XMP_Int64 filePos = 0;
+
+	while ( true ) {
+		size_t readCount = fread ( &buffer[0], 1, buffer.size(), inFile );
+		if ( readCount == 0 ) break;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		scanner.Scan ( &buffer[0], filePos, readCount );
+		seconds += std::chrono::duration<double> ( std::chrono::steady_clock::now() - start ).count();
+		filePos += readCount;
+	}
+
+	fclose ( inFile );
+
+	XMPScanner::SnipInfoVector snips ( scanner.GetSnipCount() );
+	scanner.Report ( snips );
+
+	size_t packetCount = 0;
+	for ( size_t s = 0; s < snips.size(); ++s ) {
+		if ( snips[s].fState == XMPScanner::eValidPacketSnip ) ++packetCount;
+	}
+
+	double rate = (seconds > 0.0) ? ((double)filePos / seconds / 1.0e9) : 0.0;
+	printf ( "%s: %lld bytes, %zu packets, %.3f s, %.2f GB/s\n",
+			 fileName, (long long)filePos, packetCount, seconds, rate );
+
+	sTotalBytes += filePos;
+	sTotalSeconds += seconds;
+	return true;
+
+}	// ProcessFile
+
+// =================================================================================================
+
+extern "C" int
+main ( int argc, const char * argv [] )
+{
+
+	if ( argc < 2 ) {
+		printf ( "usage: ScannerPerformance (filename)...\n" );
+		return 0;
+	}
+
+	std::vector<char> buffer ( kBlockSize );
+	for ( int i = 1; i < argc; ++i ) ProcessFile ( argv[i], buffer );
+
+	if ( argc > 2 ) {
+		double rate = (sTotalSeconds > 0.0) ? ((double)sTotalBytes / sTotalSeconds / 1.0e9) : 0.0;
+		printf ( "Total: %lld bytes, %.3f s, %.2f GB/s\n", (long long)sTotalBytes, sTotalSeconds, rate );
+	}
+
+	return 0;
+
+}
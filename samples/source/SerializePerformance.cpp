@@ -0,0 +1,163 @@
+// =================================================================================================
+// Copyright Adobe
+// All Rights Reserved.
+//
+// NOTICE:  Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+/**
+* Measures the serialize and parse throughput of XMPCore on packets dominated by large text values.
+* Three packets are built: a long dc:description with escaped characters and line breaks, an
+* xmpMM:History with thousands of events, and a photoshop:DocumentAncestors array with thousands
+* of document IDs. Each is serialized in the pretty and compact forms, then parsed back. The rate
+* in MB/s of serialized packet is printed for each step. Last the compact binary form is written
+* and loaded, its load rate is in MB/s of the compact RDF so that it compares with the parse rate.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+
+#define TXMP_STRING_TYPE std::string
+#include "public/include/XMP.incl_cpp"
+#include "public/include/XMP.hpp"
+
+using namespace std;
+
+static const size_t kDescriptionSize = 4*1024*1024;
+static const size_t kHistoryCount    = 5000;
+static const size_t kAncestorCount   = 20000;
+
+// =================================================================================================
+
+static void
+BuildDescription ( SXMPMeta * meta )
+{
+	static const char * kParagraph = "The quick brown fox jumps over the lazy dog near the river bank, "
+									 "while the photographer waits for the evening light to settle over "
+									 "the hills. The second frame of the series was taken a few minutes "
+									 "later from the old bridge, looking back towards the village and "
+									 "the church tower. Caption for \"Fox & Dog <Final>\".\n";
+	string text;
+	text.reserve ( kDescriptionSize + 400 );
+	while ( text.size() < kDescriptionSize ) text += kParagraph;
+	meta->SetLocalizedText ( kXMP_NS_DC, "description", "", "x-default", text );
+}	// BuildDescription
+
+// =================================================================================================
+
+static void
+BuildHistory ( SXMPMeta * meta )
+{
+	char buffer [100];
+	for ( size_t i = 1; i <= kHistoryCount; ++i ) {
+		meta->AppendArrayItem ( kXMP_NS_XMP_MM, "History", kXMP_PropArrayIsOrdered, 0, kXMP_PropValueIsStruct );
+		string itemPath;
+		SXMPUtils::ComposeArrayItemPath ( kXMP_NS_XMP_MM, "History", kXMP_ArrayLastItem, &itemPath );
+		meta->SetStructField ( kXMP_NS_XMP_MM, itemPath.c_str(), kXMP_NS_XMP_ResourceEvent, "action", "saved" );
+		snprintf ( buffer, sizeof(buffer), "xmp.iid:%08X-0F1E-2D3C-4B5A-69788796A5B4", (unsigned int)i );
+		meta->SetStructField ( kXMP_NS_XMP_MM, itemPath.c_str(), kXMP_NS_XMP_ResourceEvent, "instanceID", buffer );
+		snprintf ( buffer, sizeof(buffer), "2026-01-%02u:%02u:%02u+01:00", (unsigned int)(1 + i%28), (unsigned int)(i%24), (unsigned int)(i%60) );
+		meta->SetStructField ( kXMP_NS_XMP_MM, itemPath.c_str(), kXMP_NS_XMP_ResourceEvent, "when", buffer );
+		meta->SetStructField ( kXMP_NS_XMP_MM, itemPath.c_str(), kXMP_NS_XMP_ResourceEvent, "softwareAgent", "Adobe Photoshop 27.0 (Macintosh)" );
+		meta->SetStructField ( kXMP_NS_XMP_MM, itemPath.c_str(), kXMP_NS_XMP_ResourceEvent, "changed", "/" );
+	}
+}	// BuildHistory
+
+// =================================================================================================
+
+static void
+BuildAncestors ( SXMPMeta * meta )
+{
+	char buffer [100];
+	for ( size_t i = 1; i <= kAncestorCount; ++i ) {
+		snprintf ( buffer, sizeof(buffer), "xmp.did:%08X-1A2B-3C4D-5E6F-7A8B9CADBECF", (unsigned int)i );
+		meta->AppendArrayItem ( kXMP_NS_Photoshop, "DocumentAncestors", kXMP_PropArrayIsUnordered, buffer );
+	}
+}	// BuildAncestors
+
+// =================================================================================================
+
+static double
+RateMBs ( size_t bytes, size_t cycles, std::chrono::steady_clock::time_point start )
+{
+	double seconds = std::chrono::duration<double> ( std::chrono::steady_clock::now() - start ).count();
+	return (seconds > 0.0) ? ((double)bytes * cycles / seconds / 1.0e6) : 0.0;
+}	// RateMBs
+
+// =================================================================================================
+
+static void
+MeasurePacket ( const char * label, const SXMPMeta & meta, size_t cycles )
+{
+	string packet;
+	std::chrono::steady_clock::time_point start;
+
+	start = std::chrono::steady_clock::now();
+	for ( size_t i = 0; i < cycles; ++i ) meta.SerializeToBuffer ( &packet, kXMP_OmitPacketWrapper );
+	double prettyRate = RateMBs ( packet.size(), cycles, start );
+	const size_t prettySize = packet.size();
+
+	start = std::chrono::steady_clock::now();
+	for ( size_t i = 0; i < cycles; ++i ) meta.SerializeToBuffer ( &packet, (kXMP_OmitPacketWrapper | kXMP_UseCompactFormat) );
+	double compactRate = RateMBs ( packet.size(), cycles, start );
+
+	start = std::chrono::steady_clock::now();
+	for ( size_t i = 0; i < cycles; ++i ) {
+		SXMPMeta parsed ( packet.c_str(), (XMP_StringLen)packet.size() );
+	}
+	double parseRate = RateMBs ( packet.size(), cycles, start );
+
+	string binary;
+	meta.SerializeToBuffer ( &binary, kXMP_SerializeBinary );
+	start = std::chrono::steady_clock::now();
+	for ( size_t i = 0; i < cycles; ++i ) {
+		SXMPMeta loaded;
+		loaded.ParseFromBuffer ( binary.data(), (XMP_StringLen)binary.size(), kXMP_ParseBinary );
+	}
+	double binaryRate = RateMBs ( packet.size(), cycles, start );
+
+	printf ( "%-18s %8zu bytes, serialize %7.1f MB/s, compact %7.1f MB/s, parse %7.1f MB/s, binary load %7.1f MB/s\n",
+			 label, prettySize, prettyRate, compactRate, parseRate, binaryRate );
+
+}	// MeasurePacket
+
+// =================================================================================================
+
+extern "C" int
+main ( int argc, const char * argv [] )
+{
+
+	size_t cycles = 20;
+	if ( argc > 1 ) cycles = (size_t) atoi ( argv[1] );
+	if ( cycles == 0 ) {
+		printf ( "usage: SerializePerformance [cycles]\n" );
+		return 0;
+	}
+
+	if ( ! SXMPMeta::Initialize() ) {
+		printf ( "Could not initialize the toolkit\n" );
+		return 1;
+	}
+
+	try {
+
+		SXMPMeta description, history, ancestors;
+		BuildDescription ( &description );
+		BuildHistory ( &history );
+		BuildAncestors ( &ancestors );
+
+		MeasurePacket ( "Description", description, cycles );
+		MeasurePacket ( "History", history, cycles );
+		MeasurePacket ( "DocumentAncestors", ancestors, cycles );
+
+	} catch ( XMP_Error & excep ) {
+		printf ( "Caught XMP_Error %d : %s\n", excep.GetID(), excep.GetErrMsg() );
+	}
+
+	SXMPMeta::Terminate();
+	return 0;
+
+}
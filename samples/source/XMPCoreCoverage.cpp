@@ -1122,6 +1122,42 @@ static void DoXMPCoreCoverage ( FILE * log )
 
 	}
 
+	{
+		WriteMajorLabel ( log, "Test the compact binary form" );
+
+		const char * rdfSamples[] = { kRDFCoverage, kSimpleRDF, kNamespaceRDF, kXMPMetaRDF, kNewlineRDF, kDateTimeRDF };
+		const char * rdfNames[] = { "kRDFCoverage", "kSimpleRDF", "kNamespaceRDF", "kXMPMetaRDF", "kNewlineRDF", "kDateTimeRDF" };
+
+		for ( size_t sampleNum = 0; sampleNum < sizeof(rdfSamples)/sizeof(rdfSamples[0]); ++sampleNum ) {
+
+			SXMPMeta meta ( rdfSamples[sampleNum], strlen(rdfSamples[sampleNum]) );
+			std::string binary;
+			meta.SerializeToBuffer ( &binary, kXMP_SerializeBinary );
+
+			SXMPMeta meta2;
+			meta2.ParseFromBuffer ( binary.data(), (XMP_StringLen)binary.size(), kXMP_ParseBinary );
+
+			tmpStr1.erase();
+			tmpStr2.erase();
+			meta.SerializeToBuffer ( &tmpStr1, kXMP_OmitPacketWrapper );
+			meta2.SerializeToBuffer ( &tmpStr2, kXMP_OmitPacketWrapper );
+			fprintf ( log, "%s: %zd bytes of RDF, %zd bytes binary\n", rdfNames[sampleNum], tmpStr1.size(), binary.size() );
+			if ( tmpStr1 != tmpStr2 ) fprintf ( log, "** Binary round trip of %s differs **\n", rdfNames[sampleNum] );
+
+		}
+
+		try {
+			SXMPMeta meta;
+			meta.ParseFromBuffer ( kSimpleRDF, strlen(kSimpleRDF), kXMP_ParseBinary );
+			fprintf ( log, "#ERROR: No exception for RDF parsed as binary\n" );
+		} catch ( XMP_Error & excep ) {
+			fprintf ( log, "RDF parsed as binary - threw XMP_Error #%d : %s\n", excep.GetID(), excep.GetErrMsg() );
+		} catch ( ... ) {
+			fprintf ( log, "RDF parsed as binary - threw unknown exception\n" );
+		}
+
+	}
+
 	// --------------------------------------------------------------------------------------------
 	// Iteration methods
 	// -----------------
@@ -19,6 +19,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
@@ -26,6 +27,22 @@
 	#include <limits.h>
 #endif
 
+#if XMP_UNIXBuild && defined(__linux__)
+	#define HostCopyFileRange 1	// Linux has FICLONERANGE, copy_file_range, and file to file sendfile.
+	#include <sys/ioctl.h>
+	#include <sys/sendfile.h>
+	#include <sys/syscall.h>
+	#include <sys/vfs.h>
+	#include <linux/fs.h>
+#else
+	#define HostCopyFileRange 0
+#endif
+
+#if XMP_MacBuild | XMP_iOSBuild
+	#include <sys/param.h>
+	#include <sys/mount.h>
+#endif
+
 // =================================================================================================
 // Host_IO implementations for POSIX
 // =================================
@@ -161,6 +178,35 @@ bool Host_IO::GetModifyDate ( const char* filePath, XMP_DateTime* modifyDate )
 
 }	// Host_IO::GetModifyDate
 
+// =================================================================================================
+// Host_IO::GetFileIdentity
+// ========================
+
+bool Host_IO::GetFileIdentity ( const char* filePath, Host_IO::FileIdentity* identity )
+{
+	struct stat info;
+	int err = stat ( filePath, &info );
+	if ( (err != 0) || (! S_ISREG(info.st_mode)) ) return false;
+
+	identity->deviceID = (XMP_Uns64) info.st_dev;
+	identity->fileID = (XMP_Uns64) info.st_ino;
+	identity->length = (XMP_Int64) info.st_size;
+	identity->modifySeconds = (XMP_Int64) info.st_mtime;
+	#if XMP_MacBuild | XMP_iOSBuild
+		identity->modifyNanoseconds = (XMP_Int64) info.st_mtimespec.tv_nsec;
+	#else
+		identity->modifyNanoseconds = (XMP_Int64) info.st_mtim.tv_nsec;
+	#endif
+	identity->changeSeconds = (XMP_Int64) info.st_ctime;
+	#if XMP_MacBuild | XMP_iOSBuild
+		identity->changeNanoseconds = (XMP_Int64) info.st_ctimespec.tv_nsec;
+	#else
+		identity->changeNanoseconds = (XMP_Int64) info.st_ctim.tv_nsec;
+	#endif
+	return true;
+
+}	// Host_IO::GetFileIdentity
+
 // =================================================================================================
 // ConjureDerivedPath
 // ==================
@@ -287,6 +333,17 @@ void Host_IO::Rename ( const char* oldPath, const char* newPath )
 
 }	// Host_IO::Rename
 
+// =================================================================================================
+// Host_IO::Replace
+// ================
+
+void Host_IO::Replace ( const char* oldPath, const char* newPath )
+{
+	int err = rename ( oldPath, newPath );	// ! POSIX rename replaces the new path atomically.
+	if ( err != 0 ) XMP_Throw ( "Host_IO::Replace, rename failure", kXMPErr_ExternalFailure );
+
+}	// Host_IO::Replace
+
 // =================================================================================================
 // Host_IO::Delete
 // ===============
@@ -409,6 +466,186 @@ void Host_IO::SetEOF ( Host_IO::FileRef refNum, XMP_Int64 length )
 
 }	// Host_IO::SetEOF
 
+// =================================================================================================
+// Host_IO::CopyRange
+// ==================
+//
+// The copy_file_range wrapper is only in glibc 2.27 and later, and not in every other C library.
+// Where configure did not find it the system call is made directly. If the headers don't know the
+// call either, it fails with ENOSYS like an old kernel would and the copy goes to sendfile.
+
+#if HostCopyFileRange
+
+static ssize_t CopyFileRange ( int source, off64_t * sourceOffset, int dest, off64_t * destOffset, size_t count )
+{
+	#if HAVE_COPY_FILE_RANGE
+		return copy_file_range ( source, sourceOffset, dest, destOffset, count, 0 );
+	#elif defined(__NR_copy_file_range)
+		return syscall ( __NR_copy_file_range, source, sourceOffset, dest, destOffset, count, 0 );
+	#else
+		IgnoreParam ( source ); IgnoreParam ( sourceOffset );
+		IgnoreParam ( dest ); IgnoreParam ( destOffset ); IgnoreParam ( count );
+		errno = ENOSYS;
+		return -1;
+	#endif
+}	// CopyFileRange
+
+#endif
+
+XMP_Int64 Host_IO::CopyRange ( Host_IO::FileRef source, XMP_Int64 sourceOffset,
+							   Host_IO::FileRef dest, XMP_Int64 destOffset, XMP_Int64 length )
+{
+	#if ! HostCopyFileRange
+
+		IgnoreParam ( source ); IgnoreParam ( sourceOffset );
+		IgnoreParam ( dest ); IgnoreParam ( destOffset ); IgnoreParam ( length );
+		return 0;
+
+	#else
+
+		if ( length <= 0 ) return 0;
+
+		#ifdef FICLONERANGE
+		{
+			// Share the data blocks if the file system can. This needs block aligned offsets, and a
+			// block aligned length unless the range ends at the source EOF. Otherwise just try the
+			// copy, which some file systems also turn into sharing.
+			struct stat sourceInfo, destInfo;
+			if ( (fstat ( source, &sourceInfo ) == 0) && (fstat ( dest, &destInfo ) == 0) ) {
+				const XMP_Int64 blockSize = destInfo.st_blksize;
+				if ( (blockSize > 0) && ((sourceOffset % blockSize) == 0) && ((destOffset % blockSize) == 0) &&
+					 (((length % blockSize) == 0) || ((sourceOffset + length) == sourceInfo.st_size)) ) {
+					struct file_clone_range cloneRange;
+					cloneRange.src_fd = source;
+					cloneRange.src_offset = sourceOffset;
+					cloneRange.src_length = length;
+					cloneRange.dest_offset = destOffset;
+					if ( ioctl ( dest, FICLONERANGE, &cloneRange ) == 0 ) return length;
+				}
+			}
+		}
+		#endif
+
+		const size_t kMaxIOCount = TwoGB / 2;
+		off64_t inOffset  = sourceOffset;
+		off64_t outOffset = destOffset;
+		XMP_Int64 copied = 0;
+		int osCode = 0;
+
+		while ( copied < length ) {
+			size_t ioCount = kMaxIOCount;
+			if ( (length - copied) < (XMP_Int64)ioCount ) ioCount = (size_t) (length - copied);
+			ssize_t result = CopyFileRange ( source, &inOffset, dest, &outOffset, ioCount );
+			if ( result <= 0 ) {
+				if ( result < 0 ) osCode = errno;
+				break;
+			}
+			copied += result;
+		}
+
+		if ( (copied == 0) && ((osCode == EXDEV) || (osCode == ENOSYS) || (osCode == EOPNOTSUPP)) ) {
+
+			// An older kernel or different file systems, sendfile still avoids the user space copy.
+			// It writes at the destination's I/O position, which is put back afterwards.
+
+			off_t destPos = lseek ( dest, 0, SEEK_CUR );
+			if ( (destPos == -1) || (lseek ( dest, destOffset, SEEK_SET ) == -1) ) return 0;
+
+			off_t sendOffset = sourceOffset;
+			while ( copied < length ) {
+				size_t ioCount = kMaxIOCount;
+				if ( (length - copied) < (XMP_Int64)ioCount ) ioCount = (size_t) (length - copied);
+				ssize_t result = sendfile ( dest, source, &sendOffset, ioCount );
+				if ( result <= 0 ) break;
+				copied += result;
+			}
+
+			(void) lseek ( dest, destPos, SEEK_SET );
+
+		}
+
+		return copied;
+
+	#endif
+
+}	// Host_IO::CopyRange
+
+// =================================================================================================
+// Host_IO::MapReadOnly
+// ====================
+
+const void* Host_IO::MapReadOnly ( Host_IO::FileRef refNum, XMP_Int64 length )
+{
+	if ( (length <= 0) || ((XMP_Uns64)length > (XMP_Uns64)(size_t)(-1)) ) return 0;
+
+	void * mapping = mmap ( 0, (size_t)length, PROT_READ, MAP_PRIVATE, refNum, 0 );
+	if ( mapping == MAP_FAILED ) return 0;
+
+	#if ! XMP_AndroidBuild
+		(void) posix_madvise ( mapping, (size_t)length, POSIX_MADV_WILLNEED );	// Only a hint, ignore failures.
+	#endif
+	return mapping;
+
+}	// Host_IO::MapReadOnly
+
+// =================================================================================================
+// Host_IO::Unmap
+// ==============
+
+void Host_IO::Unmap ( const void* mapping, XMP_Int64 length )
+{
+	if ( mapping != 0 ) (void) munmap ( (void*)mapping, (size_t)length );
+
+}	// Host_IO::Unmap
+
+// =================================================================================================
+// Host_IO::IsLocalFile
+// ====================
+//
+// Linux has no "local" flag, the file systems that can lose their backing store while a file is
+// open are recognized by their magic numbers. Anything else on Linux, and everything on the other
+// UNIX systems, is taken as remote.
+
+bool Host_IO::IsLocalFile ( Host_IO::FileRef refNum )
+{
+
+	#if XMP_MacBuild | XMP_iOSBuild
+
+		struct statfs fsInfo;
+		if ( fstatfs ( refNum, &fsInfo ) != 0 ) return false;
+		return ((fsInfo.f_flags & MNT_LOCAL) != 0);
+
+	#elif XMP_UNIXBuild && defined(__linux__)
+
+		struct statfs fsInfo;
+		if ( fstatfs ( refNum, &fsInfo ) != 0 ) return false;
+
+		switch ( (XMP_Uns32)fsInfo.f_type ) {
+			case 0x00006969UL :	// NFS
+			case 0x0000517BUL :	// SMB
+			case 0xFF534D42UL :	// CIFS
+			case 0xFE534D42UL :	// SMB2
+			case 0x65735546UL :	// FUSE
+			case 0x01021997UL :	// 9P
+			case 0x00C36400UL :	// Ceph
+			case 0x5346414FUL :	// AFS
+			case 0x73757245UL :	// Coda
+			case 0x47504653UL :	// GPFS
+			case 0x0BD00BD0UL :	// Lustre
+				return false;
+			default :
+				return true;
+		}
+
+	#else
+
+		(void) refNum;
+		return false;
+
+	#endif
+
+}	// Host_IO::IsLocalFile
+
 // =================================================================================================
 // =====================================   Folder operations   =====================================
 // =================================================================================================
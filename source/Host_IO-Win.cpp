@@ -203,6 +203,41 @@ bool Host_IO::GetModifyDate ( const char* filePath, XMP_DateTime * modifyDate )
 
 }	// Host_IO::GetModifyDate
 
+// =================================================================================================
+// Host_IO::GetFileIdentity
+// ========================
+
+bool Host_IO::GetFileIdentity ( const char* filePath, Host_IO::FileIdentity* identity )
+{
+	Host_IO::FileRef fileHandle;
+
+	try {
+		if ( Host_IO::GetFileMode ( filePath ) != Host_IO::kFMode_IsFile ) return false;
+		fileHandle = Host_IO::Open ( filePath, Host_IO::openReadOnly );
+		if ( fileHandle == Host_IO::noFileRef ) return false;
+	} catch ( ... ) {
+		return false;
+	}
+
+	BY_HANDLE_FILE_INFORMATION info;
+	FILE_BASIC_INFO basicInfo;	// ! Only this one has the change time.
+	BOOL ok = GetFileInformationByHandle ( fileHandle, &info ) &&
+			  GetFileInformationByHandleEx ( fileHandle, FileBasicInfo, &basicInfo, sizeof(basicInfo) );
+	try { Host_IO::Close ( fileHandle ); } catch ( ... ) { /* Do nothing, the information is read. */ }
+	if ( ! ok ) return false;
+
+	XMP_Int64 modifyTime = ((XMP_Int64)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+	identity->deviceID = info.dwVolumeSerialNumber;
+	identity->fileID = ((XMP_Uns64)info.nFileIndexHigh << 32) | info.nFileIndexLow;
+	identity->length = ((XMP_Int64)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+	identity->modifySeconds = modifyTime / 10000000;	// FILETIME counts 100 ns units.
+	identity->modifyNanoseconds = (modifyTime % 10000000) * 100;
+	identity->changeSeconds = basicInfo.ChangeTime.QuadPart / 10000000;
+	identity->changeNanoseconds = (basicInfo.ChangeTime.QuadPart % 10000000) * 100;
+	return true;
+
+}	// Host_IO::GetFileIdentity
+
 // =================================================================================================
 // ConjureDerivedPath
 // ==================
@@ -325,6 +360,24 @@ void Host_IO::Rename ( const char* oldPath, const char* newPath )
 #endif
 }	// Host_IO::Rename
 
+// =================================================================================================
+// Host_IO::Replace
+// ================
+
+void Host_IO::Replace ( const char* oldPath, const char* newPath )
+{
+	std::string wideOldPath, wideNewPath;
+	if ( !GetWidePath ( oldPath, wideOldPath ) || wideOldPath.length() == 0 )
+		XMP_Throw ( "Host_IO::Replace, GetWidePath failure", kXMPErr_ExternalFailure );
+
+	if ( !GetWidePath ( newPath, wideNewPath ) || wideNewPath.length() == 0 )
+		XMP_Throw ( "Host_IO::Replace, GetWidePath failure", kXMPErr_ExternalFailure );
+
+	BOOL ok = MoveFileExW ( (LPCWSTR)wideOldPath.data(), (LPCWSTR)wideNewPath.data(), MOVEFILE_REPLACE_EXISTING );
+	if ( ! ok ) XMP_Throw ( "Host_IO::Replace, MoveFileExW failure", kXMPErr_ExternalFailure );
+
+}	// Host_IO::Replace
+
 // =================================================================================================
 // Host_IO::Delete
 // ===============
@@ -450,6 +503,61 @@ void Host_IO::SetEOF ( Host_IO::FileRef fileHandle, XMP_Int64 length )
 
 }	// Host_IO::SetEOF
 
+// =================================================================================================
+// Host_IO::CopyRange
+// ==================
+//
+// Block cloning on Windows needs cluster aligned offsets, which the callers can't arrange. They
+// copy through memory instead.
+
+XMP_Int64 Host_IO::CopyRange ( Host_IO::FileRef /* source */, XMP_Int64 /* sourceOffset */,
+							   Host_IO::FileRef /* dest */, XMP_Int64 /* destOffset */, XMP_Int64 /* length */ )
+{
+	return 0;
+
+}	// Host_IO::CopyRange
+
+// =================================================================================================
+// Host_IO::MapReadOnly
+// ====================
+
+const void* Host_IO::MapReadOnly ( Host_IO::FileRef fileHandle, XMP_Int64 length )
+{
+	if ( (length <= 0) || ((XMP_Uns64)length > (XMP_Uns64)(SIZE_T)(-1)) ) return 0;
+
+	HANDLE mapHandle = CreateFileMappingW ( fileHandle, 0, PAGE_READONLY, 0, 0, 0 );
+	if ( mapHandle == 0 ) return 0;
+
+	const void * mapping = MapViewOfFile ( mapHandle, FILE_MAP_READ, 0, 0, (SIZE_T)length );
+	CloseHandle ( mapHandle );	// ! The view keeps the mapping object alive.
+	return mapping;
+
+}	// Host_IO::MapReadOnly
+
+// =================================================================================================
+// Host_IO::Unmap
+// ==============
+
+void Host_IO::Unmap ( const void* mapping, XMP_Int64 /* length */ )
+{
+	if ( mapping != 0 ) (void) UnmapViewOfFile ( mapping );
+
+}	// Host_IO::Unmap
+
+// =================================================================================================
+// Host_IO::IsLocalFile
+// ====================
+//
+// FileRemoteProtocolInfo is only available for files opened through a network redirector.
+
+bool Host_IO::IsLocalFile ( Host_IO::FileRef fileHandle )
+{
+	FILE_REMOTE_PROTOCOL_INFO protocolInfo;
+	if ( GetFileInformationByHandleEx ( fileHandle, FileRemoteProtocolInfo, &protocolInfo, sizeof(protocolInfo) ) ) return false;
+	return (GetLastError() == ERROR_INVALID_PARAMETER);
+
+}	// Host_IO::IsLocalFile
+
 // =================================================================================================
 // Folder operations
 // =================================================================================================
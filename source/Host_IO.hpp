@@ -54,6 +54,12 @@ namespace Host_IO {
 	// GetModifyDate - Return the file system modification date. Returns false if the file or folder
 	// does not exist.
 	//
+	// GetFileIdentity - Return what identifies a file and the state of its contents: the device and
+	// file ID, the length, and the modification and status change times to the host's finest
+	// resolution. The change time can't be set back by the writer, so it catches an update that
+	// keeps the length and restores the modification time. Returns false if the path is not a file
+	// or the host can't tell. Never throws an exception.
+	//
 	// CreateTemp - Create a (presumably) temporary file related to some other file. The source
 	// file path is passed in, a derived name is selected in the same folder. The source file need
 	// not exist, but all folders in the path must exist. The derived name is guaranteed to not
@@ -77,6 +83,9 @@ namespace Host_IO {
 	// Rename - Rename a file or folder. The new path must not exist. Throws an XMP_Error exception
 	// for any errors.
 	//
+	// Replace - Rename a file over another, in one step where the host allows it. The new path
+	// need not exist, a file there is replaced. Throws an XMP_Error exception for any errors.
+	//
 	// Delete - Deletes a file or folder. Does nothing if the path does not exist. Throws an
 	// XMP_Error exception for any errors.
 	//
@@ -95,6 +104,25 @@ namespace Host_IO {
 	//
 	// SetEOF - Sets a new EOF offset. The I/O position may be changed. Throws an XMP_Error
 	// exception for any errors.
+	//
+	// CopyRange - Copy length bytes from one open file to another inside the host file system,
+	// without passing them through memory. Returns the number of bytes copied, which is less than
+	// length if the host has no such service, if the files don't allow it, or if an error stops the
+	// copy. The caller copies the rest itself. The I/O positions are not changed. Never throws an
+	// exception. The host may share the data blocks between the files instead of copying them. The
+	// files may be the same one if the ranges don't overlap.
+	//
+	// MapReadOnly - Map the first length bytes of an open file into memory for reading. Returns 0
+	// if the host can't map the file, the caller must then fall back to Read. The I/O position is
+	// not changed. Never throws an exception. The mapping stays valid after the file is closed.
+	//
+	// Unmap - Release a mapping made by MapReadOnly, passing the same length. Never throws an
+	// exception.
+	//
+	// IsLocalFile - True if the open file is on a local volume. Pages of a mapped file on a network
+	// or user space file system can fail to load when the server goes away, which shows up as a
+	// signal or exception at an arbitrary read instead of an error from Read. Returns false if the
+	// host can't tell. Never throws an exception.
 
 	#if XMP_WinBuild
 		typedef HANDLE FileRef;
@@ -117,6 +145,27 @@ namespace Host_IO {
 	
 	bool GetModifyDate ( const char* filePath, XMP_DateTime* modifyDate );
 
+	struct FileIdentity {
+		XMP_Uns64 deviceID;
+		XMP_Uns64 fileID;
+		XMP_Int64 length;
+		XMP_Int64 modifySeconds;
+		XMP_Int64 modifyNanoseconds;
+		XMP_Int64 changeSeconds;
+		XMP_Int64 changeNanoseconds;
+		FileIdentity() : deviceID(0), fileID(0), length(0), modifySeconds(0), modifyNanoseconds(0),
+						 changeSeconds(0), changeNanoseconds(0) {};
+		bool operator== ( const FileIdentity & other ) const {
+			return (this->deviceID == other.deviceID) && (this->fileID == other.fileID) &&
+				   (this->length == other.length) && (this->modifySeconds == other.modifySeconds) &&
+				   (this->modifyNanoseconds == other.modifyNanoseconds) &&
+				   (this->changeSeconds == other.changeSeconds) && (this->changeNanoseconds == other.changeNanoseconds);
+		};
+		bool operator!= ( const FileIdentity & other ) const { return ! (*this == other); };
+	};
+
+	bool GetFileIdentity ( const char* filePath, FileIdentity* identity );
+
 	std::string CreateTemp ( const char* sourcePath );
 
 	enum { openReadOnly = true, openReadWrite = false };
@@ -126,6 +175,7 @@ namespace Host_IO {
 
 	void    SwapData ( const char* sourcePath, const char* destPath );
 	void	Rename   ( const char* oldPath, const char* newPath );
+	void	Replace  ( const char* oldPath, const char* newPath );
 	void	Delete   ( const char* filePath );
 
 	XMP_Int64	Seek     ( FileRef file, XMP_Int64 offset, SeekMode mode );
@@ -134,6 +184,13 @@ namespace Host_IO {
 	XMP_Int64	Length   ( FileRef file );
 	void		SetEOF   ( FileRef file, XMP_Int64 length );
 
+	XMP_Int64	CopyRange ( FileRef source, XMP_Int64 sourceOffset,
+							FileRef dest, XMP_Int64 destOffset, XMP_Int64 length );
+
+	const void*	MapReadOnly ( FileRef file, XMP_Int64 length );
+	void		Unmap       ( const void* mapping, XMP_Int64 length );
+	bool		IsLocalFile ( FileRef file );
+
 	inline XMP_Int64 Offset ( FileRef file ) { return Host_IO::Seek ( file, 0, kXMP_SeekFromCurrent ); };
 	inline XMP_Int64 Rewind ( FileRef file ) { return Host_IO::Seek ( file, 0, kXMP_SeekFromStart ); };	// Always returns 0.
 	inline XMP_Int64 ToEOF  ( FileRef file ) { return Host_IO::Seek ( file, 0, kXMP_SeekFromEnd ); };
@@ -0,0 +1,52 @@
+#ifndef __SSE2Utils_hpp__
+#define __SSE2Utils_hpp__ 1
+
+// =================================================================================================
+// Copyright Adobe
+// All Rights Reserved
+//
+// NOTICE: Adobe permits you to use, modify, and distribute this file in accordance with the terms
+// of the Adobe license agreement accompanying it.
+// =================================================================================================
+
+#include "public/include/XMP_Environment.h"	// ! This must be the first include.
+
+// =================================================================================================
+// XMP_UseSSE2 is 1 when the compiler targets SSE2, which is always true for x86-64. The byte
+// scanners of XMPCore and XMPFiles use it to pick their 16 byte block loops.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define XMP_UseSSE2 1
+	#include <emmintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+#else
+	#define XMP_UseSSE2 0
+#endif
+
+#if XMP_UseSSE2
+
+// -------------------------------------------------------------------------------------------------
+// FirstBitIndex
+// -------------
+//
+// Returns the index of the lowest set bit. The mask must not be 0, it is normally the result of
+// _mm_movemask_epi8 for a block with at least one hit.
+
+static inline int FirstBitIndex ( unsigned int mask )
+{
+	#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward ( &index, mask );
+		return (int)index;
+	#else
+		return __builtin_ctz ( mask );
+	#endif
+}
+
+#endif	// XMP_UseSSE2
+
+// =================================================================================================
+
+#endif	// __SSE2Utils_hpp__
@@ -14,8 +14,11 @@
 
 #include "source/XIO.hpp"
 #include "source/XMP_LibUtils.hpp"
+#include "source/XMPFiles_IO.hpp"
 #include "source/UnicodeConversions.hpp"
 
+#include <vector>
+
 #if XMP_WinBuild
 	#pragma warning ( disable : 4800 )	// forcing value to bool 'true' or 'false' (performance warning)
 #endif
@@ -146,6 +149,89 @@ void XIO::ReplaceTextFile ( XMP_IO* textFile, const std::string & newContent, bo
 
 }	// XIO::ReplaceTextFile
 
+// =================================================================================================
+// CopyBuffer
+// ==========
+//
+// The buffer for copies through memory. Short copies use 64K on the stack, long ones a page aligned
+// 1MB buffer, which XMPFiles_IO reads and writes directly instead of through its read buffer.
+
+enum { kSmallCopyBuffer = 64*1024, kLargeCopyBuffer = 1024*1024, kCopyBufferAlign = 4096 };
+
+class CopyBuffer {
+public:
+	XMP_Uns8 * ptr;
+	XMP_Uns32  size;
+	CopyBuffer ( XMP_Int64 length ) : ptr(smallBuffer), size(kSmallCopyBuffer)
+	{
+		if ( length <= kSmallCopyBuffer ) return;
+		try {
+			this->largeBuffer.resize ( kLargeCopyBuffer + kCopyBufferAlign );
+			size_t misalign = (size_t)&this->largeBuffer[0] & (kCopyBufferAlign - 1);
+			this->ptr = &this->largeBuffer[0] + ((misalign == 0) ? 0 : (kCopyBufferAlign - misalign));
+			this->size = kLargeCopyBuffer;
+		} catch ( ... ) {
+			// Keep using the small buffer.
+		}
+	};
+private:
+	XMP_Uns8 smallBuffer [kSmallCopyBuffer];
+	std::vector<XMP_Uns8> largeBuffer;
+};
+
+// =================================================================================================
+// CopyInHost
+// ==========
+//
+// Lets the host file system copy as much of a range as it will when both files are XMPFiles_IO,
+// see XMPFiles_IO::HostCopy. Short ranges are left to the caller, they are done with one read and
+// write anyway. The copy is done in pieces, the abortProc is checked before each. Within one file
+// a piece is no larger than the distance between the ranges so it never overlaps its destination.
+// Returns the count copied from the start of the range, or from its end if fromEnd is set. The I/O
+// positions are not changed.
+
+static XMP_Int64 CopyInHost ( XMP_IO* srcFile, XMP_Int64 srcOffset,
+							  XMP_IO* dstFile, XMP_Int64 dstOffset,
+							  XMP_Int64 length, bool fromEnd,
+							  XMP_AbortProc abortProc, void* abortArg, const char * abortMessage )
+{
+	enum { kHostCopyPiece = 16*1024*1024 };
+
+	if ( length <= kSmallCopyBuffer ) return 0;
+	XMPFiles_IO * hostSource = dynamic_cast<XMPFiles_IO*> ( srcFile );
+	XMPFiles_IO * hostDest   = dynamic_cast<XMPFiles_IO*> ( dstFile );
+	if ( (hostSource == 0) || (hostDest == 0) ) return 0;
+
+	XMP_Int64 pieceLimit = kHostCopyPiece;
+	if ( srcFile == dstFile ) {
+		XMP_Int64 distance = (srcOffset > dstOffset) ? (srcOffset - dstOffset) : (dstOffset - srcOffset);
+		if ( distance < kSmallCopyBuffer ) return 0;
+		if ( pieceLimit > distance ) pieceLimit = distance;
+	}
+
+	XMP_Int64 done = 0;
+
+	while ( done < length ) {
+
+		if ( (abortProc != 0) && abortProc ( abortArg ) ) XMP_Throw ( abortMessage, kXMPErr_UserAbort );
+
+		XMP_Int64 pieceSize = length - done;
+		if ( pieceSize > pieceLimit ) pieceSize = pieceLimit;
+		XMP_Int64 pieceOffset = fromEnd ? (length - done - pieceSize) : done;
+
+		XMP_Int64 copied = hostSource->HostCopy ( (srcOffset + pieceOffset), hostDest, (dstOffset + pieceOffset), pieceSize );
+		if ( copied < pieceSize ) {
+			if ( ! fromEnd ) done += copied;	// ! From the end a partial piece is redone by the caller.
+			break;
+		}
+		done += copied;
+
+	}
+
+	return done;
+
+}	// CopyInHost
+
 // =================================================================================================
 // XIO::Copy
 // =========
@@ -154,7 +240,18 @@ void XIO::Copy ( XMP_IO* sourceFile, XMP_IO* destFile, XMP_Int64 length,
 				 XMP_AbortProc abortProc /* = 0 */, void* abortArg /* = 0 */ )
 {
 	const bool checkAbort = (abortProc != 0);
-	XMP_Uns8 buffer [64*1024];
+
+	if ( length > kSmallCopyBuffer ) {
+		XMP_Int64 hostCopied = CopyInHost ( sourceFile, sourceFile->Offset(), destFile, destFile->Offset(),
+											length, false, abortProc, abortArg, "XIO::Copy, user abort" );
+		if ( hostCopied > 0 ) {
+			sourceFile->Seek ( hostCopied, kXMP_SeekFromCurrent );
+			destFile->Seek ( hostCopied, kXMP_SeekFromCurrent );
+			length -= hostCopied;
+		}
+	}
+
+	CopyBuffer buffer ( length );
 
 	while ( length > 0 ) {
 
@@ -162,17 +259,52 @@ void XIO::Copy ( XMP_IO* sourceFile, XMP_IO* destFile, XMP_Int64 length,
 			XMP_Throw ( "XIO::Copy, user abort", kXMPErr_UserAbort );
 		}
 
-		XMP_Int32 ioCount = sizeof(buffer);
+		XMP_Int32 ioCount = buffer.size;
 		if ( length < ioCount ) ioCount = (XMP_Int32)length;
 
-		sourceFile->Read ( buffer, ioCount, XMP_IO::kReadAll );
-		destFile->Write ( buffer, ioCount );
+		sourceFile->Read ( buffer.ptr, ioCount, XMP_IO::kReadAll );
+		destFile->Write ( buffer.ptr, ioCount );
 		length -= ioCount;
 
 	}
 
 }	// XIO::Copy
 
+// =================================================================================================
+// XIO::BorrowRange
+// ================
+
+const XMP_Uns8 * XIO::BorrowRange ( XMP_IO* file, XMP_Int64 offset, XMP_Uns32 count )
+{
+	XMPFiles_IO * hostFile = dynamic_cast<XMPFiles_IO*> ( file );
+	if ( hostFile == 0 ) return 0;
+	return hostFile->BorrowRange ( offset, count );
+
+}	// XIO::BorrowRange
+
+// =================================================================================================
+// XIO::ReadRange
+// ==============
+
+void XIO::ReadRange ( XMP_IO* file, XMP_Int64 offset, XMP_Uns32 count,
+					  std::string * dest, bool append /* = false */ )
+{
+	if ( ! append ) dest->erase();
+
+	const XMP_Uns8 * borrowed = XIO::BorrowRange ( file, offset, count );
+
+	if ( borrowed != 0 ) {
+		dest->append ( (const char*)borrowed, count );
+		file->Seek ( (offset + count), kXMP_SeekFromStart );
+	} else {
+		size_t destOffset = dest->size();
+		dest->resize ( destOffset + count );
+		file->Seek ( offset, kXMP_SeekFromStart );
+		if ( count > 0 ) file->ReadAll ( &(*dest)[destOffset], count );
+	}
+
+}	// XIO::ReadRange
+
 // =================================================================================================
 // XIO::Move
 // =========
@@ -187,25 +319,30 @@ void XIO::Move ( XMP_IO* srcFile, XMP_Int64 srcOffset,
 				 XMP_IO* dstFile, XMP_Int64 dstOffset,
 				 XMP_Int64 length, XMP_AbortProc abortProc /* = 0 */, void * abortArg /* = 0 */ )
 {
-	enum { kBufferLen = 64*1024 };
-	XMP_Uns8 buffer [kBufferLen];
-
 	const bool checkAbort = (abortProc != 0);
 
 	if ( srcOffset > dstOffset ) {	// avoiding shadow effects
 
 	// move down -> shift lowest packet first !
 
+		XMP_Int64 hostMoved = CopyInHost ( srcFile, srcOffset, dstFile, dstOffset, length, false,
+										   abortProc, abortArg, "XIO::Move - User abort" );
+		srcOffset += hostMoved;
+		dstOffset += hostMoved;
+		length -= hostMoved;
+
+		CopyBuffer buffer ( length );
+
 		while ( length > 0 ) {
 
 			if ( checkAbort && abortProc(abortArg) ) XMP_Throw ( "XIO::Move - User abort", kXMPErr_UserAbort );
-			XMP_Int32 ioCount = kBufferLen;
-			if ( length < kBufferLen ) ioCount = (XMP_Int32)length; //smartly avoids 32/64 bit issues
+			XMP_Int32 ioCount = buffer.size;
+			if ( length < ioCount ) ioCount = (XMP_Int32)length; //smartly avoids 32/64 bit issues
 
 			srcFile->Seek ( srcOffset, kXMP_SeekFromStart );
-			srcFile->ReadAll ( buffer, ioCount );
+			srcFile->ReadAll ( buffer.ptr, ioCount );
 			dstFile->Seek ( dstOffset, kXMP_SeekFromStart );
-			dstFile->Write ( buffer, ioCount );
+			dstFile->Write ( buffer.ptr, ioCount );
 			length -= ioCount;
 
 			srcOffset += ioCount;
@@ -215,22 +352,28 @@ void XIO::Move ( XMP_IO* srcFile, XMP_Int64 srcOffset,
 
 	} else {	// move up -> shift highest packet first
 
+		XMP_Int64 hostMoved = CopyInHost ( srcFile, srcOffset, dstFile, dstOffset, length, true,
+										   abortProc, abortArg, "XIO::Move - User abort" );
+		length -= hostMoved;	// The top of the range is done.
+
+		CopyBuffer buffer ( length );
+
 		srcOffset += length; //move to end
 		dstOffset += length;
 
 		while ( length > 0 ) {
 
 			if ( checkAbort && abortProc(abortArg) ) XMP_Throw ( "XIO::Move - User abort", kXMPErr_UserAbort );
-			XMP_Int32 ioCount = kBufferLen;
-			if ( length < kBufferLen ) ioCount = (XMP_Int32)length; //smartly avoids 32/64 bit issues
+			XMP_Int32 ioCount = buffer.size;
+			if ( length < ioCount ) ioCount = (XMP_Int32)length; //smartly avoids 32/64 bit issues
 
 			srcOffset -= ioCount;
 			dstOffset -= ioCount;
 
 			srcFile->Seek ( srcOffset, kXMP_SeekFromStart );
-			srcFile->ReadAll ( buffer, ioCount );
+			srcFile->ReadAll ( buffer.ptr, ioCount );
 			dstFile->Seek ( dstOffset, kXMP_SeekFromStart );
-			dstFile->Write ( buffer, ioCount );
+			dstFile->Write ( buffer.ptr, ioCount );
 			length -= ioCount;
 
 		}
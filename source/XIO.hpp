@@ -42,6 +42,17 @@ namespace XIO {
 					   XMP_IO* destFile, XMP_Int64 destOffset,
 					   XMP_Int64 length, XMP_AbortProc abortProc = 0, void* abortArg = 0 );
 
+	// BorrowRange - Direct access to count bytes at offset, for a memory mapped XMPFiles_IO. Returns
+	// 0 for any other XMP_IO or if the range is not in the file. The I/O position is not changed.
+	//
+	// ReadRange - Sets (or appends to) a string with count bytes from offset, leaving the I/O position
+	// after them. Copies once from a mapped file, otherwise reads straight into the string.
+
+	extern const XMP_Uns8 * BorrowRange ( XMP_IO* file, XMP_Int64 offset, XMP_Uns32 count );
+
+	extern void ReadRange ( XMP_IO* file, XMP_Int64 offset, XMP_Uns32 count,
+							std::string * dest, bool append = false );
+
 	static inline bool CheckFileSpace ( XMP_IO* file, XMP_Int64 length )
 	{
 		XMP_Int64 remaining = file->Length() - file->Offset();
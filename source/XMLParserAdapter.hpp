@@ -103,6 +103,22 @@ private:
 
 };
 
+// =================================================================================================
+// Optional consumer of the XML tree while it is being built. StartElement is called once an element
+// and its attributes have been added, EndElement once its content is complete. EndElement may remove
+// the element from the back of its parent's content and delete it, the adapter is done with it. The
+// sink is owned by the adapter.
+
+class XML_ElementSink {
+public:
+
+	virtual ~XML_ElementSink() {};
+
+	virtual void StartElement ( XML_Node * elemNode ) = 0;
+	virtual void EndElement   ( XML_Node * elemNode ) = 0;
+
+};
+
 // =================================================================================================
 // Abstract base class for XML parser adapters used by the XMP toolkit.
 
@@ -113,14 +129,14 @@ public:
 
 	XMLParserAdapter() : tree(0,"",kRootNode), rootNode(0), rootCount(0),
 	                     charEncoding(XMP_OptionBits(-1)), pendingCount(0),
-	                     errorCallback(0)
+	                     errorCallback(0), elementSink(0)
 	{
 		#if XMP_DebugBuild
 			parseLog = 0;
 		#endif
 	};
 
-	virtual ~XMLParserAdapter() {};
+	virtual ~XMLParserAdapter() { delete this->elementSink; };
 	
 	virtual void ParseBuffer ( const void * buffer, size_t length, bool last ) = 0;
 	
@@ -143,6 +159,7 @@ public:
 	unsigned char	pendingInput[kXMLPendingInputMax];	// Buffered input for character encoding checks.
 
 	GenericErrorCallback * errorCallback;	// Set if the relevant XMPCore or XMPFiles object has one.
+	XML_ElementSink * elementSink;			// Only set for a streaming parse.
 
 	#if XMP_DebugBuild
 		FILE * parseLog;
@@ -37,14 +37,10 @@ bool XML_Node::IsWhitespaceNode() const
 {
 	if ( this->kind != kCDataNode ) return false;
 
-	for ( size_t i = 0; i < this->value.size(); ++i ) {
-		unsigned char ch = this->value[i];
-		if ( IsWhitespaceChar ( ch ) ) continue;
-		// *** Add checks for other whitespace characters.
-		return false;	// All the checks failed, this isn't whitespace.
-	}
-
-	return true;
+	// *** Add checks for other whitespace characters.
+	const XMP_Uns8 * valueStart = (const XMP_Uns8 *) this->value.data();
+	const XMP_Uns8 * valueEnd = valueStart + this->value.size();
+	return (XMP_SkipXMLWhitespace ( valueStart, valueEnd ) == valueEnd);
 
 }	// XML_Node::IsWhitespaceNode
 
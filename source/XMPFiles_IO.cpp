@@ -16,6 +16,12 @@
 #include "source/XMPFiles_IO.hpp"
 #include "source/XIO.hpp"
 
+#ifndef XMPFiles_MapReadOnlyFiles
+	#define XMPFiles_MapReadOnlyFiles 1	// Define as 0 to remove the mapping support entirely.
+#endif
+
+static XMP_Uns32 sReadBufferSize = 64*1024;	// Set by XMPFiles::Initialize.
+static bool sMapReadOnlyFiles = false;		// Set by XMPFiles::Initialize.
 
 #define EMPTY_FILE_PATH ""
 #define XMP_FILESIO_STATIC_START try { /* int a;*/
@@ -98,6 +104,13 @@ XMPFiles_IO::XMPFiles_IO (
 	, currOffset(0)
 	, isTemp(false)
 	, derivedTemp(0)
+	, mappedData(0)
+	, hostOffset(0)	// ! New_XMPFiles_IO rewinds, other callers must pass a file at offset 0.
+	, readBuffer(0)
+	, readBufferSize(sReadBufferSize)
+	, bufferOffset(0)
+	, bufferLength(0)
+	, noHostCopy(false)
 	, progressTracker(_progressTracker)
 	, errorCallback(_errorCallback)
 {
@@ -105,6 +118,9 @@ XMPFiles_IO::XMPFiles_IO (
 	XMP_Assert ( this->fileRef != Host_IO::noFileRef );
 
 	this->currLength = Host_IO::Length ( this->fileRef );
+	if ( XMPFiles_MapReadOnlyFiles && sMapReadOnlyFiles && this->readOnly && Host_IO::IsLocalFile ( this->fileRef ) ) {
+		this->mappedData = (const XMP_Uns8*) Host_IO::MapReadOnly ( this->fileRef, this->currLength );
+	}
 	XMP_FILESIO_END2 ( _filePath, kXMPErrSev_FileFatal )
 }	// XMPFiles_IO::XMPFiles_IO
 
@@ -117,8 +133,10 @@ XMPFiles_IO::~XMPFiles_IO()
 	try {
 		XMP_FILESIO_START
 		if ( this->derivedTemp != 0 ) this->DeleteTemp();
+		this->UnmapFile();
 		if ( this->fileRef != Host_IO::noFileRef ) Host_IO::Close ( this->fileRef );
 		if ( this->isTemp && (! this->filePath.empty()) ) Host_IO::Delete ( this->filePath.c_str() );
+		delete [] this->readBuffer;
 		XMP_FILESIO_END1 ( kXMPErrSev_Recoverable )
 	} catch ( ... ) {
 		// All of the above is fail-safe cleanup, ignore problems.
@@ -145,7 +163,7 @@ XMP_Uns32 XMPFiles_IO::Read ( void * buffer, XMP_Uns32 count, bool readAll /* =
 {
 	XMP_FILESIO_START
 	XMP_Assert ( this->fileRef != Host_IO::noFileRef );
-	XMP_Assert ( this->currOffset == Host_IO::Offset ( this->fileRef ) );
+	XMP_Assert ( (this->hostOffset == -1) || (this->hostOffset == Host_IO::Offset ( this->fileRef )) );
 	XMP_Assert ( this->currLength == Host_IO::Length ( this->fileRef ) );
 	XMP_Assert ( this->currOffset <= this->currLength );
 
@@ -154,8 +172,20 @@ XMP_Uns32 XMPFiles_IO::Read ( void * buffer, XMP_Uns32 count, bool readAll /* =
 		count = (XMP_Uns32) (this->currLength - this->currOffset);
 	}
 
-	XMP_Uns32 amountRead = Host_IO::Read ( this->fileRef, buffer, count );
-	XMP_Enforce ( amountRead == count );
+	XMP_Uns32 amountRead;
+	if ( this->mappedData != 0 ) {
+		memcpy ( buffer, this->mappedData + this->currOffset, count );
+		amountRead = count;
+		++this->ioStats.savedReads;
+	} else if ( this->readBufferSize != 0 ) {
+		amountRead = this->ReadBuffered ( (XMP_Uns8*)buffer, count );
+	} else {
+		this->SeekHost ( this->currOffset );
+		amountRead = Host_IO::Read ( this->fileRef, buffer, count );
+		XMP_Enforce ( amountRead == count );
+		this->hostOffset += amountRead;
+		++this->ioStats.hostReads;
+	}
 
 	this->currOffset += amountRead;
 	return amountRead;
@@ -172,21 +202,29 @@ void XMPFiles_IO::Write ( const void * buffer, XMP_Uns32 count )
 {
 	XMP_FILESIO_START
 	XMP_Assert ( this->fileRef != Host_IO::noFileRef );
-	XMP_Assert ( this->currOffset == Host_IO::Offset ( this->fileRef ) );
+	XMP_Assert ( (this->hostOffset == -1) || (this->hostOffset == Host_IO::Offset ( this->fileRef )) );
 	XMP_Assert ( this->currLength == Host_IO::Length ( this->fileRef ) );
 	XMP_Assert ( this->currOffset <= this->currLength );
 
 	try {
 		if ( this->readOnly )
 			XMP_Throw ( "New_XMPFiles_IO, write not permitted on read only file", kXMPErr_FilePermission );
+		this->DropBuffered ( this->currOffset, count );
+		this->SeekHost ( this->currOffset );
 		Host_IO::Write ( this->fileRef, buffer, count );
+		this->hostOffset += count;
+		++this->ioStats.hostWrites;
+		this->ioStats.bytesWritten += count;
 		if ( this->progressTracker != 0 ) this->progressTracker->AddWorkDone ( (float) count );
 	} catch ( ... ) {
 		try {
 			// we should try to maintain the state as best as possible
 			// but no exception should escape from this backup plan.
 			// Make sure the internal state reflects partial writes.
+			this->bufferLength = 0;
+			this->hostOffset = -1;
 			this->currOffset = Host_IO::Offset ( this->fileRef );
+			this->hostOffset = this->currOffset;
 			this->currLength = Host_IO::Length ( this->fileRef );
 		} catch ( ... ) {
 			// don't do anything
@@ -208,7 +246,7 @@ XMP_Int64 XMPFiles_IO::Seek ( XMP_Int64 offset, SeekMode mode )
 {
 	XMP_FILESIO_START
 	XMP_Assert ( this->fileRef != Host_IO::noFileRef );
-	XMP_Assert ( this->currOffset == Host_IO::Offset ( this->fileRef ) );
+	XMP_Assert ( (this->hostOffset == -1) || (this->hostOffset == Host_IO::Offset ( this->fileRef )) );
 	XMP_Assert ( this->currLength == Host_IO::Length ( this->fileRef ) );
 
 	XMP_Int64 newOffset = offset;
@@ -220,13 +258,15 @@ XMP_Int64 XMPFiles_IO::Seek ( XMP_Int64 offset, SeekMode mode )
 	XMP_Enforce ( newOffset >= 0 );
 
 	if ( newOffset <= this->currLength ) {
-		this->currOffset = Host_IO::Seek ( this->fileRef, offset, mode );
+		this->currOffset = newOffset;	// The host offset is moved by the next host read or write.
+		++this->ioStats.savedSeeks;
 	} else if ( this->readOnly ) {
 		XMP_Throw ( "XMPFiles_IO::Seek, read-only seek beyond EOF", kXMPErr_EnforceFailure );
 	} else {
+		this->hostOffset = -1;	// ! Some versions of Host_IO::SetEOF implicitly seek to EOF.
 		Host_IO::SetEOF ( this->fileRef, newOffset );	// Extend a file open for writing.
 		this->currLength = newOffset;
-		this->currOffset = Host_IO::Seek ( this->fileRef, 0, kXMP_SeekFromEnd );
+		this->currOffset = newOffset;
 	}
 
 	XMP_Assert ( this->currOffset == newOffset );
@@ -244,7 +284,7 @@ XMP_Int64 XMPFiles_IO::Length()
 {
 	XMP_FILESIO_START
 	XMP_Assert ( this->fileRef != Host_IO::noFileRef );
-	XMP_Assert ( this->currOffset == Host_IO::Offset ( this->fileRef ) );
+	XMP_Assert ( (this->hostOffset == -1) || (this->hostOffset == Host_IO::Offset ( this->fileRef )) );
 	XMP_Assert ( this->currLength == Host_IO::Length ( this->fileRef ) );
 	XMP_FILESIO_END1 ( kXMPErrSev_FileFatal )
 	return this->currLength;
@@ -259,21 +299,24 @@ void XMPFiles_IO::Truncate ( XMP_Int64 length )
 {
 	XMP_FILESIO_START
 	XMP_Assert ( this->fileRef != Host_IO::noFileRef );
-	XMP_Assert ( this->currOffset == Host_IO::Offset ( this->fileRef ) );
+	XMP_Assert ( (this->hostOffset == -1) || (this->hostOffset == Host_IO::Offset ( this->fileRef )) );
 	XMP_Assert ( this->currLength == Host_IO::Length ( this->fileRef ) );
 
 	if ( this->readOnly )
 		XMP_Throw ( "New_XMPFiles_IO, truncate not permitted on read only file", kXMPErr_FilePermission );
 
 	XMP_Enforce ( length <= this->currLength );
+	this->hostOffset = -1;	// ! Some versions of Host_IO::SetEOF implicitly seek to EOF.
 	Host_IO::SetEOF ( this->fileRef, length );
 
 	this->currLength = length;
 	if ( this->currOffset > this->currLength ) this->currOffset = this->currLength;
 
-	// ! Seek to the expected offset, some versions of Host_IO::SetEOF implicitly seek to EOF.
-	Host_IO::Seek ( this->fileRef, this->currOffset, kXMP_SeekFromStart );
-	XMP_Assert ( this->currOffset == Host_IO::Offset ( this->fileRef ) );
+	if ( this->bufferOffset >= length ) {
+		this->bufferLength = 0;
+	} else if ( (this->bufferOffset + this->bufferLength) > length ) {
+		this->bufferLength = (XMP_Uns32) (length - this->bufferOffset);
+	}
 	XMP_FILESIO_END1 ( kXMPErrSev_FileFatal )
 
 }	// XMPFiles_IO::Truncate
@@ -331,12 +374,23 @@ void XMPFiles_IO::AbsorbTemp()
 	this->Close();
 	temp->Close();
 
+	const XMP_IOStats & tempStats = temp->ioStats;	// The rewrite is part of this file's update.
+	this->ioStats.hostReads += tempStats.hostReads;
+	this->ioStats.savedReads += tempStats.savedReads;
+	this->ioStats.hostSeeks += tempStats.hostSeeks;
+	this->ioStats.savedSeeks += tempStats.savedSeeks;
+	this->ioStats.hostWrites += tempStats.hostWrites;
+	this->ioStats.bytesWritten += tempStats.bytesWritten;
+	this->ioStats.bytesCopied += tempStats.bytesCopied;
+
 	Host_IO::SwapData ( this->filePath.c_str(), temp->filePath.c_str() );
 	this->DeleteTemp();
 
 	this->fileRef = Host_IO::Open ( this->filePath.c_str(), Host_IO::openReadWrite );
 	this->currLength = Host_IO::Length ( this->fileRef );
 	this->currOffset = 0;
+	this->hostOffset = 0;
+	this->bufferLength = 0;
 	XMP_FILESIO_END1 ( kXMPErrSev_FileFatal )
 
 }	// XMPFiles_IO::AbsorbTemp
@@ -377,6 +431,8 @@ void XMPFiles_IO::DeleteTemp()
 void XMPFiles_IO::Close()
 {
 	XMP_FILESIO_START
+	this->UnmapFile();
+	this->bufferLength = 0;
 	if ( this->fileRef != Host_IO::noFileRef ) {
 		Host_IO::Close ( this->fileRef );
 		this->fileRef = Host_IO::noFileRef;
@@ -386,3 +442,169 @@ void XMPFiles_IO::Close()
 }	// XMPFiles_IO::Close
 
 // =================================================================================================
+// XMPFiles_IO::HostCopy
+// =====================
+//
+// The destination's counts get the copied bytes, its progress tracker is told about them as if
+// they were written. A destination where the host copied nothing is not tried again, so callers
+// that copy many small ranges don't keep paying for a failing system call.
+
+XMP_Int64 XMPFiles_IO::HostCopy ( XMP_Int64 offset, XMPFiles_IO * dest, XMP_Int64 destOffset, XMP_Int64 length )
+{
+	XMP_FILESIO_START
+	XMP_Assert ( (this->fileRef != Host_IO::noFileRef) && (dest->fileRef != Host_IO::noFileRef) );
+
+	if ( dest->readOnly )
+		XMP_Throw ( "XMPFiles_IO::HostCopy, write not permitted on read only file", kXMPErr_FilePermission );
+	if ( dest->noHostCopy || (offset < 0) || (destOffset < 0) ) return 0;
+	if ( length > (this->currLength - offset) ) length = this->currLength - offset;
+	if ( length <= 0 ) return 0;
+
+	dest->DropBuffered ( destOffset, length );
+	XMP_Int64 copied = Host_IO::CopyRange ( this->fileRef, offset, dest->fileRef, destOffset, length );
+	if ( copied == 0 ) dest->noHostCopy = true;
+
+	if ( (destOffset + copied) > dest->currLength ) dest->currLength = destOffset + copied;
+	dest->ioStats.bytesCopied += copied;
+	if ( (dest->progressTracker != 0) && (copied > 0) ) dest->progressTracker->AddWorkDone ( (float) copied );
+
+	return copied;
+	XMP_FILESIO_END1 ( kXMPErrSev_FileFatal )
+	return 0;
+
+}	// XMPFiles_IO::HostCopy
+
+// =================================================================================================
+// XMPFiles_IO::BorrowRange
+// ========================
+
+const XMP_Uns8 * XMPFiles_IO::BorrowRange ( XMP_Int64 offset, XMP_Uns32 count ) const
+{
+	if ( (this->mappedData == 0) || (offset < 0) || (offset > this->currLength) ) return 0;
+	if ( count > (this->currLength - offset) ) return 0;
+	return this->mappedData + offset;
+
+}	// XMPFiles_IO::BorrowRange
+
+// =================================================================================================
+// XMPFiles_IO::UnmapFile
+// ======================
+
+void XMPFiles_IO::UnmapFile()
+{
+	if ( this->mappedData == 0 ) return;
+
+	Host_IO::Unmap ( this->mappedData, this->currLength );
+	this->mappedData = 0;
+
+}	// XMPFiles_IO::UnmapFile
+
+// =================================================================================================
+// XMPFiles_IO::DropBuffered
+// =========================
+
+void XMPFiles_IO::DropBuffered ( XMP_Int64 offset, XMP_Int64 count )
+{
+	if ( (this->bufferLength != 0) && (offset < (this->bufferOffset + this->bufferLength)) &&
+		 ((offset + count) > this->bufferOffset) ) {
+		this->bufferLength = 0;	// Drop buffered bytes that a write changes.
+	}
+
+}	// XMPFiles_IO::DropBuffered
+
+// =================================================================================================
+// XMPFiles_IO::SeekHost
+// =====================
+
+void XMPFiles_IO::SeekHost ( XMP_Int64 offset )
+{
+	if ( this->hostOffset == offset ) return;
+
+	this->hostOffset = -1;	// In case the seek throws.
+	this->hostOffset = Host_IO::Seek ( this->fileRef, offset, kXMP_SeekFromStart );
+	++this->ioStats.hostSeeks;
+
+}	// XMPFiles_IO::SeekHost
+
+// =================================================================================================
+// XMPFiles_IO::ReadBuffered
+// =========================
+//
+// Copy what the buffer holds at currOffset, then either read the rest straight into the caller's
+// buffer if it is large, or refill the buffer starting at the first byte still needed. The caller
+// has already limited count to the bytes left in the file.
+
+XMP_Uns32 XMPFiles_IO::ReadBuffered ( XMP_Uns8 * buffer, XMP_Uns32 count )
+{
+	XMP_Int64 readOffset = this->currOffset;
+	XMP_Uns32 remaining = count;
+
+	const XMP_Int64 bufferEnd = this->bufferOffset + this->bufferLength;
+	if ( (this->bufferLength != 0) && (this->bufferOffset <= readOffset) && (readOffset < bufferEnd) ) {
+		XMP_Uns32 available = (XMP_Uns32) (bufferEnd - readOffset);
+		XMP_Uns32 ioCount = (remaining < available) ? remaining : available;
+		memcpy ( buffer, this->readBuffer + (readOffset - this->bufferOffset), ioCount );
+		buffer += ioCount;
+		readOffset += ioCount;
+		remaining -= ioCount;
+	}
+
+	if ( remaining == 0 ) {
+		++this->ioStats.savedReads;
+		return count;
+	}
+
+	this->SeekHost ( readOffset );
+	++this->ioStats.hostReads;
+
+	if ( remaining >= this->readBufferSize ) {
+
+		XMP_Uns32 amountRead = Host_IO::Read ( this->fileRef, buffer, remaining );
+		XMP_Enforce ( amountRead == remaining );
+		this->hostOffset += amountRead;
+
+	} else {
+
+		if ( this->readBuffer == 0 ) this->readBuffer = new XMP_Uns8 [this->readBufferSize];
+
+		XMP_Uns32 fillCount = this->readBufferSize;
+		if ( fillCount > (this->currLength - readOffset) ) fillCount = (XMP_Uns32) (this->currLength - readOffset);
+
+		this->bufferLength = 0;	// In case the read throws.
+		XMP_Uns32 amountRead = Host_IO::Read ( this->fileRef, this->readBuffer, fillCount );
+		XMP_Enforce ( amountRead == fillCount );
+		this->hostOffset += amountRead;
+		this->bufferOffset = readOffset;
+		this->bufferLength = amountRead;
+
+		memcpy ( buffer, this->readBuffer, remaining );
+
+	}
+
+	return count;
+
+}	// XMPFiles_IO::ReadBuffered
+
+// =================================================================================================
+// XMPFiles_IO::SetReadBufferSize
+// ==============================
+
+/* class static */
+void XMPFiles_IO::SetReadBufferSize ( XMP_Uns32 size )
+{
+	sReadBufferSize = size;
+
+}	// XMPFiles_IO::SetReadBufferSize
+
+// =================================================================================================
+// XMPFiles_IO::SetMapReadOnlyFiles
+// ================================
+
+/* class static */
+void XMPFiles_IO::SetMapReadOnlyFiles ( bool mapFiles )
+{
+	sMapReadOnlyFiles = mapFiles;
+
+}	// XMPFiles_IO::SetMapReadOnlyFiles
+
+// =================================================================================================
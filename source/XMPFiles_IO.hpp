@@ -27,6 +27,17 @@ class XMPFiles_IO : public XMP_IO {
 	// Implementation class for I/O inside XMPFiles, uses host O/S file services. All of the common
 	// functions behave as described for XMP_IO. Use openReadOnly and openReadWrite constants from
 	// Host_IO for the readOnly parameter to the constructors.
+	//
+	// With SetMapReadOnlyFiles a read-only file on a local volume is memory mapped when the host
+	// allows it. Read and Seek then copy from the mapping and make no system calls, which matters
+	// for handlers that walk a file with many small reads. BorrowRange gives direct access to the
+	// mapped bytes, see XIO::BorrowRange. Mapping is off by default: a file that another process
+	// truncates while it is mapped makes the next access to the lost pages raise SIGBUS, where a
+	// host read would just come up short.
+	//
+	// Other files are read through a read-ahead buffer, sized by SetReadBufferSize. Seek only moves
+	// the logical offset, the host offset is moved lazily before the next host read or write. Writes
+	// and truncation drop or trim the buffered bytes so it always matches the file.
 public:
 	static XMPFiles_IO * New_XMPFiles_IO(
 		const char * filePath,
@@ -66,6 +77,23 @@ public:
 
 	void Close();	// Not part of XMP_IO, added here to let errors propagate.
 
+	// Returns a pointer to count bytes at offset, or 0 if the file is not mapped or the range is not
+	// inside the file. The pointer is valid until the file is closed.
+	const XMP_Uns8 * BorrowRange ( XMP_Int64 offset, XMP_Uns32 count ) const;
+
+	// Copies length bytes at offset to destOffset in dest inside the host file system, see
+	// Host_IO::CopyRange. Returns the number of bytes copied, which can be less than length, the
+	// caller copies the rest through memory. The I/O positions do not change. Use XIO::Copy or
+	// XIO::Move, they call this for local files.
+	XMP_Int64 HostCopy ( XMP_Int64 offset, XMPFiles_IO * dest, XMP_Int64 destOffset, XMP_Int64 length );
+
+	const XMP_IOStats & GetIOStats() const { return this->ioStats; };
+
+	// Sets the read buffer size for files opened after the call, 0 disables buffering. Set from the
+	// XMPFiles::Initialize options.
+	static void SetReadBufferSize ( XMP_Uns32 size );
+	static void SetMapReadOnlyFiles ( bool mapFiles );
+
 private:
 	bool					readOnly;
 	std::string				filePath;
@@ -74,6 +102,16 @@ private:
 	XMP_Int64				currLength;
 	bool					isTemp;
 	XMPFiles_IO *			derivedTemp;
+	const XMP_Uns8 *		mappedData;	// The whole file when mapped, only for read-only files.
+	XMP_Int64				hostOffset;	// The host file offset, -1 if unknown.
+
+	XMP_Uns8 *				readBuffer;	// Allocated on the first buffered read.
+	XMP_Uns32				readBufferSize;
+	XMP_Int64				bufferOffset;	// The file offset of readBuffer[0].
+	XMP_Uns32				bufferLength;	// The number of valid bytes in readBuffer.
+	bool					noHostCopy;		// Set once HostCopy to this file has failed.
+
+	XMP_IOStats				ioStats;
 	
 	XMP_ProgressTracker *	progressTracker;	// ! Owned by the XMPFiles object!
 	GenericErrorCallback *	errorCallback;		// ! Owned by the XMPFiles object!
@@ -83,8 +121,20 @@ private:
 		: fileRef(Host_IO::noFileRef)
 		, isTemp(false)
 		, derivedTemp(0)
+		, mappedData(0)
+		, hostOffset(-1)
+		, readBuffer(0)
+		, readBufferSize(0)
+		, bufferOffset(0)
+		, bufferLength(0)
+		, noHostCopy(false)
 		, progressTracker(0) {};
 
+	void UnmapFile();
+	void DropBuffered ( XMP_Int64 offset, XMP_Int64 count );
+	void SeekHost ( XMP_Int64 offset );
+	XMP_Uns32 ReadBuffered ( XMP_Uns8 * buffer, XMP_Uns32 count );
+
 	// The copy constructor and assignment operators are private to prevent client use. Allowing
 	// them would require shared I/O state between XMPFiles_IO objects.
 	XMPFiles_IO(const XMPFiles_IO & original);
@@ -9,6 +9,7 @@
 #include "public/include/XMP_Environment.h"
 
 #include "source/XMP_LibUtils.hpp"
+#include "source/SSE2Utils.hpp"
 
 #include "source/UnicodeInlines.incl_cpp"
 
@@ -350,6 +351,151 @@ void XMP_ReadWriteLock::Release()
 
 #endif
 
+// =================================================================================================
+// XML text scanning
+// =================
+//
+// The SSE2 loops look at 16 byte blocks and return the first flagged byte. The word loops use the
+// usual bit tricks on 8 bytes: a byte less than n (n <= 0x80) leaves its high bit set in the
+// expression (x - n*ones) & ~x, a byte equal to c is a zero byte in x ^ c*ones. Borrows can flag
+// a byte above a real hit, never a word without one, so a flagged word is rechecked byte by byte.
+
+#if ! XMP_UseSSE2
+
+static const XMP_Uns64 kByteOnes  = 0x0101010101010101ULL;
+static const XMP_Uns64 kByteHighs = 0x8080808080808080ULL;
+
+static inline XMP_Uns64 BytesBelow ( XMP_Uns64 word, XMP_Uns8 n )
+{
+	return (word - (kByteOnes * n)) & ~word;
+}
+
+static inline XMP_Uns64 BytesEqual ( XMP_Uns64 word, XMP_Uns8 c )
+{
+	const XMP_Uns64 diff = word ^ (kByteOnes * c);
+	return (diff - kByteOnes) & ~diff;
+}
+
+#endif
+
+// -------------------------------------------------------------------------------------------------
+
+const XMP_Uns8 * XMP_FindXMLEscape ( const XMP_Uns8 * start, const XMP_Uns8 * limit, bool forAttribute )
+{
+	const XMP_Uns8 quote = forAttribute ? '"' : '&';	// ! Elements check '&' twice rather than branch.
+
+	#if XMP_UseSSE2
+
+		const __m128i lastControl = _mm_set1_epi8 ( 0x1F );
+		const __m128i ampersand   = _mm_set1_epi8 ( '&' );
+		const __m128i lessThan    = _mm_set1_epi8 ( '<' );
+		const __m128i greaterThan = _mm_set1_epi8 ( '>' );
+		const __m128i quoteChar   = _mm_set1_epi8 ( (char)quote );
+
+		for ( ; (limit - start) >= 16; start += 16 ) {
+			const __m128i block = _mm_loadu_si128 ( (const __m128i *) start );
+			__m128i hits = _mm_cmpeq_epi8 ( _mm_min_epu8 ( block, lastControl ), block );	// Unsigned block <= 0x1F.
+			hits = _mm_or_si128 ( hits, _mm_cmpeq_epi8 ( block, ampersand ) );
+			hits = _mm_or_si128 ( hits, _mm_cmpeq_epi8 ( block, lessThan ) );
+			hits = _mm_or_si128 ( hits, _mm_cmpeq_epi8 ( block, greaterThan ) );
+			hits = _mm_or_si128 ( hits, _mm_cmpeq_epi8 ( block, quoteChar ) );
+			const unsigned int mask = (unsigned int) _mm_movemask_epi8 ( hits );
+			if ( mask != 0 ) return start + FirstBitIndex ( mask );
+		}
+
+	#else
+
+		for ( ; (limit - start) >= 8; start += 8 ) {
+			XMP_Uns64 word;
+			memcpy ( &word, start, 8 );
+			const XMP_Uns64 hits = BytesBelow ( word, 0x20 ) | BytesEqual ( word, '&' ) | BytesEqual ( word, '<' ) |
+								   BytesEqual ( word, '>' ) | BytesEqual ( word, quote );
+			if ( (hits & kByteHighs) != 0 ) break;
+		}
+
+	#endif
+
+	for ( ; start < limit; ++start ) {
+		const XMP_Uns8 ch = *start;
+		if ( (ch < 0x20) || (ch == '&') || (ch == '<') || (ch == '>') || (ch == quote) ) break;
+	}
+
+	return start;
+
+}	// XMP_FindXMLEscape
+
+// -------------------------------------------------------------------------------------------------
+
+const XMP_Uns8 * XMP_SkipPlainASCII ( const XMP_Uns8 * start, const XMP_Uns8 * limit )
+{
+
+	#if XMP_UseSSE2
+
+		const __m128i firstPlain = _mm_set1_epi8 ( 0x20 );
+		const __m128i deleteChar = _mm_set1_epi8 ( 0x7F );
+		const __m128i ampersand  = _mm_set1_epi8 ( '&' );
+
+		for ( ; (limit - start) >= 16; start += 16 ) {
+			const __m128i block = _mm_loadu_si128 ( (const __m128i *) start );
+			__m128i hits = _mm_cmplt_epi8 ( block, firstPlain );	// ! Signed, also catches 0x80..0xFF.
+			hits = _mm_or_si128 ( hits, _mm_cmpeq_epi8 ( block, deleteChar ) );
+			hits = _mm_or_si128 ( hits, _mm_cmpeq_epi8 ( block, ampersand ) );
+			const unsigned int mask = (unsigned int) _mm_movemask_epi8 ( hits );
+			if ( mask != 0 ) return start + FirstBitIndex ( mask );
+		}
+
+	#else
+
+		for ( ; (limit - start) >= 8; start += 8 ) {
+			XMP_Uns64 word;
+			memcpy ( &word, start, 8 );
+			const XMP_Uns64 hits = word | BytesBelow ( word, 0x20 ) | BytesEqual ( word, 0x7F ) | BytesEqual ( word, '&' );
+			if ( (hits & kByteHighs) != 0 ) break;
+		}
+
+	#endif
+
+	for ( ; start < limit; ++start ) {
+		if ( (*start < 0x20) || (*start > 0x7E) || (*start == '&') ) break;
+	}
+
+	return start;
+
+}	// XMP_SkipPlainASCII
+
+// -------------------------------------------------------------------------------------------------
+
+const XMP_Uns8 * XMP_SkipXMLWhitespace ( const XMP_Uns8 * start, const XMP_Uns8 * limit )
+{
+
+	#if XMP_UseSSE2
+
+		const __m128i space    = _mm_set1_epi8 ( ' ' );
+		const __m128i tab      = _mm_set1_epi8 ( kTab );
+		const __m128i lineFeed = _mm_set1_epi8 ( kLF );
+		const __m128i carriage = _mm_set1_epi8 ( kCR );
+
+		for ( ; (limit - start) >= 16; start += 16 ) {
+			const __m128i block = _mm_loadu_si128 ( (const __m128i *) start );
+			__m128i white = _mm_cmpeq_epi8 ( block, space );
+			white = _mm_or_si128 ( white, _mm_cmpeq_epi8 ( block, tab ) );
+			white = _mm_or_si128 ( white, _mm_cmpeq_epi8 ( block, lineFeed ) );
+			white = _mm_or_si128 ( white, _mm_cmpeq_epi8 ( block, carriage ) );
+			const unsigned int mask = ~ (unsigned int) _mm_movemask_epi8 ( white ) & 0xFFFF;
+			if ( mask != 0 ) return start + FirstBitIndex ( mask );
+		}
+
+	#endif
+
+	for ( ; start < limit; ++start ) {	// Whitespace runs are short, there is no word loop.
+		const XMP_Uns8 ch = *start;
+		if ( (ch != ' ') && (ch != kTab) && (ch != kLF) && (ch != kCR) ) break;
+	}
+
+	return start;
+
+}	// XMP_SkipXMLWhitespace
+
 // =================================================================================================
 // Data structure dumping utilities
 // ================================
@@ -431,66 +577,206 @@ DumpStringMap ( const XMP_StringMap & map, XMP_StringPtr label, XMP_TextOutputPr
 // Namespace Tables
 // =================================================================================================
 
+static const size_t kMinNamespaceSlots = 128;	// Room for the standard namespaces without growing.
+
+XMP_NamespaceTable::NamespaceIndex::NamespaceIndex ( size_t slotCount ) : slotMask(slotCount - 1), uriSlots(0), prefixSlots(0)
+{
+	XMP_Assert ( (slotCount & (slotCount - 1)) == 0 );
+	this->uriSlots = new std::atomic<const NamespaceEntry*> [slotCount];
+	this->prefixSlots = new std::atomic<const NamespaceEntry*> [slotCount];
+	for ( size_t i = 0; i < slotCount; ++i ) {
+		this->uriSlots[i].store ( 0, std::memory_order_relaxed );
+		this->prefixSlots[i].store ( 0, std::memory_order_relaxed );
+	}
+}	// XMP_NamespaceTable::NamespaceIndex::NamespaceIndex
+
+XMP_NamespaceTable::NamespaceIndex::~NamespaceIndex()
+{
+	delete [] this->uriSlots;
+	delete [] this->prefixSlots;
+}	// XMP_NamespaceTable::NamespaceIndex::~NamespaceIndex
+
+// =================================================================================================
+
+XMP_NamespaceTable::XMP_NamespaceTable() : index ( new NamespaceIndex ( kMinNamespaceSlots ) )
+{
+	InitializeBasicMutex ( this->writerMutex );
+}	// XMP_NamespaceTable::XMP_NamespaceTable
+
+// =================================================================================================
+
 XMP_NamespaceTable::XMP_NamespaceTable ( const XMP_NamespaceTable & presets )
+	: index ( new NamespaceIndex ( presets.index.load()->slotMask + 1 ) )
 {
-	XMP_AutoLock presetLock ( &presets.lock, kXMP_ReadLock );
+	InitializeBasicMutex ( this->writerMutex );
 
-	this->uriToPrefixMap = presets.uriToPrefixMap;
-	this->prefixToURIMap = presets.prefixToURIMap;
+	XMP_AutoMutex presetLock ( &presets.writerMutex );	// ! Keeps presets.entries stable.
+	this->entries.reserve ( presets.entries.size() );
+	for ( size_t i = 0, limit = presets.entries.size(); i < limit; ++i ) {
+		this->AddEntry ( new NamespaceEntry ( *presets.entries[i] ) );
+	}
 
 }	// XMP_NamespaceTable::XMP_NamespaceTable
 
 // =================================================================================================
 
+XMP_NamespaceTable::~XMP_NamespaceTable()
+{
+	delete this->index.load();
+	for ( size_t i = 0, limit = this->oldIndices.size(); i < limit; ++i ) delete this->oldIndices[i];
+	for ( size_t i = 0, limit = this->entries.size(); i < limit; ++i ) delete this->entries[i];
+	TerminateBasicMutex ( this->writerMutex );
+}	// XMP_NamespaceTable::~XMP_NamespaceTable
+
+// =================================================================================================
+
+static XMP_Uns32 HashPrefix ( XMP_StringPtr prefix, XMP_StringLen len, bool addColon )
+{
+	XMP_Uns32 hash = XMP_AtomTable::Hash ( prefix, len );
+	if ( addColon ) hash = (hash ^ (XMP_Uns8)':') * 16777619UL;	// ! Continue the FNV-1a hash.
+	return hash;
+}	// HashPrefix
+
+// =================================================================================================
+
+const XMP_NamespaceTable::NamespaceEntry *
+XMP_NamespaceTable::FindURI ( XMP_StringPtr uri, XMP_StringLen len, XMP_Uns32 hash ) const
+{
+	const NamespaceIndex * currIndex = this->index.load ( std::memory_order_acquire );
+	const size_t slotMask = currIndex->slotMask;
+
+	for ( size_t slot = hash & slotMask; ; slot = (slot + 1) & slotMask ) {
+		const NamespaceEntry * entry = currIndex->uriSlots[slot].load ( std::memory_order_acquire );
+		if ( entry == 0 ) return 0;
+		if ( (entry->uriHash == hash) && (entry->uri.size() == len) &&
+			 (memcmp ( entry->uri.data(), uri, len ) == 0) ) return entry;
+	}
+
+}	// XMP_NamespaceTable::FindURI
+
+// =================================================================================================
+
+const XMP_NamespaceTable::NamespaceEntry *
+XMP_NamespaceTable::FindPrefix ( XMP_StringPtr prefix, XMP_StringLen len, bool addColon, XMP_Uns32 hash ) const
+{
+	const NamespaceIndex * currIndex = this->index.load ( std::memory_order_acquire );
+	const size_t slotMask = currIndex->slotMask;
+	const size_t fullLen = len + (addColon ? 1 : 0);
+
+	for ( size_t slot = hash & slotMask; ; slot = (slot + 1) & slotMask ) {
+		const NamespaceEntry * entry = currIndex->prefixSlots[slot].load ( std::memory_order_acquire );
+		if ( entry == 0 ) return 0;
+		if ( (entry->prefixHash == hash) && (entry->prefix.size() == fullLen) &&
+			 (memcmp ( entry->prefix.data(), prefix, len ) == 0) ) return entry;	// ! Stored prefixes end with ':'.
+	}
+
+}	// XMP_NamespaceTable::FindPrefix
+
+// =================================================================================================
+// AddEntry
+// --------
+//
+// Must be called with the writer mutex held, or from a constructor. The entry is published to the
+// prefix slots first so that a reader finding it by URI can always also find it by prefix.
+
+void XMP_NamespaceTable::AddEntry ( NamespaceEntry * entry )
+{
+	const NamespaceIndex * currIndex = this->index.load ( std::memory_order_relaxed );
+
+	if ( 2*(this->entries.size() + 1) > (currIndex->slotMask + 1) ) {
+
+		NamespaceIndex * newIndex = new NamespaceIndex ( 2 * (currIndex->slotMask + 1) );
+		const size_t slotMask = newIndex->slotMask;
+
+		for ( size_t i = 0, limit = this->entries.size(); i < limit; ++i ) {
+			const NamespaceEntry * oldEntry = this->entries[i];
+			size_t slot = oldEntry->prefixHash & slotMask;
+			while ( newIndex->prefixSlots[slot].load ( std::memory_order_relaxed ) != 0 ) slot = (slot + 1) & slotMask;
+			newIndex->prefixSlots[slot].store ( oldEntry, std::memory_order_relaxed );
+			slot = oldEntry->uriHash & slotMask;
+			while ( newIndex->uriSlots[slot].load ( std::memory_order_relaxed ) != 0 ) slot = (slot + 1) & slotMask;
+			newIndex->uriSlots[slot].store ( oldEntry, std::memory_order_relaxed );
+		}
+
+		this->oldIndices.push_back ( currIndex );
+		this->index.store ( newIndex, std::memory_order_release );
+		currIndex = newIndex;
+
+	}
+
+	const size_t slotMask = currIndex->slotMask;
+	this->entries.push_back ( entry );
+
+	size_t slot = entry->prefixHash & slotMask;
+	while ( currIndex->prefixSlots[slot].load ( std::memory_order_relaxed ) != 0 ) slot = (slot + 1) & slotMask;
+	currIndex->prefixSlots[slot].store ( entry, std::memory_order_release );
+
+	slot = entry->uriHash & slotMask;
+	while ( currIndex->uriSlots[slot].load ( std::memory_order_relaxed ) != 0 ) slot = (slot + 1) & slotMask;
+	currIndex->uriSlots[slot].store ( entry, std::memory_order_release );
+
+}	// XMP_NamespaceTable::AddEntry
+
+// =================================================================================================
+
 bool XMP_NamespaceTable::Define ( XMP_StringPtr _uri, XMP_StringPtr _suggPrefix,
 								  XMP_StringPtr * prefixPtr, XMP_StringLen * prefixLen )
 {
-	XMP_AutoLock tableLock ( &this->lock, kXMP_WriteLock );
-	bool prefixMatches = false;
-
 	XMP_Assert ( (_uri != 0) && (*_uri != 0) && (_suggPrefix != 0) && (*_suggPrefix != 0) );
 
-	XMP_VarString	uri ( _uri );
 	XMP_VarString	suggPrefix ( _suggPrefix );
 	if ( suggPrefix[suggPrefix.size()-1] != ':' ) suggPrefix += ':';
 	VerifySimpleXMLName ( _suggPrefix, _suggPrefix+suggPrefix.size()-1 );	// Exclude the colon.
 
-	XMP_StringMapPos uriPos = this->uriToPrefixMap.find ( uri );
+	// The parser defines every xmlns it sees, almost always for a known URI. Check without locking.
 
-	if ( uriPos == this->uriToPrefixMap.end() ) {
+	const XMP_StringLen uriLen = (XMP_StringLen) strlen ( _uri );
+	const XMP_Uns32 uriHash = XMP_AtomTable::Hash ( _uri, uriLen );
+	const NamespaceEntry * entry = this->FindURI ( _uri, uriLen, uriHash );
 
-		// The URI is not yet registered, make sure we use a unique prefix.
+	if ( entry == 0 ) {
 
-		XMP_VarString uniqPrefix ( suggPrefix );
-		int  suffix = 0;
-		char buffer [32];	// AUDIT: Plenty of room for the "_%d_" suffix.
+		XMP_AutoMutex tableLock ( &this->writerMutex );
+		entry = this->FindURI ( _uri, uriLen, uriHash );	// ! Another thread might have added it.
 
-		while ( true ) {
-			if ( this->prefixToURIMap.find ( uniqPrefix ) == this->prefixToURIMap.end() ) break;
-			++suffix;
-			snprintf ( buffer, sizeof(buffer), "_%d_:", suffix );	// AUDIT: Using sizeof for snprintf length is safe.
-			uniqPrefix = suggPrefix;
-			uniqPrefix.erase ( uniqPrefix.size()-1 );	// ! Remove the trailing ':'.
-			uniqPrefix += buffer;
-		}
+		if ( entry == 0 ) {
 
-		// Add the new namespace to both maps.
+			// The URI is not yet registered, make sure we use a unique prefix.
 
-		XMP_StringPair newNS ( uri, uniqPrefix );
-		uriPos = this->uriToPrefixMap.insert ( this->uriToPrefixMap.end(), newNS );
+			XMP_VarString uniqPrefix ( suggPrefix );
+			int  suffix = 0;
+			char buffer [32];	// AUDIT: Plenty of room for the "_%d_" suffix.
 
-		newNS.first.swap ( newNS.second );
-		(void) this->prefixToURIMap.insert ( this->prefixToURIMap.end(), newNS );
+			while ( true ) {
+				XMP_Uns32 prefixHash = HashPrefix ( uniqPrefix.c_str(), (XMP_StringLen)uniqPrefix.size(), false );
+				if ( this->FindPrefix ( uniqPrefix.c_str(), (XMP_StringLen)uniqPrefix.size(), false, prefixHash ) == 0 ) break;
+				++suffix;
+				snprintf ( buffer, sizeof(buffer), "_%d_:", suffix );	// AUDIT: Using sizeof for snprintf length is safe.
+				uniqPrefix = suggPrefix;
+				uniqPrefix.erase ( uniqPrefix.size()-1 );	// ! Remove the trailing ':'.
+				uniqPrefix += buffer;
+			}
+
+			// Add the new namespace to the index.
+
+			NamespaceEntry * newEntry = new NamespaceEntry;
+			newEntry->uri.assign ( _uri, uriLen );
+			newEntry->uriHash = uriHash;
+			newEntry->prefix.swap ( uniqPrefix );
+			newEntry->prefixHash = HashPrefix ( newEntry->prefix.c_str(), (XMP_StringLen)newEntry->prefix.size(), false );
+			this->AddEntry ( newEntry );
+			entry = newEntry;
+
+		}
 
 	}
 
 	// Return the actual prefix and see if it matches the suggested prefix.
 
-	if ( prefixPtr != 0 ) *prefixPtr = uriPos->second.c_str();
-	if ( prefixLen != 0 ) *prefixLen = (XMP_StringLen)uriPos->second.size();
+	if ( prefixPtr != 0 ) *prefixPtr = entry->prefix.c_str();
+	if ( prefixLen != 0 ) *prefixLen = (XMP_StringLen)entry->prefix.size();
 
-	prefixMatches = ( uriPos->second == suggPrefix );
-	return prefixMatches;
+	return ( entry->prefix == suggPrefix );
 
 }	// XMP_NamespaceTable::Define
 
@@ -498,21 +784,15 @@ bool XMP_NamespaceTable::Define ( XMP_StringPtr _uri, XMP_StringPtr _suggPrefix,
 
 bool XMP_NamespaceTable::GetPrefix ( XMP_StringPtr _uri, XMP_StringPtr * prefixPtr, XMP_StringLen * prefixLen ) const
 {
-	XMP_AutoLock tableLock ( &this->lock, kXMP_ReadLock );
-	bool found = false;
-
 	XMP_Assert ( (_uri != 0) && (*_uri != 0) );
 
-	XMP_VarString uri ( _uri );
-	XMP_cStringMapPos uriPos = this->uriToPrefixMap.find ( uri );
-
-	if ( uriPos != this->uriToPrefixMap.end() ) {
-		if ( prefixPtr != 0 ) *prefixPtr = uriPos->second.c_str();
-		if ( prefixLen != 0 ) *prefixLen = (XMP_StringLen)uriPos->second.size();
-		found = true;
-	}
+	const XMP_StringLen uriLen = (XMP_StringLen) strlen ( _uri );
+	const NamespaceEntry * entry = this->FindURI ( _uri, uriLen, XMP_AtomTable::Hash ( _uri, uriLen ) );
+	if ( entry == 0 ) return false;
 
-	return found;
+	if ( prefixPtr != 0 ) *prefixPtr = entry->prefix.c_str();
+	if ( prefixLen != 0 ) *prefixLen = (XMP_StringLen)entry->prefix.size();
+	return true;
 
 }	// XMP_NamespaceTable::GetPrefix
 
@@ -520,23 +800,16 @@ bool XMP_NamespaceTable::GetPrefix ( XMP_StringPtr _uri, XMP_StringPtr * prefixP
 
 bool XMP_NamespaceTable::GetURI ( XMP_StringPtr _prefix, XMP_StringPtr * uriPtr, XMP_StringLen * uriLen ) const
 {
-	XMP_AutoLock tableLock ( &this->lock, kXMP_ReadLock );
-
-	bool found = false;
-
 	XMP_Assert ( (_prefix != 0) && (*_prefix != 0) );
 
-	XMP_VarString prefix ( _prefix );
-	if ( prefix[prefix.size()-1] != ':' ) prefix += ':';
-	XMP_cStringMapPos prefixPos = this->prefixToURIMap.find ( prefix );
+	const XMP_StringLen prefixLen = (XMP_StringLen) strlen ( _prefix );
+	const bool addColon = (_prefix[prefixLen-1] != ':');
+	const NamespaceEntry * entry = this->FindPrefix ( _prefix, prefixLen, addColon, HashPrefix ( _prefix, prefixLen, addColon ) );
+	if ( entry == 0 ) return false;
 
-	if ( prefixPos != this->prefixToURIMap.end() ) {
-		if ( uriPtr != 0 ) *uriPtr = prefixPos->second.c_str();
-		if ( uriLen != 0 ) *uriLen = (XMP_StringLen)prefixPos->second.size();
-		found = true;
-	}
-
-	return found;
+	if ( uriPtr != 0 ) *uriPtr = entry->uri.c_str();
+	if ( uriLen != 0 ) *uriLen = (XMP_StringLen)entry->uri.size();
+	return true;
 
 }	// XMP_NamespaceTable::GetURI
 
@@ -544,59 +817,173 @@ bool XMP_NamespaceTable::GetURI ( XMP_StringPtr _prefix, XMP_StringPtr * uriPtr,
 
 void XMP_NamespaceTable::Dump ( XMP_TextOutputProc outProc, void * refCon ) const
 {
-	XMP_AutoLock tableLock ( &this->lock, kXMP_ReadLock );
+	XMP_AutoMutex tableLock ( &this->writerMutex );	// ! Keeps the entries stable.
 
-	XMP_cStringMapPos p2uEnd = this->prefixToURIMap.end();	// ! Move up to avoid gcc complaints.
-	XMP_cStringMapPos u2pEnd = this->uriToPrefixMap.end();
+	XMP_StringMap prefixToURIMap;
+	for ( size_t i = 0, limit = this->entries.size(); i < limit; ++i ) {
+		prefixToURIMap.insert ( XMP_StringPair ( this->entries[i]->prefix, this->entries[i]->uri ) );
+	}
 
-	DumpStringMap ( this->prefixToURIMap, "Dumping namespace prefix to URI map", outProc, refCon );
+	DumpStringMap ( prefixToURIMap, "Dumping namespace prefix to URI map", outProc, refCon );
 
-	if ( this->prefixToURIMap.size() != this->uriToPrefixMap.size() ) {
-		OutProcLiteral ( "** bad namespace map sizes **" );
+	if ( prefixToURIMap.size() != this->entries.size() ) {
+		OutProcLiteral ( "** duplicate namespace prefix **" );
 		XMP_Throw ( "Fatal namespace map problem", kXMPErr_InternalFailure );
 	}
 
-	for ( XMP_cStringMapPos nsLeft = this->prefixToURIMap.begin(); nsLeft != p2uEnd; ++nsLeft ) {
+	for ( size_t i = 0, limit = this->entries.size(); i < limit; ++i ) {
+
+		const NamespaceEntry * entry = this->entries[i];
 
-		XMP_cStringMapPos nsOther = this->uriToPrefixMap.find ( nsLeft->second );
-		if ( (nsOther == u2pEnd) || (nsLeft != this->prefixToURIMap.find ( nsOther->second )) ) {
+		if ( this->FindURI ( entry->uri.c_str(), (XMP_StringLen)entry->uri.size(), entry->uriHash ) != entry ) {
 			OutProcLiteral ( "  ** bad namespace URI **  " );
-			DumpClearString ( nsLeft->second, outProc, refCon );
+			DumpClearString ( entry->uri, outProc, refCon );
 			break;
 		}
 
-		for ( XMP_cStringMapPos nsRight = nsLeft; nsRight != p2uEnd; ++nsRight ) {
-			if ( nsRight == nsLeft ) continue;	// ! Can't start at nsLeft+1, no operator+!
-			if ( nsLeft->second == nsRight->second ) {
-				OutProcLiteral ( "  ** duplicate namespace URI **  " );
-				DumpClearString ( nsLeft->second, outProc, refCon );
-				break;
-			}
+		if ( this->FindPrefix ( entry->prefix.c_str(), (XMP_StringLen)entry->prefix.size(), false, entry->prefixHash ) != entry ) {
+			OutProcLiteral ( "  ** bad namespace prefix **  " );
+			DumpClearString ( entry->prefix, outProc, refCon );
+			break;
 		}
 
 	}
 
-	for ( XMP_cStringMapPos nsLeft = this->uriToPrefixMap.begin(); nsLeft != u2pEnd; ++nsLeft ) {
+}	// XMP_NamespaceTable::Dump
 
-		XMP_cStringMapPos nsOther = this->prefixToURIMap.find ( nsLeft->second );
-		if ( (nsOther == p2uEnd) || (nsLeft != this->uriToPrefixMap.find ( nsOther->second )) ) {
-			OutProcLiteral ( "  ** bad namespace prefix **  " );
-			DumpClearString ( nsLeft->second, outProc, refCon );
-			break;
-		}
+// =================================================================================================
+// Atom Tables
+// ===========
 
-		for ( XMP_cStringMapPos nsRight = nsLeft; nsRight != u2pEnd; ++nsRight ) {
-			if ( nsRight == nsLeft ) continue;	// ! Can't start at nsLeft+1, no operator+!
-			if ( nsLeft->second == nsRight->second ) {
-				OutProcLiteral ( "  ** duplicate namespace prefix **  " );
-				DumpClearString ( nsLeft->second, outProc, refCon );
-				break;
-			}
+static const size_t kMinAtomSlots = 256;
+
+XMP_AtomTable::AtomIndex::AtomIndex ( size_t slotCount ) : slotMask(slotCount - 1), slots(0)
+{
+	XMP_Assert ( (slotCount & (slotCount - 1)) == 0 );
+	this->slots = new std::atomic<const AtomEntry*> [slotCount];
+	for ( size_t i = 0; i < slotCount; ++i ) this->slots[i].store ( 0, std::memory_order_relaxed );
+}	// XMP_AtomTable::AtomIndex::AtomIndex
+
+XMP_AtomTable::AtomIndex::~AtomIndex()
+{
+	delete [] this->slots;
+}	// XMP_AtomTable::AtomIndex::~AtomIndex
+
+// =================================================================================================
+
+XMP_AtomTable::XMP_AtomTable ( size_t _maxCount )
+	: index ( new AtomIndex ( kMinAtomSlots ) ), maxCount(_maxCount), isFull(_maxCount == 0)
+{
+	InitializeBasicMutex ( this->writerMutex );
+}	// XMP_AtomTable::XMP_AtomTable
+
+// =================================================================================================
+
+XMP_AtomTable::~XMP_AtomTable()
+{
+	for ( size_t i = 0, limit = this->oldIndices.size(); i < limit; ++i ) delete this->oldIndices[i];
+	for ( size_t i = 0, limit = this->entries.size(); i < limit; ++i ) delete this->entries[i];
+	delete this->index.load();
+	TerminateBasicMutex ( this->writerMutex );
+}	// XMP_AtomTable::~XMP_AtomTable
+
+// =================================================================================================
+
+XMP_Uns32 XMP_AtomTable::Hash ( XMP_StringPtr str, XMP_StringLen len )
+{
+	XMP_Uns32 hash = 2166136261UL;	// FNV-1a
+	for ( XMP_StringPtr strEnd = str + len; str != strEnd; ++str ) hash = (hash ^ (XMP_Uns8)*str) * 16777619UL;
+	return hash;
+}	// XMP_AtomTable::Hash
+
+// =================================================================================================
+
+const XMP_AtomTable::AtomEntry * XMP_AtomTable::FindEntry ( XMP_StringPtr str, XMP_StringLen len, XMP_Uns32 hash ) const
+{
+	const AtomIndex * currIndex = this->index.load ( std::memory_order_acquire );
+	const size_t slotMask = currIndex->slotMask;
+
+	for ( size_t slot = hash & slotMask; ; slot = (slot + 1) & slotMask ) {
+		const AtomEntry * entry = currIndex->slots[slot].load ( std::memory_order_acquire );
+		if ( entry == 0 ) return 0;
+		if ( (entry->hash == hash) && (entry->atom.size() == len) &&
+			 (memcmp ( entry->atom.data(), str, len ) == 0) ) return entry;
+	}
+
+}	// XMP_AtomTable::FindEntry
+
+// =================================================================================================
+
+const XMP_VarString * XMP_AtomTable::Find ( XMP_StringPtr str, XMP_StringLen len ) const
+{
+	if ( len == 0 ) return 0;
+	const AtomEntry * entry = this->FindEntry ( str, len, Hash ( str, len ) );
+	return (entry == 0) ? 0 : &entry->atom;
+}	// XMP_AtomTable::Find
+
+// =================================================================================================
+// Intern
+// ------
+//
+// Names are almost always already present, check without locking. A new entry is published with
+// a release store, a reader sees the complete entry or nothing. When the index gets half full a
+// larger copy is built and swapped in. Replaced indices are kept until the table is deleted
+// because a reader might still be probing one, the sizes double so the total is bounded by the
+// current index. A full table adds nothing, the caller keeps its own copy of the string.
+
+const XMP_VarString * XMP_AtomTable::Intern ( XMP_StringPtr str, XMP_StringLen len )
+{
+	if ( len == 0 ) return 0;
+	const XMP_Uns32 hash = Hash ( str, len );
+
+	const AtomEntry * entry = this->FindEntry ( str, len, hash );
+	if ( entry != 0 ) return &entry->atom;
+
+	XMP_AutoMutex tableLock ( &this->writerMutex );
+	entry = this->FindEntry ( str, len, hash );	// ! Another thread might have added it.
+	if ( entry != 0 ) return &entry->atom;
+	if ( this->entries.size() >= this->maxCount ) return 0;
+
+	const AtomIndex * currIndex = this->index.load ( std::memory_order_relaxed );
+
+	if ( 2*(this->entries.size() + 1) > (currIndex->slotMask + 1) ) {
+
+		AtomIndex * newIndex = new AtomIndex ( 2 * (currIndex->slotMask + 1) );
+		const size_t slotMask = newIndex->slotMask;
+
+		for ( size_t i = 0, limit = this->entries.size(); i < limit; ++i ) {
+			const AtomEntry * oldEntry = this->entries[i];
+			size_t slot = oldEntry->hash & slotMask;
+			while ( newIndex->slots[slot].load ( std::memory_order_relaxed ) != 0 ) slot = (slot + 1) & slotMask;
+			newIndex->slots[slot].store ( oldEntry, std::memory_order_relaxed );
 		}
 
+		this->oldIndices.push_back ( currIndex );
+		this->index.store ( newIndex, std::memory_order_release );
+		currIndex = newIndex;
+
 	}
 
-}	// XMP_NamespaceTable::Dump
+	AtomEntry * newEntry = new AtomEntry ( str, len, hash );
+	this->entries.push_back ( newEntry );
+
+	const size_t slotMask = currIndex->slotMask;
+	size_t slot = hash & slotMask;
+	while ( currIndex->slots[slot].load ( std::memory_order_relaxed ) != 0 ) slot = (slot + 1) & slotMask;
+	currIndex->slots[slot].store ( newEntry, std::memory_order_release );
+	if ( this->entries.size() >= this->maxCount ) this->isFull.store ( true, std::memory_order_release );
+
+	return &newEntry->atom;
+
+}	// XMP_AtomTable::Intern
+
+// =================================================================================================
+
+size_t XMP_AtomTable::Count() const
+{
+	XMP_AutoMutex tableLock ( &this->writerMutex );	// ! Keeps entries stable.
+	return this->entries.size();
+}	// XMP_AtomTable::Count
 
 // =================================================================================================
 static XMP_Bool matchdigit ( XMP_StringPtr text ) {
@@ -12,6 +12,7 @@
 #include "public/include/XMP_Environment.h"	// ! Must be the first include.
 #include "public/include/XMP_Const.h"
 
+#include <atomic>
 #include <map>
 #include <string>
 #include <vector>
@@ -209,8 +210,23 @@ struct ErrorCallbackBox
 //   The lower level synchronization primitives are pthread mutex and condition for UNIX (including
 //   Mac OS X). For Windows there is a choice of critical section and condition variable for Vista
 //   and newer; or critical section, event, and semaphore for XP and newer.
-
-#define UseHomeGrownLock 1
+//
+// * UseStdSharedMutex - This choice uses the C++17 std::shared_mutex. It has the advantages of the
+//   Boost choice without the extra library, and readers do not serialize on an internal mutex as
+//   they do with the home grown lock. It is the default when the compiler supports C++17.
+//
+// The choice can be made from the build by defining one of the symbols, otherwise a default is
+// picked here. The per-object locks and the few library-wide tables all use the chosen mechanism.
+// The library-wide tables that are read on every property access (the namespace and atom tables)
+// need no lock for lookups, see XMP_NamespaceTable.
+
+#if ! (UseNoLock | UseGlobalLibraryLock | UseBoostLock | UsePThreadLock | UseWinSlimLock | UseHomeGrownLock | UseStdSharedMutex)
+	#if __cplusplus >= 201703L
+		#define UseStdSharedMutex 1
+	#else
+		#define UseHomeGrownLock 1
+	#endif
+#endif
 
 // -------------------------------------------------------------------------------------------------
 // A basic exclusive access mutex and atomic increment/decrement operations.
@@ -339,6 +355,20 @@ private:
 	#define XMP_BasicRWLock_ReleaseFromRead(lck)	lck.unlock_shared()
 	#define XMP_BasicRWLock_ReleaseFromWrite(lck)	lck.unlock()
 
+#elif UseStdSharedMutex
+
+	#include <shared_mutex>
+	typedef std::shared_mutex XMP_BasicRWLock;
+	
+	#define XMP_BasicRWLock_Initialize(lck)			/* Do nothing. */
+	#define XMP_BasicRWLock_Terminate(lck)			/* Do nothing. */
+
+	#define XMP_BasicRWLock_AcquireForRead(lck)		lck.lock_shared()
+	#define XMP_BasicRWLock_AcquireForWrite(lck)	lck.lock()
+
+	#define XMP_BasicRWLock_ReleaseFromRead(lck)	lck.unlock_shared()
+	#define XMP_BasicRWLock_ReleaseFromWrite(lck)	lck.unlock()
+
 #elif UsePThreadLock
 
 	#include <pthread.h>
@@ -563,6 +593,24 @@ private:
 #define NO_EXCEPT_FALSE noexcept(false)
 #define NO_EXCEPT_TRUE noexcept(true)
 
+// =================================================================================================
+// XML text scanning
+// =================
+//
+// Find the end of a run of bytes that need no special handling, for the serializer's escaping and
+// the parser's input checks. The bytes are checked 16 at a time with SSE2, otherwise 8 at a time
+// within a 64 bit word. Each returns limit if the whole run is plain.
+
+// The first ASCII control, '&', '<', or '>', and also '"' if forAttribute. These are the characters
+// escaped when serializing an element or attribute value.
+extern const XMP_Uns8 * XMP_FindXMLEscape ( const XMP_Uns8 * start, const XMP_Uns8 * limit, bool forAttribute );
+
+// The first byte that is not printable ASCII (0x20..0x7E), or is '&'.
+extern const XMP_Uns8 * XMP_SkipPlainASCII ( const XMP_Uns8 * start, const XMP_Uns8 * limit );
+
+// The first byte that is not XML whitespace (space, tab, LF, or CR).
+extern const XMP_Uns8 * XMP_SkipXMLWhitespace ( const XMP_Uns8 * start, const XMP_Uns8 * limit );
+
 // =================================================================================================
 // Data structure dumping utilities
 // ================================
@@ -613,12 +661,23 @@ typedef std::map < XMP_VarString, XMP_VarString > XMP_StringMap;
 typedef XMP_StringMap::iterator       XMP_StringMapPos;
 typedef XMP_StringMap::const_iterator XMP_cStringMapPos;
 
+// -------------------------------------------------------------------------------------------------
+// XMP_NamespaceTable
+// ------------------
+//
+// The URI/prefix pairs are only ever added, and after startup almost never. Lookups take no lock:
+// the pairs are reached through an immutable-size hash index that is published with an atomic
+// pointer. Define takes a writer mutex, fills an empty slot (a release store, so readers see the
+// completed pair or nothing), and when the index gets half full builds a larger copy and swaps the
+// pointer. Replaced indices are kept until the table is deleted because a reader might still be
+// probing one, the sizes double so the total is bounded by the current index.
+
 class XMP_NamespaceTable {
 public:
 
-	XMP_NamespaceTable() {};
+	XMP_NamespaceTable();
 	XMP_NamespaceTable ( const XMP_NamespaceTable & presets );
-	virtual ~XMP_NamespaceTable() {};
+	virtual ~XMP_NamespaceTable();
 
     bool Define ( XMP_StringPtr uri, XMP_StringPtr suggPrefix,
     			  XMP_StringPtr * prefixPtr, XMP_StringLen * prefixLen);
@@ -630,8 +689,86 @@ public:
 
 private:
 
-	XMP_ReadWriteLock lock;
-	XMP_StringMap uriToPrefixMap, prefixToURIMap;
+	struct NamespaceEntry {
+		XMP_VarString uri, prefix;	// ! The prefix includes the trailing colon.
+		XMP_Uns32 uriHash, prefixHash;
+	};
+
+	struct NamespaceIndex {
+		size_t slotMask;
+		std::atomic<const NamespaceEntry*> * uriSlots;
+		std::atomic<const NamespaceEntry*> * prefixSlots;
+		explicit NamespaceIndex ( size_t slotCount );
+		~NamespaceIndex();
+	};
+
+	std::atomic<const NamespaceIndex*> index;
+	std::vector<const NamespaceIndex*> oldIndices;	// ! Only touched with the writer mutex held.
+	std::vector<NamespaceEntry*> entries;			// ! Only touched with the writer mutex held.
+	mutable XMP_BasicMutex writerMutex;
+
+	const NamespaceEntry * FindURI ( XMP_StringPtr uri, XMP_StringLen len, XMP_Uns32 hash ) const;
+	const NamespaceEntry * FindPrefix ( XMP_StringPtr prefix, XMP_StringLen len, bool addColon, XMP_Uns32 hash ) const;
+	void AddEntry ( NamespaceEntry * entry );
+
+	void operator= ( const XMP_NamespaceTable & );	// ! Must not be used.
+
+};
+
+// -------------------------------------------------------------------------------------------------
+// XMP_AtomTable
+// -------------
+//
+// A set of interned strings, the companion of XMP_NamespaceTable for the names used in the data
+// model. Each distinct string is stored once and its address is the atom, two atoms from the same
+// table are equal exactly when the pointers are equal. The table never shrinks, atoms live until
+// the table is deleted. Instead it holds at most maxCount strings, after that Intern only returns
+// strings that are already present. The index works like the namespace table's: lookups take no
+// lock, only a first Intern of a new string takes the writer mutex. The empty string is never
+// interned, it is represented by a null atom.
+
+class XMP_AtomTable {
+public:
+
+	explicit XMP_AtomTable ( size_t maxCount = kMaxAtomCount );
+	virtual ~XMP_AtomTable();
+
+	const XMP_VarString * Intern ( XMP_StringPtr str, XMP_StringLen len );	// Returns 0 if full.
+	const XMP_VarString * Find   ( XMP_StringPtr str, XMP_StringLen len ) const;	// Returns 0 if not present.
+
+	size_t Count() const;
+	bool IsFull() const { return this->isFull.load ( std::memory_order_acquire ); };	// ! Once full, always full.
+
+	static XMP_Uns32 Hash ( XMP_StringPtr str, XMP_StringLen len );
+
+	static const size_t kMaxAtomCount = 64*1024;
+
+private:
+
+	struct AtomEntry {
+		XMP_VarString atom;	// ! First, the atom is the address of the entry.
+		XMP_Uns32 hash;
+		AtomEntry ( XMP_StringPtr str, XMP_StringLen len, XMP_Uns32 _hash ) : atom(str,len), hash(_hash) {};
+	};
+
+	struct AtomIndex {
+		size_t slotMask;
+		std::atomic<const AtomEntry*> * slots;
+		explicit AtomIndex ( size_t slotCount );
+		~AtomIndex();
+	};
+
+	std::atomic<const AtomIndex*> index;
+	std::vector<const AtomIndex*> oldIndices;	// ! Only touched with the writer mutex held.
+	std::vector<AtomEntry*> entries;			// ! Only touched with the writer mutex held.
+	const size_t maxCount;
+	std::atomic<bool> isFull;
+	mutable XMP_BasicMutex writerMutex;
+
+	const AtomEntry * FindEntry ( XMP_StringPtr str, XMP_StringLen len, XMP_Uns32 hash ) const;
+
+	XMP_AtomTable ( const XMP_AtomTable & );	// ! Atoms are addresses, a copy makes no sense.
+	void operator= ( const XMP_AtomTable & );
 
 };
 